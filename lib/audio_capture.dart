@@ -7,17 +7,38 @@
 
 export 'package:desktop_audio_capture/mic/mic_audio_capture.dart';
 export 'package:desktop_audio_capture/system/system_audio_capture.dart';
+export 'package:desktop_audio_capture/synced/synced_audio_capture.dart';
 
 // Re-export DecibelData from mic_audio_capture (both mic and system use the same class)
 export 'package:desktop_audio_capture/model/decibel_data.dart';
 export 'package:desktop_audio_capture/model/input_device_type.dart';
 export 'package:desktop_audio_capture/model/audio_status.dart';
+export 'package:desktop_audio_capture/model/audio_chunk.dart';
+export 'package:desktop_audio_capture/model/overrun_event.dart';
+export 'package:desktop_audio_capture/model/capture_stats.dart';
+export 'package:desktop_audio_capture/model/loudness_data.dart';
+export 'package:desktop_audio_capture/model/speech_event.dart';
+export 'package:desktop_audio_capture/model/delay_event.dart';
+export 'package:desktop_audio_capture/model/mel_features.dart';
+export 'package:desktop_audio_capture/model/spectrum_data.dart';
+export 'package:desktop_audio_capture/model/waveform_data.dart';
+export 'package:desktop_audio_capture/config/resample_quality.dart';
+export 'package:desktop_audio_capture/config/level_meter_config.dart';
+export 'package:desktop_audio_capture/config/voice_activity_config.dart';
+export 'package:desktop_audio_capture/config/utterance_config.dart';
+export 'package:desktop_audio_capture/config/mel_feature_config.dart';
+export 'package:desktop_audio_capture/config/spectrum_config.dart';
+export 'package:desktop_audio_capture/config/waveform_config.dart';
+export 'package:desktop_audio_capture/config/audio_filter.dart';
+export 'package:desktop_audio_capture/config/noise_suppression_level.dart';
+export 'package:desktop_audio_capture/config/agc_config.dart';
+export 'package:desktop_audio_capture/config/compressor_config.dart';
 
 /// Abstract base class for audio capture functionality.
 ///
 /// This class defines the common interface for capturing audio from different sources
-/// (microphone or system audio). Implementations include [MicAudioCapture] and
-/// [SystemAudioCapture].
+/// (microphone or system audio). Implementations include [MicAudioCapture],
+/// [SystemAudioCapture] and [SyncedAudioCapture].
 ///
 /// Example:
 /// ```dart
@@ -0,0 +1,96 @@
+/// What automatic gain control measures the input level with.
+enum AgcDetector {
+  /// Plain RMS level, in dBFS.
+  rms,
+
+  /// K-weighted loudness as in ITU-R BS.1770, in LUFS: closer to how loud
+  /// speech sounds than RMS.
+  loudness,
+}
+
+/// Automatic gain control, applied natively to the processed audio.
+///
+/// With an [AgcConfig] the fixed `gainBoost` is replaced by a gain that
+/// follows the input level towards [targetDb], falling with [attackMs] and
+/// rising with [releaseMs], and a look-ahead limiter that keeps peaks under
+/// [ceilingDb] without clipping. Pauses quieter than [gateDb] hold the gain.
+/// The audio is delayed by [lookaheadMs]. The applied gains are reported
+/// with every `DecibelData` as `gainDb` and `limiterGainDb`. Linux only.
+///
+/// Example:
+/// ```dart
+/// // Even out near and far talkers at -18 LUFS.
+/// final config = MicAudioConfig(
+///   agc: const AgcConfig(detector: AgcDetector.loudness, targetDb: -18),
+/// );
+/// ```
+class AgcConfig {
+  /// What the level is measured with (default: [AgcDetector.rms]).
+  final AgcDetector detector;
+
+  /// Level the gain steers towards, in dBFS or LUFS per [detector]
+  /// (default: -20, range: -60 to 0).
+  final double targetDb;
+
+  /// Integration time of the level in milliseconds (default: 400).
+  final int windowMs;
+
+  /// Time constant of the gain while it falls, in milliseconds (default:
+  /// 150).
+  final int attackMs;
+
+  /// Time constant of the gain while it rises, in milliseconds (default:
+  /// 2000).
+  final int releaseMs;
+
+  /// Highest gain in dB (default: 30, range: 0 to 60).
+  final double maxGainDb;
+
+  /// Input quieter than this, in dB, holds the gain (default: -60).
+  final double gateDb;
+
+  /// How far the limiter looks ahead, in milliseconds (default: 5, range: 0
+  /// to 50). The audio is delayed by as much.
+  final int lookaheadMs;
+
+  /// Highest peak the limiter lets through, in dBFS (default: -1, range:
+  /// -20 to 0).
+  final double ceilingDb;
+
+  /// Creates an automatic gain control configuration.
+  const AgcConfig({
+    this.detector = AgcDetector.rms,
+    this.targetDb = -20.0,
+    this.windowMs = 400,
+    this.attackMs = 150,
+    this.releaseMs = 2000,
+    this.maxGainDb = 30.0,
+    this.gateDb = -60.0,
+    this.lookaheadMs = 5,
+    this.ceilingDb = -1.0,
+  });
+
+  /// The options as passed to the platform with the capture configuration:
+  /// `agc`, `agcDetector` (the [AgcDetector] name), `agcTargetDb`,
+  /// `agcWindowMs`, `agcAttackMs`, `agcReleaseMs`, `agcMaxGainDb`,
+  /// `agcGateDb`, `agcLookaheadMs` and `agcCeilingDb`.
+  Map<String, dynamic> toMap() {
+    return {
+      'agc': true,
+      'agcDetector': detector.name,
+      'agcTargetDb': targetDb,
+      'agcWindowMs': windowMs,
+      'agcAttackMs': attackMs,
+      'agcReleaseMs': releaseMs,
+      'agcMaxGainDb': maxGainDb,
+      'agcGateDb': gateDb,
+      'agcLookaheadMs': lookaheadMs,
+      'agcCeilingDb': ceilingDb,
+    };
+  }
+
+  @override
+  String toString() {
+    return 'AgcConfig(detector: ${detector.name}, targetDb: $targetDb, windowMs: $windowMs, attackMs: $attackMs, releaseMs: $releaseMs, maxGainDb: $maxGainDb, gateDb: $gateDb, lookaheadMs: $lookaheadMs, ceilingDb: $ceilingDb)';
+  }
+}
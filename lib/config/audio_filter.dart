@@ -0,0 +1,119 @@
+/// Shape of an [AudioFilter] stage.
+enum AudioFilterType {
+  /// Removes a DC offset, passing everything above [AudioFilter.frequencyHz].
+  dcBlock,
+
+  /// Removes rumble below [AudioFilter.frequencyHz].
+  highPass,
+
+  /// Removes hiss above [AudioFilter.frequencyHz].
+  lowPass,
+
+  /// Raises or lowers everything below [AudioFilter.frequencyHz] by
+  /// [AudioFilter.gainDb].
+  lowShelf,
+
+  /// Raises or lowers everything above [AudioFilter.frequencyHz] by
+  /// [AudioFilter.gainDb].
+  highShelf,
+
+  /// Removes a narrow band around [AudioFilter.frequencyHz], such as mains
+  /// hum.
+  notch,
+}
+
+/// One stage of the native filter chain.
+///
+/// Stages run in order on the audio as read, before the gain, noise
+/// suppression and every measurement, so levels and loudness see the
+/// filtered audio. Each stage is a biquad: 12 dB per octave for the high-
+/// and low-pass, 6 dB for the DC blocker. Linux only.
+///
+/// Example:
+/// ```dart
+/// // Remove a DC offset, rumble below 80 Hz and 50 Hz mains hum.
+/// final config = MicAudioConfig(
+///   filters: const [
+///     AudioFilter.dcBlock(),
+///     AudioFilter.highPass(frequencyHz: 80),
+///     AudioFilter.notch(frequencyHz: 50),
+///   ],
+/// );
+/// ```
+class AudioFilter {
+  /// What the stage does.
+  final AudioFilterType type;
+
+  /// Corner, shelf or notch frequency in Hz (range: 1 up to just under half
+  /// the sample rate).
+  final double frequencyHz;
+
+  /// Quality factor: the resonance of the high- and low-pass, the slope of
+  /// the shelves, the narrowness of the notch (range: 0.1 to 100). Unused
+  /// by the DC blocker.
+  final double q;
+
+  /// Gain of the shelves in dB (range: -24 to 24). Unused by the other
+  /// stages.
+  final double gainDb;
+
+  /// Creates a filter stage; prefer the named constructors.
+  const AudioFilter({
+    required this.type,
+    required this.frequencyHz,
+    this.q = 0.7071,
+    this.gainDb = 0.0,
+  });
+
+  /// A DC blocker with its corner at [frequencyHz] (default: 10).
+  const AudioFilter.dcBlock({this.frequencyHz = 10.0})
+      : type = AudioFilterType.dcBlock,
+        q = 0.7071,
+        gainDb = 0.0;
+
+  /// A high-pass at [frequencyHz] (default: 80), Butterworth by default.
+  const AudioFilter.highPass({this.frequencyHz = 80.0, this.q = 0.7071})
+      : type = AudioFilterType.highPass,
+        gainDb = 0.0;
+
+  /// A low-pass at [frequencyHz], Butterworth by default.
+  const AudioFilter.lowPass({required this.frequencyHz, this.q = 0.7071})
+      : type = AudioFilterType.lowPass,
+        gainDb = 0.0;
+
+  /// A low shelf of [gainDb] below [frequencyHz].
+  const AudioFilter.lowShelf({
+    required this.frequencyHz,
+    required this.gainDb,
+    this.q = 0.7071,
+  }) : type = AudioFilterType.lowShelf;
+
+  /// A high shelf of [gainDb] above [frequencyHz].
+  const AudioFilter.highShelf({
+    required this.frequencyHz,
+    required this.gainDb,
+    this.q = 0.7071,
+  }) : type = AudioFilterType.highShelf;
+
+  /// A notch at [frequencyHz] (50 or 60 for mains hum), [q] wide (default:
+  /// 10, about 5 Hz at 50 Hz).
+  const AudioFilter.notch({required this.frequencyHz, this.q = 10.0})
+      : type = AudioFilterType.notch,
+        gainDb = 0.0;
+
+  /// The stage as passed to the platform in the `filters` list: `type` (the
+  /// [AudioFilterType] name), `frequencyHz`, `q` and `gainDb`.
+  Map<String, dynamic> toMap() {
+    return {
+      'type': type.name,
+      'frequencyHz': frequencyHz,
+      'q': q,
+      'gainDb': gainDb,
+    };
+  }
+
+  @override
+  String toString() {
+    return 'AudioFilter(type: ${type.name}, frequencyHz: $frequencyHz, q: $q, gainDb: $gainDb)';
+  }
+}
@@ -0,0 +1,76 @@
+/// Compressor and limiter, applied natively where the gain boost is applied.
+///
+/// Without one, the boosted audio is clamped at full scale, and loud input
+/// clips. With a [CompressorConfig] it is compressed instead: levels more
+/// than [thresholdDb] are reduced by [ratio] over a soft knee [kneeDb] wide,
+/// the detector rising with [attackMs] and falling with [releaseMs], and
+/// the limiter keeps peaks under [ceilingDb]. Nothing is delayed. The gain
+/// reduction is reported with every `DecibelData` as `compressorGainDb`;
+/// levels and loudness are still measured on the captured audio. Linux
+/// only; Windows always limits its boosted audio at full scale instead of
+/// clamping it.
+///
+/// Example:
+/// ```dart
+/// // Boost a quiet microphone without letting loud words distort.
+/// final config = MicAudioConfig(
+///   gainBoost: 6.0,
+///   compressor: const CompressorConfig(thresholdDb: -18, ratio: 3),
+/// );
+/// ```
+class CompressorConfig {
+  /// Level above which the gain is reduced, in dBFS (default: -12, range:
+  /// -60 to 0).
+  final double thresholdDb;
+
+  /// How many dB over the threshold in make one dB out (default: 4, range:
+  /// 1 to 20). 1 leaves only the limiter.
+  final double ratio;
+
+  /// Width of the soft knee around [thresholdDb] in dB (default: 6, range:
+  /// 0 to 24).
+  final double kneeDb;
+
+  /// Time constant of the level detector while it rises, in milliseconds
+  /// (default: 5).
+  final int attackMs;
+
+  /// Time constant of the level detector while it falls, in milliseconds
+  /// (default: 150).
+  final int releaseMs;
+
+  /// Highest peak the limiter lets through, in dBFS (default: -1, range:
+  /// -20 to 0).
+  final double ceilingDb;
+
+  /// Creates a compressor configuration.
+  const CompressorConfig({
+    this.thresholdDb = -12.0,
+    this.ratio = 4.0,
+    this.kneeDb = 6.0,
+    this.attackMs = 5,
+    this.releaseMs = 150,
+    this.ceilingDb = -1.0,
+  });
+
+  /// The options as passed to the platform with the capture configuration:
+  /// `compressor`, `compressorThresholdDb`, `compressorRatio`,
+  /// `compressorKneeDb`, `compressorAttackMs`, `compressorReleaseMs` and
+  /// `compressorCeilingDb`.
+  Map<String, dynamic> toMap() {
+    return {
+      'compressor': true,
+      'compressorThresholdDb': thresholdDb,
+      'compressorRatio': ratio,
+      'compressorKneeDb': kneeDb,
+      'compressorAttackMs': attackMs,
+      'compressorReleaseMs': releaseMs,
+      'compressorCeilingDb': ceilingDb,
+    };
+  }
+
+  @override
+  String toString() {
+    return 'CompressorConfig(thresholdDb: $thresholdDb, ratio: $ratio, kneeDb: $kneeDb, attackMs: $attackMs, releaseMs: $releaseMs, ceilingDb: $ceilingDb)';
+  }
+}
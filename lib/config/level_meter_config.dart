@@ -0,0 +1,84 @@
+/// How levels on `decibelStream` are measured and how often they are sent.
+///
+/// Without a [LevelMeterConfig] each audio chunk carries the RMS level of
+/// its own samples, so levels arrive as often as chunks do. With one, levels
+/// are measured as the audio is read, over blocks of 1/[rateHz] seconds, and
+/// sent at that rate whatever the chunk size; the audio is read in pieces of
+/// one block and reassembled into chunks of the configured size. Each level
+/// then also carries a peak and a held peak. Linux only.
+///
+/// Example:
+/// ```dart
+/// // A VU-style meter refreshed 30 times a second.
+/// final config = MicAudioConfig(meter: LevelMeterConfig.vu());
+///
+/// // A peak meter with a one second peak hold.
+/// final ppm = SystemAudioConfig(
+///   meter: LevelMeterConfig(rateHz: 60, attackMs: 5, releaseMs: 1500,
+///       holdMs: 1000),
+/// );
+/// ```
+class LevelMeterConfig {
+  /// Levels per second (default: 30, range: 1 to 120).
+  final int rateHz;
+
+  /// RMS integration time in milliseconds (default: 0, one block).
+  ///
+  /// The RMS level averages the power of this much recent audio. 300 ms
+  /// gives VU-like averaging.
+  final int windowMs;
+
+  /// Time constant of the peak while it rises, in milliseconds (default: 0,
+  /// instant).
+  final int attackMs;
+
+  /// Time constant of the peak while it falls, in milliseconds (default: 0,
+  /// instant).
+  final int releaseMs;
+
+  /// How long the highest peak is held before it falls, in milliseconds
+  /// (default: 0, no hold).
+  final int holdMs;
+
+  /// Creates a meter configuration. Times are rounded to whole blocks.
+  const LevelMeterConfig({
+    this.rateHz = 30,
+    this.windowMs = 0,
+    this.attackMs = 0,
+    this.releaseMs = 0,
+    this.holdMs = 0,
+  });
+
+  /// VU-style averaging: a 300 ms RMS window and a slowly falling peak.
+  const LevelMeterConfig.vu({this.rateHz = 30})
+      : windowMs = 300,
+        attackMs = 0,
+        releaseMs = 300,
+        holdMs = 0;
+
+  /// PPM-style peak metering: a fast rising, slowly falling peak held for
+  /// a second.
+  const LevelMeterConfig.ppm({this.rateHz = 30})
+      : windowMs = 0,
+        attackMs = 5,
+        releaseMs = 1500,
+        holdMs = 1000;
+
+  /// The options as passed to the platform with the capture configuration:
+  /// `meterRateHz`, `meterWindowMs`, `meterAttackMs`, `meterReleaseMs` and
+  /// `meterHoldMs`.
+  Map<String, dynamic> toMap() {
+    return {
+      'meterRateHz': rateHz,
+      'meterWindowMs': windowMs,
+      'meterAttackMs': attackMs,
+      'meterReleaseMs': releaseMs,
+      'meterHoldMs': holdMs,
+    };
+  }
+
+  @override
+  String toString() {
+    return 'LevelMeterConfig(rateHz: $rateHz, windowMs: $windowMs, attackMs: $attackMs, releaseMs: $releaseMs, holdMs: $holdMs)';
+  }
+}
@@ -0,0 +1,60 @@
+/// Log-mel spectrogram features extracted natively next to capture.
+///
+/// With a [MelFeatureConfig] the processed audio is also turned into
+/// log-mel frames as speech recognition front ends take them, delivered as
+/// `MelFeatures` on `featureStream`: a Hann window of [windowMs] every
+/// [hopMs], its power spectrum weighted by [bins] triangular filters on the
+/// mel scale from [lowHz] to [highHz], and the natural log of each. Frames
+/// are only computed while `featureStream` is listened to. Linux only.
+///
+/// Example:
+/// ```dart
+/// // 80 bins, 25 ms windows, 10 ms hop.
+/// final config = MicAudioConfig(melFeatures: const MelFeatureConfig());
+/// ```
+class MelFeatureConfig {
+  /// Mel filters per frame (default: 80, range: 1 to 256).
+  final int bins;
+
+  /// Analysis window in milliseconds (default: 25, range: 5 to 100).
+  final int windowMs;
+
+  /// Time between frames in milliseconds (default: 10, at most
+  /// [windowMs]).
+  final int hopMs;
+
+  /// Lower edge of the lowest filter in Hz (default: 20).
+  final double lowHz;
+
+  /// Upper edge of the highest filter in Hz (default: 0, half the sample
+  /// rate).
+  final double highHz;
+
+  /// Creates a feature extraction configuration.
+  const MelFeatureConfig({
+    this.bins = 80,
+    this.windowMs = 25,
+    this.hopMs = 10,
+    this.lowHz = 20.0,
+    this.highHz = 0.0,
+  });
+
+  /// The options as passed to the platform with the capture configuration:
+  /// `melFeatures`, `melBins`, `melWindowMs`, `melHopMs`, `melLowHz` and
+  /// `melHighHz`.
+  Map<String, dynamic> toMap() {
+    return {
+      'melFeatures': true,
+      'melBins': bins,
+      'melWindowMs': windowMs,
+      'melHopMs': hopMs,
+      'melLowHz': lowHz,
+      'melHighHz': highHz,
+    };
+  }
+
+  @override
+  String toString() {
+    return 'MelFeatureConfig(bins: $bins, windowMs: $windowMs, hopMs: $hopMs, lowHz: $lowHz, highHz: $highHz)';
+  }
+}
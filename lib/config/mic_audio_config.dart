@@ -52,6 +52,7 @@ class MicAudioConfig extends AudioCaptureConfig {
   ///
   /// Higher values increase microphone sensitivity and amplify the input signal.
   /// Use with caution as very high values may cause distortion.
+  /// Ignored when [agc] is set.
   final double gainBoost;
 
   /// Input volume (default: 1.0, range: 0.0 to 1.0).
@@ -62,6 +63,113 @@ class MicAudioConfig extends AudioCaptureConfig {
   /// - 1.0: Full volume
   final double inputVolume;
 
+  /// Input device to capture from (default: `null`, the system default).
+  ///
+  /// Use an `id` returned by [MicAudioCapture.getAvailableInputDevices].
+  /// On Linux this is the PulseAudio source name.
+  final String? deviceId;
+
+  /// Whether audio lost to overruns is replaced by silence (default: `false`).
+  ///
+  /// When the capture falls behind, the lost frames are always reported on
+  /// `overrunStream`. With this enabled the same number of silent frames is
+  /// also inserted, so sample positions and durations keep matching the
+  /// capture timeline. Gaps longer than 10 seconds are not filled.
+  /// Linux only.
+  final bool fillGaps;
+
+  /// Whether the capture threads request real-time scheduling (default:
+  /// `false`).
+  ///
+  /// Keeps capture running on loaded machines. The threads ask for SCHED_RR,
+  /// directly if the process may (`RLIMIT_RTPRIO`) or else through
+  /// RealtimeKit, and lock their buffers into memory. Capture continues at
+  /// normal priority if neither is permitted; `getStats()` reports what was
+  /// granted. Linux only.
+  final bool realtime;
+
+  /// SCHED_RR priority requested when [realtime] is set (default: 10,
+  /// range: 1 to 99). RealtimeKit may grant less.
+  final int realtimePriority;
+
+  /// CPUs the capture threads are pinned to (default: `null`, any CPU).
+  /// CPU numbers from 0 to 63. Linux only.
+  final List<int>? cpuAffinity;
+
+  /// Whether to capture at the source's own sample rate and sample format
+  /// and convert to 16-bit PCM at [sampleRate] in the plugin (default:
+  /// `false`).
+  ///
+  /// By default the audio server converts, with whatever method and latency
+  /// its configuration dictates. With this set the stream is opened at the
+  /// rate and format the server reports for the source, and a known-quality
+  /// resampler and dithered format conversion take over; `chunkStream`
+  /// reports the time each chunk took. Linux only.
+  final bool nativeRate;
+
+  /// Quality of the conversion when [nativeRate] is set (default:
+  /// [ResampleQuality.medium]).
+  final ResampleQuality resampleQuality;
+
+  /// Whether to capture for a level meter only (default: `false`).
+  ///
+  /// No PCM is delivered: the stream is read in 100 ms fragments, levels are
+  /// measured as the audio arrives, and `decibelStream` receives one level
+  /// per [meter] block (30 a second by default), paced on the main loop.
+  /// This takes far fewer wakeups than a full capture delivering chunks at
+  /// the same rate. [nativeRate] does not apply. Linux only.
+  final bool meterOnly;
+
+  /// How levels are measured and how often they are sent (default: `null`,
+  /// one RMS level per chunk). See [LevelMeterConfig].
+  final LevelMeterConfig? meter;
+
+  /// Whether to measure loudness as EBU R128 defines it (default: `false`).
+  ///
+  /// Every level on `decibelStream` then also carries the momentary,
+  /// short-term and integrated loudness, the loudness range and the true
+  /// peak, and `getStats()` reports them for the whole capture. Measured on
+  /// all captured audio, listened to or not. Linux only.
+  final bool loudness;
+
+  /// Voice activity detection (default: `null`, none). See
+  /// [VoiceActivityConfig]. Ignored when [meterOnly] is set.
+  final VoiceActivityConfig? voiceActivity;
+
+  /// Delivery of the audio as whole utterances (default: `null`, fixed
+  /// chunks). See [UtteranceConfig]. Overrides the options of
+  /// [voiceActivity]. Ignored when [meterOnly] is set.
+  final UtteranceConfig? utterances;
+
+  /// Log-mel feature extraction (default: `null`, none). See
+  /// [MelFeatureConfig]. Ignored when [meterOnly] is set.
+  final MelFeatureConfig? melFeatures;
+
+  /// Spectrum analysis for visualizers (default: `null`, none). See
+  /// [SpectrumConfig]. Ignored when [meterOnly] is set.
+  final SpectrumConfig? spectrum;
+
+  /// Waveform buckets for display (default: `null`, none). See
+  /// [WaveformConfig]. Ignored when [meterOnly] is set.
+  final WaveformConfig? waveform;
+
+  /// Filter stages run in order on the audio as read (default: `null`,
+  /// none): DC removal, rumble, hum or tone shaping. See [AudioFilter].
+  final List<AudioFilter>? filters;
+
+  /// Noise suppression strength (default: `null`, none). Delays the audio
+  /// by 16 ms at 16 kHz. Ignored when [meterOnly] is set.
+  final NoiseSuppressionLevel? noiseSuppression;
+
+  /// Automatic gain control in place of the fixed gain boost (default:
+  /// `null`, none). See [AgcConfig]. Ignored when [meterOnly] is set.
+  final AgcConfig? agc;
+
+  /// Compression of the boosted audio (default: `null`, the boosted audio
+  /// is clamped at full scale). See [CompressorConfig]. Ignored when
+  /// [meterOnly] is set.
+  final CompressorConfig? compressor;
+
   /// Creates a new [MicAudioConfig] instance.
   ///
   /// All parameters are optional and have default values:
@@ -70,6 +178,25 @@ class MicAudioConfig extends AudioCaptureConfig {
   /// - [bitDepth]: 16
   /// - [gainBoost]: 2.5
   /// - [inputVolume]: 1.0
+  /// - [deviceId]: null
+  /// - [fillGaps]: false
+  /// - [realtime]: false
+  /// - [realtimePriority]: 10
+  /// - [cpuAffinity]: null
+  /// - [nativeRate]: false
+  /// - [resampleQuality]: [ResampleQuality.medium]
+  /// - [meterOnly]: false
+  /// - [meter]: null
+  /// - [loudness]: false
+  /// - [voiceActivity]: null
+  /// - [utterances]: null
+  /// - [melFeatures]: null
+  /// - [spectrum]: null
+  /// - [waveform]: null
+  /// - [filters]: null
+  /// - [noiseSuppression]: null
+  /// - [agc]: null
+  /// - [compressor]: null
   ///
   /// Example:
   /// ```dart
@@ -85,6 +212,25 @@ class MicAudioConfig extends AudioCaptureConfig {
     this.bitDepth = 16,
     this.gainBoost = 2.5,
     this.inputVolume = 1.0,
+    this.deviceId,
+    this.fillGaps = false,
+    this.realtime = false,
+    this.realtimePriority = 10,
+    this.cpuAffinity,
+    this.nativeRate = false,
+    this.resampleQuality = ResampleQuality.medium,
+    this.meterOnly = false,
+    this.meter,
+    this.loudness = false,
+    this.voiceActivity,
+    this.utterances,
+    this.melFeatures,
+    this.spectrum,
+    this.waveform,
+    this.filters,
+    this.noiseSuppression,
+    this.agc,
+    this.compressor,
   });
 
   /// Creates a copy of this configuration with modified values.
@@ -108,6 +254,25 @@ class MicAudioConfig extends AudioCaptureConfig {
     int? bitDepth,
     double? gainBoost,
     double? inputVolume,
+    String? deviceId,
+    bool? fillGaps,
+    bool? realtime,
+    int? realtimePriority,
+    List<int>? cpuAffinity,
+    bool? nativeRate,
+    ResampleQuality? resampleQuality,
+    bool? meterOnly,
+    LevelMeterConfig? meter,
+    bool? loudness,
+    VoiceActivityConfig? voiceActivity,
+    UtteranceConfig? utterances,
+    MelFeatureConfig? melFeatures,
+    SpectrumConfig? spectrum,
+    WaveformConfig? waveform,
+    List<AudioFilter>? filters,
+    NoiseSuppressionLevel? noiseSuppression,
+    AgcConfig? agc,
+    CompressorConfig? compressor,
   }) {
     return MicAudioConfig(
       sampleRate: sampleRate ?? this.sampleRate,
@@ -115,6 +280,25 @@ class MicAudioConfig extends AudioCaptureConfig {
       bitDepth: bitDepth ?? this.bitDepth,
       gainBoost: gainBoost ?? this.gainBoost,
       inputVolume: inputVolume ?? this.inputVolume,
+      deviceId: deviceId ?? this.deviceId,
+      fillGaps: fillGaps ?? this.fillGaps,
+      realtime: realtime ?? this.realtime,
+      realtimePriority: realtimePriority ?? this.realtimePriority,
+      cpuAffinity: cpuAffinity ?? this.cpuAffinity,
+      nativeRate: nativeRate ?? this.nativeRate,
+      resampleQuality: resampleQuality ?? this.resampleQuality,
+      meterOnly: meterOnly ?? this.meterOnly,
+      meter: meter ?? this.meter,
+      loudness: loudness ?? this.loudness,
+      voiceActivity: voiceActivity ?? this.voiceActivity,
+      utterances: utterances ?? this.utterances,
+      melFeatures: melFeatures ?? this.melFeatures,
+      spectrum: spectrum ?? this.spectrum,
+      waveform: waveform ?? this.waveform,
+      filters: filters ?? this.filters,
+      noiseSuppression: noiseSuppression ?? this.noiseSuppression,
+      agc: agc ?? this.agc,
+      compressor: compressor ?? this.compressor,
     );
   }
 
@@ -126,6 +310,28 @@ class MicAudioConfig extends AudioCaptureConfig {
   /// - `bitDepth`: int
   /// - `gainBoost`: double
   /// - `inputVolume`: double
+  /// - `deviceId`: String (only when set)
+  /// - `fillGaps`: bool
+  /// - `realtime`: bool
+  /// - `realtimePriority`: int
+  /// - `cpuAffinity`: List<int> (only when set)
+  /// - `nativeRate`: bool
+  /// - `resampleQuality`: String (the [ResampleQuality] name)
+  /// - `meterOnly`: bool
+  /// - the [LevelMeterConfig.toMap] entries (only when [meter] is set)
+  /// - `loudness`: bool
+  /// - the [VoiceActivityConfig.toMap] entries (only when [voiceActivity] is
+  ///   set)
+  /// - the [UtteranceConfig.toMap] entries (only when [utterances] is set)
+  /// - the [MelFeatureConfig.toMap] entries (only when [melFeatures] is
+  ///   set)
+  /// - the [SpectrumConfig.toMap] entries (only when [spectrum] is set)
+  /// - the [WaveformConfig.toMap] entries (only when [waveform] is set)
+  /// - `filters`: List of the [AudioFilter.toMap] maps (only when set)
+  /// - `noiseSuppression`: String (the [NoiseSuppressionLevel] name, only
+  ///   when set)
+  /// - the [AgcConfig.toMap] entries (only when [agc] is set)
+  /// - the [CompressorConfig.toMap] entries (only when [compressor] is set)
   ///
   /// Example:
   /// ```dart
@@ -134,7 +340,7 @@ class MicAudioConfig extends AudioCaptureConfig {
   ///   channels: 2,
   /// );
   /// final map = config.toMap();
-  /// // map = {'sampleRate': 44100, 'channels': 2, 'bitDepth': 16, 'gainBoost': 2.5, 'inputVolume': 1.0}
+  /// // map = {'sampleRate': 44100, 'channels': 2, 'bitDepth': 16, 'gainBoost': 2.5, 'inputVolume': 1.0, 'fillGaps': false, 'realtime': false, 'realtimePriority': 10}
   /// ```
   Map<String, dynamic> toMap() {
     return {
@@ -143,11 +349,32 @@ class MicAudioConfig extends AudioCaptureConfig {
       'bitDepth': bitDepth,
       'gainBoost': gainBoost,
       'inputVolume': inputVolume,
+      if (deviceId != null) 'deviceId': deviceId,
+      'fillGaps': fillGaps,
+      'realtime': realtime,
+      'realtimePriority': realtimePriority,
+      if (cpuAffinity != null) 'cpuAffinity': cpuAffinity,
+      'nativeRate': nativeRate,
+      'resampleQuality': resampleQuality.name,
+      'meterOnly': meterOnly,
+      if (meter != null) ...meter!.toMap(),
+      'loudness': loudness,
+      if (voiceActivity != null) ...voiceActivity!.toMap(),
+      if (utterances != null) ...utterances!.toMap(),
+      if (melFeatures != null) ...melFeatures!.toMap(),
+      if (spectrum != null) ...spectrum!.toMap(),
+      if (waveform != null) ...waveform!.toMap(),
+      if (filters != null)
+        'filters': [for (final filter in filters!) filter.toMap()],
+      if (noiseSuppression != null)
+        'noiseSuppression': noiseSuppression!.name,
+      if (agc != null) ...agc!.toMap(),
+      if (compressor != null) ...compressor!.toMap(),
     };
   }
 
   @override
   String toString() {
-    return 'MicConfig(sampleRate: $sampleRate, channels: $channels, bitDepth: $bitDepth, gainBoost: $gainBoost, inputVolume: $inputVolume)';
+    return 'MicConfig(sampleRate: $sampleRate, channels: $channels, bitDepth: $bitDepth, gainBoost: $gainBoost, inputVolume: $inputVolume, deviceId: $deviceId, fillGaps: $fillGaps, realtime: $realtime, cpuAffinity: $cpuAffinity, nativeRate: $nativeRate, meterOnly: $meterOnly, meter: $meter, loudness: $loudness, voiceActivity: $voiceActivity, utterances: $utterances, melFeatures: $melFeatures, spectrum: $spectrum, waveform: $waveform, filters: $filters, noiseSuppression: $noiseSuppression, agc: $agc, compressor: $compressor)';
   }
 }
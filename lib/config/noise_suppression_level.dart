@@ -0,0 +1,18 @@
+/// Strength of the native noise suppression.
+///
+/// Each level caps how far steady background noise such as fans, hum and
+/// air conditioning is attenuated. Stronger levels remove more of it at the
+/// cost of more audible artifacts on speech.
+enum NoiseSuppressionLevel {
+  /// Up to 6 dB.
+  low,
+
+  /// Up to 12 dB.
+  moderate,
+
+  /// Up to 18 dB.
+  high,
+
+  /// Up to 24 dB.
+  veryHigh,
+}
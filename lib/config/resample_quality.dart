@@ -0,0 +1,15 @@
+/// Quality of the in-process sample rate conversion.
+///
+/// Higher presets use longer filters: better rejection of content above the
+/// output Nyquist frequency at the cost of CPU time and a few milliseconds
+/// of latency.
+enum ResampleQuality {
+  /// About 50 dB rejection; the cheapest.
+  low,
+
+  /// About 70 dB rejection.
+  medium,
+
+  /// About 90 dB rejection.
+  high,
+}
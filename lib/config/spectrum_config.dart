@@ -0,0 +1,77 @@
+/// Spectrum analysis for visualizers, computed natively next to capture.
+///
+/// With a [SpectrumConfig] the processed audio is also run through a
+/// Hann-windowed FFT of [fftSize] samples, with consecutive frames
+/// overlapping by [overlap], and the power summed into [bands] bands spaced
+/// evenly on a log frequency axis from [lowHz] to [highHz]. The band levels
+/// are delivered as `SpectrumData` on `spectrumStream` about [rateHz] times
+/// a second, in dBFS: a full-scale sine reads about 0 dB in its band. They
+/// are only computed while `spectrumStream` is listened to. Linux only.
+///
+/// Example:
+/// ```dart
+/// // 32 bands from 40 Hz to 16 kHz, 30 updates a second.
+/// final config = MicAudioConfig(spectrum: const SpectrumConfig());
+/// ```
+class SpectrumConfig {
+  /// FFT size in samples (default: 2048, rounded up to a power of two,
+  /// range: 64 to 16384). Larger sizes resolve low frequencies better but
+  /// react more slowly.
+  final int fftSize;
+
+  /// Fraction of each frame the next one overlaps (default: 0.5, range: 0
+  /// to 0.95).
+  final double overlap;
+
+  /// Number of bands (default: 32, range: 1 to 512).
+  final int bands;
+
+  /// Lower edge of the lowest band in Hz (default: 40).
+  final double lowHz;
+
+  /// Upper edge of the highest band in Hz (default: 16000, or half the
+  /// sample rate if lower; 0 for half the sample rate).
+  final double highHz;
+
+  /// Weight of the previous level in each new one (default: 0.5, range: 0
+  /// to 0.99), as the smoothing time constant of a Web Audio analyser.
+  /// Higher values fall back more slowly.
+  final double smoothing;
+
+  /// Updates per second (default: 30, range: 1 to 120). At most one per FFT
+  /// frame, so small overlaps of large FFTs deliver fewer.
+  final int rateHz;
+
+  /// Creates a spectrum analyzer configuration.
+  const SpectrumConfig({
+    this.fftSize = 2048,
+    this.overlap = 0.5,
+    this.bands = 32,
+    this.lowHz = 40.0,
+    this.highHz = 16000.0,
+    this.smoothing = 0.5,
+    this.rateHz = 30,
+  });
+
+  /// The options as passed to the platform with the capture configuration:
+  /// `spectrum`, `spectrumFftSize`, `spectrumOverlap`, `spectrumBands`,
+  /// `spectrumLowHz`, `spectrumHighHz`, `spectrumSmoothing` and
+  /// `spectrumRateHz`.
+  Map<String, dynamic> toMap() {
+    return {
+      'spectrum': true,
+      'spectrumFftSize': fftSize,
+      'spectrumOverlap': overlap,
+      'spectrumBands': bands,
+      'spectrumLowHz': lowHz,
+      'spectrumHighHz': highHz,
+      'spectrumSmoothing': smoothing,
+      'spectrumRateHz': rateHz,
+    };
+  }
+
+  @override
+  String toString() {
+    return 'SpectrumConfig(fftSize: $fftSize, overlap: $overlap, bands: $bands, lowHz: $lowHz, highHz: $highHz, smoothing: $smoothing, rateHz: $rateHz)';
+  }
+}
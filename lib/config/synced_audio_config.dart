@@ -0,0 +1,229 @@
+import 'package:desktop_audio_capture/audio_capture.dart';
+
+/// How [SyncedAudioCapture] delivers the microphone and system audio tracks.
+enum SyncedOutputMode {
+  /// Two-channel 16-bit frames: microphone first, then system audio.
+  interleaved,
+
+  /// One 16-bit channel: `mic * micGain + system * systemGain`.
+  mixed,
+
+  /// One 16-bit channel: `mic * micGain` with the echo of the system audio
+  /// removed, for speakerphone calls. The system track is the far-end
+  /// reference; its echo delay is found automatically. Linux only.
+  echoCancelled,
+}
+
+/// Configuration class for synchronized microphone + system audio capture.
+///
+/// Both sources are opened with the same sample rate and chunk size and are
+/// aligned natively by sample position, so frame `n` of the microphone track
+/// and frame `n` of the system track were captured at the same time.
+///
+/// Example:
+/// ```dart
+/// // Two aligned tracks, e.g. for a meeting transcriber
+/// final config = SyncedAudioConfig(
+///   sampleRate: 16000,
+///   chunkDurationMs: 100,
+/// );
+///
+/// // One mixed track with the system audio turned down
+/// final mixed = config.copyWith(
+///   outputMode: SyncedOutputMode.mixed,
+///   systemGain: 0.5,
+/// );
+/// ```
+class SyncedAudioConfig extends AudioCaptureConfig {
+  /// Sample rate in Hz of both tracks (default: 16000).
+  final int sampleRate;
+
+  /// Channels opened per source (default: 1). Each source is downmixed to
+  /// one track.
+  final int channels;
+
+  /// Duration of one delivered chunk in milliseconds (default: 1000).
+  final int chunkDurationMs;
+
+  /// Output layout (default: [SyncedOutputMode.interleaved]).
+  final SyncedOutputMode outputMode;
+
+  /// Gain of the microphone track (default: 1.0, range: 0.0 to 10.0).
+  final double micGain;
+
+  /// Gain of the system audio track (default: 1.0, range: 0.0 to 10.0).
+  final double systemGain;
+
+  /// Input volume applied to both sources (default: 1.0, range: 0.0 to 1.0).
+  final double inputVolume;
+
+  /// Microphone to capture (default: `null`, the system default).
+  final String? micDeviceId;
+
+  /// Monitor source to capture (default: `null`, the default output's
+  /// monitor).
+  final String? systemDeviceId;
+
+  /// Whether the capture threads request real-time scheduling (default:
+  /// `false`).
+  ///
+  /// Keeps capture running on loaded machines. The threads ask for SCHED_RR,
+  /// directly if the process may (`RLIMIT_RTPRIO`) or else through
+  /// RealtimeKit, and lock their buffers into memory. Capture continues at
+  /// normal priority if neither is permitted; `getStats()` reports what was
+  /// granted. Linux only.
+  final bool realtime;
+
+  /// SCHED_RR priority requested when [realtime] is set (default: 10,
+  /// range: 1 to 99). RealtimeKit may grant less.
+  final int realtimePriority;
+
+  /// CPUs the capture threads are pinned to (default: `null`, any CPU).
+  /// CPU numbers from 0 to 63. Linux only.
+  final List<int>? cpuAffinity;
+
+  /// Whether to capture at the source's own sample rate and sample format
+  /// and convert to 16-bit PCM at [sampleRate] in the plugin (default:
+  /// `false`).
+  ///
+  /// By default the audio server converts, with whatever method and latency
+  /// its configuration dictates. With this set the stream is opened at the
+  /// rate and format the server reports for the source, and a known-quality
+  /// resampler and dithered format conversion take over; `chunkStream`
+  /// reports the time each chunk took. Linux only.
+  final bool nativeRate;
+
+  /// Quality of the conversion when [nativeRate] is set (default:
+  /// [ResampleQuality.medium]).
+  final ResampleQuality resampleQuality;
+
+  /// Whether to measure the delay of the microphone behind the system
+  /// audio (default: `false`).
+  ///
+  /// The two sources have their own latencies, and the microphone hears
+  /// the speakers a room's distance later. With this set the plugin
+  /// correlates the last second of both tracks natively (GCC-PHAT on 4 kHz
+  /// copies) every [delayIntervalMs] and reports the delay and its
+  /// confidence on `delayStream` and in `getStats()`. Linux only.
+  final bool estimateDelay;
+
+  /// Interval between delay estimates in milliseconds (default: 1000,
+  /// range: 100 to 60000).
+  final int delayIntervalMs;
+
+  /// Compression of each gained track (default: `null`, the tracks are
+  /// clamped at full scale). See [CompressorConfig]. Linux only.
+  final CompressorConfig? compressor;
+
+  /// Creates a new [SyncedAudioConfig] instance.
+  ///
+  /// All parameters are optional and have default values:
+  /// - [sampleRate]: 16000
+  /// - [channels]: 1
+  /// - [chunkDurationMs]: 1000
+  /// - [outputMode]: [SyncedOutputMode.interleaved]
+  /// - [micGain]: 1.0
+  /// - [systemGain]: 1.0
+  /// - [inputVolume]: 1.0
+  /// - [micDeviceId]: null
+  /// - [systemDeviceId]: null
+  /// - [realtime]: false
+  /// - [realtimePriority]: 10
+  /// - [cpuAffinity]: null
+  /// - [nativeRate]: false
+  /// - [resampleQuality]: [ResampleQuality.medium]
+  /// - [estimateDelay]: false
+  /// - [delayIntervalMs]: 1000
+  /// - [compressor]: null
+  SyncedAudioConfig({
+    this.sampleRate = 16000,
+    this.channels = 1,
+    this.chunkDurationMs = 1000,
+    this.outputMode = SyncedOutputMode.interleaved,
+    this.micGain = 1.0,
+    this.systemGain = 1.0,
+    this.inputVolume = 1.0,
+    this.micDeviceId,
+    this.systemDeviceId,
+    this.realtime = false,
+    this.realtimePriority = 10,
+    this.cpuAffinity,
+    this.nativeRate = false,
+    this.resampleQuality = ResampleQuality.medium,
+    this.estimateDelay = false,
+    this.delayIntervalMs = 1000,
+    this.compressor,
+  });
+
+  /// Creates a copy of this configuration with modified values.
+  SyncedAudioConfig copyWith({
+    int? sampleRate,
+    int? channels,
+    int? chunkDurationMs,
+    SyncedOutputMode? outputMode,
+    double? micGain,
+    double? systemGain,
+    double? inputVolume,
+    String? micDeviceId,
+    String? systemDeviceId,
+    bool? realtime,
+    int? realtimePriority,
+    List<int>? cpuAffinity,
+    bool? nativeRate,
+    ResampleQuality? resampleQuality,
+    bool? estimateDelay,
+    int? delayIntervalMs,
+    CompressorConfig? compressor,
+  }) {
+    return SyncedAudioConfig(
+      sampleRate: sampleRate ?? this.sampleRate,
+      channels: channels ?? this.channels,
+      chunkDurationMs: chunkDurationMs ?? this.chunkDurationMs,
+      outputMode: outputMode ?? this.outputMode,
+      micGain: micGain ?? this.micGain,
+      systemGain: systemGain ?? this.systemGain,
+      inputVolume: inputVolume ?? this.inputVolume,
+      micDeviceId: micDeviceId ?? this.micDeviceId,
+      systemDeviceId: systemDeviceId ?? this.systemDeviceId,
+      realtime: realtime ?? this.realtime,
+      realtimePriority: realtimePriority ?? this.realtimePriority,
+      cpuAffinity: cpuAffinity ?? this.cpuAffinity,
+      nativeRate: nativeRate ?? this.nativeRate,
+      resampleQuality: resampleQuality ?? this.resampleQuality,
+      estimateDelay: estimateDelay ?? this.estimateDelay,
+      delayIntervalMs: delayIntervalMs ?? this.delayIntervalMs,
+      compressor: compressor ?? this.compressor,
+    );
+  }
+
+  /// Converts this configuration to a map for method channel communication.
+  ///
+  /// `outputMode` is sent by name; device ids, `cpuAffinity` and the
+  /// [CompressorConfig.toMap] entries are only sent when set.
+  Map<String, dynamic> toMap() {
+    return {
+      'sampleRate': sampleRate,
+      'channels': channels,
+      'chunkDurationMs': chunkDurationMs,
+      'outputMode': outputMode.name,
+      'micGain': micGain,
+      'systemGain': systemGain,
+      'inputVolume': inputVolume,
+      if (micDeviceId != null) 'micDeviceId': micDeviceId,
+      if (systemDeviceId != null) 'systemDeviceId': systemDeviceId,
+      'realtime': realtime,
+      'realtimePriority': realtimePriority,
+      if (cpuAffinity != null) 'cpuAffinity': cpuAffinity,
+      'nativeRate': nativeRate,
+      'resampleQuality': resampleQuality.name,
+      'estimateDelay': estimateDelay,
+      'delayIntervalMs': delayIntervalMs,
+      if (compressor != null) ...compressor!.toMap(),
+    };
+  }
+
+  @override
+  String toString() {
+    return 'SyncedAudioConfig(sampleRate: $sampleRate, channels: $channels, chunkDurationMs: $chunkDurationMs, outputMode: ${outputMode.name}, micGain: $micGain, systemGain: $systemGain, inputVolume: $inputVolume, micDeviceId: $micDeviceId, systemDeviceId: $systemDeviceId, realtime: $realtime, cpuAffinity: $cpuAffinity, nativeRate: $nativeRate, estimateDelay: $estimateDelay, compressor: $compressor)';
+  }
+}
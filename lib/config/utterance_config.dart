@@ -0,0 +1,62 @@
+/// Delivery of captured audio as whole utterances instead of fixed chunks.
+///
+/// With an [UtteranceConfig] the audio is segmented by voice activity
+/// detection as it is captured, and `audioStream` and `chunkStream` deliver
+/// one chunk per utterance: the speech, led in by up to [preRollMs] of the
+/// audio before it, with `AudioChunk.endPosition` and
+/// `AudioChunk.endReason` set. Audio without speech is not delivered, so
+/// each chunk is ready to be handed to speech recognition as it is. Levels
+/// are still sent per chunk. Linux only.
+///
+/// Example:
+/// ```dart
+/// final config = MicAudioConfig(
+///   utterances: const UtteranceConfig(maxDurationMs: 10000),
+/// );
+/// capture.chunkStream?.listen((utterance) => recognize(utterance.data));
+/// ```
+class UtteranceConfig {
+  /// Speech probability at which speech starts (default: 0.5, range: 0.01
+  /// to 0.99).
+  final double threshold;
+
+  /// How long speech must be absent for an utterance to end, in
+  /// milliseconds (default: 700, range: 0 to 10000). The silence is
+  /// delivered as the end of the utterance.
+  final int silenceTimeoutMs;
+
+  /// How much audio before speech starts leads into each utterance, in
+  /// milliseconds (default: 300, range: 0 to 2000).
+  final int preRollMs;
+
+  /// Longest utterance, not counting its pre-roll, in milliseconds
+  /// (default: 15000, range: 1000 to 60000). Longer speech is split, and
+  /// the next utterance follows on without a gap.
+  final int maxDurationMs;
+
+  /// Creates an utterance segmentation configuration.
+  const UtteranceConfig({
+    this.threshold = 0.5,
+    this.silenceTimeoutMs = 700,
+    this.preRollMs = 300,
+    this.maxDurationMs = 15000,
+  });
+
+  /// The options as passed to the platform with the capture configuration:
+  /// `utterances`, `utteranceThreshold`, `utteranceSilenceMs`,
+  /// `utterancePreRollMs` and `utteranceMaxMs`.
+  Map<String, dynamic> toMap() {
+    return {
+      'utterances': true,
+      'utteranceThreshold': threshold,
+      'utteranceSilenceMs': silenceTimeoutMs,
+      'utterancePreRollMs': preRollMs,
+      'utteranceMaxMs': maxDurationMs,
+    };
+  }
+
+  @override
+  String toString() {
+    return 'UtteranceConfig(threshold: $threshold, silenceTimeoutMs: $silenceTimeoutMs, preRollMs: $preRollMs, maxDurationMs: $maxDurationMs)';
+  }
+}
@@ -0,0 +1,64 @@
+/// Voice activity detection on a capture's audio.
+///
+/// With a [VoiceActivityConfig] each `AudioChunk` carries the probability
+/// that it holds speech, and `speechStream` reports speech starting and
+/// ending. With [speechOnly] set, chunks without speech are not delivered
+/// at all. Linux only.
+///
+/// The detector looks at the energy of each 20 ms of audio above a tracked
+/// noise floor and at how much of it lies in the speech band; steady noise,
+/// hum and clicks do not count as speech.
+///
+/// Example:
+/// ```dart
+/// // Deliver speech only, with 300 ms of audio leading into it.
+/// final config = MicAudioConfig(
+///   voiceActivity: VoiceActivityConfig(speechOnly: true),
+/// );
+/// ```
+class VoiceActivityConfig {
+  /// Speech probability at which speech starts (default: 0.5, range: 0.01
+  /// to 0.99). Lower values catch quieter speech but also more noise.
+  final double threshold;
+
+  /// How long speech lasts after it was last detected, in milliseconds
+  /// (default: 500, range: 0 to 10000), so pauses between words do not end
+  /// it.
+  final int hangoverMs;
+
+  /// How much audio before speech starts is delivered with it when
+  /// [speechOnly] is set, in milliseconds (default: 300, range: 0 to 2000).
+  final int preRollMs;
+
+  /// Whether only chunks with speech are delivered on `audioStream` and
+  /// `chunkStream` (default: `false`). Levels are sent for every chunk
+  /// either way. A chunk leading into speech also carries up to [preRollMs]
+  /// of the audio held back before it.
+  final bool speechOnly;
+
+  /// Creates a voice activity configuration.
+  const VoiceActivityConfig({
+    this.threshold = 0.5,
+    this.hangoverMs = 500,
+    this.preRollMs = 300,
+    this.speechOnly = false,
+  });
+
+  /// The options as passed to the platform with the capture configuration:
+  /// `voiceActivity`, `voiceThreshold`, `voiceHangoverMs`, `voicePreRollMs`
+  /// and `speechOnly`.
+  Map<String, dynamic> toMap() {
+    return {
+      'voiceActivity': true,
+      'voiceThreshold': threshold,
+      'voiceHangoverMs': hangoverMs,
+      'voicePreRollMs': preRollMs,
+      'speechOnly': speechOnly,
+    };
+  }
+
+  @override
+  String toString() {
+    return 'VoiceActivityConfig(threshold: $threshold, hangoverMs: $hangoverMs, preRollMs: $preRollMs, speechOnly: $speechOnly)';
+  }
+}
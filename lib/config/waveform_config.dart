@@ -0,0 +1,48 @@
+/// Waveform decimation for display, computed natively next to capture.
+///
+/// With a [WaveformConfig] the processed audio is also reduced to the
+/// minimum, maximum and RMS of fixed buckets, [bucketRateHz] buckets per
+/// second, and delivered as `WaveformData` on `waveformStream` as buckets
+/// complete. With more than one of [levels], each further level merges two
+/// buckets of the one before, so a display can pick the resolution nearest
+/// its pixel width. Buckets are only computed while `waveformStream` is
+/// listened to, and a waveform display needs no PCM subscription. Linux
+/// only.
+///
+/// Example:
+/// ```dart
+/// // 100 buckets a second, plus 50 and 25.
+/// final config = MicAudioConfig(
+///   waveform: const WaveformConfig(levels: 3),
+/// );
+/// ```
+class WaveformConfig {
+  /// Buckets per second of the finest level (default: 100, range: 1 to
+  /// 4000, at most the sample rate).
+  final int bucketRateHz;
+
+  /// Number of resolutions, each half the one before (default: 1, range: 1
+  /// to 8).
+  final int levels;
+
+  /// Creates a waveform configuration.
+  const WaveformConfig({
+    this.bucketRateHz = 100,
+    this.levels = 1,
+  });
+
+  /// The options as passed to the platform with the capture configuration:
+  /// `waveform`, `waveformBucketRateHz` and `waveformLevels`.
+  Map<String, dynamic> toMap() {
+    return {
+      'waveform': true,
+      'waveformBucketRateHz': bucketRateHz,
+      'waveformLevels': levels,
+    };
+  }
+
+  @override
+  String toString() {
+    return 'WaveformConfig(bucketRateHz: $bucketRateHz, levels: $levels)';
+  }
+}
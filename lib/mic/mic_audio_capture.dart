@@ -7,6 +7,7 @@ export 'package:desktop_audio_capture/config/mic_audio_config.dart';
 enum _MicAudioMethod {
   startCapture,
   stopCapture,
+  getCaptureStats,
   requestPermissions,
   hasInputDevice,
   getAvailableInputDevices,
@@ -66,11 +67,66 @@ class MicAudioCapture extends AudioCapture {
   static const EventChannel _decibelStreamChannel = EventChannel(
     'com.mic_audio_transcriber/mic_decibel',
   );
+  static const EventChannel _eventsChannel = EventChannel(
+    'com.mic_audio_transcriber/mic_events',
+  );
 
   Stream<Uint8List>? _audioStream;
+  Stream<AudioChunk>? _chunkStream;
   Stream<MicAudioStatus>? _statusStream;
   Stream<DecibelData>? _decibelStream;
+  Stream<OverrunEvent>? _overrunStream;
+  Stream<SpeechEvent>? _speechStream;
+  Stream<MelFeatures>? _featureStream;
+  Stream<SpectrumData>? _spectrumStream;
+  Stream<WaveformData>? _waveformStream;
   bool _isRecording = false;
+  int? _sessionId;
+
+  /// Native capture session of this instance, or `null` when not recording.
+  ///
+  /// Each [MicAudioCapture] owns one session, so several instances can record
+  /// different microphones at the same time. Platforms without session
+  /// support report `null` even while recording.
+  int? get sessionId => _sessionId;
+
+  // Audio of a session is delivered with its timing on the session's own
+  // channel; without a session the shared channel carries bare bytes.
+  Stream<Uint8List> _createAudioStream() {
+    final sessionId = _sessionId;
+    if (sessionId == null) {
+      _chunkStream = null;
+      return _audioStreamChannel.receiveBroadcastStream().map((
+        dynamic event,
+      ) {
+        if (event is Uint8List) {
+          return event;
+        } else if (event is List<int>) {
+          return Uint8List.fromList(event);
+        }
+        throw Exception('Unexpected audio data type: ${event.runtimeType}');
+      });
+    }
+    final chunkStream = EventChannel('${_audioStreamChannel.name}/$sessionId')
+        .receiveBroadcastStream()
+        .map((dynamic event) {
+      if (event is Map) {
+        return AudioChunk.fromMap(event);
+      }
+      throw Exception('Unexpected audio chunk type: ${event.runtimeType}');
+    });
+    _chunkStream = chunkStream;
+    return chunkStream.map((chunk) => chunk.data);
+  }
+
+  // Status and decibel events of other sessions are dropped.
+  bool _isOwnEvent(dynamic event) {
+    if (event is! Map || _sessionId == null) {
+      return true;
+    }
+    final sessionId = event['sessionId'];
+    return sessionId == null || sessionId == _sessionId;
+  }
 
   /// Stream of raw audio data bytes from microphone capture.
   ///
@@ -97,19 +153,25 @@ class MicAudioCapture extends AudioCapture {
       return null;
     }
     // Create stream lazily if recording but stream not created yet
-    _audioStream = _audioStreamChannel.receiveBroadcastStream().map((
-      dynamic event,
-    ) {
-      if (event is Uint8List) {
-        return event;
-      } else if (event is List<int>) {
-        return Uint8List.fromList(event);
-      }
-      throw Exception('Unexpected audio data type: ${event.runtimeType}');
-    });
+    _audioStream = _createAudioStream();
     return _audioStream;
   }
 
+  /// Stream of captured chunks with their capture timing.
+  ///
+  /// Carries the same audio as [audioStream] plus a sequence number, the
+  /// sample position and the capture time of every chunk (see [AudioChunk]).
+  /// Only available while recording on platforms with capture sessions
+  /// (Linux); `null` otherwise.
+  ///
+  /// Example:
+  /// ```dart
+  /// micCapture.chunkStream?.listen((chunk) {
+  ///   print('#${chunk.sequence} captured at ${chunk.captureTime}');
+  /// });
+  /// ```
+  Stream<AudioChunk>? get chunkStream => _chunkStream;
+
   /// Stream of microphone status updates.
   ///
   /// Returns a [Stream<MicStatus>] containing:
@@ -131,9 +193,10 @@ class MicAudioCapture extends AudioCapture {
   /// ```
   Stream<MicAudioStatus>? get statusStream {
     // Create status stream if not already created
-    _statusStream ??= _statusStreamChannel.receiveBroadcastStream().map((
-      dynamic event,
-    ) {
+    _statusStream ??= _statusStreamChannel
+        .receiveBroadcastStream()
+        .where(_isOwnEvent)
+        .map((dynamic event) {
       if (event is Map) {
         return MicAudioStatus.fromJson(Map<String, dynamic>.from(event));
       }
@@ -166,6 +229,135 @@ class MicAudioCapture extends AudioCapture {
   /// ```
   Stream<DecibelData>? get decibelStream => _decibelStream;
 
+  /// Stream of audio lost by this session's capture (see [OverrunEvent]).
+  ///
+  /// Reported whenever the audio server or the plugin had to discard audio
+  /// because the capture fell behind. Only available while recording on
+  /// platforms with capture sessions (Linux); `null` otherwise.
+  ///
+  /// Example:
+  /// ```dart
+  /// micCapture.overrunStream?.listen((event) {
+  ///   print('Lost ${event.lostFrames} frames (${event.cause.name})');
+  /// });
+  /// ```
+  Stream<OverrunEvent>? get overrunStream {
+    final sessionId = _sessionId;
+    if (sessionId == null) {
+      return null;
+    }
+    _overrunStream ??= _eventsChannel
+        .receiveBroadcastStream()
+        .where((dynamic event) =>
+            event is Map &&
+            event['type'] == 'overrun' &&
+            event['sessionId'] == sessionId)
+        .map((dynamic event) => OverrunEvent.fromMap(event as Map));
+    return _overrunStream;
+  }
+
+  /// Stream of speech starting and ending in this session's audio (see
+  /// [SpeechEvent]).
+  ///
+  /// Only reported when recording with a [VoiceActivityConfig] on platforms
+  /// with capture sessions (Linux); `null` when not recording.
+  ///
+  /// Example:
+  /// ```dart
+  /// micCapture.speechStream?.listen((event) {
+  ///   print(event.speaking ? 'Speaking' : 'Silent');
+  /// });
+  /// ```
+  Stream<SpeechEvent>? get speechStream {
+    final sessionId = _sessionId;
+    if (sessionId == null) {
+      return null;
+    }
+    _speechStream ??= _eventsChannel
+        .receiveBroadcastStream()
+        .where((dynamic event) =>
+            event is Map &&
+            event['type'] == 'speech' &&
+            event['sessionId'] == sessionId)
+        .map((dynamic event) => SpeechEvent.fromMap(event as Map));
+    return _speechStream;
+  }
+
+  /// Stream of log-mel features of this session's audio (see
+  /// [MelFeatures]).
+  ///
+  /// Only delivered when recording with a [MelFeatureConfig] on platforms
+  /// with capture sessions (Linux); `null` when not recording. Features are
+  /// only computed while this stream is listened to.
+  ///
+  /// Example:
+  /// ```dart
+  /// micCapture.featureStream?.listen((features) {
+  ///   print('${features.frameCount} frames of ${features.bins} bins');
+  /// });
+  /// ```
+  Stream<MelFeatures>? get featureStream {
+    final sessionId = _sessionId;
+    if (sessionId == null) {
+      return null;
+    }
+    _featureStream ??=
+        EventChannel('${_audioStreamChannel.name}/$sessionId/features')
+            .receiveBroadcastStream()
+            .map((dynamic event) => MelFeatures.fromMap(event as Map));
+    return _featureStream;
+  }
+
+  /// Stream of spectrum band levels of this session's audio, for
+  /// visualizers (see [SpectrumData]).
+  ///
+  /// Only delivered when recording with a [SpectrumConfig] on platforms
+  /// with capture sessions (Linux); `null` when not recording. The spectrum
+  /// is only analyzed while this stream is listened to.
+  ///
+  /// Example:
+  /// ```dart
+  /// micCapture.spectrumStream?.listen((spectrum) {
+  ///   bars.value = spectrum.normalized();
+  /// });
+  /// ```
+  Stream<SpectrumData>? get spectrumStream {
+    final sessionId = _sessionId;
+    if (sessionId == null) {
+      return null;
+    }
+    _spectrumStream ??=
+        EventChannel('${_audioStreamChannel.name}/$sessionId/spectrum')
+            .receiveBroadcastStream()
+            .map((dynamic event) => SpectrumData.fromMap(event as Map));
+    return _spectrumStream;
+  }
+
+  /// Stream of min/max/RMS buckets of this session's audio, for waveform
+  /// displays (see [WaveformData]).
+  ///
+  /// Only delivered when recording with a [WaveformConfig] on platforms
+  /// with capture sessions (Linux); `null` when not recording. Buckets are
+  /// only computed while this stream is listened to.
+  ///
+  /// Example:
+  /// ```dart
+  /// micCapture.waveformStream?.listen((waveform) {
+  ///   print('${waveform.levels.first.bucketCount} new buckets');
+  /// });
+  /// ```
+  Stream<WaveformData>? get waveformStream {
+    final sessionId = _sessionId;
+    if (sessionId == null) {
+      return null;
+    }
+    _waveformStream ??=
+        EventChannel('${_audioStreamChannel.name}/$sessionId/waveform')
+            .receiveBroadcastStream()
+            .map((dynamic event) => WaveformData.fromMap(event as Map));
+    return _waveformStream;
+  }
+
   MicAudioConfig _config = MicAudioConfig();
 
   /// Creates a new [MicAudioCapture] instance.
@@ -259,7 +451,10 @@ class MicAudioCapture extends AudioCapture {
           _config.toMap(),
         );
 
-        if (result is! bool || result != true) {
+        // Platforms with session support return the session id.
+        if (result is int) {
+          _sessionId = result;
+        } else if (result is! bool || result != true) {
           final errorMsg = result is String
               ? result
               : 'Failed to start microphone capture. Returned: $result';
@@ -272,21 +467,13 @@ class MicAudioCapture extends AudioCapture {
 
       // Create audio stream
       // Note: Stream will be subscribed by listeners, which triggers onListen on native side
-      _audioStream = _audioStreamChannel.receiveBroadcastStream().map((
-        dynamic event,
-      ) {
-        if (event is Uint8List) {
-          return event;
-        } else if (event is List<int>) {
-          return Uint8List.fromList(event);
-        }
-        throw Exception('Unexpected audio data type: ${event.runtimeType}');
-      });
+      _audioStream = _createAudioStream();
 
       // Create decibel stream
-      _decibelStream = _decibelStreamChannel.receiveBroadcastStream().map((
-        dynamic event,
-      ) {
+      _decibelStream = _decibelStreamChannel
+          .receiveBroadcastStream()
+          .where(_isOwnEvent)
+          .map((dynamic event) {
         if (event is Map) {
           return DecibelData.fromMap(Map<String, dynamic>.from(event));
         }
@@ -325,6 +512,7 @@ class MicAudioCapture extends AudioCapture {
     try {
       final stoped = await _channel.invokeMethod<bool>(
         _MicAudioMethod.stopCapture.name,
+        _sessionId != null ? {'sessionId': _sessionId} : null,
       );
 
       if (stoped != true) {
@@ -332,14 +520,43 @@ class MicAudioCapture extends AudioCapture {
       }
 
       _isRecording = false;
+      _sessionId = null;
       _audioStream = null;
+      _chunkStream = null;
       _statusStream = null;
       _decibelStream = null;
+      _overrunStream = null;
+      _speechStream = null;
+      _featureStream = null;
+      _spectrumStream = null;
+      _waveformStream = null;
     } catch (e) {
       rethrow;
     }
   }
 
+  /// Returns the counters of this session's capture (see [CaptureStats]).
+  ///
+  /// Returns `null` when not recording or on platforms without capture
+  /// sessions.
+  ///
+  /// Example:
+  /// ```dart
+  /// final stats = await micCapture.getStats();
+  /// print('Dropped chunks: ${stats?.droppedChunks}');
+  /// ```
+  Future<CaptureStats?> getStats() async {
+    final sessionId = _sessionId;
+    if (sessionId == null) {
+      return null;
+    }
+    final stats = await _channel.invokeMethod<dynamic>(
+      _MicAudioMethod.getCaptureStats.name,
+      {'sessionId': sessionId},
+    );
+    return stats is Map ? CaptureStats.fromMap(stats) : null;
+  }
+
   /// Whether microphone capture is currently recording.
   ///
   /// Returns `true` if capture is active, `false` otherwise.
@@ -0,0 +1,122 @@
+import 'dart:typed_data';
+
+/// Why an utterance delivered as one [AudioChunk] ended.
+enum UtteranceEndReason {
+  /// Speech ended.
+  silence,
+
+  /// The utterance reached `UtteranceConfig.maxDurationMs`; the speech
+  /// continues in the next one.
+  maxDuration,
+
+  /// Captured audio was lost.
+  gap,
+}
+
+/// A captured audio chunk with its position on the capture timeline.
+///
+/// Delivered by `chunkStream` on platforms with capture sessions (Linux).
+/// Timing is derived from the audio stream itself: the first chunk is
+/// anchored using the stream latency, and every later chunk is placed by its
+/// sample position, so consecutive chunks are exactly
+/// `frames / sampleRate` apart.
+///
+/// Example:
+/// ```dart
+/// int? expected;
+/// capture.chunkStream?.listen((chunk) {
+///   if (expected != null && chunk.sequence != expected) {
+///     print('Lost ${chunk.sequence - expected!} chunks');
+///   }
+///   expected = chunk.sequence + 1;
+///   print('Captured at ${chunk.captureTime}, frame ${chunk.samplePosition}');
+/// });
+/// ```
+class AudioChunk {
+  /// Processed 16-bit PCM samples, as delivered by `audioStream`.
+  final Uint8List data;
+
+  /// Chunk index within the session, starting at 0. A gap means chunks
+  /// were dropped before delivery, or held back for holding no speech when
+  /// captured with `VoiceActivityConfig.speechOnly`. Utterances are
+  /// numbered on their own.
+  final int sequence;
+
+  /// Index of the chunk's first frame since capture started.
+  final int samplePosition;
+
+  /// Capture time of the first frame on the platform monotonic clock, in
+  /// microseconds. Comparable across sessions of the same process.
+  final int captureTimeUs;
+
+  /// Capture time of the first frame as a Unix timestamp in seconds.
+  final double timestamp;
+
+  /// Time spent converting the chunk from the capture rate and format, in
+  /// microseconds; 0 unless captured with `nativeRate` from a source with
+  /// another rate or format.
+  final int conversionUs;
+
+  /// Probability that the chunk holds speech, from 0 to 1; `null` unless
+  /// captured with a `VoiceActivityConfig`.
+  final double? speechProbability;
+
+  /// Sample position just past the chunk's last frame; `null` unless the
+  /// chunk is an utterance (see `UtteranceConfig`).
+  final int? endPosition;
+
+  /// Why the utterance ended; `null` unless the chunk is an utterance.
+  final UtteranceEndReason? endReason;
+
+  /// Creates a new [AudioChunk] instance.
+  const AudioChunk({
+    required this.data,
+    required this.sequence,
+    required this.samplePosition,
+    required this.captureTimeUs,
+    required this.timestamp,
+    this.conversionUs = 0,
+    this.speechProbability,
+    this.endPosition,
+    this.endReason,
+  });
+
+  /// Whether the chunk is a whole utterance rather than a fixed chunk.
+  bool get isUtterance => endReason != null;
+
+  /// Creates an [AudioChunk] from a session channel event.
+  factory AudioChunk.fromMap(Map<dynamic, dynamic> map) {
+    final data = map['data'];
+    return AudioChunk(
+      data: data is Uint8List
+          ? data
+          : Uint8List.fromList(List<int>.from(data as List? ?? const [])),
+      sequence: (map['sequence'] as num?)?.toInt() ?? 0,
+      samplePosition: (map['samplePosition'] as num?)?.toInt() ?? 0,
+      captureTimeUs: (map['captureTimeUs'] as num?)?.toInt() ?? 0,
+      timestamp: (map['timestamp'] as num?)?.toDouble() ??
+          DateTime.now().millisecondsSinceEpoch / 1000.0,
+      conversionUs: (map['conversionUs'] as num?)?.toInt() ?? 0,
+      speechProbability: (map['speechProbability'] as num?)?.toDouble(),
+      endPosition: (map['endPosition'] as num?)?.toInt(),
+      endReason: _parseEndReason(map['endReason']),
+    );
+  }
+
+  static UtteranceEndReason? _parseEndReason(dynamic value) {
+    for (final reason in UtteranceEndReason.values) {
+      if (reason.name == value) {
+        return reason;
+      }
+    }
+    return null;
+  }
+
+  /// Capture time of the first frame as a [DateTime].
+  DateTime get captureTime =>
+      DateTime.fromMicrosecondsSinceEpoch((timestamp * 1000000).round());
+
+  @override
+  String toString() =>
+      'AudioChunk(sequence: $sequence, samplePosition: $samplePosition, captureTimeUs: $captureTimeUs, bytes: ${data.length})';
+}
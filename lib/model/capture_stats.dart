@@ -0,0 +1,244 @@
+import 'package:desktop_audio_capture/model/loudness_data.dart';
+
+/// Counters of a running capture session.
+///
+/// Returned by `getStats()` on platforms with capture sessions (Linux).
+///
+/// Example:
+/// ```dart
+/// final stats = await capture.getStats();
+/// if (stats != null && stats.overruns > 0) {
+///   print('Lost ${stats.lostFrames} frames in ${stats.overruns} overruns');
+/// }
+/// ```
+class CaptureStats {
+  /// Native capture session the counters belong to.
+  final int sessionId;
+
+  /// Chunks read from the audio server, over all tracks.
+  final int chunksCaptured;
+
+  /// Chunks dropped because processing fell behind the capture.
+  final int droppedChunks;
+
+  /// Overrun events reported, one per gap and cause.
+  final int overruns;
+
+  /// Frames lost over all overruns.
+  final int lostFrames;
+
+  /// Lost frames that were replaced by silence.
+  final int filledFrames;
+
+  /// Scheduling granted to the capture threads: `normal`, `direct`
+  /// (SCHED_RR set by the process) or `rtkit` (granted by RealtimeKit).
+  final String scheduling;
+
+  /// Capture threads running with real-time scheduling.
+  final int realtimeThreads;
+
+  /// Number of intervals between two reads the jitter figures cover.
+  final int jitterSamples;
+
+  /// Mean deviation of the interval between two reads from the chunk
+  /// duration, in microseconds.
+  final int jitterMeanUs;
+
+  /// Largest deviation of the interval between two reads from the chunk
+  /// duration, in microseconds.
+  final int jitterMaxUs;
+
+  /// Read intervals per jitter range; bucket `i` counts deviations up to
+  /// [jitterHistogramBoundsUs]`[i]`, the last bucket everything above.
+  final List<int> jitterHistogram;
+
+  // Pipeline: reader thread -> processing queue -> processing worker ->
+  // platform thread.
+
+  /// Chunks waiting for processing when the stats were taken.
+  final int readyQueueDepth;
+
+  /// Chunks the processing queues hold before capture drops the newest.
+  final int readyQueueCapacity;
+
+  /// Most chunks ever waiting for processing on one track.
+  final int readyQueueHighWater;
+
+  /// Longest time a chunk waited for processing, in microseconds.
+  final int readyWaitMaxUs;
+
+  /// Chunks processed (volume, mixing, gap filling).
+  final int processedChunks;
+
+  /// Mean processing time of a chunk, in microseconds.
+  final int processingMeanUs;
+
+  /// Longest processing time of a chunk, in microseconds.
+  final int processingMaxUs;
+
+  /// Processed chunks waiting for the platform thread to send them.
+  final int emitQueueDepth;
+
+  /// Processed chunks that can wait to be sent before newer ones are
+  /// dropped.
+  final int emitQueueCapacity;
+
+  /// Most processed chunks ever waiting to be sent.
+  final int emitQueueHighWater;
+
+  /// Processed chunks dropped because [emitQueueCapacity] chunks were
+  /// already waiting to be sent.
+  final int emitDroppedChunks;
+
+  /// Chunks sent to Dart.
+  final int emittedChunks;
+
+  /// Mean time a processed chunk waited to be sent, in microseconds.
+  final int emitWaitMeanUs;
+
+  /// Longest time a processed chunk waited to be sent, in microseconds.
+  final int emitWaitMaxUs;
+
+  /// Rate each track is captured at, in Hz. Differs from the requested
+  /// rate when captured with `nativeRate`.
+  final List<int> captureRates;
+
+  /// Sample format each track is captured in: `s16`, `s24`, `s24_32`,
+  /// `s32` or `f32`. Differs from `s16` when captured with `nativeRate`.
+  final List<String> captureFormats;
+
+  /// Chunks converted from the capture rate or format in the plugin.
+  final int convertedChunks;
+
+  /// Mean conversion time of a chunk, in microseconds.
+  final int conversionMeanUs;
+
+  /// Longest conversion time of a chunk, in microseconds.
+  final int conversionMaxUs;
+
+  /// Loudness of everything captured so far, for captures started with
+  /// `loudness` enabled.
+  final LoudnessData? loudness;
+
+  /// Last delay of the microphone behind the system audio in milliseconds,
+  /// for synced captures with `estimateDelay` (see `DelayEvent`).
+  final double? delayMs;
+
+  /// Confidence of [delayMs], from 0 to 1.
+  final double? delayConfidence;
+
+  /// Delay of the echo behind the system audio, in milliseconds, for synced
+  /// captures with [SyncedOutputMode.echoCancelled].
+  final int? echoDelayMs;
+
+  /// Echo return loss enhancement: how much the echo canceller attenuates
+  /// the microphone while system audio plays, in dB.
+  final double? echoErleDb;
+
+  /// Upper bounds of the [jitterHistogram] buckets, in microseconds.
+  static const List<int> jitterHistogramBoundsUs = [
+    1000,
+    2000,
+    5000,
+    10000,
+    20000,
+    50000,
+  ];
+
+  /// Creates a new [CaptureStats] instance.
+  const CaptureStats({
+    required this.sessionId,
+    required this.chunksCaptured,
+    required this.droppedChunks,
+    required this.overruns,
+    required this.lostFrames,
+    required this.filledFrames,
+    this.scheduling = 'normal',
+    this.realtimeThreads = 0,
+    this.jitterSamples = 0,
+    this.jitterMeanUs = 0,
+    this.jitterMaxUs = 0,
+    this.jitterHistogram = const [],
+    this.readyQueueDepth = 0,
+    this.readyQueueCapacity = 0,
+    this.readyQueueHighWater = 0,
+    this.readyWaitMaxUs = 0,
+    this.processedChunks = 0,
+    this.processingMeanUs = 0,
+    this.processingMaxUs = 0,
+    this.emitQueueDepth = 0,
+    this.emitQueueCapacity = 0,
+    this.emitQueueHighWater = 0,
+    this.emitDroppedChunks = 0,
+    this.emittedChunks = 0,
+    this.emitWaitMeanUs = 0,
+    this.emitWaitMaxUs = 0,
+    this.captureRates = const [],
+    this.captureFormats = const [],
+    this.convertedChunks = 0,
+    this.conversionMeanUs = 0,
+    this.conversionMaxUs = 0,
+    this.loudness,
+    this.delayMs,
+    this.delayConfidence,
+    this.echoDelayMs,
+    this.echoErleDb,
+  });
+
+  /// Creates a [CaptureStats] from a `getCaptureStats` result.
+  factory CaptureStats.fromMap(Map<dynamic, dynamic> map) {
+    return CaptureStats(
+      sessionId: (map['sessionId'] as num?)?.toInt() ?? 0,
+      chunksCaptured: (map['chunksCaptured'] as num?)?.toInt() ?? 0,
+      droppedChunks: (map['droppedChunks'] as num?)?.toInt() ?? 0,
+      overruns: (map['overruns'] as num?)?.toInt() ?? 0,
+      lostFrames: (map['lostFrames'] as num?)?.toInt() ?? 0,
+      filledFrames: (map['filledFrames'] as num?)?.toInt() ?? 0,
+      scheduling: map['scheduling'] as String? ?? 'normal',
+      realtimeThreads: (map['realtimeThreads'] as num?)?.toInt() ?? 0,
+      jitterSamples: (map['jitterSamples'] as num?)?.toInt() ?? 0,
+      jitterMeanUs: (map['jitterMeanUs'] as num?)?.toInt() ?? 0,
+      jitterMaxUs: (map['jitterMaxUs'] as num?)?.toInt() ?? 0,
+      jitterHistogram: (map['jitterHistogram'] as List?)
+              ?.map((count) => (count as num).toInt())
+              .toList() ??
+          const [],
+      readyQueueDepth: (map['readyQueueDepth'] as num?)?.toInt() ?? 0,
+      readyQueueCapacity: (map['readyQueueCapacity'] as num?)?.toInt() ?? 0,
+      readyQueueHighWater: (map['readyQueueHighWater'] as num?)?.toInt() ?? 0,
+      readyWaitMaxUs: (map['readyWaitMaxUs'] as num?)?.toInt() ?? 0,
+      processedChunks: (map['processedChunks'] as num?)?.toInt() ?? 0,
+      processingMeanUs: (map['processingMeanUs'] as num?)?.toInt() ?? 0,
+      processingMaxUs: (map['processingMaxUs'] as num?)?.toInt() ?? 0,
+      emitQueueDepth: (map['emitQueueDepth'] as num?)?.toInt() ?? 0,
+      emitQueueCapacity: (map['emitQueueCapacity'] as num?)?.toInt() ?? 0,
+      emitQueueHighWater: (map['emitQueueHighWater'] as num?)?.toInt() ?? 0,
+      emitDroppedChunks: (map['emitDroppedChunks'] as num?)?.toInt() ?? 0,
+      emittedChunks: (map['emittedChunks'] as num?)?.toInt() ?? 0,
+      emitWaitMeanUs: (map['emitWaitMeanUs'] as num?)?.toInt() ?? 0,
+      emitWaitMaxUs: (map['emitWaitMaxUs'] as num?)?.toInt() ?? 0,
+      captureRates: (map['captureRates'] as List?)
+              ?.map((rate) => (rate as num).toInt())
+              .toList() ??
+          const [],
+      captureFormats: (map['captureFormats'] as List?)
+              ?.map((format) => format as String)
+              .toList() ??
+          const [],
+      convertedChunks: (map['convertedChunks'] as num?)?.toInt() ?? 0,
+      conversionMeanUs: (map['conversionMeanUs'] as num?)?.toInt() ?? 0,
+      conversionMaxUs: (map['conversionMaxUs'] as num?)?.toInt() ?? 0,
+      loudness: map['loudness'] is Map
+          ? LoudnessData.fromMap(map['loudness'] as Map)
+          : null,
+      delayMs: (map['delayMs'] as num?)?.toDouble(),
+      delayConfidence: (map['delayConfidence'] as num?)?.toDouble(),
+      echoDelayMs: (map['echoDelayMs'] as num?)?.toInt(),
+      echoErleDb: (map['echoErleDb'] as num?)?.toDouble(),
+    );
+  }
+
+  @override
+  String toString() =>
+      'CaptureStats(sessionId: $sessionId, chunksCaptured: $chunksCaptured, droppedChunks: $droppedChunks, overruns: $overruns, lostFrames: $lostFrames, scheduling: $scheduling, jitterMaxUs: $jitterMaxUs, readyQueueHighWater: $readyQueueHighWater, processingMaxUs: $processingMaxUs, emitWaitMaxUs: $emitWaitMaxUs)';
+}
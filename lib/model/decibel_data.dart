@@ -1,3 +1,5 @@
+import 'package:desktop_audio_capture/model/loudness_data.dart';
+
 /// Decibel data from audio capture.
 ///
 /// This class represents a single decibel reading with its timestamp.
@@ -34,9 +36,45 @@ class DecibelData {
 
   /// Unix timestamp in seconds (not milliseconds).
   ///
-  /// This represents when the decibel reading was taken.
+  /// This represents when the measured audio was captured. Platforms without
+  /// capture timing report when the reading was taken instead.
   final double timestamp;
 
+  /// Sequence number of the measured chunk, if the platform reports it.
+  ///
+  /// Matches `AudioChunk.sequence` of the same chunk.
+  final int? sequence;
+
+  /// Capture time of the measured chunk on the monotonic clock in
+  /// microseconds, if the platform reports it.
+  final int? captureTimeUs;
+
+  /// Peak sample level in dB after the meter's attack and release, when
+  /// levels come from a `LevelMeterConfig` meter. [decibel] is then the RMS
+  /// level over the meter's window.
+  final double? peak;
+
+  /// Highest recent [peak], held for the meter's hold time.
+  final double? peakHold;
+
+  /// Loudness of the capture up to this reading, when it was started with
+  /// `loudness` enabled.
+  final LoudnessData? loudness;
+
+  /// Gain applied by automatic gain control in dB, when the capture was
+  /// started with an `AgcConfig`.
+  final double? gainDb;
+
+  /// Gain reduction of the automatic gain control's limiter in dB (0 or
+  /// below), alongside [gainDb].
+  final double? limiterGainDb;
+
+  /// Lowest gain of the compressor and limiter in dB (0 or below) over the
+  /// last processed chunk, when the capture was started with a
+  /// `CompressorConfig` (for synced captures, of the microphone track or
+  /// the mix).
+  final double? compressorGainDb;
+
   /// Creates a new [DecibelData] instance.
   ///
   /// [decibel] should be in the range -120 to 0 dB.
@@ -52,6 +90,14 @@ class DecibelData {
   const DecibelData({
     required this.decibel,
     required this.timestamp,
+    this.sequence,
+    this.captureTimeUs,
+    this.peak,
+    this.peakHold,
+    this.loudness,
+    this.gainDb,
+    this.limiterGainDb,
+    this.compressorGainDb,
   });
 
   /// Creates a [DecibelData] instance from a map.
@@ -75,6 +121,16 @@ class DecibelData {
       decibel: (map['decibel'] as num?)?.toDouble() ?? -120.0,
       timestamp: (map['timestamp'] as num?)?.toDouble() ??
           DateTime.now().millisecondsSinceEpoch / 1000.0,
+      sequence: (map['sequence'] as num?)?.toInt(),
+      captureTimeUs: (map['captureTimeUs'] as num?)?.toInt(),
+      peak: (map['peak'] as num?)?.toDouble(),
+      peakHold: (map['peakHold'] as num?)?.toDouble(),
+      loudness: map['loudness'] is Map
+          ? LoudnessData.fromMap(map['loudness'] as Map)
+          : null,
+      gainDb: (map['gainDb'] as num?)?.toDouble(),
+      limiterGainDb: (map['limiterGainDb'] as num?)?.toDouble(),
+      compressorGainDb: (map['compressorGainDb'] as num?)?.toDouble(),
     );
   }
 
@@ -97,6 +153,14 @@ class DecibelData {
     return {
       'decibel': decibel,
       'timestamp': timestamp,
+      if (sequence != null) 'sequence': sequence,
+      if (captureTimeUs != null) 'captureTimeUs': captureTimeUs,
+      if (peak != null) 'peak': peak,
+      if (peakHold != null) 'peakHold': peakHold,
+      if (loudness != null) 'loudness': loudness!.toMap(),
+      if (gainDb != null) 'gainDb': gainDb,
+      if (limiterGainDb != null) 'limiterGainDb': limiterGainDb,
+      if (compressorGainDb != null) 'compressorGainDb': compressorGainDb,
     };
   }
 
@@ -0,0 +1,65 @@
+/// Delay measured between the microphone and system audio of a synced
+/// capture.
+///
+/// Delivered by `SyncedAudioCapture.delayStream` when the capture was
+/// started with `estimateDelay` (Linux). Each estimate correlates the last
+/// second of both tracks; positions refer to the session's sample timeline
+/// (see `AudioChunk.samplePosition`).
+///
+/// Example:
+/// ```dart
+/// synced.delayStream?.listen((event) {
+///   if (event.confidence > 0.3) {
+///     print('Microphone ${event.delayMs.toStringAsFixed(1)} ms behind');
+///   }
+/// });
+/// ```
+class DelayEvent {
+  /// Native capture session the delay was measured in.
+  final int sessionId;
+
+  /// Delay of the microphone behind the system audio in milliseconds,
+  /// negative when the microphone leads.
+  final double delayMs;
+
+  /// Height of the correlation peak, from 0 to 1: near 1 when the
+  /// microphone hears a clean copy of the system audio, near 0 when the two
+  /// are unrelated and [delayMs] means nothing.
+  final double confidence;
+
+  /// Sample position just past the audio the estimate covers.
+  final int samplePosition;
+
+  /// Capture time of that position on the monotonic clock, in microseconds.
+  final int captureTimeUs;
+
+  /// Capture time of that position as a Unix timestamp in seconds.
+  final double timestamp;
+
+  /// Creates a new [DelayEvent] instance.
+  const DelayEvent({
+    required this.sessionId,
+    required this.delayMs,
+    required this.confidence,
+    required this.samplePosition,
+    required this.captureTimeUs,
+    required this.timestamp,
+  });
+
+  /// Creates a [DelayEvent] from a session event map.
+  factory DelayEvent.fromMap(Map<dynamic, dynamic> map) {
+    return DelayEvent(
+      sessionId: (map['sessionId'] as num?)?.toInt() ?? 0,
+      delayMs: (map['delayMs'] as num?)?.toDouble() ?? 0.0,
+      confidence: (map['confidence'] as num?)?.toDouble() ?? 0.0,
+      samplePosition: (map['samplePosition'] as num?)?.toInt() ?? 0,
+      captureTimeUs: (map['captureTimeUs'] as num?)?.toInt() ?? 0,
+      timestamp: (map['timestamp'] as num?)?.toDouble() ??
+          DateTime.now().millisecondsSinceEpoch / 1000.0,
+    );
+  }
+
+  @override
+  String toString() =>
+      'DelayEvent(sessionId: $sessionId, delayMs: ${delayMs.toStringAsFixed(2)}, confidence: ${confidence.toStringAsFixed(2)}, samplePosition: $samplePosition)';
+}
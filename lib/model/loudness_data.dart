@@ -0,0 +1,67 @@
+/// Loudness of a capture as defined by EBU R128 and ITU-R BS.1770.
+///
+/// Sent with each `DecibelData` and in `CaptureStats` when the capture was
+/// started with `loudness` enabled. Loudness values are in LUFS; silence
+/// reads -120.
+///
+/// Example:
+/// ```dart
+/// capture.decibelStream?.listen((data) {
+///   final loudness = data.loudness;
+///   if (loudness != null) {
+///     print('${loudness.shortTerm} LUFS, ${loudness.truePeak} dBTP');
+///   }
+/// });
+/// ```
+class LoudnessData {
+  /// Loudness of the last 400 ms.
+  final double momentary;
+
+  /// Loudness of the last 3 seconds.
+  final double shortTerm;
+
+  /// Gated loudness of everything captured so far; the value to normalize
+  /// to a target such as -23 LUFS.
+  final double integrated;
+
+  /// Loudness range (EBU Tech 3342) of everything captured so far, in LU.
+  final double range;
+
+  /// Highest true peak captured so far, in dBTP, found by oversampling.
+  final double truePeak;
+
+  /// Creates a new [LoudnessData] instance.
+  const LoudnessData({
+    required this.momentary,
+    required this.shortTerm,
+    required this.integrated,
+    required this.range,
+    required this.truePeak,
+  });
+
+  /// Creates a [LoudnessData] from the `loudness` entry of a platform map.
+  factory LoudnessData.fromMap(Map<dynamic, dynamic> map) {
+    return LoudnessData(
+      momentary: (map['momentary'] as num?)?.toDouble() ?? -120.0,
+      shortTerm: (map['shortTerm'] as num?)?.toDouble() ?? -120.0,
+      integrated: (map['integrated'] as num?)?.toDouble() ?? -120.0,
+      range: (map['range'] as num?)?.toDouble() ?? 0.0,
+      truePeak: (map['truePeak'] as num?)?.toDouble() ?? -120.0,
+    );
+  }
+
+  /// Converts this [LoudnessData] instance to a map.
+  Map<String, dynamic> toMap() {
+    return {
+      'momentary': momentary,
+      'shortTerm': shortTerm,
+      'integrated': integrated,
+      'range': range,
+      'truePeak': truePeak,
+    };
+  }
+
+  @override
+  String toString() =>
+      'LoudnessData(momentary: ${momentary.toStringAsFixed(1)}, shortTerm: ${shortTerm.toStringAsFixed(1)}, integrated: ${integrated.toStringAsFixed(1)} LUFS, range: ${range.toStringAsFixed(1)} LU, truePeak: ${truePeak.toStringAsFixed(1)} dBTP)';
+}
@@ -0,0 +1,91 @@
+import 'dart:typed_data';
+
+/// A run of consecutive log-mel frames of a capture session.
+///
+/// Delivered by `featureStream` when the capture was started with a
+/// `MelFeatureConfig` (Linux). Frame `i` covers [windowSamples] samples
+/// from `samplePosition + i * hopSamples` on the session's sample timeline
+/// (see `AudioChunk.samplePosition`).
+///
+/// Example:
+/// ```dart
+/// capture.featureStream?.listen((features) {
+///   for (var i = 0; i < features.frameCount; i++) {
+///     model.accept(features.frame(i));
+///   }
+/// });
+/// ```
+class MelFeatures {
+  /// Index of this run within the session, starting at 0. A gap means runs
+  /// were dropped before delivery.
+  final int sequence;
+
+  /// Sample position where the first frame's window starts.
+  final int samplePosition;
+
+  /// Number of frames.
+  final int frameCount;
+
+  /// Values per frame.
+  final int bins;
+
+  /// Samples between the starts of consecutive frames.
+  final int hopSamples;
+
+  /// Samples each frame's window covers.
+  final int windowSamples;
+
+  /// Natural log of each filter's energy, frame after frame.
+  final Float32List values;
+
+  /// Capture time of the first frame's first sample on the monotonic clock,
+  /// in microseconds.
+  final int captureTimeUs;
+
+  /// Capture time of the first frame's first sample as a Unix timestamp in
+  /// seconds.
+  final double timestamp;
+
+  /// Creates a new [MelFeatures] instance.
+  const MelFeatures({
+    required this.sequence,
+    required this.samplePosition,
+    required this.frameCount,
+    required this.bins,
+    required this.hopSamples,
+    required this.windowSamples,
+    required this.values,
+    required this.captureTimeUs,
+    required this.timestamp,
+  });
+
+  /// Creates a [MelFeatures] from a feature channel event.
+  factory MelFeatures.fromMap(Map<dynamic, dynamic> map) {
+    final values = map['features'];
+    return MelFeatures(
+      sequence: (map['sequence'] as num?)?.toInt() ?? 0,
+      samplePosition: (map['samplePosition'] as num?)?.toInt() ?? 0,
+      frameCount: (map['frameCount'] as num?)?.toInt() ?? 0,
+      bins: (map['bins'] as num?)?.toInt() ?? 0,
+      hopSamples: (map['hopSamples'] as num?)?.toInt() ?? 0,
+      windowSamples: (map['windowSamples'] as num?)?.toInt() ?? 0,
+      values: values is Float32List
+          ? values
+          : Float32List.fromList(
+              (values as List? ?? const [])
+                  .map((value) => (value as num).toDouble())
+                  .toList()),
+      captureTimeUs: (map['captureTimeUs'] as num?)?.toInt() ?? 0,
+      timestamp: (map['timestamp'] as num?)?.toDouble() ??
+          DateTime.now().millisecondsSinceEpoch / 1000.0,
+    );
+  }
+
+  /// The [bins] values of frame [index], as a view of [values].
+  Float32List frame(int index) =>
+      Float32List.sublistView(values, index * bins, (index + 1) * bins);
+
+  @override
+  String toString() =>
+      'MelFeatures(sequence: $sequence, samplePosition: $samplePosition, frameCount: $frameCount, bins: $bins)';
+}
@@ -0,0 +1,89 @@
+/// Why captured audio was lost.
+enum OverrunCause {
+  /// The audio server discarded audio because the capture did not read it
+  /// in time.
+  serverOverflow,
+
+  /// Chunks were dropped because processing fell behind the capture.
+  queueDrop,
+}
+
+/// A stretch of audio lost by a capture session.
+///
+/// Delivered by `overrunStream` on platforms with capture sessions (Linux).
+/// Positions refer to the session's sample timeline (see
+/// `AudioChunk.samplePosition`), which keeps counting across the gap.
+///
+/// Example:
+/// ```dart
+/// capture.overrunStream?.listen((event) {
+///   print('Lost ${event.durationMs.toStringAsFixed(1)} ms '
+///       'at frame ${event.samplePosition} (${event.cause.name})');
+/// });
+/// ```
+class OverrunEvent {
+  /// Native capture session that lost the audio.
+  final int sessionId;
+
+  /// Where the audio was lost.
+  final OverrunCause cause;
+
+  /// Track of a synced session that lost the audio (`microphone` or
+  /// `system`), or `null` for single-source sessions.
+  final String? track;
+
+  /// Sample position of the first lost frame.
+  final int samplePosition;
+
+  /// Number of lost frames.
+  final int lostFrames;
+
+  /// Duration of the lost audio in milliseconds.
+  final double durationMs;
+
+  /// Whether the lost frames were replaced by silence in the delivered
+  /// audio.
+  final bool filled;
+
+  /// Capture time of the first lost frame on the monotonic clock, in
+  /// microseconds.
+  final int captureTimeUs;
+
+  /// Capture time of the first lost frame as a Unix timestamp in seconds.
+  final double timestamp;
+
+  /// Creates a new [OverrunEvent] instance.
+  const OverrunEvent({
+    required this.sessionId,
+    required this.cause,
+    this.track,
+    required this.samplePosition,
+    required this.lostFrames,
+    required this.durationMs,
+    required this.filled,
+    required this.captureTimeUs,
+    required this.timestamp,
+  });
+
+  /// Creates an [OverrunEvent] from a session event map.
+  factory OverrunEvent.fromMap(Map<dynamic, dynamic> map) {
+    return OverrunEvent(
+      sessionId: (map['sessionId'] as num?)?.toInt() ?? 0,
+      cause: map['cause'] == OverrunCause.serverOverflow.name
+          ? OverrunCause.serverOverflow
+          : OverrunCause.queueDrop,
+      track: map['track'] as String?,
+      samplePosition: (map['samplePosition'] as num?)?.toInt() ?? 0,
+      lostFrames: (map['lostFrames'] as num?)?.toInt() ?? 0,
+      durationMs: (map['durationMs'] as num?)?.toDouble() ?? 0.0,
+      filled: map['filled'] == true,
+      captureTimeUs: (map['captureTimeUs'] as num?)?.toInt() ?? 0,
+      timestamp: (map['timestamp'] as num?)?.toDouble() ??
+          DateTime.now().millisecondsSinceEpoch / 1000.0,
+    );
+  }
+
+  @override
+  String toString() =>
+      'OverrunEvent(sessionId: $sessionId, cause: ${cause.name}, samplePosition: $samplePosition, lostFrames: $lostFrames, filled: $filled)';
+}
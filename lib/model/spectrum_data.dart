@@ -0,0 +1,86 @@
+import 'dart:typed_data';
+
+/// Band levels of a capture session's audio, for spectrum visualizers.
+///
+/// Delivered by `spectrumStream` when the capture was started with a
+/// `SpectrumConfig` (Linux). Each update holds the smoothed levels of the
+/// latest FFT frame, which ends just before [samplePosition] on the
+/// session's sample timeline (see `AudioChunk.samplePosition`).
+///
+/// Example:
+/// ```dart
+/// capture.spectrumStream?.listen((spectrum) {
+///   setState(() => _bars = spectrum.normalized(floorDb: -90));
+/// });
+/// ```
+class SpectrumData {
+  /// Index of this update within the session, starting at 0. A gap means
+  /// updates were dropped before delivery.
+  final int sequence;
+
+  /// Sample position just past the analyzed audio.
+  final int samplePosition;
+
+  /// FFT size the levels were computed with.
+  final int fftSize;
+
+  /// Level of each band in dBFS, from -120 (silence) to about 0.
+  final Float32List levels;
+
+  /// Center frequency of each band in Hz, from low to high.
+  final Float32List frequencies;
+
+  /// Capture time at [samplePosition] on the monotonic clock, in
+  /// microseconds.
+  final int captureTimeUs;
+
+  /// Capture time at [samplePosition] as a Unix timestamp in seconds.
+  final double timestamp;
+
+  /// Creates a new [SpectrumData] instance.
+  const SpectrumData({
+    required this.sequence,
+    required this.samplePosition,
+    required this.fftSize,
+    required this.levels,
+    required this.frequencies,
+    required this.captureTimeUs,
+    required this.timestamp,
+  });
+
+  /// Creates a [SpectrumData] from a spectrum channel event.
+  factory SpectrumData.fromMap(Map<dynamic, dynamic> map) {
+    return SpectrumData(
+      sequence: (map['sequence'] as num?)?.toInt() ?? 0,
+      samplePosition: (map['samplePosition'] as num?)?.toInt() ?? 0,
+      fftSize: (map['fftSize'] as num?)?.toInt() ?? 0,
+      levels: _floats(map['levels']),
+      frequencies: _floats(map['frequencies']),
+      captureTimeUs: (map['captureTimeUs'] as num?)?.toInt() ?? 0,
+      timestamp: (map['timestamp'] as num?)?.toDouble() ??
+          DateTime.now().millisecondsSinceEpoch / 1000.0,
+    );
+  }
+
+  /// Number of bands.
+  int get bandCount => levels.length;
+
+  /// The levels mapped to 0.0 (at or below [floorDb]) to 1.0 (0 dBFS), as
+  /// bar heights.
+  List<double> normalized({double floorDb = -90.0}) => levels
+      .map((level) => ((level - floorDb) / -floorDb).clamp(0.0, 1.0))
+      .toList();
+
+  static Float32List _floats(dynamic value) {
+    if (value is Float32List) {
+      return value;
+    }
+    return Float32List.fromList((value as List? ?? const [])
+        .map((element) => (element as num).toDouble())
+        .toList());
+  }
+
+  @override
+  String toString() =>
+      'SpectrumData(sequence: $sequence, samplePosition: $samplePosition, bands: $bandCount)';
+}
@@ -0,0 +1,62 @@
+/// Speech starting or ending in a capture session's audio.
+///
+/// Delivered by `speechStream` when the capture was started with a
+/// `VoiceActivityConfig` (Linux). Speech starts with the first frame found
+/// to be speech and ends once the configured hangover has passed without
+/// any; positions refer to the session's sample timeline (see
+/// `AudioChunk.samplePosition`).
+///
+/// Example:
+/// ```dart
+/// capture.speechStream?.listen((event) {
+///   print(event.speaking ? 'Speech started' : 'Speech ended');
+/// });
+/// ```
+class SpeechEvent {
+  /// Native capture session the speech was detected in.
+  final int sessionId;
+
+  /// Whether speech starts (`true`) or ends (`false`).
+  final bool speaking;
+
+  /// Speech probability of the chunk the change was detected in, from 0
+  /// to 1.
+  final double probability;
+
+  /// Sample position of the first frame of speech, or of the first frame
+  /// after it.
+  final int samplePosition;
+
+  /// Capture time of that frame on the monotonic clock, in microseconds.
+  final int captureTimeUs;
+
+  /// Capture time of that frame as a Unix timestamp in seconds.
+  final double timestamp;
+
+  /// Creates a new [SpeechEvent] instance.
+  const SpeechEvent({
+    required this.sessionId,
+    required this.speaking,
+    required this.probability,
+    required this.samplePosition,
+    required this.captureTimeUs,
+    required this.timestamp,
+  });
+
+  /// Creates a [SpeechEvent] from a session event map.
+  factory SpeechEvent.fromMap(Map<dynamic, dynamic> map) {
+    return SpeechEvent(
+      sessionId: (map['sessionId'] as num?)?.toInt() ?? 0,
+      speaking: map['speaking'] == true,
+      probability: (map['probability'] as num?)?.toDouble() ?? 0.0,
+      samplePosition: (map['samplePosition'] as num?)?.toInt() ?? 0,
+      captureTimeUs: (map['captureTimeUs'] as num?)?.toInt() ?? 0,
+      timestamp: (map['timestamp'] as num?)?.toDouble() ??
+          DateTime.now().millisecondsSinceEpoch / 1000.0,
+    );
+  }
+
+  @override
+  String toString() =>
+      'SpeechEvent(sessionId: $sessionId, speaking: $speaking, probability: ${probability.toStringAsFixed(2)}, samplePosition: $samplePosition)';
+}
@@ -0,0 +1,117 @@
+import 'dart:typed_data';
+
+/// Waveform buckets of one resolution, from a [WaveformData] update.
+///
+/// Bucket `i` covers [bucketSamples] samples from
+/// `samplePosition + i * bucketSamples` on the session's sample timeline.
+class WaveformLevel {
+  /// Samples each bucket covers.
+  final int bucketSamples;
+
+  /// Sample position where the first bucket starts.
+  final int samplePosition;
+
+  /// Minimum, maximum and RMS of each bucket, bucket after bucket, as
+  /// 16-bit sample values.
+  final Int16List data;
+
+  /// Creates a new [WaveformLevel] instance.
+  const WaveformLevel({
+    required this.bucketSamples,
+    required this.samplePosition,
+    required this.data,
+  });
+
+  /// Creates a [WaveformLevel] from one entry of a waveform channel event.
+  factory WaveformLevel.fromMap(Map<dynamic, dynamic> map) {
+    final data = map['data'];
+    return WaveformLevel(
+      bucketSamples: (map['bucketSamples'] as num?)?.toInt() ?? 0,
+      samplePosition: (map['samplePosition'] as num?)?.toInt() ?? 0,
+      // The packed values, viewed in place where they are aligned.
+      data: data is Uint8List
+          ? (data.offsetInBytes.isEven
+              ? data.buffer.asInt16List(
+                  data.offsetInBytes, data.lengthInBytes ~/ 2)
+              : Uint8List.fromList(data).buffer.asInt16List())
+          : Int16List(0),
+    );
+  }
+
+  /// Number of buckets.
+  int get bucketCount => data.length ~/ 3;
+
+  /// Lowest sample of bucket [index].
+  int min(int index) => data[index * 3];
+
+  /// Highest sample of bucket [index].
+  int max(int index) => data[index * 3 + 1];
+
+  /// RMS of bucket [index], from 0 to 32767.
+  int rms(int index) => data[index * 3 + 2];
+
+  @override
+  String toString() =>
+      'WaveformLevel(bucketSamples: $bucketSamples, samplePosition: $samplePosition, bucketCount: $bucketCount)';
+}
+
+/// Min/max/RMS buckets of a capture session's audio, for waveform displays.
+///
+/// Delivered by `waveformStream` when the capture was started with a
+/// `WaveformConfig` (Linux). Each update holds the buckets completed since
+/// the previous one, at every resolution in [levels], finest first.
+///
+/// Example:
+/// ```dart
+/// capture.waveformStream?.listen((waveform) {
+///   final level = waveform.levels.first;
+///   for (var i = 0; i < level.bucketCount; i++) {
+///     columns.add((level.min(i), level.max(i)));
+///   }
+/// });
+/// ```
+class WaveformData {
+  /// Index of this update within the session, starting at 0. A gap means
+  /// updates were dropped before delivery.
+  final int sequence;
+
+  /// Sample position where the first bucket of the finest level starts.
+  final int samplePosition;
+
+  /// The buckets of each resolution, finest first.
+  final List<WaveformLevel> levels;
+
+  /// Capture time at [samplePosition] on the monotonic clock, in
+  /// microseconds.
+  final int captureTimeUs;
+
+  /// Capture time at [samplePosition] as a Unix timestamp in seconds.
+  final double timestamp;
+
+  /// Creates a new [WaveformData] instance.
+  const WaveformData({
+    required this.sequence,
+    required this.samplePosition,
+    required this.levels,
+    required this.captureTimeUs,
+    required this.timestamp,
+  });
+
+  /// Creates a [WaveformData] from a waveform channel event.
+  factory WaveformData.fromMap(Map<dynamic, dynamic> map) {
+    return WaveformData(
+      sequence: (map['sequence'] as num?)?.toInt() ?? 0,
+      samplePosition: (map['samplePosition'] as num?)?.toInt() ?? 0,
+      levels: (map['levels'] as List? ?? const [])
+          .map((level) => WaveformLevel.fromMap(level as Map))
+          .toList(),
+      captureTimeUs: (map['captureTimeUs'] as num?)?.toInt() ?? 0,
+      timestamp: (map['timestamp'] as num?)?.toDouble() ??
+          DateTime.now().millisecondsSinceEpoch / 1000.0,
+    );
+  }
+
+  @override
+  String toString() =>
+      'WaveformData(sequence: $sequence, samplePosition: $samplePosition, levels: ${levels.length})';
+}
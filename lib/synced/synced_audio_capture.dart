@@ -0,0 +1,294 @@
+import 'dart:async';
+
+import 'package:desktop_audio_capture/audio_capture.dart';
+import 'package:flutter/services.dart';
+
+export 'package:desktop_audio_capture/config/synced_audio_config.dart';
+
+enum _SyncedAudioMethod {
+  startSyncedCapture,
+  stopCapture,
+  getCaptureStats,
+  requestPermissions,
+}
+
+/// Class for capturing the microphone and system audio on one timeline.
+///
+/// Both sources are read natively from the same clock and aligned by sample
+/// position before delivery, so no Dart-side buffering is needed to line
+/// them up. Depending on [SyncedAudioConfig.outputMode] each chunk holds
+/// interleaved two-track frames (microphone, system), a single mixed track,
+/// or the microphone track with the system audio's echo removed.
+///
+/// Currently supported on Linux only; [startCapture] throws elsewhere.
+///
+/// Example:
+/// ```dart
+/// final synced = SyncedAudioCapture(
+///   config: SyncedAudioConfig(chunkDurationMs: 100),
+/// );
+///
+/// await synced.startCapture();
+///
+/// synced.audioStream?.listen((audioData) {
+///   final samples = audioData.buffer.asInt16List();
+///   for (var i = 0; i + 1 < samples.length; i += 2) {
+///     final mic = samples[i];
+///     final system = samples[i + 1];
+///     // ...
+///   }
+/// });
+///
+/// await synced.stopCapture();
+/// ```
+class SyncedAudioCapture extends AudioCapture {
+  static const MethodChannel _channel = MethodChannel(
+    'com.system_audio_transcriber/audio_capture',
+  );
+  static const String _audioStreamChannelName =
+      'com.system_audio_transcriber/audio_stream';
+  static const EventChannel _statusStreamChannel = EventChannel(
+    'com.system_audio_transcriber/audio_status',
+  );
+  static const EventChannel _decibelStreamChannel = EventChannel(
+    'com.system_audio_transcriber/audio_decibel',
+  );
+  static const EventChannel _eventsChannel = EventChannel(
+    'com.system_audio_transcriber/audio_events',
+  );
+
+  Stream<Uint8List>? _audioStream;
+  Stream<AudioChunk>? _chunkStream;
+  Stream<SystemAudioStatus>? _statusStream;
+  Stream<DecibelData>? _decibelStream;
+  Stream<OverrunEvent>? _overrunStream;
+  Stream<DelayEvent>? _delayStream;
+  int? _sessionId;
+
+  /// Native capture session of this instance, or `null` when not recording.
+  int? get sessionId => _sessionId;
+
+  // Only events of this session are delivered.
+  bool _isOwnEvent(dynamic event) {
+    return event is Map && event['sessionId'] == _sessionId;
+  }
+
+  /// Stream of aligned audio chunks (16-bit little-endian PCM).
+  ///
+  /// The stream is only available after [startCapture] has been called.
+  Stream<Uint8List>? get audioStream => _audioStream;
+
+  /// Stream of aligned chunks with their sequence number, sample position
+  /// and capture time (see [AudioChunk]).
+  ///
+  /// The stream is only available after [startCapture] has been called.
+  Stream<AudioChunk>? get chunkStream => _chunkStream;
+
+  /// Stream of status updates of this session.
+  ///
+  /// The stream is only available after [startCapture] has been called.
+  Stream<SystemAudioStatus>? get statusStream {
+    if (_sessionId == null) {
+      return null;
+    }
+    _statusStream ??= _statusStreamChannel
+        .receiveBroadcastStream()
+        .where(_isOwnEvent)
+        .map((dynamic event) {
+      return SystemAudioStatus.fromJson(Map<String, dynamic>.from(event));
+    });
+    return _statusStream;
+  }
+
+  /// Stream of decibel (dB) readings of the delivered chunks.
+  ///
+  /// The stream is only available while recording is active.
+  Stream<DecibelData>? get decibelStream {
+    if (_sessionId == null) {
+      return null;
+    }
+    _decibelStream ??= _decibelStreamChannel
+        .receiveBroadcastStream()
+        .where(_isOwnEvent)
+        .map((dynamic event) {
+      return DecibelData.fromMap(Map<String, dynamic>.from(event));
+    });
+    return _decibelStream;
+  }
+
+  /// Stream of audio lost by this session's capture (see [OverrunEvent]).
+  ///
+  /// Reported whenever the audio server or the plugin had to discard audio
+  /// because the capture fell behind. Only available while recording on
+  /// platforms with capture sessions (Linux); `null` otherwise.
+  ///
+  /// Example:
+  /// ```dart
+  /// synced.overrunStream?.listen((event) {
+  ///   print('Lost ${event.lostFrames} frames (${event.cause.name})');
+  /// });
+  /// ```
+  Stream<OverrunEvent>? get overrunStream {
+    final sessionId = _sessionId;
+    if (sessionId == null) {
+      return null;
+    }
+    _overrunStream ??= _eventsChannel
+        .receiveBroadcastStream()
+        .where((dynamic event) =>
+            event is Map &&
+            event['type'] == 'overrun' &&
+            event['sessionId'] == sessionId)
+        .map((dynamic event) => OverrunEvent.fromMap(event as Map));
+    return _overrunStream;
+  }
+
+  /// Stream of delays measured between the microphone and system audio
+  /// (see [DelayEvent]).
+  ///
+  /// Reported every [SyncedAudioConfig.delayIntervalMs] while both tracks
+  /// carry sound, for captures started with
+  /// [SyncedAudioConfig.estimateDelay]. Only available while recording on
+  /// platforms with capture sessions (Linux); `null` otherwise.
+  ///
+  /// Example:
+  /// ```dart
+  /// synced.delayStream?.listen((event) {
+  ///   print('${event.delayMs} ms (confidence ${event.confidence})');
+  /// });
+  /// ```
+  Stream<DelayEvent>? get delayStream {
+    final sessionId = _sessionId;
+    if (sessionId == null) {
+      return null;
+    }
+    _delayStream ??= _eventsChannel
+        .receiveBroadcastStream()
+        .where((dynamic event) =>
+            event is Map &&
+            event['type'] == 'delay' &&
+            event['sessionId'] == sessionId)
+        .map((dynamic event) => DelayEvent.fromMap(event as Map));
+    return _delayStream;
+  }
+
+  SyncedAudioConfig _config = SyncedAudioConfig();
+
+  /// Creates a new [SyncedAudioCapture] instance.
+  ///
+  /// [config] is optional. If not provided, default configuration will be used
+  /// (sampleRate: 16000, chunkDurationMs: 1000, interleaved output).
+  SyncedAudioCapture({SyncedAudioConfig? config}) {
+    _config = config ?? SyncedAudioConfig();
+  }
+
+  /// Updates the configuration used by the next [startCapture] call.
+  void updateConfig(SyncedAudioConfig config) {
+    _config = config;
+  }
+
+  /// Starts capturing the microphone and system audio together.
+  ///
+  /// Throws an [Exception] if permissions are not granted, either source
+  /// cannot be opened, or the platform has no synced capture support.
+  ///
+  /// Example:
+  /// ```dart
+  /// await synced.startCapture(
+  ///   config: SyncedAudioConfig(outputMode: SyncedOutputMode.mixed),
+  /// );
+  /// ```
+  Future<void> startCapture({SyncedAudioConfig? config}) async {
+    if (isRecording) {
+      return;
+    }
+
+    if (config != null) {
+      updateConfig(config);
+    }
+
+    final hasPermission = await _channel.invokeMethod<bool>(
+      _SyncedAudioMethod.requestPermissions.name,
+    );
+    if (hasPermission != true) {
+      throw Exception('Audio capture permission not granted');
+    }
+
+    dynamic result;
+    try {
+      result = await _channel.invokeMethod<dynamic>(
+        _SyncedAudioMethod.startSyncedCapture.name,
+        _config.toMap(),
+      );
+    } on MissingPluginException {
+      throw Exception('Synced capture is not supported on this platform');
+    }
+
+    if (result is! int) {
+      throw Exception('Failed to start synced audio capture');
+    }
+    _sessionId = result;
+
+    final chunkStream = EventChannel('$_audioStreamChannelName/$result')
+        .receiveBroadcastStream()
+        .map((dynamic event) {
+      if (event is Map) {
+        return AudioChunk.fromMap(event);
+      }
+      throw Exception('Unexpected audio chunk type: ${event.runtimeType}');
+    });
+    _chunkStream = chunkStream;
+    _audioStream = chunkStream.map((chunk) => chunk.data);
+  }
+
+  /// Stops the synced capture session.
+  ///
+  /// If capture is not active, this method does nothing.
+  Future<void> stopCapture() async {
+    final sessionId = _sessionId;
+    if (sessionId == null) return;
+
+    final stopped = await _channel.invokeMethod<bool>(
+      _SyncedAudioMethod.stopCapture.name,
+      {'sessionId': sessionId},
+    );
+
+    if (stopped != true) {
+      throw Exception('Failed to stop synced audio capture');
+    }
+
+    _sessionId = null;
+    _audioStream = null;
+    _chunkStream = null;
+    _statusStream = null;
+    _decibelStream = null;
+    _overrunStream = null;
+    _delayStream = null;
+  }
+
+  /// Returns the counters of this session's capture (see [CaptureStats]).
+  ///
+  /// Returns `null` when not recording or on platforms without capture
+  /// sessions.
+  ///
+  /// Example:
+  /// ```dart
+  /// final stats = await synced.getStats();
+  /// print('Dropped chunks: ${stats?.droppedChunks}');
+  /// ```
+  Future<CaptureStats?> getStats() async {
+    final sessionId = _sessionId;
+    if (sessionId == null) {
+      return null;
+    }
+    final stats = await _channel.invokeMethod<dynamic>(
+      _SyncedAudioMethod.getCaptureStats.name,
+      {'sessionId': sessionId},
+    );
+    return stats is Map ? CaptureStats.fromMap(stats) : null;
+  }
+
+  /// Whether the synced capture is currently recording.
+  @override
+  bool get isRecording => _sessionId != null;
+}
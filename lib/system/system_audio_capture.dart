@@ -8,6 +8,7 @@ export 'package:desktop_audio_capture/config/system_adudio_config.dart';
 enum _SystemAudioMethod {
   startCapture,
   stopCapture,
+  getCaptureStats,
   requestPermissions,
 }
 
@@ -55,11 +56,66 @@ class SystemAudioCapture extends AudioCapture {
   static const EventChannel _decibelStreamChannel = EventChannel(
     'com.system_audio_transcriber/audio_decibel',
   );
+  static const EventChannel _eventsChannel = EventChannel(
+    'com.system_audio_transcriber/audio_events',
+  );
 
   Stream<Uint8List>? _audioStream;
+  Stream<AudioChunk>? _chunkStream;
   Stream<SystemAudioStatus>? _statusStream;
   Stream<DecibelData>? _decibelStream;
+  Stream<OverrunEvent>? _overrunStream;
+  Stream<SpeechEvent>? _speechStream;
+  Stream<MelFeatures>? _featureStream;
+  Stream<SpectrumData>? _spectrumStream;
+  Stream<WaveformData>? _waveformStream;
   bool _isRecording = false;
+  int? _sessionId;
+
+  /// Native capture session of this instance, or `null` when not recording.
+  ///
+  /// Each [SystemAudioCapture] owns one session, so several instances can
+  /// record different output monitors at the same time. Platforms without
+  /// session support report `null` even while recording.
+  int? get sessionId => _sessionId;
+
+  // Audio of a session is delivered with its timing on the session's own
+  // channel; without a session the shared channel carries bare bytes.
+  Stream<Uint8List> _createAudioStream() {
+    final sessionId = _sessionId;
+    if (sessionId == null) {
+      _chunkStream = null;
+      return _audioStreamChannel.receiveBroadcastStream().map((
+        dynamic event,
+      ) {
+        if (event is Uint8List) {
+          return event;
+        } else if (event is List<int>) {
+          return Uint8List.fromList(event);
+        }
+        throw Exception('Unexpected audio data type: ${event.runtimeType}');
+      });
+    }
+    final chunkStream = EventChannel('${_audioStreamChannel.name}/$sessionId')
+        .receiveBroadcastStream()
+        .map((dynamic event) {
+      if (event is Map) {
+        return AudioChunk.fromMap(event);
+      }
+      throw Exception('Unexpected audio chunk type: ${event.runtimeType}');
+    });
+    _chunkStream = chunkStream;
+    return chunkStream.map((chunk) => chunk.data);
+  }
+
+  // Status and decibel events of other sessions are dropped.
+  bool _isOwnEvent(dynamic event) {
+    if (event is! Map || _sessionId == null) {
+      return true;
+    }
+    final sessionId = event['sessionId'];
+    return sessionId == null || sessionId == _sessionId;
+  }
 
   /// Stream of raw audio data bytes from system audio capture.
   ///
@@ -78,6 +134,21 @@ class SystemAudioCapture extends AudioCapture {
   /// ```
   Stream<Uint8List>? get audioStream => _audioStream;
 
+  /// Stream of captured chunks with their capture timing.
+  ///
+  /// Carries the same audio as [audioStream] plus a sequence number, the
+  /// sample position and the capture time of every chunk (see [AudioChunk]).
+  /// Only available while recording on platforms with capture sessions
+  /// (Linux); `null` otherwise.
+  ///
+  /// Example:
+  /// ```dart
+  /// systemCapture.chunkStream?.listen((chunk) {
+  ///   print('#${chunk.sequence} captured at ${chunk.captureTime}');
+  /// });
+  /// ```
+  Stream<AudioChunk>? get chunkStream => _chunkStream;
+
   /// Stream of system audio capture status updates.
   ///
   /// Returns a [Stream<SystemAudioStatus>] containing status information:
@@ -95,9 +166,10 @@ class SystemAudioCapture extends AudioCapture {
   /// ```
   Stream<SystemAudioStatus>? get statusStream {
     // Create status stream if not already created
-    _statusStream ??= _statusStreamChannel.receiveBroadcastStream().map((
-      dynamic event,
-    ) {
+    _statusStream ??= _statusStreamChannel
+        .receiveBroadcastStream()
+        .where(_isOwnEvent)
+        .map((dynamic event) {
       if (event is Map) {
         return SystemAudioStatus.fromJson(Map<String, dynamic>.from(event));
       }
@@ -128,9 +200,10 @@ class SystemAudioCapture extends AudioCapture {
       return null;
     }
     // Create decibel stream if not already created
-    _decibelStream ??= _decibelStreamChannel.receiveBroadcastStream().map((
-      dynamic event,
-    ) {
+    _decibelStream ??= _decibelStreamChannel
+        .receiveBroadcastStream()
+        .where(_isOwnEvent)
+        .map((dynamic event) {
       if (event is Map) {
         return DecibelData.fromMap(Map<String, dynamic>.from(event));
       }
@@ -141,6 +214,135 @@ class SystemAudioCapture extends AudioCapture {
     return _decibelStream;
   }
 
+  /// Stream of audio lost by this session's capture (see [OverrunEvent]).
+  ///
+  /// Reported whenever the audio server or the plugin had to discard audio
+  /// because the capture fell behind. Only available while recording on
+  /// platforms with capture sessions (Linux); `null` otherwise.
+  ///
+  /// Example:
+  /// ```dart
+  /// systemCapture.overrunStream?.listen((event) {
+  ///   print('Lost ${event.lostFrames} frames (${event.cause.name})');
+  /// });
+  /// ```
+  Stream<OverrunEvent>? get overrunStream {
+    final sessionId = _sessionId;
+    if (sessionId == null) {
+      return null;
+    }
+    _overrunStream ??= _eventsChannel
+        .receiveBroadcastStream()
+        .where((dynamic event) =>
+            event is Map &&
+            event['type'] == 'overrun' &&
+            event['sessionId'] == sessionId)
+        .map((dynamic event) => OverrunEvent.fromMap(event as Map));
+    return _overrunStream;
+  }
+
+  /// Stream of speech starting and ending in this session's audio (see
+  /// [SpeechEvent]).
+  ///
+  /// Only reported when recording with a [VoiceActivityConfig] on platforms
+  /// with capture sessions (Linux); `null` when not recording.
+  ///
+  /// Example:
+  /// ```dart
+  /// systemCapture.speechStream?.listen((event) {
+  ///   print(event.speaking ? 'Speaking' : 'Silent');
+  /// });
+  /// ```
+  Stream<SpeechEvent>? get speechStream {
+    final sessionId = _sessionId;
+    if (sessionId == null) {
+      return null;
+    }
+    _speechStream ??= _eventsChannel
+        .receiveBroadcastStream()
+        .where((dynamic event) =>
+            event is Map &&
+            event['type'] == 'speech' &&
+            event['sessionId'] == sessionId)
+        .map((dynamic event) => SpeechEvent.fromMap(event as Map));
+    return _speechStream;
+  }
+
+  /// Stream of log-mel features of this session's audio (see
+  /// [MelFeatures]).
+  ///
+  /// Only delivered when recording with a [MelFeatureConfig] on platforms
+  /// with capture sessions (Linux); `null` when not recording. Features are
+  /// only computed while this stream is listened to.
+  ///
+  /// Example:
+  /// ```dart
+  /// systemCapture.featureStream?.listen((features) {
+  ///   print('${features.frameCount} frames of ${features.bins} bins');
+  /// });
+  /// ```
+  Stream<MelFeatures>? get featureStream {
+    final sessionId = _sessionId;
+    if (sessionId == null) {
+      return null;
+    }
+    _featureStream ??=
+        EventChannel('${_audioStreamChannel.name}/$sessionId/features')
+            .receiveBroadcastStream()
+            .map((dynamic event) => MelFeatures.fromMap(event as Map));
+    return _featureStream;
+  }
+
+  /// Stream of spectrum band levels of this session's audio, for
+  /// visualizers (see [SpectrumData]).
+  ///
+  /// Only delivered when recording with a [SpectrumConfig] on platforms
+  /// with capture sessions (Linux); `null` when not recording. The spectrum
+  /// is only analyzed while this stream is listened to.
+  ///
+  /// Example:
+  /// ```dart
+  /// systemCapture.spectrumStream?.listen((spectrum) {
+  ///   bars.value = spectrum.normalized();
+  /// });
+  /// ```
+  Stream<SpectrumData>? get spectrumStream {
+    final sessionId = _sessionId;
+    if (sessionId == null) {
+      return null;
+    }
+    _spectrumStream ??=
+        EventChannel('${_audioStreamChannel.name}/$sessionId/spectrum')
+            .receiveBroadcastStream()
+            .map((dynamic event) => SpectrumData.fromMap(event as Map));
+    return _spectrumStream;
+  }
+
+  /// Stream of min/max/RMS buckets of this session's audio, for waveform
+  /// displays (see [WaveformData]).
+  ///
+  /// Only delivered when recording with a [WaveformConfig] on platforms
+  /// with capture sessions (Linux); `null` when not recording. Buckets are
+  /// only computed while this stream is listened to.
+  ///
+  /// Example:
+  /// ```dart
+  /// systemCapture.waveformStream?.listen((waveform) {
+  ///   print('${waveform.levels.first.bucketCount} new buckets');
+  /// });
+  /// ```
+  Stream<WaveformData>? get waveformStream {
+    final sessionId = _sessionId;
+    if (sessionId == null) {
+      return null;
+    }
+    _waveformStream ??=
+        EventChannel('${_audioStreamChannel.name}/$sessionId/waveform')
+            .receiveBroadcastStream()
+            .map((dynamic event) => WaveformData.fromMap(event as Map));
+    return _waveformStream;
+  }
+
   SystemAudioConfig _config = SystemAudioConfig();
 
   /// Creates a new [SystemAudioCapture] instance.
@@ -223,26 +425,20 @@ class SystemAudioCapture extends AudioCapture {
     try {
       await requestPermissions();
 
-      final started = await _channel.invokeMethod<bool>(
+      final started = await _channel.invokeMethod<dynamic>(
         _SystemAudioMethod.startCapture.name,
         _config.toMap(),
       );
 
-      if (started != true) {
+      // Platforms with session support return the session id.
+      if (started is int) {
+        _sessionId = started;
+      } else if (started != true) {
         throw Exception('Failed to start system audio capture');
       }
 
       // Listen to audio stream
-      _audioStream = _audioStreamChannel.receiveBroadcastStream().map((
-        dynamic event,
-      ) {
-        if (event is Uint8List) {
-          return event;
-        } else if (event is List<int>) {
-          return Uint8List.fromList(event);
-        }
-        throw Exception('Unexpected audio data type: ${event.runtimeType}');
-      });
+      _audioStream = _createAudioStream();
 
       // Status stream is created lazily via getter, no need to recreate here
 
@@ -274,6 +470,7 @@ class SystemAudioCapture extends AudioCapture {
     try {
       final stopped = await _channel.invokeMethod<bool>(
         _SystemAudioMethod.stopCapture.name,
+        _sessionId != null ? {'sessionId': _sessionId} : null,
       );
 
       if (stopped != true) {
@@ -281,14 +478,43 @@ class SystemAudioCapture extends AudioCapture {
       }
 
       _isRecording = false;
+      _sessionId = null;
       _audioStream = null;
+      _chunkStream = null;
       _statusStream = null;
       _decibelStream = null;
+      _overrunStream = null;
+      _speechStream = null;
+      _featureStream = null;
+      _spectrumStream = null;
+      _waveformStream = null;
     } catch (e) {
       rethrow;
     }
   }
 
+  /// Returns the counters of this session's capture (see [CaptureStats]).
+  ///
+  /// Returns `null` when not recording or on platforms without capture
+  /// sessions.
+  ///
+  /// Example:
+  /// ```dart
+  /// final stats = await systemCapture.getStats();
+  /// print('Dropped chunks: ${stats?.droppedChunks}');
+  /// ```
+  Future<CaptureStats?> getStats() async {
+    final sessionId = _sessionId;
+    if (sessionId == null) {
+      return null;
+    }
+    final stats = await _channel.invokeMethod<dynamic>(
+      _SystemAudioMethod.getCaptureStats.name,
+      {'sessionId': sessionId},
+    );
+    return stats is Map ? CaptureStats.fromMap(stats) : null;
+  }
+
   /// Whether system audio capture is currently recording.
   ///
   /// Returns `true` if capture is active, `false` otherwise.
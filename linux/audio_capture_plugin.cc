@@ -8,11 +8,11 @@
 #include <pulse/simple.h>
 
 #include <algorithm>
-#include <cmath>
 #include <cstdint>
-#include <memory>
 #include <string>
-#include <vector>
+
+#include "capture_session.h"
+#include "source_info.h"
 
 namespace {
 
@@ -20,6 +20,8 @@ constexpr char kMethodChannelName[] = "com.system_audio_transcriber/audio_captur
 constexpr char kEventChannelName[] = "com.system_audio_transcriber/audio_stream";
 constexpr char kStatusEventChannelName[] = "com.system_audio_transcriber/audio_status";
 constexpr char kDecibelEventChannelName[] = "com.system_audio_transcriber/audio_decibel";
+constexpr char kEventsChannelName[] = "com.system_audio_transcriber/audio_events";
+constexpr char kCaptureThreadName[] = "voxa-audio-capture";
 
 constexpr int kDefaultSampleRate = 16000;
 constexpr int kDefaultChannels = 1;
@@ -27,30 +29,10 @@ constexpr int kDefaultBitsPerSample = 16;
 constexpr int kDefaultChunkDurationMs = 1000;
 constexpr float kDefaultGainBoost = 2.5f;
 constexpr float kDefaultInputVolume = 1.0f;
-
-struct AudioChunkPayload {
-  AudioChunkPayload(AudioCapturePlugin* plugin, GBytes* bytes, double decibel)
-      : plugin(plugin), bytes(bytes), decibel(decibel) {}
-
-  AudioCapturePlugin* plugin;
-  GBytes* bytes;
-  double decibel;
-};
-
-struct CaptureThreadContext {
-  AudioCapturePlugin* plugin;
-  pa_simple* stream;
-  size_t chunk_size;
-  int sample_rate;
-  int channels;
-  int bits_per_sample;
-  float gain_boost;
-  float input_volume;
-};
-
-gboolean EmitAudioOnMainThread(gpointer user_data);
-gpointer CaptureThread(gpointer user_data);
-double CalculateDecibel(const int16_t* samples, size_t sample_count);
+constexpr float kDefaultTrackGain = 1.0f;
+// Range of the interval between delay estimates.
+constexpr int64_t kMinDelayIntervalMs = 100;
+constexpr int64_t kMaxDelayIntervalMs = 60000;
 
 }  // namespace
 
@@ -58,35 +40,21 @@ struct _AudioCapturePlugin {
   GObject parent_instance;
 
   FlMethodChannel* method_channel;
-  FlEventChannel* event_channel;
-  FlEventChannel* status_event_channel;
-  FlEventChannel* decibel_event_channel;
-  GMainContext* main_context;
-
-  GMutex lock;
-  gint should_stop;
-  gboolean is_capturing;
-  gboolean has_listener;
-  gboolean has_status_listener;
-  gboolean has_decibel_listener;
-
-  GThread* capture_thread;
+  audio_capture::CaptureHost host;
 };
 
 G_DEFINE_TYPE(AudioCapturePlugin, audio_capture_plugin, G_TYPE_OBJECT)
 
 namespace {
 
-bool OpenPulseStream(int sample_rate, int channels, int bits_per_sample,
-                     size_t chunk_size, pa_simple** out_stream, std::string* error_message) {
+bool OpenPulseStream(const std::string& device_id, const char* stream_name,
+                     const audio_capture::CaptureFormat& format, int channels,
+                     size_t chunk_size, pa_simple** out_stream,
+                     std::string* error_message) {
   pa_sample_spec spec;
-  spec.rate = sample_rate;
+  spec.rate = format.rate;
   spec.channels = static_cast<uint8_t>(channels);
-  if (bits_per_sample == 16) {
-    spec.format = PA_SAMPLE_S16LE;
-  } else {
-    spec.format = PA_SAMPLE_S16LE;
-  }
+  spec.format = audio_capture::PulseSampleFormat(format.sample_format);
 
   pa_buffer_attr attr;
   attr.maxlength = static_cast<uint32_t>(chunk_size * 4);
@@ -96,15 +64,23 @@ bool OpenPulseStream(int sample_rate, int channels, int bits_per_sample,
   attr.fragsize = static_cast<uint32_t>(chunk_size);
 
   int error = 0;
+  pa_simple* stream = nullptr;
 
-  pa_simple* stream =
-      pa_simple_new(nullptr, "Voxa", PA_STREAM_RECORD, "@DEFAULT_MONITOR@",
-                    "System Capture", &spec, nullptr, &attr, &error);
-
-  if (stream == nullptr) {
-    // Fallback to default source (microphone) if monitor is unavailable.
-    stream = pa_simple_new(nullptr, "Voxa", PA_STREAM_RECORD, nullptr,
-                           "Default Capture", &spec, nullptr, &attr, &error);
+  if (!device_id.empty()) {
+    // An explicitly requested source has no fallback.
+    stream = pa_simple_new(nullptr, "Voxa", PA_STREAM_RECORD,
+                           device_id.c_str(), stream_name, &spec, nullptr,
+                           &attr, &error);
+  } else {
+    stream = pa_simple_new(nullptr, "Voxa", PA_STREAM_RECORD,
+                           "@DEFAULT_MONITOR@", stream_name, &spec,
+                           nullptr, &attr, &error);
+
+    if (stream == nullptr) {
+      // Fallback to default source (microphone) if monitor is unavailable.
+      stream = pa_simple_new(nullptr, "Voxa", PA_STREAM_RECORD, nullptr,
+                             "Default Capture", &spec, nullptr, &attr, &error);
+    }
   }
 
   if (stream == nullptr) {
@@ -134,277 +110,16 @@ size_t CalculateChunkSize(int sample_rate, int channels, int bits_per_sample,
   return chunk_size;
 }
 
-void ApplyGainBoostAndConvertToMono(const int16_t* input, int16_t* output,
-                                    size_t frame_count, int input_channels,
-                                    float gain_boost) {
-  const float max_value = 32767.0f;
-  const float min_value = -32768.0f;
-
-  if (input_channels == 1) {
-    // Mono: just apply gain boost
-    for (size_t i = 0; i < frame_count; ++i) {
-      float sample = static_cast<float>(input[i]) * gain_boost;
-      sample = std::max(min_value, std::min(max_value, sample));
-      output[i] = static_cast<int16_t>(sample);
-    }
-  } else {
-    // Stereo: convert to mono and apply gain boost
-    for (size_t i = 0; i < frame_count; ++i) {
-      float left = static_cast<float>(input[i * 2]);
-      float right = static_cast<float>(input[i * 2 + 1]);
-      float mono = (left + right) / 2.0f * gain_boost;
-      mono = std::max(min_value, std::min(max_value, mono));
-      output[i] = static_cast<int16_t>(mono);
-    }
-  }
-}
-
-double CalculateDecibel(const int16_t* samples, size_t sample_count) {
-  if (sample_count == 0) {
-    return -120.0;
-  }
-
-  // Calculate RMS (Root Mean Square)
-  double sum_of_squares = 0.0;
-  for (size_t i = 0; i < sample_count; ++i) {
-    double value = static_cast<double>(samples[i]);
-    sum_of_squares += value * value;
-  }
-  double mean_square = sum_of_squares / static_cast<double>(sample_count);
-  double rms = sqrt(mean_square);
-
-  // Calculate decibel: dB = 20 * log10(RMS / max_value)
-  // For Int16, max_value is 32767.0
-  const double max_value = 32767.0;
-  if (rms <= 0.0) {
-    return -120.0;  // Avoid log(0)
-  }
-
-  double decibel = 20.0 * log10(rms / max_value);
-
-  // Clamp to reasonable range (-120 dB to 0 dB)
-  return std::max(-120.0, std::min(0.0, decibel));
-}
-
-gboolean EmitAudioOnMainThread(gpointer user_data) {
-  std::unique_ptr<AudioChunkPayload> payload(
-      static_cast<AudioChunkPayload*>(user_data));
-  AudioCapturePlugin* plugin = payload->plugin;
-
-  gsize length = 0;
-  const guint8* data =
-      static_cast<const guint8*>(g_bytes_get_data(payload->bytes, &length));
-
-  g_mutex_lock(&plugin->lock);
-  const gboolean can_emit =
-      plugin->event_channel != nullptr && plugin->has_listener;
-  const gboolean can_emit_decibel =
-      plugin->decibel_event_channel != nullptr && plugin->has_decibel_listener;
-  g_mutex_unlock(&plugin->lock);
-
-  if (can_emit && length > 0) {
-    g_autoptr(FlValue) value = fl_value_new_uint8_list(data, length);
-    g_autoptr(GError) error = nullptr;
-    
-    if (!fl_event_channel_send(plugin->event_channel, value, nullptr, &error)) {
-      g_warning("Failed to send audio chunk: %s",
-                error != nullptr ? error->message : "unknown error");
-    }
-  }
-
-  // Send decibel data
-  if (can_emit_decibel) {
-    g_autoptr(FlValue) decibel_map = fl_value_new_map();
-    fl_value_set_string_take(decibel_map, "decibel", fl_value_new_float(payload->decibel));
-    fl_value_set_string_take(decibel_map, "timestamp", fl_value_new_float(g_get_real_time() / 1000000.0));
-    
-    g_autoptr(GError) error = nullptr;
-    if (!fl_event_channel_send(plugin->decibel_event_channel, decibel_map, nullptr, &error)) {
-      g_warning("Failed to send decibel data: %s",
-                error != nullptr ? error->message : "unknown error");
-    }
-  }
-
-  g_bytes_unref(payload->bytes);
-  g_object_unref(plugin);
-
-  return G_SOURCE_REMOVE;
-}
-
-gpointer CaptureThread(gpointer user_data) {
-  std::unique_ptr<CaptureThreadContext> context(
-      static_cast<CaptureThreadContext*>(user_data));
-  AudioCapturePlugin* plugin = context->plugin;
-
-  // Read raw audio from PulseAudio
-  std::vector<uint8_t> raw_buffer(context->chunk_size);
-
-  // Output buffer for processed audio (mono)
-  const size_t output_frame_count = context->chunk_size / (sizeof(int16_t) * context->channels);
-  std::vector<int16_t> output_buffer(output_frame_count);
-
-  while (!g_atomic_int_get(&plugin->should_stop)) {
-    int error = 0;
-    if (pa_simple_read(context->stream, raw_buffer.data(), raw_buffer.size(),
-                       &error) < 0) {
-      g_warning("PulseAudio read error: %s", pa_strerror(error));
-      break;
-    }
-
-    if (g_atomic_int_get(&plugin->should_stop)) {
-      break;
-    }
-
-    // Apply input volume
-    if (context->input_volume < 1.0f) {
-      int16_t* samples = reinterpret_cast<int16_t*>(raw_buffer.data());
-      const size_t sample_count = raw_buffer.size() / sizeof(int16_t);
-      for (size_t i = 0; i < sample_count; ++i) {
-        samples[i] = static_cast<int16_t>(
-            static_cast<float>(samples[i]) * context->input_volume);
-      }
-    }
-
-    // Process audio: convert to mono and apply gain boost
-    const int16_t* input_samples =
-        reinterpret_cast<const int16_t*>(raw_buffer.data());
-    const size_t input_frame_count =
-        raw_buffer.size() / (sizeof(int16_t) * context->channels);
-    const size_t frames_to_process =
-        std::min(input_frame_count, output_frame_count);
-
-    // Always process to ensure mono output and gain boost application
-    ApplyGainBoostAndConvertToMono(input_samples, output_buffer.data(),
-                                    frames_to_process, context->channels,
-                                    context->gain_boost);
-
-    // Create output bytes (mono)
-    const size_t output_bytes = frames_to_process * sizeof(int16_t);
-    
-    // Calculate decibel from output buffer
-    double decibel = CalculateDecibel(output_buffer.data(), frames_to_process);
-    
-    GBytes* bytes = g_bytes_new(output_buffer.data(), output_bytes);
-    auto* payload = new AudioChunkPayload(plugin, bytes, decibel);
-    g_object_ref(plugin);
-    g_main_context_invoke_full(plugin->main_context, G_PRIORITY_DEFAULT,
-                               EmitAudioOnMainThread, payload, nullptr);
-  }
-
-  pa_simple_free(context->stream);
-
-  g_mutex_lock(&plugin->lock);
-  plugin->is_capturing = FALSE;
-  plugin->capture_thread = nullptr;
-  g_mutex_unlock(&plugin->lock);
-
-  // Send status update
-  g_mutex_lock(&plugin->lock);
-  const gboolean has_status_listener = plugin->has_status_listener;
-  g_mutex_unlock(&plugin->lock);
-  
-  if (has_status_listener && plugin->status_event_channel != nullptr) {
-    g_autoptr(FlValue) status_map = fl_value_new_map();
-    fl_value_set_string_take(status_map, "isActive", fl_value_new_bool(FALSE));
-    fl_value_set_string_take(status_map, "timestamp", fl_value_new_float(g_get_real_time() / 1000000.0));
-    
-    g_autoptr(GError) error = nullptr;
-    fl_event_channel_send(plugin->status_event_channel, status_map, nullptr, &error);
-  }
-
-  g_object_unref(plugin);
-  return nullptr;
-}
-
-static FlMethodErrorResponse* OnListenHandler(FlEventChannel* channel, 
-                                              FlValue* arguments, 
-                                              gpointer user_data) {
-  AudioCapturePlugin* plugin = AUDIO_CAPTURE_PLUGIN(user_data);
-  (void)channel;
-  (void)arguments;
-  g_mutex_lock(&plugin->lock);
-  plugin->has_listener = TRUE;
-  g_mutex_unlock(&plugin->lock);
-  return nullptr;
-}
-
-static FlMethodErrorResponse* OnCancelHandler(FlEventChannel* channel, 
-                                              FlValue* arguments,
-                                              gpointer user_data) {
-  AudioCapturePlugin* plugin = AUDIO_CAPTURE_PLUGIN(user_data);
-  (void)channel;
-  (void)arguments;
-  g_mutex_lock(&plugin->lock);
-  plugin->has_listener = FALSE;
-  g_mutex_unlock(&plugin->lock);
-  return nullptr;
-}
-
-static FlMethodErrorResponse* OnStatusListenHandler(FlEventChannel* channel,
-                                                     FlValue* arguments,
-                                                     gpointer user_data) {
-  AudioCapturePlugin* plugin = AUDIO_CAPTURE_PLUGIN(user_data);
-  (void)channel;
-  (void)arguments;
-  g_mutex_lock(&plugin->lock);
-  plugin->has_status_listener = TRUE;
-  const gboolean is_active = plugin->is_capturing;
-  g_mutex_unlock(&plugin->lock);
-
-  // Send current status immediately
-  g_autoptr(FlValue) status_map = fl_value_new_map();
-  fl_value_set_string_take(status_map, "isActive", fl_value_new_bool(is_active));
-  fl_value_set_string_take(status_map, "timestamp", fl_value_new_float(g_get_real_time() / 1000000.0));
-  
-  g_autoptr(GError) error = nullptr;
-  fl_event_channel_send(plugin->status_event_channel, status_map, nullptr, &error);
-  
-  return nullptr;
-}
-
-static FlMethodErrorResponse* OnStatusCancelHandler(FlEventChannel* channel,
-                                                    FlValue* arguments,
-                                                    gpointer user_data) {
-  AudioCapturePlugin* plugin = AUDIO_CAPTURE_PLUGIN(user_data);
-  (void)channel;
-  (void)arguments;
-  g_mutex_lock(&plugin->lock);
-  plugin->has_status_listener = FALSE;
-  g_mutex_unlock(&plugin->lock);
-  return nullptr;
-}
-
-static FlMethodErrorResponse* OnDecibelListenHandler(FlEventChannel* channel,
-                                                      FlValue* arguments,
-                                                      gpointer user_data) {
-  AudioCapturePlugin* plugin = AUDIO_CAPTURE_PLUGIN(user_data);
-  (void)channel;
-  (void)arguments;
-  g_mutex_lock(&plugin->lock);
-  plugin->has_decibel_listener = TRUE;
-  g_mutex_unlock(&plugin->lock);
-  return nullptr;
-}
-
-static FlMethodErrorResponse* OnDecibelCancelHandler(FlEventChannel* channel,
-                                                      FlValue* arguments,
-                                                      gpointer user_data) {
-  AudioCapturePlugin* plugin = AUDIO_CAPTURE_PLUGIN(user_data);
-  (void)channel;
-  (void)arguments;
-  g_mutex_lock(&plugin->lock);
-  plugin->has_decibel_listener = FALSE;
-  g_mutex_unlock(&plugin->lock);
-  return nullptr;
-}
-
-bool StartCapture(AudioCapturePlugin* plugin, FlValue* args) {
+// Returns the new session id, or 0 if capture could not be started.
+guint StartCapture(AudioCapturePlugin* plugin, FlValue* args) {
   int sample_rate = kDefaultSampleRate;
   int channels = kDefaultChannels;
   int bits_per_sample = kDefaultBitsPerSample;
   int chunk_duration_ms = kDefaultChunkDurationMs;
   float gain_boost = kDefaultGainBoost;
   float input_volume = kDefaultInputVolume;
+  bool fill_gaps = false;
+  std::string device_id;
 
   if (args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP) {
     FlValue* value = nullptr;
@@ -440,10 +155,22 @@ bool StartCapture(AudioCapturePlugin* plugin, FlValue* args) {
       input_volume = fl_value_get_float(value);
       input_volume = std::max(0.0f, std::min(1.0f, input_volume));
     }
+
+    value = fl_value_lookup_string(args, "deviceId");
+    if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_STRING) {
+      device_id = fl_value_get_string(value);
+    }
+
+    value = fl_value_lookup_string(args, "fillGaps");
+    if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_BOOL) {
+      fill_gaps = fl_value_get_bool(value);
+    }
   }
 
   sample_rate = std::max(sample_rate, 8000);
   channels = std::max(1, std::min(channels, 2));
+  static_assert(2 <= audio_capture::BiquadChain::kMaxChannels,
+                "filters must run on every channel allowed");
   bits_per_sample = 16;
   chunk_duration_ms = std::max(chunk_duration_ms, 10);
   gain_boost = std::max(0.1f, std::min(10.0f, gain_boost));
@@ -453,103 +180,239 @@ bool StartCapture(AudioCapturePlugin* plugin, FlValue* args) {
       CalculateChunkSize(sample_rate, channels, bits_per_sample,
                          chunk_duration_ms);
 
+  audio_capture::CaptureSessionConfig config;
+  config.sample_rate = sample_rate;
+  config.channels = channels;
+  config.bits_per_sample = bits_per_sample;
+  config.chunk_size = chunk_size;
+  config.gain_boost = gain_boost;
+  config.input_volume = input_volume;
+  audio_capture::ParseFilterArgs(args, &config);
+  audio_capture::ParseNoiseArgs(args, &config);
+  audio_capture::ParseGainArgs(args, &config);
+  audio_capture::ParseCompressorArgs(args, &config);
+  audio_capture::ParseSchedulingArgs(args, &config);
+  audio_capture::ParseResampleArgs(args, &config);
+  audio_capture::ParseMeterArgs(args, &config);
+  audio_capture::ParseVoiceArgs(args, &config);
+  audio_capture::ParseFeatureArgs(args, &config);
+  audio_capture::ParseSpectrumArgs(args, &config);
+  audio_capture::ParseWaveformArgs(args, &config);
+  config.fill_gaps = fill_gaps;
+  config.capture_format = audio_capture::ResolveCaptureFormat(
+      config, device_id.empty() ? "@DEFAULT_MONITOR@" : device_id);
+
   pa_simple* stream = nullptr;
   std::string error_message;
 
-  if (!OpenPulseStream(sample_rate, channels, bits_per_sample, chunk_size,
+  if (!OpenPulseStream(device_id, "System Capture", config.capture_format,
+                       channels,
+                       audio_capture::CaptureChunkSize(config,
+                                                       config.capture_format),
                        &stream, &error_message)) {
     g_warning("Failed to open PulseAudio stream: %s", error_message.c_str());
-    return false;
+    return 0;
   }
 
-  g_mutex_lock(&plugin->lock);
-  if (plugin->is_capturing) {
-    g_mutex_unlock(&plugin->lock);
-    pa_simple_free(stream);
-    return false;
-  }
+  return audio_capture::CaptureSessionStart(&plugin->host, stream, config,
+                                            std::string());
+}
 
-  g_atomic_int_set(&plugin->should_stop, 0);
-  plugin->is_capturing = TRUE;
-
-  auto* context = new CaptureThreadContext{
-      plugin,
-      stream,
-      chunk_size,
-      sample_rate,
-      channels,
-      bits_per_sample,
-      gain_boost,
-      input_volume,
-  };
-
-  g_object_ref(plugin);
-  plugin->capture_thread = g_thread_new("voxa-audio-capture", CaptureThread,
-                                        context);
-  g_mutex_unlock(&plugin->lock);
-
-  if (plugin->capture_thread == nullptr) {
-    g_warning("Failed to create capture thread");
-    g_mutex_lock(&plugin->lock);
-    plugin->is_capturing = FALSE;
-    g_mutex_unlock(&plugin->lock);
-    pa_simple_free(stream);
-    g_object_unref(plugin);
-    delete context;
-    return false;
+// Starts a session capturing the microphone and the system monitor on one
+// timeline. Returns the new session id, or 0.
+guint StartSyncedCapture(AudioCapturePlugin* plugin, FlValue* args) {
+  int sample_rate = kDefaultSampleRate;
+  int channels = kDefaultChannels;
+  int chunk_duration_ms = kDefaultChunkDurationMs;
+  float input_volume = kDefaultInputVolume;
+  float mic_gain = kDefaultTrackGain;
+  float system_gain = kDefaultTrackGain;
+  std::string mic_device_id;
+  std::string system_device_id;
+  audio_capture::SyncedOutputMode mode =
+      audio_capture::SyncedOutputMode::kInterleaved;
+  bool estimate_delay = false;
+  audio_capture::DelayOptions delay_options;
+
+  if (args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP) {
+    FlValue* value = nullptr;
+
+    value = fl_value_lookup_string(args, "sampleRate");
+    if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_INT) {
+      sample_rate = fl_value_get_int(value);
+    }
+
+    value = fl_value_lookup_string(args, "channels");
+    if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_INT) {
+      channels = fl_value_get_int(value);
+    }
+
+    value = fl_value_lookup_string(args, "chunkDurationMs");
+    if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_INT) {
+      chunk_duration_ms = fl_value_get_int(value);
+    }
+
+    value = fl_value_lookup_string(args, "inputVolume");
+    if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_FLOAT) {
+      input_volume = fl_value_get_float(value);
+    }
+
+    value = fl_value_lookup_string(args, "micGain");
+    if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_FLOAT) {
+      mic_gain = fl_value_get_float(value);
+    }
+
+    value = fl_value_lookup_string(args, "systemGain");
+    if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_FLOAT) {
+      system_gain = fl_value_get_float(value);
+    }
+
+    value = fl_value_lookup_string(args, "micDeviceId");
+    if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_STRING) {
+      mic_device_id = fl_value_get_string(value);
+    }
+
+    value = fl_value_lookup_string(args, "systemDeviceId");
+    if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_STRING) {
+      system_device_id = fl_value_get_string(value);
+    }
+
+    value = fl_value_lookup_string(args, "outputMode");
+    if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_STRING) {
+      const gchar* name = fl_value_get_string(value);
+      if (strcmp(name, "mixed") == 0) {
+        mode = audio_capture::SyncedOutputMode::kMixed;
+      } else if (strcmp(name, "echoCancelled") == 0) {
+        mode = audio_capture::SyncedOutputMode::kEchoCancelled;
+      }
+    }
+
+    value = fl_value_lookup_string(args, "estimateDelay");
+    if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_BOOL) {
+      estimate_delay = fl_value_get_bool(value);
+    }
+
+    value = fl_value_lookup_string(args, "delayIntervalMs");
+    if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_INT) {
+      delay_options.interval_ms = static_cast<int>(
+          std::max(kMinDelayIntervalMs,
+                   std::min<int64_t>(fl_value_get_int(value),
+                                     kMaxDelayIntervalMs)));
+    }
   }
 
-  // Send status update
-  g_mutex_lock(&plugin->lock);
-  const gboolean has_status_listener = plugin->has_status_listener;
-  g_mutex_unlock(&plugin->lock);
-  
-  if (has_status_listener && plugin->status_event_channel != nullptr) {
-    g_autoptr(FlValue) status_map = fl_value_new_map();
-    fl_value_set_string_take(status_map, "isActive", fl_value_new_bool(TRUE));
-    fl_value_set_string_take(status_map, "timestamp", fl_value_new_float(g_get_real_time() / 1000000.0));
-    
-    g_autoptr(GError) error = nullptr;
-    fl_event_channel_send(plugin->status_event_channel, status_map, nullptr, &error);
+  sample_rate = std::max(sample_rate, 8000);
+  channels = std::max(1, std::min(channels, 2));
+  chunk_duration_ms = std::max(chunk_duration_ms, 10);
+  input_volume = std::max(0.0f, std::min(1.0f, input_volume));
+  mic_gain = std::max(0.0f, std::min(10.0f, mic_gain));
+  system_gain = std::max(0.0f, std::min(10.0f, system_gain));
+
+  // Both tracks always name their source explicitly, so a missing monitor
+  // fails instead of falling back to the microphone twice.
+  if (mic_device_id.empty() || mic_device_id == "default") {
+    mic_device_id = "@DEFAULT_SOURCE@";
+  }
+  if (system_device_id.empty()) {
+    system_device_id = "@DEFAULT_MONITOR@";
   }
 
-  return true;
-}
+  const int bits_per_sample = 16;
+  const size_t chunk_size = CalculateChunkSize(
+      sample_rate, channels, bits_per_sample, chunk_duration_ms);
+
+  audio_capture::CaptureSessionConfig config;
+  config.sample_rate = sample_rate;
+  config.channels = channels;
+  config.bits_per_sample = bits_per_sample;
+  config.chunk_size = chunk_size;
+  config.gain_boost = 1.0f;
+  config.input_volume = input_volume;
+  audio_capture::ParseSchedulingArgs(args, &config);
+  audio_capture::ParseResampleArgs(args, &config);
+  audio_capture::ParseCompressorArgs(args, &config);  // On every track.
+  config.fill_gaps = true;  // Required to keep the tracks aligned.
+  config.read_size = chunk_size;
+  config.meter_only = false;  // Synced sessions always deliver both tracks.
+  config.meter_rate_hz = 0;   // And one level per chunk.
+  config.meter_options = audio_capture::MeterOptions();
+  config.loudness = false;
+  audio_capture::ParseFilterArgs(nullptr, &config);  // No filters.
+  audio_capture::ParseNoiseArgs(nullptr, &config);  // No noise suppression.
+  audio_capture::ParseGainArgs(nullptr, &config);  // Track gains instead.
+  audio_capture::ParseVoiceArgs(nullptr, &config);  // No voice detection.
+  audio_capture::ParseFeatureArgs(nullptr, &config);  // Nor features.
+  audio_capture::ParseSpectrumArgs(nullptr, &config);  // Nor a spectrum.
+  audio_capture::ParseWaveformArgs(nullptr, &config);  // Nor a waveform.
+
+  // Each track may run at its own native rate and format; both are
+  // converted to S16 at |sample_rate| before they are aligned.
+  audio_capture::SyncedCaptureConfig synced_config;
+  synced_config.mode = mode;
+  synced_config.mic_gain = mic_gain;
+  synced_config.system_gain = system_gain;
+  synced_config.estimate_delay = estimate_delay;
+  synced_config.delay_options = delay_options;
+  config.capture_format =
+      audio_capture::ResolveCaptureFormat(config, mic_device_id);
+  synced_config.system_capture_format =
+      audio_capture::ResolveCaptureFormat(config, system_device_id);
+
+  pa_simple* mic_stream = nullptr;
+  pa_simple* system_stream = nullptr;
+  std::string error_message;
 
-bool StopCapture(AudioCapturePlugin* plugin) {
-  g_mutex_lock(&plugin->lock);
-  if (!plugin->is_capturing) {
-    g_mutex_unlock(&plugin->lock);
-    return false;
+  if (!OpenPulseStream(mic_device_id, "Mic Capture", config.capture_format,
+                       channels,
+                       audio_capture::CaptureChunkSize(config,
+                                                       config.capture_format),
+                       &mic_stream, &error_message)) {
+    g_warning("Failed to open microphone stream: %s", error_message.c_str());
+    return 0;
   }
-  g_atomic_int_set(&plugin->should_stop, 1);
-  GThread* thread = plugin->capture_thread;
-  g_mutex_unlock(&plugin->lock);
 
-  if (thread != nullptr) {
-    g_thread_join(thread);
+  if (!OpenPulseStream(system_device_id, "System Capture",
+                       synced_config.system_capture_format, channels,
+                       audio_capture::CaptureChunkSize(
+                           config, synced_config.system_capture_format),
+                       &system_stream, &error_message)) {
+    g_warning("Failed to open system audio stream: %s",
+              error_message.c_str());
+    pa_simple_free(mic_stream);
+    return 0;
   }
 
-  g_mutex_lock(&plugin->lock);
-  plugin->capture_thread = nullptr;
-  plugin->is_capturing = FALSE;
-  const gboolean has_status_listener = plugin->has_status_listener;
-  g_mutex_unlock(&plugin->lock);
-
-  // Wait a bit to ensure thread has fully stopped
-  g_usleep(100000);  // 0.1 seconds
-
-  // Send status update
-  if (has_status_listener && plugin->status_event_channel != nullptr) {
-    g_autoptr(FlValue) status_map = fl_value_new_map();
-    fl_value_set_string_take(status_map, "isActive", fl_value_new_bool(FALSE));
-    fl_value_set_string_take(status_map, "timestamp", fl_value_new_float(g_get_real_time() / 1000000.0));
-    
-    g_autoptr(GError) error = nullptr;
-    fl_event_channel_send(plugin->status_event_channel, status_map, nullptr, &error);
+  return audio_capture::CaptureSessionStartSynced(
+      &plugin->host, mic_stream, system_stream, config, synced_config);
+}
+
+// Returns the counters of the session named by the "sessionId" argument, or
+// null if it is not running.
+FlValue* GetCaptureStats(AudioCapturePlugin* plugin, FlValue* args) {
+  if (args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP) {
+    FlValue* value = fl_value_lookup_string(args, "sessionId");
+    if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_INT) {
+      FlValue* stats = audio_capture::CaptureSessionGetStats(
+          &plugin->host, static_cast<guint>(fl_value_get_int(value)));
+      if (stats != nullptr) {
+        return stats;
+      }
+    }
   }
+  return fl_value_new_null();
+}
 
-  return true;
+// Stops the session named by the "sessionId" argument, or every session of
+// the plugin when no id is given.
+bool StopCapture(AudioCapturePlugin* plugin, FlValue* args) {
+  if (args != nullptr && fl_value_get_type(args) == FL_VALUE_TYPE_MAP) {
+    FlValue* value = fl_value_lookup_string(args, "sessionId");
+    if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_INT) {
+      return audio_capture::CaptureSessionStop(
+          &plugin->host, static_cast<guint>(fl_value_get_int(value)));
+    }
+  }
+  return audio_capture::CaptureHostStopAllSessions(&plugin->host);
 }
 
 void HandleMethodCall(AudioCapturePlugin* plugin, FlMethodCall* method_call) {
@@ -561,11 +424,25 @@ void HandleMethodCall(AudioCapturePlugin* plugin, FlMethodCall* method_call) {
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
   } else if (strcmp(method, "startCapture") == 0) {
     FlValue* args = fl_method_call_get_args(method_call);
-    const bool started = StartCapture(plugin, args);
-    g_autoptr(FlValue) result = fl_value_new_bool(started);
+    const guint session_id = StartCapture(plugin, args);
+    g_autoptr(FlValue) result = session_id != 0
+                                    ? fl_value_new_int(session_id)
+                                    : fl_value_new_bool(FALSE);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (strcmp(method, "startSyncedCapture") == 0) {
+    FlValue* args = fl_method_call_get_args(method_call);
+    const guint session_id = StartSyncedCapture(plugin, args);
+    g_autoptr(FlValue) result = session_id != 0
+                                    ? fl_value_new_int(session_id)
+                                    : fl_value_new_bool(FALSE);
+    response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
+  } else if (strcmp(method, "getCaptureStats") == 0) {
+    FlValue* args = fl_method_call_get_args(method_call);
+    g_autoptr(FlValue) result = GetCaptureStats(plugin, args);
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
   } else if (strcmp(method, "stopCapture") == 0) {
-    const bool stopped = StopCapture(plugin);
+    FlValue* args = fl_method_call_get_args(method_call);
+    const bool stopped = StopCapture(plugin, args);
     g_autoptr(FlValue) result = fl_value_new_bool(stopped);
     response = FL_METHOD_RESPONSE(fl_method_success_response_new(result));
   } else {
@@ -590,30 +467,11 @@ static void MethodCallHandler(FlMethodChannel* channel,
 static void audio_capture_plugin_dispose(GObject* object) {
   AudioCapturePlugin* plugin = AUDIO_CAPTURE_PLUGIN(object);
 
-  StopCapture(plugin);
-
   if (plugin->method_channel != nullptr) {
     g_clear_object(&plugin->method_channel);
   }
 
-  if (plugin->event_channel != nullptr) {
-    g_clear_object(&plugin->event_channel);
-  }
-
-  if (plugin->status_event_channel != nullptr) {
-    g_clear_object(&plugin->status_event_channel);
-  }
-
-  if (plugin->decibel_event_channel != nullptr) {
-    g_clear_object(&plugin->decibel_event_channel);
-  }
-
-  if (plugin->main_context != nullptr) {
-    g_main_context_unref(plugin->main_context);
-    plugin->main_context = nullptr;
-  }
-
-  g_mutex_clear(&plugin->lock);
+  audio_capture::CaptureHostDispose(&plugin->host);
 
   G_OBJECT_CLASS(audio_capture_plugin_parent_class)->dispose(object);
 }
@@ -624,18 +482,9 @@ static void audio_capture_plugin_class_init(AudioCapturePluginClass* klass) {
 }
 
 static void audio_capture_plugin_init(AudioCapturePlugin* plugin) {
-  g_mutex_init(&plugin->lock);
-  plugin->main_context = g_main_context_ref_thread_default();
-  plugin->is_capturing = FALSE;
-  plugin->has_listener = FALSE;
-  plugin->has_status_listener = FALSE;
-  plugin->has_decibel_listener = FALSE;
   plugin->method_channel = nullptr;
-  plugin->event_channel = nullptr;
-  plugin->status_event_channel = nullptr;
-  plugin->decibel_event_channel = nullptr;
-  plugin->capture_thread = nullptr;
-  g_atomic_int_set(&plugin->should_stop, 0);
+  audio_capture::CaptureHostInit(&plugin->host, G_OBJECT(plugin),
+                                 kCaptureThreadName);
 }
 
 void audio_capture_plugin_register_with_registrar(FlPluginRegistrar* registrar) {
@@ -657,36 +506,10 @@ void audio_capture_plugin_register_with_messenger(FlBinaryMessenger* messenger)
       plugin->method_channel, MethodCallHandler, g_object_ref(plugin),
       g_object_unref);
 
-  plugin->event_channel = fl_event_channel_new(
-      messenger, kEventChannelName, FL_METHOD_CODEC(codec));
-  
-  // Use the newer API with proper function signatures
-  fl_event_channel_set_stream_handlers(
-      plugin->event_channel, 
-      OnListenHandler, 
-      OnCancelHandler,
-      g_object_ref(plugin), 
-      g_object_unref);
-
-  // Register status event channel
-  plugin->status_event_channel = fl_event_channel_new(
-      messenger, kStatusEventChannelName, FL_METHOD_CODEC(codec));
-  fl_event_channel_set_stream_handlers(
-      plugin->status_event_channel,
-      OnStatusListenHandler,
-      OnStatusCancelHandler,
-      g_object_ref(plugin),
-      g_object_unref);
-
-  // Register decibel event channel
-  plugin->decibel_event_channel = fl_event_channel_new(
-      messenger, kDecibelEventChannelName, FL_METHOD_CODEC(codec));
-  fl_event_channel_set_stream_handlers(
-      plugin->decibel_event_channel,
-      OnDecibelListenHandler,
-      OnDecibelCancelHandler,
-      g_object_ref(plugin),
-      g_object_unref);
+  // Register the audio, status, decibel and events channels
+  audio_capture::CaptureHostRegisterChannels(
+      &plugin->host, messenger, kEventChannelName, kStatusEventChannelName,
+      kDecibelEventChannelName, kEventsChannelName);
 
   g_object_unref(plugin);
 }
@@ -0,0 +1,3954 @@
+#include "capture_session.h"
+
+#include <pulse/error.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "buffer_pool.h"
+#include "echo_canceller.h"
+#include "level_meter.h"
+#include "realtime_thread.h"
+#include "resampler.h"
+#include "sample_format.h"
+#include "source_info.h"
+#include "spsc_queue.h"
+
+namespace audio_capture {
+
+namespace {
+
+// Chunks of one source waiting for the processing worker. When the ready
+// queue is full the reader drops the chunk it just read.
+constexpr size_t kMaxPendingChunks = 16;
+
+// Released chunks kept for reuse per source: enough for a full ready queue
+// plus the ones being read and processed.
+constexpr size_t kChunkPoolSize = 32;
+
+// Processed chunks of one session that may wait for the main loop. Their
+// buffers are allocated when the session starts; with all of them waiting,
+// the worker drops the newest chunk.
+constexpr size_t kEmitPoolSize = 64;
+
+constexpr int kDefaultRealtimePriority = 10;
+
+// Meter-only sessions read at least this much audio at once, and send
+// levels at the configured rate, within these bounds.
+constexpr int kMeterFragmentMs = 100;
+constexpr int kDefaultMeterRateHz = 30;
+constexpr int kMaxMeterRateHz = 120;
+// Longest meter window, ballistics or hold time accepted.
+constexpr int kMaxMeterTimeMs = 60000;
+// Longest voice hangover and speech-only pre-roll accepted.
+constexpr int kMaxVoiceHangoverMs = 10000;
+constexpr int kMaxVoicePreRollMs = 2000;
+// Bounds of the gain control options.
+constexpr int kMaxAgcTimeMs = 60000;
+constexpr int kMaxAgcLookaheadMs = 50;
+constexpr double kMaxAgcGainDb = 60.0;
+// Bounds of the compressor options.
+constexpr int kMaxCompressorTimeMs = 5000;
+constexpr double kMaxCompressorRatio = 20.0;
+constexpr double kMaxCompressorKneeDb = 24.0;
+// Most stages of a filter chain, and the bounds of their options.
+constexpr size_t kMaxFilters = 8;
+constexpr double kMinFilterHz = 1.0;
+constexpr double kMaxFilterHz = 96000.0;
+constexpr double kMinFilterQ = 0.1;
+constexpr double kMaxFilterQ = 100.0;
+constexpr double kMaxFilterGainDb = 24.0;
+// Bounds of the longest utterance of a segmenting session.
+constexpr int kMinUtteranceMs = 1000;
+constexpr int kMaxUtteranceMs = 60000;
+// Bounds of the log-mel feature options.
+constexpr int kMaxMelBins = 256;
+constexpr int kMaxMelWindowMs = 100;
+// Bounds of the spectrum analyzer options.
+constexpr int kMaxSpectrumFftSize = 16384;
+constexpr int kMaxSpectrumBands = 512;
+constexpr int kDefaultSpectrumRateHz = 30;
+constexpr int kMaxSpectrumRateHz = 120;
+// Finest waveform buckets accepted, per second.
+constexpr int kMaxWaveformBucketRateHz = 4000;
+
+// Upper bounds of the scheduling jitter histogram buckets, in microseconds.
+// The last bucket counts everything above.
+constexpr gint64 kJitterBucketBoundsUs[] = {1000, 2000, 5000, 10000, 20000,
+                                            50000};
+constexpr int kJitterBuckets = G_N_ELEMENTS(kJitterBucketBoundsUs) + 1;
+
+// Sources of one session: the single stream, or microphone and system audio.
+constexpr int kMaxSources = 2;
+constexpr int kMicSource = 0;
+constexpr int kSystemSource = 1;
+
+// How far one synced track may run ahead of the other before the lagging
+// one is treated as stalled.
+constexpr int kMaxSyncBacklogMs = 2000;
+
+// A capture time estimate this far past the sample counter means the server
+// dropped audio; smaller offsets are latency jitter. At least half a chunk.
+constexpr gint64 kMinOverflowUs = 20000;
+
+// Longest gap a single-source session fills with silence. Longer gaps are
+// reported but not filled, so one chunk never grows without bound.
+constexpr int kMaxGapFillMs = 10000;
+
+// What the listeners of a session consume, as bits. Processing skips work
+// for outputs nobody listens to.
+constexpr gint kConsumePcm = 1 << 0;
+constexpr gint kConsumeDecibel = 1 << 1;
+constexpr gint kConsumeFeatures = 1 << 2;
+constexpr gint kConsumeSpectrum = 1 << 3;
+constexpr gint kConsumeWaveform = 1 << 4;
+// Outputs computed from the processed samples rather than carrying them.
+constexpr gint kConsumeAnalysis =
+    kConsumeFeatures | kConsumeSpectrum | kConsumeWaveform;
+
+// Causes of an overrun event.
+constexpr char kCauseServerOverflow[] = "serverOverflow";
+constexpr char kCauseQueueDrop[] = "queueDrop";
+
+struct AudioChunkPayload;
+struct CaptureSession;
+struct RawChunk;
+
+// One PulseAudio stream of a session and the thread reading it.
+struct CaptureSource {
+  CaptureSession* session;
+  int index;
+  pa_simple* stream;
+
+  // The reader hands chunks to the session's processing worker through
+  // |ready_chunks| and gets them back through |free_chunks|. The reader is
+  // the only producer of one and consumer of the other, and the worker of
+  // the session the reverse, so neither side takes a lock.
+  std::unique_ptr<SpscQueue<RawChunk*>> ready_chunks;
+  std::unique_ptr<SpscQueue<RawChunk*>> free_chunks;
+  GThread* reader_thread;
+  int capture_rate;            // Rate the stream was opened at.
+  SampleFormat sample_format;  // Format the stream was opened in.
+  size_t capture_chunk_size;   // Bytes per read.
+
+  // Synced sessions only. Used by the worker processing the session.
+  gint64 first_frame_time;       // Monotonic capture time of frame 0.
+  std::vector<int16_t> frames;   // Mono frames not yet emitted.
+  size_t frames_owed;            // Silence inserted for a stall.
+
+  // Used by the worker processing the session.
+  guint64 next_frame_position;   // Expected position of the next chunk.
+
+  // Converts from |capture_rate| to the session rate; null if they match.
+  // Used by the worker processing the session.
+  std::unique_ptr<Resampler> resampler;
+  guint64 resample_next;      // Capture-rate position of the next chunk.
+  guint64 resample_position;  // Session-rate position of the next output.
+
+  // Converts the samples read to S16, or to floats in |float_frames| when
+  // they are also resampled; null for S16 streams. |output_converter| takes
+  // the resampled floats to S16. Used by the worker processing the session.
+  std::unique_ptr<SampleConverter> input_converter;
+  std::unique_ptr<SampleConverter> output_converter;
+  std::vector<float> float_frames;
+};
+
+// Why an utterance emitted by a segmenting session ended.
+enum class UtteranceEnd {
+  kNone,         // Not an utterance.
+  kSilence,      // Speech ended.
+  kMaxDuration,  // It reached the longest utterance; speech goes on.
+  kGap,          // Audio was lost.
+};
+
+// Position of a chunk on its session's timeline.
+struct ChunkTiming {
+  guint64 sequence;        // Chunk index; a gap means chunks were lost.
+  guint64 frame_position;  // Index of the first frame since capture start.
+  gint64 capture_time;     // Monotonic capture time of the first frame.
+};
+
+// A chunk as read from one source. |data| points just past the header in the
+// same allocation, so a chunk is released with a single g_free.
+struct RawChunk {
+  int source;
+  ChunkTiming timing;
+  guint64 overflow_frames;  // Lost by the server just before this chunk.
+  size_t size;              // Bytes at |data|.
+  size_t frames;            // Frames at |data|; at the session rate once
+                            // converted, and timing with them.
+  gint64 conversion_us;     // Time spent converting format and rate.
+  gboolean locked;          // Locked into memory by a real-time session.
+  gint64 read_time;         // Monotonic time the read returned.
+  guint8* data;
+};
+
+// Counters reported by CaptureSessionGetStats.
+struct SessionStats {
+  guint64 chunks_captured;
+  guint64 dropped_chunks;  // Discarded from a full ready queue.
+  guint64 overruns;        // Overrun events reported.
+  guint64 lost_frames;
+  guint64 filled_frames;   // Silence inserted for lost frames.
+
+  // Deviation of the interval between two reads returning from the chunk
+  // duration: how irregularly the readers get to run.
+  guint64 jitter_samples;
+  gint64 jitter_total_us;
+  gint64 jitter_max_us;
+  guint64 jitter_histogram[kJitterBuckets];
+
+  gint realtime_readers;  // Readers granted real-time scheduling.
+  ThreadScheduling scheduling;
+
+  // Pipeline stages: reader -> ready queue -> processing worker -> main
+  // loop emission.
+  guint64 ready_high_water;   // Most chunks ever waiting for the worker.
+  gint64 ready_wait_max_us;   // Longest wait of a chunk for the worker.
+  guint64 processed_chunks;
+  gint64 processing_total_us;
+  gint64 processing_max_us;
+  guint64 emitted_chunks;
+  guint64 emit_dropped_chunks;  // No free emit buffer for them.
+  guint64 emit_high_water;    // Most emissions ever waiting for the loop.
+  gint64 emit_wait_total_us;
+  gint64 emit_wait_max_us;
+
+  // In-process conversion, for chunks read at another rate or format.
+  guint64 converted_chunks;
+  gint64 conversion_total_us;
+  gint64 conversion_max_us;
+
+  // Of sessions measuring loudness, as of the last chunk processed.
+  gboolean has_loudness;
+  LoudnessReading loudness;
+
+  // Of synced sessions estimating delay, as of the last estimate.
+  gboolean has_delay;
+  DelayEstimate delay;
+
+  // Of echo-cancelled synced sessions, as of the last block processed.
+  gboolean has_echo;
+  size_t echo_delay_frames;
+  double echo_erle_db;
+};
+
+struct CaptureSession {
+  gint ref_count;
+  guint id;
+  CaptureHost* host;
+  CaptureSessionConfig config;
+  std::string device_name;
+
+  CaptureSource sources[kMaxSources];
+  int source_count;
+  gint should_stop;
+  gboolean finished;  // Main thread only.
+
+  // Synced sessions only.
+  gboolean synced;
+  SyncedCaptureConfig synced_config;
+  gboolean aligned;  // Tracks share a timeline. Processing worker only.
+  gint64 timeline_origin;   // Capture time of output frame 0.
+  guint64 emitted_blocks;
+  guint64 emitted_frames;
+
+  // Set while a pool worker is scheduled to drain the ready queues.
+  gint processing_scheduled;
+
+  gint pending_emissions;  // Chunks handed to the main loop, not yet sent.
+
+  GMutex stats_lock;
+  SessionStats stats;
+
+  size_t chunk_capacity;  // Bytes per chunk buffer, read or converted.
+
+  // Processed chunks waiting for the main loop, in buffers of |emit_pool|.
+  // Queued by the processing worker and sent by |emit_source|.
+  std::unique_ptr<BufferPool> emit_pool;
+  std::unique_ptr<SpscQueue<AudioChunkPayload*>> emit_queue;
+  GSource* emit_source;
+
+  // Buffers a real-time session prefaulted and locked, besides its chunks,
+  // as (start, bytes); all unlocked when the session goes.
+  std::vector<std::pair<void*, size_t>> locked_regions;
+
+  // Used only by the pool worker currently processing this session.
+  std::vector<int16_t> output_buffer;
+  gint64 pending_conversion_us;  // Conversion time of a synced block so far.
+
+  // Sessions with a meter rate. |meter| and |meter_levels| are used by the
+  // processing worker. In meter-only sessions, levels queued beyond
+  // |max_meter_backlog| are dropped by the emit source, so a stalled main
+  // loop does not make the meter lag.
+  std::unique_ptr<LevelMeter> meter;
+  std::vector<MeterReading> meter_levels;
+  guint64 meter_sequence;
+  size_t max_meter_backlog;
+
+  // Sessions measuring loudness. Processing worker only; the latest reading
+  // is also copied to |stats|.
+  std::unique_ptr<LoudnessMeter> loudness;
+  LoudnessReading loudness_reading;
+
+  // Sessions with a filter chain. Processing worker only.
+  std::unique_ptr<BiquadChain> filters;
+
+  // Sessions suppressing noise. Processing worker only. Samples not
+  // following on from |denoise_next_position| restart its frames.
+  std::unique_ptr<NoiseSuppressor> denoiser;
+  guint64 denoise_next_position;
+
+  // Sessions with gain control. Processing worker only. Samples not
+  // following on from |agc_next_position| restart its look-ahead.
+  std::unique_ptr<AutomaticGainControl> agc;
+  guint64 agc_next_position;
+
+  // Sessions compressing their gained output, with the gained samples it
+  // takes; synced sessions gain their tracks there either way. Interleaved
+  // synced sessions compress the system track with |system_compressor|.
+  // Processing worker only.
+  std::unique_ptr<Compressor> compressor;
+  std::unique_ptr<Compressor> system_compressor;
+  std::vector<float> gained_buffer;
+
+  // Synced sessions estimating delay. Processing worker only. Blocks not
+  // following on from |delay_next_position| restart its windows.
+  std::unique_ptr<DelayEstimator> delay;
+  guint64 delay_next_position;
+
+  // Echo-cancelled synced sessions. Processing worker only. Blocks not
+  // following on from |echo_next_position| restart its blocks.
+  std::unique_ptr<EchoCanceller> echo;
+  guint64 echo_next_position;
+
+  // Sessions detecting voice activity. Processing worker only.
+  // |speech_probability| is that of the chunk being emitted. Speech-only
+  // sessions keep the last |pre_roll_capacity| samples they held back in
+  // |pre_roll|, ending just before |pre_roll_end|, and lead into the next
+  // chunk with speech from |voice_output|.
+  std::unique_ptr<VoiceDetector> voice;
+  std::vector<VoiceTransition> voice_transitions;
+  double speech_probability;
+  std::vector<int16_t> pre_roll;
+  size_t pre_roll_capacity;
+  guint64 pre_roll_end;
+  std::vector<int16_t> voice_output;
+
+  // Segmenting sessions gather the utterance in progress in |utterance|,
+  // preallocated for the longest one, up to |utterance_limit| samples. The
+  // position and capture time are those of its first frame. Processing
+  // worker only.
+  bool utterance_active;
+  std::vector<int16_t> utterance;
+  size_t max_utterance_samples;  // Not counting the pre-roll.
+  size_t utterance_limit;
+  guint64 utterance_position;
+  gint64 utterance_time;
+  gint64 utterance_conversion_us;
+  guint64 utterance_sequence;  // Of the next utterance.
+
+  // Sessions that meter at a rate but also emit samples read one meter
+  // period at a time and gather the processed frames here until a chunk is
+  // complete. The position and capture time are those of the first frame.
+  // Processing worker only.
+  std::vector<int16_t> assembly;
+  guint64 assembly_position;
+  gint64 assembly_time;
+  gint64 assembly_conversion_us;
+  guint64 chunk_sequence;  // Of the next assembled chunk.
+
+  // Sessions extracting log-mel features. Processing worker only. Frame 0
+  // of |mel| starts at |mel_origin|; samples not following on from
+  // |mel_next_position| restart it. Up to |mel_max_frames| frames are
+  // extracted into |mel_frames| and emitted at a time.
+  std::unique_ptr<MelSpectrogram> mel;
+  std::vector<float> mel_frames;
+  size_t mel_max_frames;
+  guint64 mel_origin;
+  guint64 mel_next_position;
+  guint64 feature_sequence;
+
+  // Sessions analyzing the spectrum. Processing worker only. Frame 0 of
+  // |analyzer| starts at |spectrum_origin|; samples not following on from
+  // |spectrum_next_position| restart it. The levels are emitted once a
+  // frame ends at or past |spectrum_next_emit|, which then moves on by
+  // |spectrum_interval| samples.
+  std::unique_ptr<SpectrumAnalyzer> analyzer;
+  guint64 spectrum_origin;
+  guint64 spectrum_next_position;
+  guint64 spectrum_next_emit;
+  guint64 spectrum_interval;
+  guint64 spectrum_sequence;
+
+  // Sessions decimating the waveform. Processing worker only. Bucket 0 of
+  // every level of |waveform| starts at |waveform_origin|; samples not
+  // following on from |waveform_next_position| restart it. The buckets
+  // completed by each |waveform_piece| samples are emitted together.
+  std::unique_ptr<WaveformDecimator> waveform;
+  size_t waveform_piece;
+  guint64 waveform_origin;
+  guint64 waveform_next_position;
+  guint64 waveform_sequence;
+
+  // Per-session PCM channel. Main thread only.
+  FlEventChannel* event_channel;
+  gint has_listener;
+
+  // Per-session feature channel, with |mel| only. Main thread only.
+  FlEventChannel* features_channel;
+  gint has_features_listener;
+
+  // Per-session spectrum channel, with |analyzer| only. Main thread only.
+  FlEventChannel* spectrum_channel;
+  gint has_spectrum_listener;
+
+  // Per-session waveform channel, with |waveform| only. Main thread only.
+  FlEventChannel* waveform_channel;
+  gint has_waveform_listener;
+};
+
+struct OverrunPayload {
+  CaptureSession* session;
+  int source;
+  const char* cause;
+  guint64 sample_position;  // Position of the first lost frame.
+  guint64 lost_frames;
+  gboolean filled;
+  gint64 capture_time;      // Monotonic capture time of the first lost frame.
+};
+
+struct DelayPayload {
+  CaptureSession* session;
+  DelayEstimate estimate;
+  guint64 sample_position;  // End of the audio it covers.
+  gint64 capture_time;      // Monotonic capture time of that frame.
+};
+
+struct SpeechPayload {
+  CaptureSession* session;
+  gboolean speaking;        // Whether speech starts or ends.
+  guint64 sample_position;  // Where it does.
+  gint64 capture_time;      // Monotonic capture time of that frame.
+  double probability;       // Of the chunk it happens in.
+};
+
+// The buckets of one waveform level a payload carries.
+struct WaveformRun {
+  guint64 sample_position;  // Where the first bucket starts.
+  size_t bucket_samples;
+  size_t bucket_count;
+};
+
+// Sent as is: min, max and RMS as consecutive 16-bit values.
+static_assert(sizeof(WaveformBucket) == 3 * sizeof(int16_t),
+              "waveform buckets must be packed");
+
+// A processed chunk on its way to the main loop. It heads a buffer of its
+// session's emit pool, with the samples right after it, so emitting in
+// steady state allocates nothing.
+struct AudioChunkPayload {
+  double decibel;
+  double peak;       // With |has_peaks|: meter peak and held peak.
+  double peak_hold;
+  ChunkTiming timing;
+  gint64 conversion_us;  // Format and rate conversion time of the samples.
+  gint64 queued_time;
+  size_t sample_count;  // 0 if nobody listened for PCM when processed.
+  gboolean has_decibel;  // Whether |decibel| was measured.
+  gboolean has_peaks;    // Whether |peak| and |peak_hold| were.
+  gboolean has_loudness;  // Whether |loudness| was.
+  LoudnessReading loudness;
+  gboolean has_gain;  // Whether the gain control's gains were read.
+  double gain_db;
+  double limiter_gain_db;
+  gboolean has_compression;  // Whether the compressor's gain was read.
+  double compressor_gain_db;
+  gboolean has_speech_probability;  // Whether voice activity was detected.
+  double speech_probability;
+  UtteranceEnd utterance_end;  // Why, if the samples are an utterance.
+  size_t feature_frames;  // Log-mel frames carried instead of samples.
+  size_t spectrum_bands;  // Or band levels.
+  size_t waveform_levels;  // Or a waveform run per level, then the buckets.
+  gboolean pooled;  // False for chunks too long for the pool (gap fill).
+
+  int16_t* samples() { return reinterpret_cast<int16_t*>(this + 1); }
+  float* values() { return reinterpret_cast<float*>(this + 1); }
+  WaveformRun* waveform_runs() {
+    return reinterpret_cast<WaveformRun*>(this + 1);
+  }
+  WaveformBucket* waveform_buckets() {
+    return reinterpret_cast<WaveformBucket*>(waveform_runs() +
+                                             waveform_levels);
+  }
+};
+
+// Main loop source sending the chunks a session queued for emission. The
+// processing worker wakes it by setting its ready time, which unlike
+// invoking a callback needs no allocation. Meter-only sessions pace it
+// instead: it dispatches every |interval| and sends one level each time,
+// whatever the fragment size.
+struct EmitSource {
+  GSource source;
+  CaptureSession* session;  // Referenced until the source is detached.
+  gint64 interval;          // 0 unless paced.
+  gint64 next_dispatch;     // Monotonic time of the next paced dispatch.
+};
+
+// Sessions of every plugin, keyed by id. Holds one reference per session.
+GMutex g_sessions_lock;
+GHashTable* g_sessions = nullptr;
+gint g_last_session_id = 0;
+
+void ProcessSessionTask(gpointer data, gpointer user_data);
+
+// Processing pool shared by all sessions. Each session is processed by at
+// most one worker at a time, so its chunks stay in order.
+GThreadPool* GetProcessingPool() {
+  static gsize initialized = 0;
+  static GThreadPool* pool = nullptr;
+  if (g_once_init_enter(&initialized)) {
+    const gint max_threads =
+        std::max(2, static_cast<gint>(g_get_num_processors()));
+    pool = g_thread_pool_new(ProcessSessionTask, nullptr, max_threads, FALSE,
+                             nullptr);
+    g_once_init_leave(&initialized, 1);
+  }
+  return pool;
+}
+
+CaptureSession* CaptureSessionRef(CaptureSession* session) {
+  g_atomic_int_inc(&session->ref_count);
+  return session;
+}
+
+void DestroyChunk(RawChunk* chunk);
+void ReleasePayload(CaptureSession* session, AudioChunkPayload* payload);
+
+void CaptureSessionUnref(CaptureSession* session) {
+  if (!g_atomic_int_dec_and_test(&session->ref_count)) {
+    return;
+  }
+  GObject* owner = session->host->owner;
+  for (int i = 0; i < session->source_count; ++i) {
+    CaptureSource& source = session->sources[i];
+    RawChunk* chunk = nullptr;
+    while (source.ready_chunks->Pop(&chunk)) {
+      DestroyChunk(chunk);
+    }
+    while (source.free_chunks->Pop(&chunk)) {
+      DestroyChunk(chunk);
+    }
+  }
+  // Chunks processed after the session finished were never sent.
+  AudioChunkPayload* payload = nullptr;
+  while (session->emit_queue->Pop(&payload)) {
+    ReleasePayload(session, payload);
+  }
+  g_source_unref(session->emit_source);
+  for (const auto& region : session->locked_regions) {
+    munlock(region.first, region.second);
+  }
+  g_mutex_clear(&session->stats_lock);
+  delete session;
+  g_object_unref(owner);
+}
+
+void DestroyChunk(RawChunk* chunk) {
+  if (chunk->locked) {
+    munlock(chunk, sizeof(RawChunk) + chunk->size);
+  }
+  g_free(chunk);
+}
+
+RawChunk* NewChunk(CaptureSession* session) {
+  const size_t size = session->chunk_capacity;
+  auto* chunk = static_cast<RawChunk*>(g_malloc(sizeof(RawChunk) + size));
+  chunk->size = size;
+  chunk->data = reinterpret_cast<guint8*>(chunk + 1);
+  chunk->locked = session->config.realtime &&
+                  PrefaultAndLock(chunk, sizeof(RawChunk) + size);
+  return chunk;
+}
+
+// Prefaults and locks |size| bytes at |data| for a real-time session, and
+// remembers them for CaptureSessionUnref to unlock.
+void LockSessionMemory(CaptureSession* session, void* data, size_t size) {
+  if (PrefaultAndLock(data, size)) {
+    session->locked_regions.emplace_back(data, size);
+  }
+}
+
+// Takes a chunk from the source's pool, allocating one only if it is empty.
+// Reader only.
+RawChunk* AcquireChunk(CaptureSource* source) {
+  RawChunk* chunk = nullptr;
+  return source->free_chunks->Pop(&chunk) ? chunk : NewChunk(source->session);
+}
+
+// Returns a processed chunk to its source's pool. Processing worker only.
+void ReleaseChunk(CaptureSession* session, RawChunk* chunk) {
+  if (!session->sources[chunk->source].free_chunks->Push(chunk)) {
+    DestroyChunk(chunk);
+  }
+}
+
+int16_t ClampToInt16(float sample) {
+  return static_cast<int16_t>(std::max(-32768.0f, std::min(32767.0f, sample)));
+}
+
+void ApplyGainBoostAndConvertToMono(const int16_t* input, int16_t* output,
+                                    size_t frame_count, int input_channels,
+                                    float gain_boost) {
+  const float max_value = 32767.0f;
+  const float min_value = -32768.0f;
+
+  if (input_channels == 1) {
+    // Mono: just apply gain boost
+    for (size_t i = 0; i < frame_count; ++i) {
+      float sample = static_cast<float>(input[i]) * gain_boost;
+      sample = std::max(min_value, std::min(max_value, sample));
+      output[i] = static_cast<int16_t>(sample);
+    }
+  } else {
+    // Stereo: convert to mono and apply gain boost
+    for (size_t i = 0; i < frame_count; ++i) {
+      float left = static_cast<float>(input[i * 2]);
+      float right = static_cast<float>(input[i * 2 + 1]);
+      float mono = (left + right) / 2.0f * gain_boost;
+      mono = std::max(min_value, std::min(max_value, mono));
+      output[i] = static_cast<int16_t>(mono);
+    }
+  }
+}
+
+// Like the above, but leaves the gained samples as floats, free to pass
+// full scale, for a Compressor to bring back within it.
+void ApplyGainBoostAndConvertToMono(const int16_t* input, float* output,
+                                    size_t frame_count, int input_channels,
+                                    float gain_boost) {
+  if (input_channels == 1) {
+    for (size_t i = 0; i < frame_count; ++i) {
+      output[i] = static_cast<float>(input[i]) * gain_boost;
+    }
+  } else {
+    for (size_t i = 0; i < frame_count; ++i) {
+      const float left = static_cast<float>(input[i * 2]);
+      const float right = static_cast<float>(input[i * 2 + 1]);
+      output[i] = (left + right) / 2.0f * gain_boost;
+    }
+  }
+}
+
+// Returns the buffer of |payload| to the emit pool, or frees it if it did
+// not fit there.
+void ReleasePayload(CaptureSession* session, AudioChunkPayload* payload) {
+  if (payload->pooled) {
+    session->emit_pool->Release(payload);
+  } else {
+    g_free(payload);
+  }
+}
+
+void CountEmitDrops(CaptureSession* session, guint64 count) {
+  g_mutex_lock(&session->stats_lock);
+  session->stats.emit_dropped_chunks += count;
+  g_mutex_unlock(&session->stats_lock);
+}
+
+FlValue* LoudnessToMap(const LoudnessReading& reading) {
+  FlValue* map = fl_value_new_map();
+  fl_value_set_string_take(map, "momentary", fl_value_new_float(reading.momentary));
+  fl_value_set_string_take(map, "shortTerm", fl_value_new_float(reading.short_term));
+  fl_value_set_string_take(map, "integrated", fl_value_new_float(reading.integrated));
+  fl_value_set_string_take(map, "range", fl_value_new_float(reading.range));
+  fl_value_set_string_take(map, "truePeak", fl_value_new_float(reading.true_peak));
+  return map;
+}
+
+const char* UtteranceEndName(UtteranceEnd end) {
+  switch (end) {
+    case UtteranceEnd::kSilence:
+      return "silence";
+    case UtteranceEnd::kMaxDuration:
+      return "maxDuration";
+    case UtteranceEnd::kGap:
+      return "gap";
+    case UtteranceEnd::kNone:
+      break;
+  }
+  return "none";
+}
+
+// Sends the log-mel frames of |payload| on the session's feature channel.
+void SendFeatures(CaptureSession* session, AudioChunkPayload* payload,
+                  double timestamp) {
+  if (session->features_channel == nullptr ||
+      !g_atomic_int_get(&session->has_features_listener)) {
+    return;
+  }
+  const MelSpectrogram& mel = *session->mel;
+  g_autoptr(FlValue) features_map = fl_value_new_map();
+  fl_value_set_string_take(features_map, "sequence", fl_value_new_int(payload->timing.sequence));
+  fl_value_set_string_take(features_map, "samplePosition", fl_value_new_int(payload->timing.frame_position));
+  fl_value_set_string_take(features_map, "captureTimeUs", fl_value_new_int(payload->timing.capture_time));
+  fl_value_set_string_take(features_map, "timestamp", fl_value_new_float(timestamp));
+  fl_value_set_string_take(features_map, "bins", fl_value_new_int(mel.bins()));
+  fl_value_set_string_take(features_map, "frameCount", fl_value_new_int(payload->feature_frames));
+  fl_value_set_string_take(features_map, "hopSamples", fl_value_new_int(mel.hop_samples()));
+  fl_value_set_string_take(features_map, "windowSamples", fl_value_new_int(mel.window_samples()));
+  fl_value_set_string_take(features_map, "features", fl_value_new_float32_list(payload->values(), payload->feature_frames * mel.bins()));
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_event_channel_send(session->features_channel, features_map,
+                             nullptr, &error)) {
+    g_warning("Failed to send features: %s",
+              error != nullptr ? error->message : "unknown error");
+  }
+}
+
+// Sends the band levels of |payload| on the session's spectrum channel.
+void SendSpectrum(CaptureSession* session, AudioChunkPayload* payload,
+                  double timestamp) {
+  if (session->spectrum_channel == nullptr ||
+      !g_atomic_int_get(&session->has_spectrum_listener)) {
+    return;
+  }
+  const SpectrumAnalyzer& analyzer = *session->analyzer;
+  g_autoptr(FlValue) spectrum_map = fl_value_new_map();
+  fl_value_set_string_take(spectrum_map, "sequence", fl_value_new_int(payload->timing.sequence));
+  fl_value_set_string_take(spectrum_map, "samplePosition", fl_value_new_int(payload->timing.frame_position));
+  fl_value_set_string_take(spectrum_map, "captureTimeUs", fl_value_new_int(payload->timing.capture_time));
+  fl_value_set_string_take(spectrum_map, "timestamp", fl_value_new_float(timestamp));
+  fl_value_set_string_take(spectrum_map, "fftSize", fl_value_new_int(analyzer.fft_size()));
+  fl_value_set_string_take(spectrum_map, "levels", fl_value_new_float32_list(payload->values(), payload->spectrum_bands));
+  fl_value_set_string_take(spectrum_map, "frequencies", fl_value_new_float32_list(analyzer.frequencies().data(), analyzer.bands()));
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_event_channel_send(session->spectrum_channel, spectrum_map,
+                             nullptr, &error)) {
+    g_warning("Failed to send spectrum: %s",
+              error != nullptr ? error->message : "unknown error");
+  }
+}
+
+// Sends the waveform buckets of |payload| on the session's waveform
+// channel, each level's as packed 16-bit min, max and RMS triples.
+void SendWaveform(CaptureSession* session, AudioChunkPayload* payload,
+                  double timestamp) {
+  if (session->waveform_channel == nullptr ||
+      !g_atomic_int_get(&session->has_waveform_listener)) {
+    return;
+  }
+  g_autoptr(FlValue) levels = fl_value_new_list();
+  const WaveformBucket* buckets = payload->waveform_buckets();
+  for (size_t i = 0; i < payload->waveform_levels; ++i) {
+    const WaveformRun& run = payload->waveform_runs()[i];
+    g_autoptr(FlValue) level_map = fl_value_new_map();
+    fl_value_set_string_take(level_map, "bucketSamples", fl_value_new_int(run.bucket_samples));
+    fl_value_set_string_take(level_map, "samplePosition", fl_value_new_int(run.sample_position));
+    fl_value_set_string_take(level_map, "data", fl_value_new_uint8_list(reinterpret_cast<const uint8_t*>(buckets), run.bucket_count * sizeof(WaveformBucket)));
+    fl_value_append(levels, level_map);
+    buckets += run.bucket_count;
+  }
+
+  g_autoptr(FlValue) waveform_map = fl_value_new_map();
+  fl_value_set_string_take(waveform_map, "sequence", fl_value_new_int(payload->timing.sequence));
+  fl_value_set_string_take(waveform_map, "samplePosition", fl_value_new_int(payload->timing.frame_position));
+  fl_value_set_string_take(waveform_map, "captureTimeUs", fl_value_new_int(payload->timing.capture_time));
+  fl_value_set_string_take(waveform_map, "timestamp", fl_value_new_float(timestamp));
+  fl_value_set_string(waveform_map, "levels", levels);
+
+  g_autoptr(GError) error = nullptr;
+  if (!fl_event_channel_send(session->waveform_channel, waveform_map,
+                             nullptr, &error)) {
+    g_warning("Failed to send waveform: %s",
+              error != nullptr ? error->message : "unknown error");
+  }
+}
+
+// Sends one processed chunk. Main thread only.
+void EmitAudio(CaptureSession* session, AudioChunkPayload* payload) {
+  CaptureHost* host = session->host;
+
+  const gint64 wait = g_get_monotonic_time() - payload->queued_time;
+  g_atomic_int_add(&session->pending_emissions, -1);
+  g_mutex_lock(&session->stats_lock);
+  session->stats.emitted_chunks++;
+  session->stats.emit_wait_total_us += wait;
+  session->stats.emit_wait_max_us =
+      std::max(session->stats.emit_wait_max_us, wait);
+  g_mutex_unlock(&session->stats_lock);
+
+  const gsize length = payload->sample_count * sizeof(int16_t);
+  const guint8* data = reinterpret_cast<const guint8*>(payload->samples());
+
+  g_mutex_lock(&host->lock);
+  const gboolean can_emit =
+      host->event_channel != nullptr && host->has_listener;
+  const gboolean can_emit_decibel =
+      host->decibel_event_channel != nullptr && host->has_decibel_listener;
+  g_mutex_unlock(&host->lock);
+
+  const gboolean can_emit_session = session->event_channel != nullptr &&
+                                    g_atomic_int_get(&session->has_listener);
+
+  // Capture time on the wall clock, for consumers without access to the
+  // monotonic clock.
+  const double timestamp =
+      (payload->timing.capture_time +
+       (g_get_real_time() - g_get_monotonic_time())) /
+      static_cast<double>(G_USEC_PER_SEC);
+
+  if (payload->feature_frames > 0) {
+    SendFeatures(session, payload, timestamp);
+    return;
+  }
+  if (payload->spectrum_bands > 0) {
+    SendSpectrum(session, payload, timestamp);
+    return;
+  }
+  if (payload->waveform_levels > 0) {
+    SendWaveform(session, payload, timestamp);
+    return;
+  }
+
+  if ((can_emit || can_emit_session) && length > 0) {
+    g_autoptr(FlValue) value = fl_value_new_uint8_list(data, length);
+
+    // Session channels carry the chunk's timing alongside the samples.
+    if (can_emit_session) {
+      g_autoptr(FlValue) chunk_map = fl_value_new_map();
+      fl_value_set_string(chunk_map, "data", value);
+      fl_value_set_string_take(chunk_map, "sequence", fl_value_new_int(payload->timing.sequence));
+      fl_value_set_string_take(chunk_map, "samplePosition", fl_value_new_int(payload->timing.frame_position));
+      fl_value_set_string_take(chunk_map, "captureTimeUs", fl_value_new_int(payload->timing.capture_time));
+      fl_value_set_string_take(chunk_map, "timestamp", fl_value_new_float(timestamp));
+      fl_value_set_string_take(chunk_map, "conversionUs", fl_value_new_int(payload->conversion_us));
+      if (payload->has_speech_probability) {
+        fl_value_set_string_take(chunk_map, "speechProbability", fl_value_new_float(payload->speech_probability));
+      }
+      if (payload->utterance_end != UtteranceEnd::kNone) {
+        fl_value_set_string_take(chunk_map, "endPosition", fl_value_new_int(payload->timing.frame_position + payload->sample_count));
+        fl_value_set_string_take(chunk_map, "endReason", fl_value_new_string(UtteranceEndName(payload->utterance_end)));
+      }
+
+      g_autoptr(GError) error = nullptr;
+      if (!fl_event_channel_send(session->event_channel, chunk_map, nullptr,
+                                 &error)) {
+        g_warning("Failed to send audio chunk: %s",
+                  error != nullptr ? error->message : "unknown error");
+      }
+    }
+
+    // The plugin-level stream carries every session for single-session
+    // clients.
+    if (can_emit) {
+      g_autoptr(GError) error = nullptr;
+      if (!fl_event_channel_send(host->event_channel, value, nullptr,
+                                 &error)) {
+        g_warning("Failed to send audio chunk: %s",
+                  error != nullptr ? error->message : "unknown error");
+      }
+    }
+  }
+
+  // Send decibel data
+  if (can_emit_decibel && payload->has_decibel) {
+    g_autoptr(FlValue) decibel_map = fl_value_new_map();
+    fl_value_set_string_take(decibel_map, "decibel", fl_value_new_float(payload->decibel));
+    fl_value_set_string_take(decibel_map, "timestamp", fl_value_new_float(timestamp));
+    fl_value_set_string_take(decibel_map, "sessionId", fl_value_new_int(session->id));
+    fl_value_set_string_take(decibel_map, "sequence", fl_value_new_int(payload->timing.sequence));
+    fl_value_set_string_take(decibel_map, "captureTimeUs", fl_value_new_int(payload->timing.capture_time));
+    if (payload->has_peaks) {
+      fl_value_set_string_take(decibel_map, "peak", fl_value_new_float(payload->peak));
+      fl_value_set_string_take(decibel_map, "peakHold", fl_value_new_float(payload->peak_hold));
+    }
+    if (payload->has_loudness) {
+      fl_value_set_string_take(decibel_map, "loudness", LoudnessToMap(payload->loudness));
+    }
+    if (payload->has_gain) {
+      fl_value_set_string_take(decibel_map, "gainDb", fl_value_new_float(payload->gain_db));
+      fl_value_set_string_take(decibel_map, "limiterGainDb", fl_value_new_float(payload->limiter_gain_db));
+    }
+    if (payload->has_compression) {
+      fl_value_set_string_take(decibel_map, "compressorGainDb", fl_value_new_float(payload->compressor_gain_db));
+    }
+
+    g_autoptr(GError) error = nullptr;
+    if (!fl_event_channel_send(host->decibel_event_channel, decibel_map,
+                               nullptr, &error)) {
+      g_warning("Failed to send decibel data: %s",
+                error != nullptr ? error->message : "unknown error");
+    }
+  }
+}
+
+// Sends every chunk queued for emission. Main thread only.
+void SendEmittedChunks(CaptureSession* session) {
+  AudioChunkPayload* payload = nullptr;
+  while (session->emit_queue->Pop(&payload)) {
+    EmitAudio(session, payload);
+    ReleasePayload(session, payload);
+  }
+}
+
+// Sends the oldest queued level of a meter-only session, after dropping
+// those a stalled main loop left behind. Main thread only.
+void SendPacedLevel(CaptureSession* session) {
+  AudioChunkPayload* payload = nullptr;
+  guint64 dropped = 0;
+  while (session->emit_queue->Size() > session->max_meter_backlog &&
+         session->emit_queue->Pop(&payload)) {
+    g_atomic_int_add(&session->pending_emissions, -1);
+    ReleasePayload(session, payload);
+    ++dropped;
+  }
+  if (dropped > 0) {
+    CountEmitDrops(session, dropped);
+  }
+  if (session->emit_queue->Pop(&payload)) {
+    EmitAudio(session, payload);
+    ReleasePayload(session, payload);
+  }
+}
+
+gboolean DispatchEmitSource(GSource* source, GSourceFunc callback,
+                            gpointer user_data) {
+  (void)callback;
+  (void)user_data;
+  EmitSource* emit_source = reinterpret_cast<EmitSource*>(source);
+  if (emit_source->interval > 0) {
+    // A late dispatch delays the following ones instead of bunching them.
+    const gint64 now = g_get_monotonic_time();
+    emit_source->next_dispatch += emit_source->interval;
+    if (emit_source->next_dispatch <= now) {
+      emit_source->next_dispatch = now + emit_source->interval;
+    }
+    g_source_set_ready_time(source, emit_source->next_dispatch);
+    SendPacedLevel(emit_source->session);
+    return G_SOURCE_CONTINUE;
+  }
+  // Reset before draining, so a chunk queued meanwhile wakes the source
+  // again instead of waiting for the next one.
+  g_source_set_ready_time(source, -1);
+  SendEmittedChunks(emit_source->session);
+  return G_SOURCE_CONTINUE;
+}
+
+GSourceFuncs g_emit_source_funcs = {nullptr, nullptr, DispatchEmitSource,
+                                    nullptr, nullptr, nullptr};
+
+// Sends the chunks already queued, then stops sending and drops the emit
+// source's reference. Chunks the worker still queues are released with the
+// session. Main thread only.
+void DetachEmitSource(CaptureSession* session) {
+  EmitSource* source = reinterpret_cast<EmitSource*>(session->emit_source);
+  if (source->session == nullptr) {
+    return;
+  }
+  SendEmittedChunks(session);
+  g_source_destroy(session->emit_source);
+  source->session = nullptr;
+  CaptureSessionUnref(session);
+}
+
+gboolean EmitOverrunOnMainThread(gpointer user_data) {
+  std::unique_ptr<OverrunPayload> payload(
+      static_cast<OverrunPayload*>(user_data));
+  CaptureSession* session = payload->session;
+  CaptureHost* host = session->host;
+
+  g_mutex_lock(&host->lock);
+  const gboolean can_emit =
+      host->events_event_channel != nullptr && host->has_events_listener;
+  g_mutex_unlock(&host->lock);
+
+  if (can_emit) {
+    const double duration_ms = payload->lost_frames * 1000.0 /
+                               session->config.sample_rate;
+    const double timestamp =
+        (payload->capture_time +
+         (g_get_real_time() - g_get_monotonic_time())) /
+        static_cast<double>(G_USEC_PER_SEC);
+
+    g_autoptr(FlValue) event_map = fl_value_new_map();
+    fl_value_set_string_take(event_map, "type", fl_value_new_string("overrun"));
+    fl_value_set_string_take(event_map, "sessionId", fl_value_new_int(session->id));
+    fl_value_set_string_take(event_map, "cause", fl_value_new_string(payload->cause));
+    if (session->synced) {
+      fl_value_set_string_take(event_map, "track", fl_value_new_string(payload->source == kMicSource ? "microphone" : "system"));
+    }
+    fl_value_set_string_take(event_map, "samplePosition", fl_value_new_int(payload->sample_position));
+    fl_value_set_string_take(event_map, "lostFrames", fl_value_new_int(payload->lost_frames));
+    fl_value_set_string_take(event_map, "durationMs", fl_value_new_float(duration_ms));
+    fl_value_set_string_take(event_map, "filled", fl_value_new_bool(payload->filled));
+    fl_value_set_string_take(event_map, "captureTimeUs", fl_value_new_int(payload->capture_time));
+    fl_value_set_string_take(event_map, "timestamp", fl_value_new_float(timestamp));
+
+    g_autoptr(GError) error = nullptr;
+    if (!fl_event_channel_send(host->events_event_channel, event_map, nullptr,
+                               &error)) {
+      g_warning("Failed to send overrun event: %s",
+                error != nullptr ? error->message : "unknown error");
+    }
+  }
+
+  CaptureSessionUnref(session);
+  return G_SOURCE_REMOVE;
+}
+
+gboolean EmitSpeechOnMainThread(gpointer user_data) {
+  std::unique_ptr<SpeechPayload> payload(
+      static_cast<SpeechPayload*>(user_data));
+  CaptureSession* session = payload->session;
+  CaptureHost* host = session->host;
+
+  g_mutex_lock(&host->lock);
+  const gboolean can_emit =
+      host->events_event_channel != nullptr && host->has_events_listener;
+  g_mutex_unlock(&host->lock);
+
+  if (can_emit) {
+    const double timestamp =
+        (payload->capture_time +
+         (g_get_real_time() - g_get_monotonic_time())) /
+        static_cast<double>(G_USEC_PER_SEC);
+
+    g_autoptr(FlValue) event_map = fl_value_new_map();
+    fl_value_set_string_take(event_map, "type", fl_value_new_string("speech"));
+    fl_value_set_string_take(event_map, "sessionId", fl_value_new_int(session->id));
+    fl_value_set_string_take(event_map, "speaking", fl_value_new_bool(payload->speaking));
+    fl_value_set_string_take(event_map, "samplePosition", fl_value_new_int(payload->sample_position));
+    fl_value_set_string_take(event_map, "probability", fl_value_new_float(payload->probability));
+    fl_value_set_string_take(event_map, "captureTimeUs", fl_value_new_int(payload->capture_time));
+    fl_value_set_string_take(event_map, "timestamp", fl_value_new_float(timestamp));
+
+    g_autoptr(GError) error = nullptr;
+    if (!fl_event_channel_send(host->events_event_channel, event_map, nullptr,
+                               &error)) {
+      g_warning("Failed to send speech event: %s",
+                error != nullptr ? error->message : "unknown error");
+    }
+  }
+
+  CaptureSessionUnref(session);
+  return G_SOURCE_REMOVE;
+}
+
+gboolean EmitDelayOnMainThread(gpointer user_data) {
+  std::unique_ptr<DelayPayload> payload(static_cast<DelayPayload*>(user_data));
+  CaptureSession* session = payload->session;
+  CaptureHost* host = session->host;
+
+  g_mutex_lock(&host->lock);
+  const gboolean can_emit =
+      host->events_event_channel != nullptr && host->has_events_listener;
+  g_mutex_unlock(&host->lock);
+
+  if (can_emit) {
+    const double timestamp =
+        (payload->capture_time +
+         (g_get_real_time() - g_get_monotonic_time())) /
+        static_cast<double>(G_USEC_PER_SEC);
+
+    g_autoptr(FlValue) event_map = fl_value_new_map();
+    fl_value_set_string_take(event_map, "type", fl_value_new_string("delay"));
+    fl_value_set_string_take(event_map, "sessionId", fl_value_new_int(session->id));
+    fl_value_set_string_take(event_map, "delayMs", fl_value_new_float(payload->estimate.delay_ms));
+    fl_value_set_string_take(event_map, "confidence", fl_value_new_float(payload->estimate.confidence));
+    fl_value_set_string_take(event_map, "samplePosition", fl_value_new_int(payload->sample_position));
+    fl_value_set_string_take(event_map, "captureTimeUs", fl_value_new_int(payload->capture_time));
+    fl_value_set_string_take(event_map, "timestamp", fl_value_new_float(timestamp));
+
+    g_autoptr(GError) error = nullptr;
+    if (!fl_event_channel_send(host->events_event_channel, event_map, nullptr,
+                               &error)) {
+      g_warning("Failed to send delay event: %s",
+                error != nullptr ? error->message : "unknown error");
+    }
+  }
+
+  CaptureSessionUnref(session);
+  return G_SOURCE_REMOVE;
+}
+
+void ReportSpeech(CaptureSession* session, gboolean speaking,
+                  guint64 sample_position, gint64 capture_time,
+                  double probability) {
+  auto* payload = new SpeechPayload();
+  payload->session = CaptureSessionRef(session);
+  payload->speaking = speaking;
+  payload->sample_position = sample_position;
+  payload->capture_time = capture_time;
+  payload->probability = probability;
+  g_main_context_invoke_full(session->host->main_context, G_PRIORITY_DEFAULT,
+                             EmitSpeechOnMainThread, payload, nullptr);
+}
+
+void ReportOverrun(CaptureSession* session, int source, const char* cause,
+                   guint64 sample_position, guint64 lost_frames,
+                   gboolean filled, gint64 capture_time) {
+  g_mutex_lock(&session->stats_lock);
+  session->stats.overruns++;
+  session->stats.lost_frames += lost_frames;
+  if (filled) {
+    session->stats.filled_frames += lost_frames;
+  }
+  g_mutex_unlock(&session->stats_lock);
+
+  auto* payload = new OverrunPayload();
+  payload->session = CaptureSessionRef(session);
+  payload->source = source;
+  payload->cause = cause;
+  payload->sample_position = sample_position;
+  payload->lost_frames = lost_frames;
+  payload->filled = filled;
+  payload->capture_time = capture_time;
+  g_main_context_invoke_full(session->host->main_context, G_PRIORITY_DEFAULT,
+                             EmitOverrunOnMainThread, payload, nullptr);
+}
+
+// Returns how many frames of |chunk|'s source are missing just before it,
+// whether dropped from the ready queue or by the server, and advances the
+// source's expected position past the chunk.
+guint64 TakeGap(CaptureSession* session, const RawChunk* chunk) {
+  CaptureSource& source = session->sources[chunk->source];
+  const guint64 expected = source.next_frame_position;
+  source.next_frame_position = chunk->timing.frame_position + chunk->frames;
+  return chunk->timing.frame_position > expected
+             ? chunk->timing.frame_position - expected
+             : 0;
+}
+
+// Reports the |gap| frames missing before |chunk|, one event per cause:
+// whole chunks dropped from the queue, then audio the server discarded.
+void ReportGap(CaptureSession* session, const RawChunk* chunk, guint64 gap,
+               gboolean filled) {
+  const int sample_rate = session->config.sample_rate;
+  const guint64 gap_start = chunk->timing.frame_position - gap;
+  const guint64 overflow = std::min(chunk->overflow_frames, gap);
+  const guint64 dropped = gap - overflow;
+  auto time_of = [&](guint64 position) {
+    return chunk->timing.capture_time -
+           static_cast<gint64>((chunk->timing.frame_position - position) *
+                               G_USEC_PER_SEC / sample_rate);
+  };
+
+  if (dropped > 0) {
+    ReportOverrun(session, chunk->source, kCauseQueueDrop, gap_start, dropped,
+                  filled, time_of(gap_start));
+  }
+  if (overflow > 0) {
+    ReportOverrun(session, chunk->source, kCauseServerOverflow,
+                  gap_start + dropped, overflow, filled,
+                  time_of(gap_start + dropped));
+  }
+}
+
+void ApplyInputVolume(int16_t* samples, size_t sample_count, float volume) {
+  if (volume >= 1.0f) {
+    return;
+  }
+  for (size_t i = 0; i < sample_count; ++i) {
+    samples[i] = static_cast<int16_t>(static_cast<float>(samples[i]) * volume);
+  }
+}
+
+// Updates the consumers of |host| after a listener flag changed. Called
+// with |host->lock| held.
+void UpdateHostConsumers(CaptureHost* host) {
+  g_atomic_int_set(&host->consumers,
+                   (host->has_listener ? kConsumePcm : 0) |
+                       (host->has_decibel_listener ? kConsumeDecibel : 0));
+}
+
+// What the listeners of |session| currently consume. Read for every chunk,
+// so processing follows listeners as they attach and detach.
+gint SessionConsumers(CaptureSession* session) {
+  gint consumers = g_atomic_int_get(&session->host->consumers);
+  if (g_atomic_int_get(&session->has_listener)) {
+    consumers |= kConsumePcm;
+  }
+  if (g_atomic_int_get(&session->has_features_listener)) {
+    consumers |= kConsumeFeatures;
+  }
+  if (g_atomic_int_get(&session->has_spectrum_listener)) {
+    consumers |= kConsumeSpectrum;
+  }
+  if (g_atomic_int_get(&session->has_waveform_listener)) {
+    consumers |= kConsumeWaveform;
+  }
+  return consumers;
+}
+
+// Hands a filled payload to the main thread, waking the emit source unless
+// it is paced. Drops it if the queue is full.
+void QueuePayload(CaptureSession* session, AudioChunkPayload* payload) {
+  payload->queued_time = g_get_monotonic_time();
+  if (!session->emit_queue->Push(payload)) {
+    ReleasePayload(session, payload);
+    CountEmitDrops(session, 1);
+    return;
+  }
+
+  const gint depth = g_atomic_int_add(&session->pending_emissions, 1) + 1;
+  g_mutex_lock(&session->stats_lock);
+  session->stats.emit_high_water =
+      std::max(session->stats.emit_high_water, static_cast<guint64>(depth));
+  g_mutex_unlock(&session->stats_lock);
+  if (reinterpret_cast<EmitSource*>(session->emit_source)->interval == 0) {
+    g_source_set_ready_time(session->emit_source, 0);
+  }
+}
+
+// Copies the current gains of the session's gain control and compressor,
+// for those it has, into |payload|.
+void SetGain(CaptureSession* session, AudioChunkPayload* payload) {
+  payload->has_gain = session->agc != nullptr;
+  payload->gain_db = payload->has_gain ? session->agc->gain_db() : 0.0;
+  payload->limiter_gain_db =
+      payload->has_gain ? session->agc->limiter_gain_db() : 0.0;
+  payload->has_compression = session->compressor != nullptr;
+  payload->compressor_gain_db =
+      payload->has_compression ? session->compressor->gain_db() : 0.0;
+}
+
+// Takes an emit buffer of |size| bytes for a payload at |timing|, with no
+// levels, gains, samples, features, bands or buckets yet. Buffers larger
+// than the pool's are allocated. Returns null, counting the drop, if every
+// pooled buffer is still waiting for the main loop.
+AudioChunkPayload* AcquirePayload(CaptureSession* session,
+                                  const ChunkTiming& timing,
+                                  size_t size = sizeof(AudioChunkPayload)) {
+  const gboolean pooled = size <= session->emit_pool->buffer_size();
+  auto* payload = static_cast<AudioChunkPayload*>(
+      pooled ? session->emit_pool->Acquire() : g_malloc(size));
+  if (payload == nullptr) {
+    CountEmitDrops(session, 1);
+    return nullptr;
+  }
+  payload->has_decibel = FALSE;
+  payload->has_peaks = FALSE;
+  payload->has_loudness = FALSE;
+  payload->has_gain = FALSE;
+  payload->has_compression = FALSE;
+  payload->has_speech_probability = FALSE;
+  payload->utterance_end = UtteranceEnd::kNone;
+  payload->feature_frames = 0;
+  payload->spectrum_bands = 0;
+  payload->waveform_levels = 0;
+  payload->timing = timing;
+  payload->conversion_us = 0;
+  payload->sample_count = 0;
+  payload->pooled = pooled;
+  return payload;
+}
+
+// Hands processed samples to the main thread for emission: the samples if
+// |consumers| take PCM, their level if they take decibels. Drops them if
+// every emit buffer is still waiting for the main loop.
+void EmitProcessed(CaptureSession* session, const int16_t* samples,
+                   size_t sample_count, gint consumers,
+                   const ChunkTiming& timing, gint64 conversion_us,
+                   UtteranceEnd utterance_end = UtteranceEnd::kNone) {
+  const size_t emit_count = (consumers & kConsumePcm) ? sample_count : 0;
+  // Only utterances and chunks lengthened by filling a gap with silence
+  // exceed the pool's buffers; those are rare enough to allocate.
+  AudioChunkPayload* payload = AcquirePayload(
+      session, timing,
+      sizeof(AudioChunkPayload) + emit_count * sizeof(int16_t));
+  if (payload == nullptr) {
+    return;
+  }
+  payload->has_decibel = (consumers & kConsumeDecibel) != 0;
+  payload->decibel =
+      payload->has_decibel ? MeasureLevel(samples, sample_count) : 0.0;
+  payload->has_loudness =
+      payload->has_decibel && session->loudness != nullptr;
+  payload->loudness = session->loudness_reading;
+  SetGain(session, payload);
+  payload->has_speech_probability =
+      session->voice != nullptr && utterance_end == UtteranceEnd::kNone;
+  payload->speech_probability = session->speech_probability;
+  payload->utterance_end = utterance_end;
+  payload->conversion_us = conversion_us;
+  payload->sample_count = emit_count;
+  memcpy(payload->samples(), samples, emit_count * sizeof(int16_t));
+  QueuePayload(session, payload);
+}
+
+// Hands one meter reading to the main thread, without samples.
+void EmitLevel(CaptureSession* session, const MeterReading& reading,
+               const ChunkTiming& timing) {
+  AudioChunkPayload* payload = AcquirePayload(session, timing);
+  if (payload == nullptr) {
+    return;
+  }
+  payload->has_decibel = TRUE;
+  payload->decibel = reading.rms;
+  payload->has_peaks = TRUE;
+  payload->peak = reading.peak;
+  payload->peak_hold = reading.peak_hold;
+  payload->has_loudness = session->loudness != nullptr;
+  payload->loudness = session->loudness_reading;
+  SetGain(session, payload);
+  QueuePayload(session, payload);
+}
+
+// Folds |frames| frames starting at |timing| into the session's meter and
+// emits the level of every meter period they complete, placed at the
+// period's start.
+void MeterFrames(CaptureSession* session, const int16_t* frames,
+                 size_t frame_count, const ChunkTiming& chunk_timing,
+                 gint consumers) {
+  LevelMeter& meter = *session->meter;
+  if (!(consumers & kConsumeDecibel)) {
+    meter.Reset();  // Start with a whole period when a listener returns.
+    return;
+  }
+
+  const int sample_rate = session->config.sample_rate;
+  const size_t block = meter.block_frames();
+  // Where the first completed period ends in this chunk; it may have
+  // started in an earlier one.
+  const guint64 first_end =
+      chunk_timing.frame_position + meter.frames_to_next_level();
+  const size_t count =
+      meter.Process(frames, frame_count, session->meter_levels.data(),
+                    session->meter_levels.size());
+  for (size_t i = 0; i < count; ++i) {
+    const guint64 start = first_end + i * block - block;
+    ChunkTiming timing;
+    timing.sequence = session->meter_sequence++;
+    timing.frame_position = start;
+    timing.capture_time =
+        chunk_timing.capture_time +
+        (static_cast<gint64>(start) -
+         static_cast<gint64>(chunk_timing.frame_position)) *
+            G_USEC_PER_SEC / sample_rate;
+    EmitLevel(session, session->meter_levels[i], timing);
+  }
+}
+
+// Adds |frame_count| frames to the session's loudness. Loudness covers the
+// whole capture, so it is measured whether or not anyone listens.
+void MeasureLoudness(CaptureSession* session, const int16_t* frames,
+                     size_t frame_count) {
+  session->loudness->Process(frames, frame_count);
+  session->loudness_reading = session->loudness->Reading();
+  g_mutex_lock(&session->stats_lock);
+  session->stats.has_loudness = TRUE;
+  session->stats.loudness = session->loudness_reading;
+  g_mutex_unlock(&session->stats_lock);
+}
+
+// Hands |count| log-mel frames starting at |timing| to the main thread.
+void EmitFeatures(CaptureSession* session, const float* frames, size_t count,
+                  const ChunkTiming& timing) {
+  AudioChunkPayload* payload = AcquirePayload(session, timing);
+  if (payload == nullptr) {
+    return;
+  }
+  payload->feature_frames = count;
+  memcpy(payload->values(), frames,
+         count * session->mel->bins() * sizeof(float));
+  QueuePayload(session, payload);
+}
+
+// Extracts the log-mel frames completed by |count| processed samples and
+// emits them, at most |mel_max_frames| per payload.
+void ExtractFeatures(CaptureSession* session, const int16_t* samples,
+                     size_t count, const ChunkTiming& timing) {
+  MelSpectrogram* mel = session->mel.get();
+  if (timing.frame_position != session->mel_next_position) {
+    // Lost audio, or nobody listened: a new stream of frames.
+    mel->Reset();
+    session->mel_origin = timing.frame_position;
+  }
+  session->mel_next_position = timing.frame_position + count;
+
+  // Pieces of this many samples complete at most |mel_max_frames| frames.
+  const size_t piece = (session->mel_max_frames - 1) * mel->hop_samples();
+  for (size_t offset = 0; offset < count; offset += piece) {
+    const guint64 first = mel->frame_count();
+    const size_t frames =
+        mel->Process(samples + offset, std::min(piece, count - offset),
+                     session->mel_frames.data(), session->mel_max_frames);
+    if (frames == 0) {
+      continue;
+    }
+    ChunkTiming frame_timing;
+    frame_timing.sequence = session->feature_sequence++;
+    frame_timing.frame_position =
+        session->mel_origin + first * mel->hop_samples();
+    frame_timing.capture_time =
+        timing.capture_time +
+        (static_cast<gint64>(frame_timing.frame_position) -
+         static_cast<gint64>(timing.frame_position)) *
+            G_USEC_PER_SEC / session->config.sample_rate;
+    EmitFeatures(session, session->mel_frames.data(), frames, frame_timing);
+  }
+}
+
+// Hands the current band levels, ending at |timing|, to the main thread.
+void EmitSpectrum(CaptureSession* session, const ChunkTiming& timing) {
+  AudioChunkPayload* payload = AcquirePayload(session, timing);
+  if (payload == nullptr) {
+    return;
+  }
+  const std::vector<float>& levels = session->analyzer->levels();
+  payload->spectrum_bands = levels.size();
+  memcpy(payload->values(), levels.data(), levels.size() * sizeof(float));
+  QueuePayload(session, payload);
+}
+
+// Analyzes |count| processed samples a hop at a time, so no more than one
+// frame completes per step, and emits the levels whenever a frame ends at
+// or past the next emission point.
+void AnalyzeSpectrum(CaptureSession* session, const int16_t* samples,
+                     size_t count, const ChunkTiming& timing) {
+  SpectrumAnalyzer* analyzer = session->analyzer.get();
+  if (timing.frame_position != session->spectrum_next_position) {
+    // Lost audio, or nobody listened: a new stream of frames.
+    analyzer->Reset();
+    session->spectrum_origin = timing.frame_position;
+    session->spectrum_next_emit = timing.frame_position;
+  }
+  session->spectrum_next_position = timing.frame_position + count;
+
+  const size_t hop = analyzer->hop_samples();
+  for (size_t offset = 0; offset < count; offset += hop) {
+    if (analyzer->Process(samples + offset, std::min(hop, count - offset)) ==
+        0) {
+      continue;
+    }
+    const guint64 end = session->spectrum_origin + analyzer->frame_end();
+    if (end < session->spectrum_next_emit) {
+      continue;
+    }
+    session->spectrum_next_emit += session->spectrum_interval;
+    if (session->spectrum_next_emit <= end) {
+      // Behind, after a restart or with frames further apart than the
+      // interval: count the interval from this frame.
+      session->spectrum_next_emit = end + session->spectrum_interval;
+    }
+    ChunkTiming spectrum_timing;
+    spectrum_timing.sequence = session->spectrum_sequence++;
+    spectrum_timing.frame_position = end;
+    spectrum_timing.capture_time =
+        timing.capture_time +
+        (static_cast<gint64>(end) -
+         static_cast<gint64>(timing.frame_position)) *
+            G_USEC_PER_SEC / session->config.sample_rate;
+    EmitSpectrum(session, spectrum_timing);
+  }
+}
+
+// Hands the buckets the decimator completed, starting at |timing|, to the
+// main thread and forgets them.
+void EmitWaveform(CaptureSession* session, const ChunkTiming& timing) {
+  WaveformDecimator* waveform = session->waveform.get();
+  AudioChunkPayload* payload = AcquirePayload(session, timing);
+  if (payload == nullptr) {
+    waveform->ClearBuckets();
+    return;
+  }
+  payload->waveform_levels = waveform->levels();
+  WaveformBucket* buckets = payload->waveform_buckets();
+  for (size_t level = 0; level < waveform->levels(); ++level) {
+    const std::vector<WaveformBucket>& completed = waveform->buckets(level);
+    WaveformRun& run = payload->waveform_runs()[level];
+    run.bucket_samples = waveform->bucket_samples(level);
+    run.sample_position = session->waveform_origin +
+                          waveform->first_bucket(level) * run.bucket_samples;
+    run.bucket_count = completed.size();
+    memcpy(buckets, completed.data(),
+           completed.size() * sizeof(WaveformBucket));
+    buckets += completed.size();
+  }
+  waveform->ClearBuckets();
+  QueuePayload(session, payload);
+}
+
+// Decimates |count| processed samples, emitting the buckets every
+// |waveform_piece| samples complete.
+void DecimateWaveform(CaptureSession* session, const int16_t* samples,
+                      size_t count, const ChunkTiming& timing) {
+  WaveformDecimator* waveform = session->waveform.get();
+  if (timing.frame_position != session->waveform_next_position) {
+    // Lost audio, or nobody listened: new buckets.
+    waveform->Reset();
+    session->waveform_origin = timing.frame_position;
+  }
+  session->waveform_next_position = timing.frame_position + count;
+
+  for (size_t offset = 0; offset < count;
+       offset += session->waveform_piece) {
+    waveform->Process(samples + offset,
+                      std::min(session->waveform_piece, count - offset));
+    if (waveform->buckets(0).empty()) {
+      continue;  // Coarser levels complete with a finer bucket only.
+    }
+    ChunkTiming waveform_timing;
+    waveform_timing.sequence = session->waveform_sequence++;
+    waveform_timing.frame_position =
+        session->waveform_origin +
+        waveform->first_bucket(0) * waveform->bucket_samples(0);
+    waveform_timing.capture_time =
+        timing.capture_time +
+        (static_cast<gint64>(waveform_timing.frame_position) -
+         static_cast<gint64>(timing.frame_position)) *
+            G_USEC_PER_SEC / session->config.sample_rate;
+    EmitWaveform(session, waveform_timing);
+  }
+}
+
+// Keeps the tail of a chunk a speech-only session held back, to lead into
+// the next chunk should that have speech.
+void HoldBack(CaptureSession* session, const int16_t* samples, size_t count,
+              guint64 position) {
+  std::vector<int16_t>& pre_roll = session->pre_roll;
+  const size_t capacity = session->pre_roll_capacity;
+  if (session->pre_roll_end != position) {
+    pre_roll.clear();  // Not contiguous with the chunk.
+  }
+  if (count >= capacity) {
+    pre_roll.assign(samples + count - capacity, samples + count);
+  } else {
+    const size_t keep = std::min(pre_roll.size(), capacity - count);
+    pre_roll.erase(pre_roll.begin(), pre_roll.end() - keep);
+    pre_roll.insert(pre_roll.end(), samples, samples + count);
+  }
+  session->pre_roll_end = position + count;
+}
+
+// Emits the utterance in progress, if any, as one chunk.
+void EndUtterance(CaptureSession* session, UtteranceEnd reason) {
+  if (!session->utterance_active) {
+    return;
+  }
+  session->utterance_active = false;
+  std::vector<int16_t>& utterance = session->utterance;
+  if (!utterance.empty()) {
+    ChunkTiming timing;
+    timing.sequence = session->utterance_sequence++;
+    timing.frame_position = session->utterance_position;
+    timing.capture_time = session->utterance_time;
+    EmitProcessed(session, utterance.data(), utterance.size(), kConsumePcm,
+                  timing, session->utterance_conversion_us, reason);
+  }
+  utterance.clear();
+  session->utterance_conversion_us = 0;
+}
+
+// Starts an utterance at |position|, led in by the audio held back just
+// before it.
+void StartUtterance(CaptureSession* session, guint64 position,
+                    gint64 capture_time) {
+  std::vector<int16_t>& utterance = session->utterance;
+  std::vector<int16_t>& pre_roll = session->pre_roll;
+  if (session->pre_roll_end != position) {
+    pre_roll.clear();
+  }
+  utterance.assign(pre_roll.begin(), pre_roll.end());
+  session->utterance_limit = pre_roll.size() + session->max_utterance_samples;
+  session->utterance_position = position - pre_roll.size();
+  session->utterance_time =
+      capture_time - static_cast<gint64>(pre_roll.size() * G_USEC_PER_SEC /
+                                         session->config.sample_rate);
+  session->utterance_active = true;
+  pre_roll.clear();
+}
+
+// Adds |count| samples of speech to the utterance in progress, splitting it
+// wherever it reaches its longest.
+void ExtendUtterance(CaptureSession* session, const int16_t* samples,
+                     size_t count) {
+  std::vector<int16_t>& utterance = session->utterance;
+  while (count > 0) {
+    const size_t take =
+        std::min(count, session->utterance_limit - utterance.size());
+    utterance.insert(utterance.end(), samples, samples + take);
+    samples += take;
+    count -= take;
+    if (utterance.size() == session->utterance_limit) {
+      const guint64 next = session->utterance_position + utterance.size();
+      const gint64 next_time =
+          session->utterance_time +
+          static_cast<gint64>(utterance.size() * G_USEC_PER_SEC /
+                              session->config.sample_rate);
+      EndUtterance(session, UtteranceEnd::kMaxDuration);
+      StartUtterance(session, next, next_time);
+    }
+  }
+}
+
+// Splits a chunk of a segmenting session at the |transition_count| speech
+// transitions just detected in it, adding speech to the utterance in
+// progress and holding back the rest as pre-roll.
+void SegmentUtterances(CaptureSession* session, const int16_t* samples,
+                       size_t count, bool was_speaking,
+                       size_t transition_count, const ChunkTiming& timing,
+                       gint64 conversion_us) {
+  const int sample_rate = session->config.sample_rate;
+  if (session->utterance_active &&
+      session->utterance_position + session->utterance.size() !=
+          timing.frame_position) {
+    EndUtterance(session, UtteranceEnd::kGap);
+  }
+  if (was_speaking && !session->utterance_active) {
+    // Speech going on after lost audio, or since listening started.
+    StartUtterance(session, timing.frame_position, timing.capture_time);
+  }
+  if (session->utterance_active) {
+    session->utterance_conversion_us += conversion_us;
+  }
+
+  size_t offset = 0;
+  for (size_t i = 0; i <= transition_count; ++i) {
+    const size_t end =
+        i < transition_count ? session->voice_transitions[i].offset : count;
+    if (session->utterance_active) {
+      ExtendUtterance(session, samples + offset, end - offset);
+    } else {
+      HoldBack(session, samples + offset, end - offset,
+               timing.frame_position + offset);
+    }
+    offset = end;
+    if (i == transition_count) {
+      break;
+    }
+    if (!session->voice_transitions[i].speech) {
+      EndUtterance(session, UtteranceEnd::kSilence);
+    } else if (!session->utterance_active) {
+      StartUtterance(session, timing.frame_position + offset,
+                     timing.capture_time +
+                         static_cast<gint64>(offset * G_USEC_PER_SEC /
+                                             sample_rate));
+    }
+  }
+}
+
+// Hands a processed chunk of a single-source session on for emission,
+// after voice activity detection: reports speech starting and ending and,
+// in speech-only sessions, holds back the samples of chunks without
+// speech.
+void EmitOutput(CaptureSession* session, const int16_t* samples,
+                size_t count, gint consumers, const ChunkTiming& timing,
+                gint64 conversion_us) {
+  VoiceDetector* voice = session->voice.get();
+  if (voice == nullptr) {
+    EmitProcessed(session, samples, count, consumers, timing, conversion_us);
+    return;
+  }
+
+  const int sample_rate = session->config.sample_rate;
+  const bool was_speaking = voice->speaking();
+  const size_t transition_count =
+      voice->Process(samples, count, session->voice_transitions.data(),
+                     session->voice_transitions.size());
+  session->speech_probability = voice->probability();
+  for (size_t i = 0; i < transition_count; ++i) {
+    const VoiceTransition& transition = session->voice_transitions[i];
+    ReportSpeech(session, transition.speech,
+                 timing.frame_position + transition.offset,
+                 timing.capture_time +
+                     static_cast<gint64>(transition.offset * G_USEC_PER_SEC /
+                                         sample_rate),
+                 session->speech_probability);
+  }
+
+  if (session->config.segment_utterances) {
+    // Samples go out as utterances, levels per chunk.
+    if (consumers & kConsumePcm) {
+      SegmentUtterances(session, samples, count, was_speaking,
+                        transition_count, timing, conversion_us);
+    } else {
+      session->utterance_active = false;
+      session->utterance.clear();
+      session->utterance_conversion_us = 0;
+    }
+    if (consumers & kConsumeDecibel) {
+      EmitProcessed(session, samples, count, kConsumeDecibel, timing,
+                    conversion_us);
+    }
+    return;
+  }
+  if (!session->config.speech_only || !(consumers & kConsumePcm)) {
+    EmitProcessed(session, samples, count, consumers, timing, conversion_us);
+    return;
+  }
+  if (!was_speaking && transition_count == 0) {
+    HoldBack(session, samples, count, timing.frame_position);
+    if (consumers & kConsumeDecibel) {
+      EmitProcessed(session, samples, count, kConsumeDecibel, timing,
+                    conversion_us);
+    }
+    return;
+  }
+
+  // Speech: lead in with the audio held back just before it, if any.
+  std::vector<int16_t>& pre_roll = session->pre_roll;
+  if (pre_roll.empty() || session->pre_roll_end != timing.frame_position) {
+    pre_roll.clear();
+    EmitProcessed(session, samples, count, consumers, timing, conversion_us);
+    return;
+  }
+  std::vector<int16_t>& output = session->voice_output;
+  output.assign(pre_roll.begin(), pre_roll.end());
+  output.insert(output.end(), samples, samples + count);
+  ChunkTiming lead_timing = timing;
+  lead_timing.frame_position -= pre_roll.size();
+  lead_timing.capture_time -= static_cast<gint64>(
+      pre_roll.size() * G_USEC_PER_SEC / sample_rate);
+  pre_roll.clear();
+  EmitProcessed(session, output.data(), output.size(), consumers,
+                lead_timing, conversion_us);
+}
+
+// Emits the assembled frames as one chunk, whether complete or cut short by
+// lost audio.
+void FlushAssembly(CaptureSession* session) {
+  std::vector<int16_t>& assembly = session->assembly;
+  if (assembly.empty()) {
+    return;
+  }
+  ChunkTiming timing;
+  timing.sequence = session->chunk_sequence++;
+  timing.frame_position = session->assembly_position;
+  timing.capture_time = session->assembly_time;
+  // Levels come from the meter; assembled chunks carry samples only.
+  EmitOutput(session, assembly.data(), assembly.size(), kConsumePcm, timing,
+             session->assembly_conversion_us);
+  assembly.clear();
+  session->assembly_conversion_us = 0;
+}
+
+// Adds |count| processed frames starting at |timing| to the assembly and
+// emits every chunk they complete.
+void AssembleOutput(CaptureSession* session, const int16_t* frames,
+                    size_t count, const ChunkTiming& timing,
+                    gint64 conversion_us) {
+  const CaptureSessionConfig& config = session->config;
+  const int sample_rate = config.sample_rate;
+  const size_t chunk_frames =
+      config.chunk_size / (sizeof(int16_t) * config.channels);
+  std::vector<int16_t>& assembly = session->assembly;
+  session->assembly_conversion_us += conversion_us;
+  size_t offset = 0;
+  while (offset < count) {
+    if (assembly.empty()) {
+      session->assembly_position = timing.frame_position + offset;
+      session->assembly_time =
+          timing.capture_time +
+          static_cast<gint64>(offset * G_USEC_PER_SEC / sample_rate);
+    }
+    const size_t take =
+        std::min(count - offset, chunk_frames - assembly.size());
+    assembly.insert(assembly.end(), frames + offset, frames + offset + take);
+    offset += take;
+    if (assembly.size() == chunk_frames) {
+      FlushAssembly(session);
+    }
+  }
+}
+
+void ProcessChunk(CaptureSession* session, RawChunk* chunk) {
+  const CaptureSessionConfig& config = session->config;
+
+  // Lost audio is either reported only, or also replaced by silence ahead
+  // of this chunk so its sample position stays exact.
+  const guint64 gap = TakeGap(session, chunk);
+  const size_t max_fill =
+      static_cast<size_t>(config.sample_rate) * kMaxGapFillMs / 1000;
+  const size_t lead_in = config.fill_gaps && gap <= max_fill ? gap : 0;
+  if (gap > 0) {
+    ReportGap(session, chunk, gap, lead_in > 0);
+  }
+
+  // Everything downstream, levels included, sees the filtered audio.
+  if (session->filters != nullptr) {
+    if (gap > 0) {
+      session->filters->Reset();  // Lost audio would ring on.
+    }
+    session->filters->Process(reinterpret_cast<int16_t*>(chunk->data),
+                              chunk->frames);
+  }
+
+  int16_t* samples = reinterpret_cast<int16_t*>(chunk->data);
+  const size_t input_frame_count = chunk->frames;
+  if (session->loudness != nullptr) {
+    MeasureLoudness(session, samples, input_frame_count);
+  }
+
+  // Without listeners only the timeline above moves on.
+  gint consumers = SessionConsumers(session);
+  const bool metered = session->meter != nullptr;
+  if (metered) {
+    // Levels are measured on the audio as read, at the meter's own rate.
+    if (gap > 0) {
+      session->meter->Reset();  // A period never spans lost audio.
+    }
+    MeterFrames(session, samples, input_frame_count, chunk->timing,
+                consumers);
+    if (config.meter_only) {
+      return;
+    }
+    consumers &= ~kConsumeDecibel;
+    if (consumers == 0) {
+      session->assembly.clear();
+      session->assembly_conversion_us = 0;
+      return;
+    }
+    if (gap > 0 && lead_in == 0) {
+      // A chunk never spans lost audio either; the skipped sequence number
+      // marks the loss.
+      FlushAssembly(session);
+      session->chunk_sequence++;
+    }
+  }
+  if (consumers == 0) {
+    return;
+  }
+
+  // Apply input volume
+  ApplyInputVolume(samples, input_frame_count * config.channels,
+                   config.input_volume);
+
+  std::vector<int16_t>& output = session->output_buffer;
+  g_assert(output.size() >= lead_in + input_frame_count);
+  std::fill_n(output.begin(), lead_in, 0);
+
+  ChunkTiming timing = chunk->timing;
+  timing.frame_position -= lead_in;
+  timing.capture_time -= static_cast<gint64>(lead_in * G_USEC_PER_SEC /
+                                             config.sample_rate);
+  const int16_t* gain_input = samples;
+  int gain_channels = config.channels;
+  int16_t* gain_output = output.data() + lead_in;
+  size_t gain_count = input_frame_count;
+  if (session->denoiser != nullptr) {
+    // Noise is learned and removed at unity gain, before the boost raises
+    // its floor and the clamp or limiter distorts it; the boost then
+    // applies to the denoised, delayed output, lead-in included.
+    ApplyGainBoostAndConvertToMono(samples, gain_output, input_frame_count,
+                                   config.channels, 1.0f);
+    if (timing.frame_position != session->denoise_next_position) {
+      session->denoiser->Reset();  // The noise estimate carries on.
+    }
+    session->denoiser->Process(output.data(), lead_in + input_frame_count);
+    session->denoise_next_position =
+        timing.frame_position + lead_in + input_frame_count;
+    gain_input = output.data();
+    gain_channels = 1;
+    gain_output = output.data();
+    gain_count = lead_in + input_frame_count;
+  }
+
+  // Process audio: convert to mono and apply gain boost
+  if (session->compressor != nullptr) {
+    // Gained past full scale, then brought back within it.
+    std::vector<float>& gained = session->gained_buffer;
+    g_assert(gained.size() >= gain_count);
+    ApplyGainBoostAndConvertToMono(gain_input, gained.data(), gain_count,
+                                   gain_channels, config.gain_boost);
+    session->compressor->Process(gained.data(), gain_output, gain_count);
+  } else {
+    ApplyGainBoostAndConvertToMono(gain_input, gain_output, gain_count,
+                                   gain_channels, config.gain_boost);
+  }
+  if (session->agc != nullptr) {
+    if (timing.frame_position != session->agc_next_position) {
+      session->agc->Reset();  // The gain carries on.
+    }
+    session->agc->Process(output.data(), lead_in + input_frame_count);
+    session->agc_next_position =
+        timing.frame_position + lead_in + input_frame_count;
+  }
+  if (consumers & kConsumeAnalysis) {
+    if (consumers & kConsumeFeatures) {
+      ExtractFeatures(session, output.data(), lead_in + input_frame_count,
+                      timing);
+    }
+    if (consumers & kConsumeSpectrum) {
+      AnalyzeSpectrum(session, output.data(), lead_in + input_frame_count,
+                      timing);
+    }
+    if (consumers & kConsumeWaveform) {
+      DecimateWaveform(session, output.data(), lead_in + input_frame_count,
+                       timing);
+    }
+    consumers &= ~kConsumeAnalysis;
+    if (consumers == 0) {
+      session->assembly.clear();
+      session->assembly_conversion_us = 0;
+      return;
+    }
+  }
+  if (metered) {
+    AssembleOutput(session, output.data(), lead_in + input_frame_count,
+                   timing, chunk->conversion_us);
+    return;
+  }
+  EmitOutput(session, output.data(), lead_in + input_frame_count, consumers,
+             timing, chunk->conversion_us);
+}
+
+// Puts the tracks of a synced session on one timeline. Until every source
+// has delivered its first chunk nothing can be aligned; afterwards the track
+// that started later is preceded by silence for the difference, so equal
+// sample positions mean equal capture times from then on.
+void AlignSyncedSources(CaptureSession* session) {
+  const int sample_rate = session->config.sample_rate;
+  const size_t max_backlog =
+      static_cast<size_t>(sample_rate) * kMaxSyncBacklogMs / 1000;
+
+  if (!session->aligned) {
+    gint64 origin = G_MAXINT64;
+    bool all_started = true;
+    for (int i = 0; i < session->source_count; ++i) {
+      const CaptureSource& source = session->sources[i];
+      if (source.first_frame_time == 0) {
+        all_started = false;
+      } else {
+        origin = std::min(origin, source.first_frame_time);
+      }
+    }
+
+    if (!all_started) {
+      // Keep only the most recent audio of the sources already running.
+      for (int i = 0; i < session->source_count; ++i) {
+        CaptureSource& source = session->sources[i];
+        if (source.frames.size() > max_backlog) {
+          const size_t excess = source.frames.size() - max_backlog;
+          source.frames.erase(source.frames.begin(),
+                              source.frames.begin() + excess);
+          source.first_frame_time += static_cast<gint64>(excess) *
+                                     G_USEC_PER_SEC / sample_rate;
+        }
+      }
+      return;
+    }
+
+    for (int i = 0; i < session->source_count; ++i) {
+      CaptureSource& source = session->sources[i];
+      const size_t lead_in = static_cast<size_t>(
+          (source.first_frame_time - origin) * sample_rate / G_USEC_PER_SEC);
+      source.frames.insert(source.frames.begin(), lead_in, 0);
+    }
+    session->aligned = TRUE;
+    session->timeline_origin = origin;
+  }
+
+  // A stalled track is padded with silence so the other keeps flowing. Its
+  // late audio then skips the padded frames to stay on the timeline.
+  size_t longest = 0;
+  for (int i = 0; i < session->source_count; ++i) {
+    longest = std::max(longest, session->sources[i].frames.size());
+  }
+  if (longest <= max_backlog) {
+    return;
+  }
+  for (int i = 0; i < session->source_count; ++i) {
+    CaptureSource& source = session->sources[i];
+    const size_t missing = longest - source.frames.size();
+    if (missing > 0) {
+      source.frames.insert(source.frames.end(), missing, 0);
+      source.frames_owed += missing;
+    }
+  }
+}
+
+// Adds a block of both tracks, at unity gain, to the session's delay
+// estimate, and reports each new estimate in the stats and as an event.
+void EstimateDelay(CaptureSession* session, const int16_t* mic,
+                   const int16_t* system, size_t frames,
+                   const ChunkTiming& timing) {
+  if (timing.frame_position != session->delay_next_position) {
+    session->delay->Reset();
+  }
+  session->delay_next_position = timing.frame_position + frames;
+  if (!session->delay->Process(mic, system, frames)) {
+    return;
+  }
+  const DelayEstimate& estimate = session->delay->estimate();
+  g_mutex_lock(&session->stats_lock);
+  session->stats.has_delay = TRUE;
+  session->stats.delay = estimate;
+  g_mutex_unlock(&session->stats_lock);
+
+  auto* payload = new DelayPayload();
+  payload->session = CaptureSessionRef(session);
+  payload->estimate = estimate;
+  payload->sample_position = session->delay_next_position;
+  payload->capture_time =
+      timing.capture_time +
+      static_cast<gint64>(frames * G_USEC_PER_SEC /
+                          session->config.sample_rate);
+  g_main_context_invoke_full(session->host->main_context, G_PRIORITY_DEFAULT,
+                             EmitDelayOnMainThread, payload, nullptr);
+}
+
+// Writes |count| gained samples to every |stride|-th sample of |output|,
+// compressed by |compressor|, or clamped to full scale without one.
+void WriteGained(Compressor* compressor, const float* gained,
+                 int16_t* output, size_t count, size_t stride) {
+  if (compressor != nullptr) {
+    compressor->Process(gained, output, count, stride);
+    return;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    output[i * stride] = ClampToInt16(gained[i]);
+  }
+}
+
+// Emits every block that is complete on all tracks.
+void EmitSyncedBlocks(CaptureSession* session) {
+  const size_t block_frames =
+      session->config.chunk_size /
+      (sizeof(int16_t) * session->config.channels);
+  const SyncedCaptureConfig& synced = session->synced_config;
+  std::vector<int16_t>& mic = session->sources[kMicSource].frames;
+  std::vector<int16_t>& system = session->sources[kSystemSource].frames;
+  const gint consumers = SessionConsumers(session);
+  // The delay is estimated whether or not anyone takes the output: its
+  // events and the stats have listeners of their own.
+  const bool estimating = session->delay != nullptr;
+
+  // The tracks are gained as floats, then compressed or clamped.
+  Compressor* compressor = session->compressor.get();
+  g_assert(session->gained_buffer.size() >= block_frames);
+  float* gained = session->gained_buffer.data();
+
+  // Blocks are read at |consumed| and the tracks compacted once at the
+  // end, so a backlog costs one shift rather than one per block.
+  size_t consumed = 0;
+  while (session->aligned && mic.size() - consumed >= block_frames &&
+         system.size() - consumed >= block_frames) {
+    const int16_t* mic_block = mic.data() + consumed;
+    const int16_t* system_block = system.data() + consumed;
+    int16_t* output = session->output_buffer.data();
+    size_t sample_count = block_frames;
+
+    if (consumers == 0) {
+      // Nobody listens: the block only moves the timeline on.
+    } else if (synced.mode == SyncedOutputMode::kInterleaved) {
+      for (size_t i = 0; i < block_frames; ++i) {
+        gained[i] = mic_block[i] * synced.mic_gain;
+      }
+      WriteGained(compressor, gained, output, block_frames, 2);
+      for (size_t i = 0; i < block_frames; ++i) {
+        gained[i] = system_block[i] * synced.system_gain;
+      }
+      WriteGained(session->system_compressor.get(), gained, output + 1,
+                  block_frames, 2);
+      sample_count = block_frames * 2;
+    } else if (synced.mode == SyncedOutputMode::kEchoCancelled) {
+      // Cancelled at unity gain against the system track as played, and
+      // gained only after: a clipped microphone is no longer a linear echo
+      // path the filter can model.
+      std::copy_n(mic_block, block_frames, output);
+      if (session->emitted_frames != session->echo_next_position) {
+        session->echo->Reset();  // The echo path and delay carry on.
+      }
+      session->echo->Process(output, system_block, block_frames);
+      session->echo_next_position = session->emitted_frames + block_frames;
+      for (size_t i = 0; i < block_frames; ++i) {
+        gained[i] = output[i] * synced.mic_gain;
+      }
+      WriteGained(compressor, gained, output, block_frames, 1);
+      g_mutex_lock(&session->stats_lock);
+      session->stats.has_echo = TRUE;
+      session->stats.echo_delay_frames = session->echo->delay();
+      session->stats.echo_erle_db = session->echo->erle_db();
+      g_mutex_unlock(&session->stats_lock);
+    } else {
+      for (size_t i = 0; i < block_frames; ++i) {
+        gained[i] = mic_block[i] * synced.mic_gain +
+                    system_block[i] * synced.system_gain;
+      }
+      WriteGained(compressor, gained, output, block_frames, 1);
+    }
+
+    ChunkTiming timing;
+    timing.sequence = session->emitted_blocks++;
+    timing.frame_position = session->emitted_frames;
+    timing.capture_time =
+        session->timeline_origin +
+        static_cast<gint64>(session->emitted_frames * G_USEC_PER_SEC /
+                            session->config.sample_rate);
+    session->emitted_frames += block_frames;
+
+    if (estimating) {
+      EstimateDelay(session, mic_block, system_block, block_frames, timing);
+    }
+    if (consumers != 0) {
+      EmitProcessed(session, output, sample_count, consumers, timing,
+                    session->pending_conversion_us);
+    }
+    session->pending_conversion_us = 0;
+    consumed += block_frames;
+  }
+  mic.erase(mic.begin(), mic.begin() + consumed);
+  system.erase(system.begin(), system.begin() + consumed);
+}
+
+void ProcessSyncedChunk(CaptureSession* session, RawChunk* chunk) {
+  const CaptureSessionConfig& config = session->config;
+  CaptureSource& source = session->sources[chunk->source];
+
+  // Without listeners the tracks still advance and stay aligned, but
+  // their frames are left silent, unless the delay estimator reads them.
+  const bool consumed =
+      SessionConsumers(session) != 0 || session->delay != nullptr;
+  int16_t* samples = reinterpret_cast<int16_t*>(chunk->data);
+  if (consumed) {
+    ApplyInputVolume(samples, chunk->frames * config.channels,
+                     config.input_volume);
+  }
+  session->pending_conversion_us += chunk->conversion_us;
+
+  // Frame 0 of the source, even if the chunks before this one were lost.
+  if (source.first_frame_time == 0) {
+    source.first_frame_time =
+        chunk->timing.capture_time -
+        static_cast<gint64>(chunk->timing.frame_position * G_USEC_PER_SEC /
+                            config.sample_rate);
+  }
+
+  // Lost audio always becomes silence here, or the track would shift
+  // against the other one. Silence already padded for a stall counts.
+  const guint64 gap = TakeGap(session, chunk);
+  if (gap > 0) {
+    ReportGap(session, chunk, gap, TRUE);
+    const size_t covered =
+        static_cast<size_t>(std::min<guint64>(source.frames_owed, gap));
+    source.frames_owed -= covered;
+    source.frames.insert(source.frames.end(), gap - covered, 0);
+  }
+
+  // Downmix at unity gain; the track gains are applied on output.
+  const size_t frame_count = chunk->frames;
+  const size_t offset = source.frames.size();
+  source.frames.resize(offset + frame_count);
+  if (consumed) {
+    ApplyGainBoostAndConvertToMono(samples, source.frames.data() + offset,
+                                   frame_count, config.channels, 1.0f);
+  }
+
+  const size_t skipped = std::min(source.frames_owed, frame_count);
+  if (skipped > 0) {
+    source.frames.erase(source.frames.begin() + offset,
+                        source.frames.begin() + offset + skipped);
+    source.frames_owed -= skipped;
+  }
+
+  AlignSyncedSources(session);
+  EmitSyncedBlocks(session);
+}
+
+bool HasReadyChunks(CaptureSession* session) {
+  for (int i = 0; i < session->source_count; ++i) {
+    if (session->sources[i].ready_chunks->Size() > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Converts |chunk| in place from its source's capture format to S16 at the
+// session rate and moves its timing along: positions count session-rate
+// frames and times follow from them. After lost audio the resampler starts
+// over at the position the gap ends at, so gaps keep their length in time;
+// the few frames it still held back are reported as part of the gap.
+void ConvertChunk(CaptureSession* session, RawChunk* chunk) {
+  CaptureSource& source = session->sources[chunk->source];
+  const gint64 start_time = g_get_monotonic_time();
+  const size_t channels = static_cast<size_t>(session->config.channels);
+
+  if (source.resampler == nullptr) {
+    // Same rate: only the format changes, narrowing in place.
+    source.input_converter->Convert(chunk->data, chunk->data,
+                                    chunk->frames * channels);
+  } else {
+    const guint64 capture_rate = static_cast<guint64>(source.capture_rate);
+    const guint64 sample_rate =
+        static_cast<guint64>(session->config.sample_rate);
+
+    const guint64 position = chunk->timing.frame_position;
+    if (position != source.resample_next) {
+      source.resampler->Reset();
+      source.resample_position = position * sample_rate / capture_rate;
+    }
+    source.resample_next = position + chunk->frames;
+
+    size_t frames = 0;
+    if (source.input_converter == nullptr) {
+      int16_t* samples = reinterpret_cast<int16_t*>(chunk->data);
+      const size_t capacity = chunk->size / (sizeof(int16_t) * channels);
+      frames =
+          source.resampler->Process(samples, chunk->frames, samples, capacity);
+    } else {
+      // Resampled as floats, so the source's extra resolution is only
+      // rounded away once, with dither, at the end.
+      float* samples = source.float_frames.data();
+      source.input_converter->Convert(chunk->data, samples,
+                                      chunk->frames * channels);
+      frames = source.resampler->Process(samples, chunk->frames, samples,
+                                         source.float_frames.size() / channels);
+      source.output_converter->Convert(samples, chunk->data,
+                                       frames * channels);
+    }
+
+    // The capture time of the converted position on the capture timeline.
+    const guint64 converted = source.resample_position;
+    chunk->timing.capture_time +=
+        static_cast<gint64>(converted * G_USEC_PER_SEC / sample_rate) -
+        static_cast<gint64>(position * G_USEC_PER_SEC / capture_rate);
+    chunk->timing.frame_position = converted;
+    chunk->overflow_frames =
+        chunk->overflow_frames * sample_rate / capture_rate;
+    chunk->frames = frames;
+    source.resample_position += frames;
+  }
+
+  chunk->conversion_us = g_get_monotonic_time() - start_time;
+  g_mutex_lock(&session->stats_lock);
+  SessionStats& stats = session->stats;
+  stats.converted_chunks++;
+  stats.conversion_total_us += chunk->conversion_us;
+  stats.conversion_max_us =
+      std::max(stats.conversion_max_us, chunk->conversion_us);
+  g_mutex_unlock(&session->stats_lock);
+}
+
+void ProcessReadyChunk(CaptureSession* session, RawChunk* chunk) {
+  const gint64 start_time = g_get_monotonic_time();
+  const CaptureSource& source = session->sources[chunk->source];
+  if (source.resampler != nullptr || source.input_converter != nullptr) {
+    ConvertChunk(session, chunk);
+  }
+  if (session->synced) {
+    ProcessSyncedChunk(session, chunk);
+  } else {
+    ProcessChunk(session, chunk);
+  }
+  const gint64 end_time = g_get_monotonic_time();
+
+  g_mutex_lock(&session->stats_lock);
+  SessionStats& stats = session->stats;
+  stats.ready_wait_max_us =
+      std::max(stats.ready_wait_max_us, start_time - chunk->read_time);
+  stats.processed_chunks++;
+  stats.processing_total_us += end_time - start_time;
+  stats.processing_max_us =
+      std::max(stats.processing_max_us, end_time - start_time);
+  g_mutex_unlock(&session->stats_lock);
+}
+
+void ProcessSessionTask(gpointer data, gpointer user_data) {
+  CaptureSession* session = static_cast<CaptureSession*>(data);
+  (void)user_data;
+
+  while (true) {
+    // Take turns between the sources so one busy track cannot starve the
+    // other.
+    bool processed = false;
+    for (int i = 0; i < session->source_count; ++i) {
+      RawChunk* chunk = nullptr;
+      if (!session->sources[i].ready_chunks->Pop(&chunk)) {
+        continue;
+      }
+      if (!g_atomic_int_get(&session->should_stop)) {
+        ProcessReadyChunk(session, chunk);
+      }
+      ReleaseChunk(session, chunk);
+      processed = true;
+    }
+    if (processed) {
+      continue;
+    }
+
+    g_atomic_int_set(&session->processing_scheduled, 0);
+    // A chunk queued between the last pop and the reset would otherwise wait
+    // for the next one.
+    if (HasReadyChunks(session) &&
+        g_atomic_int_compare_and_exchange(&session->processing_scheduled, 0,
+                                          1)) {
+      continue;
+    }
+    break;
+  }
+
+  CaptureSessionUnref(session);
+}
+
+// Hands a chunk to the processing worker. Returns false, leaving |chunk|
+// with the reader, if the worker is too far behind. Reader only.
+bool QueueChunk(CaptureSource* source, RawChunk* chunk) {
+  CaptureSession* session = source->session;
+  if (!source->ready_chunks->Push(chunk)) {
+    return false;
+  }
+
+  // Only an idle session needs waking; a running worker keeps draining.
+  if (g_atomic_int_compare_and_exchange(&session->processing_scheduled, 0,
+                                        1)) {
+    g_thread_pool_push(GetProcessingPool(), CaptureSessionRef(session),
+                       nullptr);
+  }
+  return true;
+}
+
+void FinishSession(CaptureSession* session);
+
+gboolean EndSessionOnMainThread(gpointer user_data) {
+  CaptureSession* session = static_cast<CaptureSession*>(user_data);
+  FinishSession(session);
+  CaptureSessionUnref(session);
+  return G_SOURCE_REMOVE;
+}
+
+// Monotonic capture time of the first frame of a chunk of |frame_count|
+// frames that was just read: the newest frame is |latency| old. Anchors the
+// timeline of a source; later chunks are placed by their sample position.
+gint64 EstimateCaptureTime(pa_simple* stream, size_t frame_count,
+                           int sample_rate) {
+  int error = 0;
+  pa_usec_t latency = pa_simple_get_latency(stream, &error);
+  if (latency == static_cast<pa_usec_t>(-1)) {
+    latency = 0;
+  }
+  const gint64 chunk_duration =
+      static_cast<gint64>(frame_count) * G_USEC_PER_SEC / sample_rate;
+  return g_get_monotonic_time() - static_cast<gint64>(latency) -
+         chunk_duration;
+}
+
+// Applies the opt-in scheduling of |session| to the calling reader thread.
+void ConfigureReaderThread(CaptureSession* session) {
+  const CaptureSessionConfig& config = session->config;
+  if (config.cpu_mask != 0 && !PinCurrentThread(config.cpu_mask)) {
+    g_warning("Failed to pin capture thread to CPU mask 0x%" G_GINT64_MODIFIER
+              "x", config.cpu_mask);
+  }
+  if (!config.realtime) {
+    return;
+  }
+
+  const ThreadScheduling scheduling =
+      MakeCurrentThreadRealtime(config.realtime_priority);
+  if (scheduling == ThreadScheduling::kNormal) {
+    g_warning("Real-time scheduling not permitted; capturing at normal "
+              "priority");
+  } else {
+    g_mutex_lock(&session->stats_lock);
+    session->stats.realtime_readers++;
+    session->stats.scheduling = scheduling;
+    g_mutex_unlock(&session->stats_lock);
+  }
+  if (!PrefaultAndLockStack()) {
+    g_warning("Failed to lock capture thread stack (RLIMIT_MEMLOCK)");
+  }
+}
+
+void RecordReadJitter(CaptureSession* session, gint64 jitter) {
+  int bucket = 0;
+  while (bucket < kJitterBuckets - 1 &&
+         jitter > kJitterBucketBoundsUs[bucket]) {
+    ++bucket;
+  }
+
+  g_mutex_lock(&session->stats_lock);
+  SessionStats& stats = session->stats;
+  stats.jitter_samples++;
+  stats.jitter_total_us += jitter;
+  stats.jitter_max_us = std::max(stats.jitter_max_us, jitter);
+  stats.jitter_histogram[bucket]++;
+  g_mutex_unlock(&session->stats_lock);
+}
+
+gpointer ReaderThread(gpointer user_data) {
+  CaptureSource* source = static_cast<CaptureSource*>(user_data);
+  CaptureSession* session = source->session;
+  // Samples, positions and times here are in the format the stream was
+  // opened in; the worker converts them to the session's.
+  const size_t chunk_size = source->capture_chunk_size;
+  const size_t frame_count =
+      chunk_size / (SampleFormatBytes(source->sample_format) *
+                    static_cast<size_t>(session->config.channels));
+  const int sample_rate = source->capture_rate;
+  const gint64 overflow_threshold = std::max(
+      kMinOverflowUs,
+      static_cast<gint64>(frame_count) * G_USEC_PER_SEC / sample_rate / 2);
+  const gint64 chunk_duration =
+      static_cast<gint64>(frame_count) * G_USEC_PER_SEC / sample_rate;
+  gint64 anchor_time = 0;
+  gint64 clock_offset = 0;  // Smoothed drift of the estimate vs. the counter.
+  gint64 last_read_time = 0;
+  guint64 frames_read = 0;
+  guint64 sequence = 0;
+  RawChunk* spare = nullptr;  // Chunk the worker had no room for.
+
+  ConfigureReaderThread(session);
+
+  while (!g_atomic_int_get(&session->should_stop)) {
+    RawChunk* chunk = spare != nullptr ? spare : AcquireChunk(source);
+    spare = nullptr;
+    chunk->source = source->index;
+    chunk->overflow_frames = 0;
+    chunk->frames = frame_count;
+    chunk->conversion_us = 0;
+
+    int error = 0;
+    if (pa_simple_read(source->stream, chunk->data, chunk_size, &error) < 0) {
+      g_warning("PulseAudio read error: %s", pa_strerror(error));
+      DestroyChunk(chunk);
+      break;
+    }
+
+    if (g_atomic_int_get(&session->should_stop)) {
+      DestroyChunk(chunk);
+      break;
+    }
+
+    const gint64 read_time = g_get_monotonic_time();
+    chunk->read_time = read_time;
+    if (last_read_time != 0) {
+      const gint64 interval = read_time - last_read_time;
+      RecordReadJitter(session, interval > chunk_duration
+                                    ? interval - chunk_duration
+                                    : chunk_duration - interval);
+    }
+    last_read_time = read_time;
+
+    // The sample counter, not the read time, advances the timeline, so
+    // scheduling delays of this thread do not show up as jitter. Audio the
+    // server discarded while its buffer was full is the one thing the
+    // counter cannot see: it shows up as the capture time estimate running
+    // ahead, and the counter skips the lost frames.
+    const gint64 estimated_time =
+        EstimateCaptureTime(source->stream, frame_count, sample_rate);
+    if (anchor_time == 0) {
+      anchor_time = estimated_time;
+    } else {
+      const gint64 expected_time =
+          anchor_time +
+          static_cast<gint64>(frames_read * G_USEC_PER_SEC / sample_rate);
+      const gint64 offset = estimated_time - expected_time - clock_offset;
+      if (offset > overflow_threshold) {
+        chunk->overflow_frames =
+            static_cast<guint64>(offset) * sample_rate / G_USEC_PER_SEC;
+        frames_read += chunk->overflow_frames;
+      } else {
+        clock_offset += offset / 16;
+      }
+    }
+    chunk->timing.sequence = sequence++;
+    chunk->timing.frame_position = frames_read;
+    chunk->timing.capture_time =
+        anchor_time +
+        static_cast<gint64>(frames_read * G_USEC_PER_SEC / sample_rate);
+    frames_read += frame_count;
+
+    // Dropping the newest chunk keeps the reader from ever waiting on the
+    // worker; the overrun is reported like one of the server's.
+    const bool queued = QueueChunk(source, chunk);
+    if (!queued) {
+      spare = chunk;
+    }
+    const size_t depth = source->ready_chunks->Size();
+    g_mutex_lock(&session->stats_lock);
+    session->stats.chunks_captured++;
+    if (queued) {
+      session->stats.ready_high_water =
+          std::max(session->stats.ready_high_water, static_cast<guint64>(depth));
+    } else {
+      session->stats.dropped_chunks++;
+    }
+    g_mutex_unlock(&session->stats_lock);
+  }
+
+  if (spare != nullptr) {
+    DestroyChunk(spare);
+  }
+
+  pa_simple_free(source->stream);
+  source->stream = nullptr;
+
+  // The stream failed on its own; tear the session down on the main thread.
+  if (!g_atomic_int_get(&session->should_stop)) {
+    g_main_context_invoke_full(session->host->main_context, G_PRIORITY_DEFAULT,
+                               EndSessionOnMainThread,
+                               CaptureSessionRef(session), nullptr);
+  }
+
+  CaptureSessionUnref(session);
+  return nullptr;
+}
+
+// Joins the readers, unregisters the session and reports it inactive. The
+// caller must hold its own reference. Main thread only; safe to call more
+// than once.
+void FinishSession(CaptureSession* session) {
+  if (session->finished) {
+    return;
+  }
+  session->finished = TRUE;
+
+  g_atomic_int_set(&session->should_stop, 1);
+  for (int i = 0; i < session->source_count; ++i) {
+    CaptureSource& source = session->sources[i];
+    if (source.reader_thread != nullptr) {
+      g_thread_join(source.reader_thread);
+      source.reader_thread = nullptr;
+    }
+  }
+
+  DetachEmitSource(session);
+  if (session->event_channel != nullptr) {
+    g_clear_object(&session->event_channel);
+  }
+  if (session->features_channel != nullptr) {
+    g_clear_object(&session->features_channel);
+  }
+  if (session->spectrum_channel != nullptr) {
+    g_clear_object(&session->spectrum_channel);
+  }
+  if (session->waveform_channel != nullptr) {
+    g_clear_object(&session->waveform_channel);
+  }
+
+  g_mutex_lock(&session->stats_lock);
+  const SessionStats stats = session->stats;
+  g_mutex_unlock(&session->stats_lock);
+  if (stats.overruns > 0) {
+    g_warning("Capture session %u lost %" G_GUINT64_FORMAT
+              " frames in %" G_GUINT64_FORMAT " overruns",
+              session->id, stats.lost_frames, stats.overruns);
+  }
+
+  CaptureHostSendStatus(session->host, FALSE, session->id,
+                        session->device_name);
+
+  g_mutex_lock(&g_sessions_lock);
+  g_hash_table_remove(g_sessions, GUINT_TO_POINTER(session->id));
+  g_mutex_unlock(&g_sessions_lock);
+  CaptureSessionUnref(session);  // The registry's reference.
+}
+
+// Returns a new reference to the session |session_id| of |host|, or nullptr.
+CaptureSession* LookupSession(CaptureHost* host, guint session_id) {
+  CaptureSession* session = nullptr;
+  g_mutex_lock(&g_sessions_lock);
+  if (g_sessions != nullptr) {
+    session = static_cast<CaptureSession*>(
+        g_hash_table_lookup(g_sessions, GUINT_TO_POINTER(session_id)));
+    if (session != nullptr && session->host == host) {
+      CaptureSessionRef(session);
+    } else {
+      session = nullptr;
+    }
+  }
+  g_mutex_unlock(&g_sessions_lock);
+  return session;
+}
+
+FlMethodErrorResponse* OnSessionListenHandler(FlEventChannel* channel,
+                                              FlValue* arguments,
+                                              gpointer user_data) {
+  CaptureSession* session = static_cast<CaptureSession*>(user_data);
+  (void)channel;
+  (void)arguments;
+  g_atomic_int_set(&session->has_listener, 1);
+  return nullptr;
+}
+
+FlMethodErrorResponse* OnSessionCancelHandler(FlEventChannel* channel,
+                                              FlValue* arguments,
+                                              gpointer user_data) {
+  CaptureSession* session = static_cast<CaptureSession*>(user_data);
+  (void)channel;
+  (void)arguments;
+  g_atomic_int_set(&session->has_listener, 0);
+  return nullptr;
+}
+
+FlMethodErrorResponse* OnFeaturesListenHandler(FlEventChannel* channel,
+                                               FlValue* arguments,
+                                               gpointer user_data) {
+  CaptureSession* session = static_cast<CaptureSession*>(user_data);
+  (void)channel;
+  (void)arguments;
+  g_atomic_int_set(&session->has_features_listener, 1);
+  return nullptr;
+}
+
+FlMethodErrorResponse* OnFeaturesCancelHandler(FlEventChannel* channel,
+                                               FlValue* arguments,
+                                               gpointer user_data) {
+  CaptureSession* session = static_cast<CaptureSession*>(user_data);
+  (void)channel;
+  (void)arguments;
+  g_atomic_int_set(&session->has_features_listener, 0);
+  return nullptr;
+}
+
+FlMethodErrorResponse* OnSpectrumListenHandler(FlEventChannel* channel,
+                                               FlValue* arguments,
+                                               gpointer user_data) {
+  CaptureSession* session = static_cast<CaptureSession*>(user_data);
+  (void)channel;
+  (void)arguments;
+  g_atomic_int_set(&session->has_spectrum_listener, 1);
+  return nullptr;
+}
+
+FlMethodErrorResponse* OnSpectrumCancelHandler(FlEventChannel* channel,
+                                               FlValue* arguments,
+                                               gpointer user_data) {
+  CaptureSession* session = static_cast<CaptureSession*>(user_data);
+  (void)channel;
+  (void)arguments;
+  g_atomic_int_set(&session->has_spectrum_listener, 0);
+  return nullptr;
+}
+
+FlMethodErrorResponse* OnWaveformListenHandler(FlEventChannel* channel,
+                                               FlValue* arguments,
+                                               gpointer user_data) {
+  CaptureSession* session = static_cast<CaptureSession*>(user_data);
+  (void)channel;
+  (void)arguments;
+  g_atomic_int_set(&session->has_waveform_listener, 1);
+  return nullptr;
+}
+
+FlMethodErrorResponse* OnWaveformCancelHandler(FlEventChannel* channel,
+                                               FlValue* arguments,
+                                               gpointer user_data) {
+  CaptureSession* session = static_cast<CaptureSession*>(user_data);
+  (void)channel;
+  (void)arguments;
+  g_atomic_int_set(&session->has_waveform_listener, 0);
+  return nullptr;
+}
+
+FlMethodErrorResponse* OnListenHandler(FlEventChannel* channel,
+                                       FlValue* arguments,
+                                       gpointer user_data) {
+  CaptureHost* host = static_cast<CaptureHost*>(user_data);
+  (void)channel;
+  (void)arguments;
+  g_mutex_lock(&host->lock);
+  host->has_listener = TRUE;
+  UpdateHostConsumers(host);
+  g_mutex_unlock(&host->lock);
+  return nullptr;
+}
+
+FlMethodErrorResponse* OnCancelHandler(FlEventChannel* channel,
+                                       FlValue* arguments,
+                                       gpointer user_data) {
+  CaptureHost* host = static_cast<CaptureHost*>(user_data);
+  (void)channel;
+  (void)arguments;
+  g_mutex_lock(&host->lock);
+  host->has_listener = FALSE;
+  UpdateHostConsumers(host);
+  g_mutex_unlock(&host->lock);
+  return nullptr;
+}
+
+FlMethodErrorResponse* OnStatusListenHandler(FlEventChannel* channel,
+                                             FlValue* arguments,
+                                             gpointer user_data) {
+  CaptureHost* host = static_cast<CaptureHost*>(user_data);
+  (void)channel;
+  (void)arguments;
+  g_mutex_lock(&host->lock);
+  host->has_status_listener = TRUE;
+  g_mutex_unlock(&host->lock);
+
+  // Send current status immediately
+  CaptureHostSendStatus(host, CaptureHostIsCapturing(host), 0, std::string());
+  return nullptr;
+}
+
+FlMethodErrorResponse* OnStatusCancelHandler(FlEventChannel* channel,
+                                             FlValue* arguments,
+                                             gpointer user_data) {
+  CaptureHost* host = static_cast<CaptureHost*>(user_data);
+  (void)channel;
+  (void)arguments;
+  g_mutex_lock(&host->lock);
+  host->has_status_listener = FALSE;
+  g_mutex_unlock(&host->lock);
+  return nullptr;
+}
+
+FlMethodErrorResponse* OnDecibelListenHandler(FlEventChannel* channel,
+                                              FlValue* arguments,
+                                              gpointer user_data) {
+  CaptureHost* host = static_cast<CaptureHost*>(user_data);
+  (void)channel;
+  (void)arguments;
+  g_mutex_lock(&host->lock);
+  host->has_decibel_listener = TRUE;
+  UpdateHostConsumers(host);
+  g_mutex_unlock(&host->lock);
+  return nullptr;
+}
+
+FlMethodErrorResponse* OnDecibelCancelHandler(FlEventChannel* channel,
+                                              FlValue* arguments,
+                                              gpointer user_data) {
+  CaptureHost* host = static_cast<CaptureHost*>(user_data);
+  (void)channel;
+  (void)arguments;
+  g_mutex_lock(&host->lock);
+  host->has_decibel_listener = FALSE;
+  UpdateHostConsumers(host);
+  g_mutex_unlock(&host->lock);
+  return nullptr;
+}
+
+FlMethodErrorResponse* OnEventsListenHandler(FlEventChannel* channel,
+                                             FlValue* arguments,
+                                             gpointer user_data) {
+  CaptureHost* host = static_cast<CaptureHost*>(user_data);
+  (void)channel;
+  (void)arguments;
+  g_mutex_lock(&host->lock);
+  host->has_events_listener = TRUE;
+  g_mutex_unlock(&host->lock);
+  return nullptr;
+}
+
+FlMethodErrorResponse* OnEventsCancelHandler(FlEventChannel* channel,
+                                             FlValue* arguments,
+                                             gpointer user_data) {
+  CaptureHost* host = static_cast<CaptureHost*>(user_data);
+  (void)channel;
+  (void)arguments;
+  g_mutex_lock(&host->lock);
+  host->has_events_listener = FALSE;
+  g_mutex_unlock(&host->lock);
+  return nullptr;
+}
+
+// Registers a session reading |streams|, opened in |capture_formats|, and
+// starts one reader per stream. |synced_config| is null for single-source
+// sessions.
+guint StartSession(CaptureHost* host, pa_simple* const* streams,
+                   const CaptureFormat* capture_formats, int stream_count,
+                   const CaptureSessionConfig& config,
+                   const SyncedCaptureConfig* synced_config,
+                   const std::string& device_name) {
+  auto* session = new CaptureSession();
+  session->ref_count = 1;  // Held by the session registry.
+  session->id = static_cast<guint>(g_atomic_int_add(&g_last_session_id, 1) + 1);
+  session->host = host;
+  session->config = config;
+  session->device_name = device_name;
+  session->source_count = stream_count;
+  const size_t channels = static_cast<size_t>(config.channels);
+  const size_t frame_size = sizeof(int16_t) * channels;
+  session->chunk_capacity = config.read_size;
+  size_t max_chunk_frames = 0;  // Most frames of a converted chunk.
+  for (int i = 0; i < stream_count; ++i) {
+    CaptureSource& source = session->sources[i];
+    source.session = session;
+    source.index = i;
+    source.stream = streams[i];
+    source.ready_chunks.reset(new SpscQueue<RawChunk*>(kMaxPendingChunks));
+    source.free_chunks.reset(new SpscQueue<RawChunk*>(kChunkPoolSize));
+    source.reader_thread = nullptr;
+    source.first_frame_time = 0;
+    source.frames_owed = 0;
+    source.next_frame_position = 0;
+    const CaptureFormat& format = capture_formats[i];
+    source.capture_rate = format.rate > 0 ? format.rate : config.sample_rate;
+    source.sample_format = format.sample_format;
+    source.capture_chunk_size = CaptureChunkSize(config, format);
+    source.resample_next = 0;
+    source.resample_position = 0;
+    const size_t capture_frames =
+        source.capture_chunk_size /
+        (SampleFormatBytes(source.sample_format) * channels);
+    size_t max_frames = capture_frames;
+    if (source.capture_rate != config.sample_rate) {
+      source.resampler.reset(new Resampler(source.capture_rate,
+                                           config.sample_rate, config.channels,
+                                           config.resample_quality));
+      max_frames = std::max(max_frames,
+                            source.resampler->MaxOutputFrames(capture_frames));
+    }
+    if (source.sample_format != SampleFormat::kS16) {
+      if (source.resampler == nullptr) {
+        source.input_converter.reset(new SampleConverter(
+            source.sample_format, SampleFormat::kS16, Dither::kTriangular));
+      } else {
+        source.input_converter.reset(
+            new SampleConverter(source.sample_format, SampleFormat::kF32));
+        source.output_converter.reset(new SampleConverter(
+            SampleFormat::kF32, SampleFormat::kS16, Dither::kTriangular));
+        source.float_frames.resize(max_frames * channels);
+      }
+    }
+    max_chunk_frames = std::max(max_chunk_frames, max_frames);
+    // Converted in place, so a chunk holds the larger of both sides.
+    session->chunk_capacity =
+        std::max({session->chunk_capacity, source.capture_chunk_size,
+                  max_frames * frame_size});
+  }
+  session->should_stop = 0;
+  session->finished = FALSE;
+  session->synced = synced_config != nullptr;
+  if (synced_config != nullptr) {
+    session->synced_config = *synced_config;
+  }
+  session->aligned = FALSE;
+  session->timeline_origin = 0;
+  session->emitted_blocks = 0;
+  session->emitted_frames = 0;
+  session->processing_scheduled = 0;
+  session->pending_emissions = 0;
+  session->pending_conversion_us = 0;
+  g_mutex_init(&session->stats_lock);
+  session->stats = SessionStats();
+  session->stats.scheduling = ThreadScheduling::kNormal;
+  const size_t frame_count = config.chunk_size / frame_size;
+  const size_t read_frames = config.read_size / frame_size;
+  const bool interleaved =
+      synced_config != nullptr &&
+      synced_config->mode == SyncedOutputMode::kInterleaved;
+  session->meter_sequence = 0;
+  session->max_meter_backlog = 0;
+  session->assembly_position = 0;
+  session->assembly_time = 0;
+  session->assembly_conversion_us = 0;
+  session->chunk_sequence = 0;
+  if (config.meter_rate_hz > 0) {
+    // Chunks are metered as read, before any processing; the meter applies
+    // the volume and gain itself.
+    const size_t period_frames = std::max<size_t>(
+        1, static_cast<size_t>(config.sample_rate / config.meter_rate_hz));
+    session->meter.reset(new LevelMeter(
+        config.sample_rate, period_frames, config.channels,
+        config.gain_boost * std::min(config.input_volume, 1.0f),
+        config.meter_options));
+    // A chunk may complete a period begun in the one before.
+    session->meter_levels.resize(
+        std::max(read_frames, max_chunk_frames) / period_frames + 1);
+  }
+  if (config.loudness) {
+    // Measured on the chunks as read, like the meter.
+    session->loudness.reset(new LoudnessMeter(
+        config.sample_rate, config.channels,
+        config.gain_boost * std::min(config.input_volume, 1.0f)));
+  }
+  if (!config.filters.empty() && synced_config == nullptr) {
+    session->filters.reset(new BiquadChain(
+        config.sample_rate, config.channels, config.filters));
+  }
+  session->denoise_next_position = 0;
+  if (config.noise_suppression && !config.meter_only) {
+    session->denoiser.reset(
+        new NoiseSuppressor(config.sample_rate, config.noise_options));
+  }
+  session->delay_next_position = 0;
+  if (synced_config != nullptr && synced_config->estimate_delay) {
+    session->delay.reset(
+        new DelayEstimator(config.sample_rate, synced_config->delay_options));
+  }
+  session->echo_next_position = 0;
+  if (synced_config != nullptr &&
+      synced_config->mode == SyncedOutputMode::kEchoCancelled) {
+    session->echo.reset(new EchoCanceller(config.sample_rate));
+  }
+  session->agc_next_position = 0;
+  if (config.agc && !config.meter_only) {
+    // Applied to the processed chunks, before anything else sees them.
+    session->agc.reset(
+        new AutomaticGainControl(config.sample_rate, config.agc_options));
+  }
+  if (config.compressor && !config.meter_only) {
+    session->compressor.reset(
+        new Compressor(config.sample_rate, config.compressor_options));
+    if (interleaved) {
+      session->system_compressor.reset(
+          new Compressor(config.sample_rate, config.compressor_options));
+    }
+  }
+  session->speech_probability = 0.0;
+  session->pre_roll_capacity = 0;
+  session->pre_roll_end = 0;
+  session->utterance_active = false;
+  session->max_utterance_samples = 0;
+  session->utterance_limit = 0;
+  session->utterance_position = 0;
+  session->utterance_time = 0;
+  session->utterance_conversion_us = 0;
+  session->utterance_sequence = 0;
+  if (config.voice_activity && !config.meter_only) {
+    // Detected on the processed chunks, as emitted.
+    session->voice.reset(new VoiceDetector(config.sample_rate,
+                                           config.voice_options));
+    session->voice_transitions.resize(
+        session->voice->MaxTransitions(std::max(frame_count,
+                                                max_chunk_frames)) +
+        1);
+    if (config.speech_only || config.segment_utterances) {
+      session->pre_roll_capacity = static_cast<size_t>(config.sample_rate) *
+                                   config.voice_pre_roll_ms / 1000;
+      session->pre_roll.reserve(session->pre_roll_capacity);
+    }
+    if (config.segment_utterances) {
+      session->max_utterance_samples = static_cast<size_t>(
+          static_cast<gint64>(config.sample_rate) * config.max_utterance_ms /
+          1000);
+      session->utterance.reserve(session->pre_roll_capacity +
+                                 session->max_utterance_samples);
+    } else if (config.speech_only) {
+      session->voice_output.reserve(session->pre_roll_capacity +
+                                    std::max(frame_count, max_chunk_frames));
+    }
+  }
+  session->mel_max_frames = 0;
+  session->mel_origin = 0;
+  session->mel_next_position = 0;
+  session->feature_sequence = 0;
+  if (config.mel_features && !config.meter_only) {
+    // Extracted from the processed chunks, a read's worth at a time.
+    session->mel.reset(new MelSpectrogram(config.sample_rate,
+                                          config.mel_options));
+    session->mel_max_frames = read_frames / session->mel->hop_samples() + 2;
+    session->mel_frames.resize(session->mel_max_frames *
+                               session->mel->bins());
+  }
+  session->spectrum_origin = 0;
+  session->spectrum_next_position = 0;
+  session->spectrum_next_emit = 0;
+  session->spectrum_interval = 0;
+  session->spectrum_sequence = 0;
+  if (config.spectrum && !config.meter_only) {
+    session->analyzer.reset(new SpectrumAnalyzer(config.sample_rate,
+                                                 config.spectrum_options));
+    session->spectrum_interval = std::max<guint64>(
+        1, static_cast<guint64>(config.sample_rate / config.spectrum_rate_hz));
+  }
+  const size_t spectrum_bands =
+      session->analyzer != nullptr ? session->analyzer->bands() : 0;
+  session->waveform_piece = 0;
+  session->waveform_origin = 0;
+  session->waveform_next_position = 0;
+  session->waveform_sequence = 0;
+  size_t waveform_bytes = 0;
+  if (config.waveform && !config.meter_only) {
+    // Decimated a read's worth at a time; the runs of one fit a payload.
+    session->waveform.reset(new WaveformDecimator(config.sample_rate,
+                                                  config.waveform_options));
+    session->waveform_piece = read_frames;
+    session->waveform->Reserve(read_frames);
+    size_t max_buckets = 0;
+    for (size_t level = 0; level < session->waveform->levels(); ++level) {
+      max_buckets +=
+          read_frames / session->waveform->bucket_samples(level) + 1;
+    }
+    waveform_bytes = session->waveform->levels() * sizeof(WaveformRun) +
+                     max_buckets * sizeof(WaveformBucket);
+  }
+  if (config.meter_only) {
+    // Levels only: nothing is emitted with samples. A fragment's worth of
+    // levels may wait, and one more for a late read.
+    session->max_meter_backlog = session->meter_levels.size() + 1;
+  } else if (synced_config != nullptr) {
+    session->output_buffer.resize(interleaved ? read_frames * 2
+                                              : read_frames);
+    session->gained_buffer.resize(read_frames);
+  } else {
+    // Sized once for the longest chunk plus the longest silence filled ahead
+    // of it, so they are never reallocated, or unlocked, while capturing.
+    const size_t chunk_frames = std::max(read_frames, max_chunk_frames);
+    const size_t max_fill =
+        config.fill_gaps ? static_cast<size_t>(config.sample_rate) *
+                               kMaxGapFillMs / 1000
+                         : 0;
+    session->output_buffer.resize(max_fill + chunk_frames);
+    if (session->compressor != nullptr) {
+      // The gain follows the denoiser over the lead-in too.
+      session->gained_buffer.resize(
+          (session->denoiser != nullptr ? max_fill : 0) + chunk_frames);
+    }
+    if (session->meter != nullptr) {
+      session->assembly.reserve(frame_count);
+    }
+  }
+  // Large enough for any chunk the session emits, unless a gap was filled.
+  const size_t max_emit_samples =
+      config.meter_only
+          ? 0
+          : std::max({interleaved ? read_frames * 2 : read_frames,
+                      max_chunk_frames, session->assembly.capacity()}) +
+                (config.speech_only ? session->pre_roll_capacity : 0);
+  session->emit_pool.reset(new BufferPool(
+      sizeof(AudioChunkPayload) +
+          std::max({max_emit_samples * sizeof(int16_t),
+                    session->mel_frames.size() * sizeof(float),
+                    spectrum_bands * sizeof(float), waveform_bytes}),
+      kEmitPoolSize));
+  session->emit_queue.reset(
+      new SpscQueue<AudioChunkPayload*>(kEmitPoolSize));
+  if (config.realtime) {
+    // Readers of a real-time session never wait for the allocator or a page
+    // fault in steady state.
+    for (int i = 0; i < stream_count; ++i) {
+      SpscQueue<RawChunk*>* pool = session->sources[i].free_chunks.get();
+      for (size_t j = 0; j < pool->Capacity(); ++j) {
+        pool->Push(NewChunk(session));
+      }
+    }
+    if (!session->output_buffer.empty()) {
+      LockSessionMemory(session, session->output_buffer.data(),
+                        session->output_buffer.size() * sizeof(int16_t));
+    }
+    if (!session->gained_buffer.empty()) {
+      LockSessionMemory(session, session->gained_buffer.data(),
+                        session->gained_buffer.size() * sizeof(float));
+    }
+    if (session->assembly.capacity() > 0) {
+      LockSessionMemory(session, session->assembly.data(),
+                        session->assembly.capacity() * sizeof(int16_t));
+    }
+    if (session->utterance.capacity() > 0) {
+      LockSessionMemory(session, session->utterance.data(),
+                        session->utterance.capacity() * sizeof(int16_t));
+    }
+    LockSessionMemory(session, session->emit_pool->storage(),
+                      session->emit_pool->storage_size());
+    for (int i = 0; i < stream_count; ++i) {
+      std::vector<float>& float_frames = session->sources[i].float_frames;
+      if (!float_frames.empty()) {
+        LockSessionMemory(session, float_frames.data(),
+                          float_frames.size() * sizeof(float));
+      }
+    }
+  }
+  session->event_channel = nullptr;
+  session->has_listener = 0;
+  session->features_channel = nullptr;
+  session->has_features_listener = 0;
+  session->spectrum_channel = nullptr;
+  session->has_spectrum_listener = 0;
+  session->waveform_channel = nullptr;
+  session->has_waveform_listener = 0;
+  g_object_ref(host->owner);
+
+  session->emit_source =
+      g_source_new(&g_emit_source_funcs, sizeof(EmitSource));
+  EmitSource* emit_source = reinterpret_cast<EmitSource*>(session->emit_source);
+  emit_source->session = CaptureSessionRef(session);
+  emit_source->interval = 0;
+  emit_source->next_dispatch = 0;
+  if (config.meter_only) {
+    emit_source->interval = G_USEC_PER_SEC / config.meter_rate_hz;
+    emit_source->next_dispatch =
+        g_get_monotonic_time() + emit_source->interval;
+    g_source_set_ready_time(session->emit_source,
+                            emit_source->next_dispatch);
+  }
+  g_source_set_name(session->emit_source, "audio capture emission");
+  g_source_attach(session->emit_source, host->main_context);
+
+  if (host->messenger != nullptr) {
+    g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+    g_autofree gchar* channel_name =
+        g_strdup_printf("%s/%u", host->stream_channel_name, session->id);
+    session->event_channel = fl_event_channel_new(
+        host->messenger, channel_name, FL_METHOD_CODEC(codec));
+    // Cleared in FinishSession before the session can be freed.
+    fl_event_channel_set_stream_handlers(session->event_channel,
+                                         OnSessionListenHandler,
+                                         OnSessionCancelHandler, session,
+                                         nullptr);
+    if (session->mel != nullptr) {
+      g_autofree gchar* features_name =
+          g_strdup_printf("%s/features", channel_name);
+      session->features_channel = fl_event_channel_new(
+          host->messenger, features_name, FL_METHOD_CODEC(codec));
+      fl_event_channel_set_stream_handlers(session->features_channel,
+                                           OnFeaturesListenHandler,
+                                           OnFeaturesCancelHandler, session,
+                                           nullptr);
+    }
+    if (session->analyzer != nullptr) {
+      g_autofree gchar* spectrum_name =
+          g_strdup_printf("%s/spectrum", channel_name);
+      session->spectrum_channel = fl_event_channel_new(
+          host->messenger, spectrum_name, FL_METHOD_CODEC(codec));
+      fl_event_channel_set_stream_handlers(session->spectrum_channel,
+                                           OnSpectrumListenHandler,
+                                           OnSpectrumCancelHandler, session,
+                                           nullptr);
+    }
+    if (session->waveform != nullptr) {
+      g_autofree gchar* waveform_name =
+          g_strdup_printf("%s/waveform", channel_name);
+      session->waveform_channel = fl_event_channel_new(
+          host->messenger, waveform_name, FL_METHOD_CODEC(codec));
+      fl_event_channel_set_stream_handlers(session->waveform_channel,
+                                           OnWaveformListenHandler,
+                                           OnWaveformCancelHandler, session,
+                                           nullptr);
+    }
+  }
+
+  g_mutex_lock(&g_sessions_lock);
+  if (g_sessions == nullptr) {
+    g_sessions = g_hash_table_new(g_direct_hash, g_direct_equal);
+  }
+  g_hash_table_insert(g_sessions, GUINT_TO_POINTER(session->id), session);
+  g_mutex_unlock(&g_sessions_lock);
+
+  for (int i = 0; i < stream_count; ++i) {
+    CaptureSource& source = session->sources[i];
+    CaptureSessionRef(session);  // Released by the reader.
+    source.reader_thread = g_thread_try_new(host->thread_name, ReaderThread,
+                                            &source, nullptr);
+    if (source.reader_thread != nullptr) {
+      continue;
+    }
+
+    g_warning("Failed to create capture thread");
+    CaptureSessionUnref(session);  // The reader's reference.
+    session->finished = TRUE;
+    g_atomic_int_set(&session->should_stop, 1);
+    for (int j = 0; j < stream_count; ++j) {
+      CaptureSource& other = session->sources[j];
+      if (other.reader_thread != nullptr) {
+        g_thread_join(other.reader_thread);
+        other.reader_thread = nullptr;
+      } else if (other.stream != nullptr) {
+        pa_simple_free(other.stream);
+        other.stream = nullptr;
+      }
+    }
+    if (session->event_channel != nullptr) {
+      g_clear_object(&session->event_channel);
+    }
+    if (session->features_channel != nullptr) {
+      g_clear_object(&session->features_channel);
+    }
+    if (session->spectrum_channel != nullptr) {
+      g_clear_object(&session->spectrum_channel);
+    }
+    if (session->waveform_channel != nullptr) {
+      g_clear_object(&session->waveform_channel);
+    }
+    DetachEmitSource(session);
+    g_mutex_lock(&g_sessions_lock);
+    g_hash_table_remove(g_sessions, GUINT_TO_POINTER(session->id));
+    g_mutex_unlock(&g_sessions_lock);
+    CaptureSessionUnref(session);  // The registry's reference.
+    return 0;
+  }
+
+  CaptureHostSendStatus(host, TRUE, session->id, device_name);
+  return session->id;
+}
+
+// Reads a meter time in milliseconds from |args|; absent means 0.
+int LookupMeterMs(FlValue* args, const char* key) {
+  FlValue* value = fl_value_lookup_string(args, key);
+  if (value == nullptr || fl_value_get_type(value) != FL_VALUE_TYPE_INT) {
+    return 0;
+  }
+  return static_cast<int>(std::max<int64_t>(
+      0, std::min<int64_t>(fl_value_get_int(value), kMaxMeterTimeMs)));
+}
+
+// A time in milliseconds, clamped to 0 to |max|, or
+// |fallback| if |key| is missing.
+int LookupMs(FlValue* args, const char* key, int fallback, int max) {
+  FlValue* value = fl_value_lookup_string(args, key);
+  if (value == nullptr || fl_value_get_type(value) != FL_VALUE_TYPE_INT) {
+    return fallback;
+  }
+  return static_cast<int>(
+      std::max<int64_t>(0, std::min<int64_t>(fl_value_get_int(value), max)));
+}
+
+double LookupVoiceThreshold(FlValue* args, const char* key, double fallback) {
+  FlValue* value = fl_value_lookup_string(args, key);
+  if (value == nullptr || fl_value_get_type(value) != FL_VALUE_TYPE_FLOAT) {
+    return fallback;
+  }
+  return std::max(0.01, std::min(fl_value_get_float(value), 0.99));
+}
+
+}  // namespace
+
+void ParseSchedulingArgs(FlValue* args, CaptureSessionConfig* config) {
+  config->realtime = false;
+  config->realtime_priority = kDefaultRealtimePriority;
+  config->cpu_mask = 0;
+  if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return;
+  }
+
+  FlValue* value = fl_value_lookup_string(args, "realtime");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_BOOL) {
+    config->realtime = fl_value_get_bool(value);
+  }
+
+  value = fl_value_lookup_string(args, "realtimePriority");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_INT) {
+    config->realtime_priority =
+        std::max(1, std::min(static_cast<int>(fl_value_get_int(value)), 99));
+  }
+
+  value = fl_value_lookup_string(args, "cpuAffinity");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_LIST) {
+    for (size_t i = 0; i < fl_value_get_length(value); ++i) {
+      FlValue* cpu = fl_value_get_list_value(value, i);
+      if (fl_value_get_type(cpu) == FL_VALUE_TYPE_INT &&
+          fl_value_get_int(cpu) >= 0 && fl_value_get_int(cpu) < 64) {
+        config->cpu_mask |= G_GUINT64_CONSTANT(1) << fl_value_get_int(cpu);
+      }
+    }
+  }
+}
+
+void ParseResampleArgs(FlValue* args, CaptureSessionConfig* config) {
+  config->native_rate = false;
+  config->resample_quality = ResamplerQuality::kMedium;
+  config->capture_format = {0, SampleFormat::kS16};
+  if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return;
+  }
+
+  FlValue* value = fl_value_lookup_string(args, "nativeRate");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_BOOL) {
+    config->native_rate = fl_value_get_bool(value);
+  }
+
+  value = fl_value_lookup_string(args, "resampleQuality");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_STRING) {
+    const gchar* name = fl_value_get_string(value);
+    if (strcmp(name, "low") == 0) {
+      config->resample_quality = ResamplerQuality::kLow;
+    } else if (strcmp(name, "high") == 0) {
+      config->resample_quality = ResamplerQuality::kHigh;
+    }
+  }
+}
+
+void ParseMeterArgs(FlValue* args, CaptureSessionConfig* config) {
+  config->meter_only = false;
+  config->meter_rate_hz = 0;
+  config->meter_options = MeterOptions();
+  config->read_size = config->chunk_size;
+  config->loudness = false;
+  if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return;
+  }
+
+  FlValue* value = fl_value_lookup_string(args, "loudness");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_BOOL) {
+    config->loudness = fl_value_get_bool(value);
+  }
+
+  value = fl_value_lookup_string(args, "meterOnly");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_BOOL) {
+    config->meter_only = fl_value_get_bool(value);
+  }
+  if (config->meter_only) {
+    config->meter_rate_hz = kDefaultMeterRateHz;
+  }
+
+  value = fl_value_lookup_string(args, "meterRateHz");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_INT) {
+    config->meter_rate_hz = std::max(
+        1, std::min(static_cast<int>(fl_value_get_int(value)),
+                    kMaxMeterRateHz));
+  }
+  if (config->meter_rate_hz == 0) {
+    return;  // One level per chunk.
+  }
+  config->meter_options.window_ms = LookupMeterMs(args, "meterWindowMs");
+  config->meter_options.attack_ms = LookupMeterMs(args, "meterAttackMs");
+  config->meter_options.release_ms = LookupMeterMs(args, "meterReleaseMs");
+  config->meter_options.hold_ms = LookupMeterMs(args, "meterHoldMs");
+
+  const size_t frame_size =
+      sizeof(int16_t) * static_cast<size_t>(config->channels);
+  const size_t period_frames = std::max<size_t>(
+      1, static_cast<size_t>(config->sample_rate / config->meter_rate_hz));
+  if (!config->meter_only) {
+    // Read a period at a time so levels leave as soon as they are measured;
+    // the samples are reassembled into chunks of |chunk_size|.
+    config->read_size =
+        std::min(config->chunk_size, period_frames * frame_size);
+    return;
+  }
+  // Fewer, larger reads: the server wakes the reader once per fragment.
+  const size_t fragment_frames = std::max(
+      static_cast<size_t>(config->sample_rate) * kMeterFragmentMs / 1000,
+      period_frames);
+  config->chunk_size = fragment_frames * frame_size;
+  config->read_size = config->chunk_size;
+  config->native_rate = false;
+}
+
+void ParseGainArgs(FlValue* args, CaptureSessionConfig* config) {
+  config->agc = false;
+  config->agc_options = AgcOptions();
+  if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return;
+  }
+
+  FlValue* value = fl_value_lookup_string(args, "agc");
+  if (value == nullptr || fl_value_get_type(value) != FL_VALUE_TYPE_BOOL ||
+      !fl_value_get_bool(value)) {
+    return;
+  }
+  config->agc = true;
+  config->gain_boost = 1.0f;  // The gain control sets the gain instead.
+  AgcOptions& options = config->agc_options;
+  value = fl_value_lookup_string(args, "agcDetector");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_STRING &&
+      strcmp(fl_value_get_string(value), "loudness") == 0) {
+    options.detector = AgcDetector::kLoudness;
+  }
+  value = fl_value_lookup_string(args, "agcTargetDb");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_FLOAT) {
+    options.target_db =
+        std::max(-60.0, std::min(0.0, fl_value_get_float(value)));
+  }
+  options.window_ms =
+      LookupMs(args, "agcWindowMs", options.window_ms, kMaxAgcTimeMs);
+  options.attack_ms =
+      LookupMs(args, "agcAttackMs", options.attack_ms, kMaxAgcTimeMs);
+  options.release_ms =
+      LookupMs(args, "agcReleaseMs", options.release_ms, kMaxAgcTimeMs);
+  value = fl_value_lookup_string(args, "agcMaxGainDb");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_FLOAT) {
+    options.max_gain_db =
+        std::max(0.0, std::min(kMaxAgcGainDb, fl_value_get_float(value)));
+  }
+  value = fl_value_lookup_string(args, "agcGateDb");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_FLOAT) {
+    options.gate_db = std::min(0.0, fl_value_get_float(value));
+  }
+  options.lookahead_ms = LookupMs(args, "agcLookaheadMs",
+                                  options.lookahead_ms, kMaxAgcLookaheadMs);
+  value = fl_value_lookup_string(args, "agcCeilingDb");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_FLOAT) {
+    options.ceiling_db =
+        std::max(-20.0, std::min(0.0, fl_value_get_float(value)));
+  }
+}
+
+void ParseFilterArgs(FlValue* args, CaptureSessionConfig* config) {
+  config->filters.clear();
+  if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return;
+  }
+
+  FlValue* list = fl_value_lookup_string(args, "filters");
+  if (list == nullptr || fl_value_get_type(list) != FL_VALUE_TYPE_LIST) {
+    return;
+  }
+  const struct {
+    const char* name;
+    FilterType type;
+  } kTypes[] = {{"dcBlock", FilterType::kDcBlock},
+                {"highPass", FilterType::kHighPass},
+                {"lowPass", FilterType::kLowPass},
+                {"lowShelf", FilterType::kLowShelf},
+                {"highShelf", FilterType::kHighShelf},
+                {"notch", FilterType::kNotch}};
+  for (size_t i = 0; i < fl_value_get_length(list); ++i) {
+    FlValue* stage = fl_value_get_list_value(list, i);
+    if (fl_value_get_type(stage) != FL_VALUE_TYPE_MAP ||
+        config->filters.size() == kMaxFilters) {
+      continue;
+    }
+    FlValue* value = fl_value_lookup_string(stage, "type");
+    if (value == nullptr || fl_value_get_type(value) != FL_VALUE_TYPE_STRING) {
+      continue;
+    }
+    FilterSpec spec;
+    bool known = false;
+    for (const auto& type : kTypes) {
+      if (strcmp(fl_value_get_string(value), type.name) == 0) {
+        spec.type = type.type;
+        known = true;
+      }
+    }
+    if (!known) {
+      continue;
+    }
+    if (spec.type == FilterType::kDcBlock) {
+      spec.frequency_hz = 10.0;
+    }
+    value = fl_value_lookup_string(stage, "frequencyHz");
+    if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_FLOAT) {
+      spec.frequency_hz = std::max(
+          kMinFilterHz, std::min(kMaxFilterHz, fl_value_get_float(value)));
+    }
+    value = fl_value_lookup_string(stage, "q");
+    if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_FLOAT) {
+      spec.q = std::max(kMinFilterQ,
+                        std::min(kMaxFilterQ, fl_value_get_float(value)));
+    }
+    value = fl_value_lookup_string(stage, "gainDb");
+    if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_FLOAT) {
+      spec.gain_db = std::max(-kMaxFilterGainDb,
+                              std::min(kMaxFilterGainDb,
+                                       fl_value_get_float(value)));
+    }
+    config->filters.push_back(spec);
+  }
+}
+
+void ParseCompressorArgs(FlValue* args, CaptureSessionConfig* config) {
+  config->compressor = false;
+  config->compressor_options = CompressorOptions();
+  if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return;
+  }
+
+  FlValue* value = fl_value_lookup_string(args, "compressor");
+  if (value == nullptr || fl_value_get_type(value) != FL_VALUE_TYPE_BOOL ||
+      !fl_value_get_bool(value)) {
+    return;
+  }
+  config->compressor = true;
+  CompressorOptions& options = config->compressor_options;
+  value = fl_value_lookup_string(args, "compressorThresholdDb");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_FLOAT) {
+    options.threshold_db =
+        std::max(-60.0, std::min(0.0, fl_value_get_float(value)));
+  }
+  value = fl_value_lookup_string(args, "compressorRatio");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_FLOAT) {
+    options.ratio =
+        std::max(1.0, std::min(kMaxCompressorRatio, fl_value_get_float(value)));
+  }
+  value = fl_value_lookup_string(args, "compressorKneeDb");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_FLOAT) {
+    options.knee_db = std::max(
+        0.0, std::min(kMaxCompressorKneeDb, fl_value_get_float(value)));
+  }
+  options.attack_ms = LookupMs(args, "compressorAttackMs", options.attack_ms,
+                               kMaxCompressorTimeMs);
+  options.release_ms = LookupMs(args, "compressorReleaseMs",
+                                options.release_ms, kMaxCompressorTimeMs);
+  value = fl_value_lookup_string(args, "compressorCeilingDb");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_FLOAT) {
+    options.ceiling_db =
+        std::max(-20.0, std::min(0.0, fl_value_get_float(value)));
+  }
+}
+
+void ParseNoiseArgs(FlValue* args, CaptureSessionConfig* config) {
+  config->noise_suppression = false;
+  config->noise_options = NoiseOptions();
+  if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return;
+  }
+
+  FlValue* value = fl_value_lookup_string(args, "noiseSuppression");
+  if (value == nullptr || fl_value_get_type(value) != FL_VALUE_TYPE_STRING) {
+    return;
+  }
+  // Most attenuation of each level, in dB.
+  const struct {
+    const char* name;
+    double suppression_db;
+  } kLevels[] = {
+      {"low", 6.0}, {"moderate", 12.0}, {"high", 18.0}, {"veryHigh", 24.0}};
+  const gchar* name = fl_value_get_string(value);
+  for (const auto& level : kLevels) {
+    if (strcmp(name, level.name) == 0) {
+      config->noise_suppression = true;
+      config->noise_options.suppression_db = level.suppression_db;
+    }
+  }
+}
+
+void ParseVoiceArgs(FlValue* args, CaptureSessionConfig* config) {
+  config->voice_activity = false;
+  config->voice_options = VoiceOptions();
+  config->voice_pre_roll_ms = 300;
+  config->speech_only = false;
+  config->segment_utterances = false;
+  config->max_utterance_ms = 15000;
+  if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return;
+  }
+
+  FlValue* value = fl_value_lookup_string(args, "voiceActivity");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_BOOL) {
+    config->voice_activity = fl_value_get_bool(value);
+  }
+  if (config->voice_activity) {
+    config->voice_options.threshold = LookupVoiceThreshold(
+        args, "voiceThreshold", config->voice_options.threshold);
+    config->voice_options.hangover_ms =
+        LookupMs(args, "voiceHangoverMs",
+                 config->voice_options.hangover_ms, kMaxVoiceHangoverMs);
+    config->voice_pre_roll_ms =
+        LookupMs(args, "voicePreRollMs", config->voice_pre_roll_ms,
+                 kMaxVoicePreRollMs);
+    value = fl_value_lookup_string(args, "speechOnly");
+    if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_BOOL) {
+      config->speech_only = fl_value_get_bool(value);
+    }
+  }
+
+  value = fl_value_lookup_string(args, "utterances");
+  if (value == nullptr || fl_value_get_type(value) != FL_VALUE_TYPE_BOOL ||
+      !fl_value_get_bool(value)) {
+    return;
+  }
+  config->voice_activity = true;
+  config->segment_utterances = true;
+  config->speech_only = false;  // Utterances hold speech only anyway.
+  config->voice_options.threshold = LookupVoiceThreshold(
+      args, "utteranceThreshold", config->voice_options.threshold);
+  config->voice_options.hangover_ms =
+      LookupMs(args, "utteranceSilenceMs",
+               config->voice_options.hangover_ms, kMaxVoiceHangoverMs);
+  config->voice_pre_roll_ms =
+      LookupMs(args, "utterancePreRollMs", config->voice_pre_roll_ms,
+               kMaxVoicePreRollMs);
+  config->max_utterance_ms =
+      std::max(kMinUtteranceMs,
+               LookupMs(args, "utteranceMaxMs", config->max_utterance_ms,
+                        kMaxUtteranceMs));
+}
+
+void ParseFeatureArgs(FlValue* args, CaptureSessionConfig* config) {
+  config->mel_features = false;
+  config->mel_options = MelOptions();
+  if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return;
+  }
+
+  FlValue* value = fl_value_lookup_string(args, "melFeatures");
+  if (value == nullptr || fl_value_get_type(value) != FL_VALUE_TYPE_BOOL ||
+      !fl_value_get_bool(value)) {
+    return;
+  }
+  config->mel_features = true;
+  MelOptions& options = config->mel_options;
+  value = fl_value_lookup_string(args, "melBins");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_INT) {
+    options.bins = static_cast<int>(std::max<int64_t>(
+        1, std::min<int64_t>(fl_value_get_int(value), kMaxMelBins)));
+  }
+  value = fl_value_lookup_string(args, "melWindowMs");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_INT) {
+    options.window_ms = static_cast<int>(std::max<int64_t>(
+        5, std::min<int64_t>(fl_value_get_int(value), kMaxMelWindowMs)));
+  }
+  value = fl_value_lookup_string(args, "melHopMs");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_INT) {
+    options.hop_ms = static_cast<int>(std::max<int64_t>(
+        1, std::min<int64_t>(fl_value_get_int(value), options.window_ms)));
+  }
+  options.hop_ms = std::min(options.hop_ms, options.window_ms);
+  value = fl_value_lookup_string(args, "melLowHz");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_FLOAT) {
+    options.low_hz = std::max(0.0, fl_value_get_float(value));
+  }
+  value = fl_value_lookup_string(args, "melHighHz");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_FLOAT) {
+    options.high_hz = std::max(0.0, fl_value_get_float(value));
+  }
+}
+
+void ParseSpectrumArgs(FlValue* args, CaptureSessionConfig* config) {
+  config->spectrum = false;
+  config->spectrum_options = SpectrumOptions();
+  config->spectrum_rate_hz = kDefaultSpectrumRateHz;
+  if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return;
+  }
+
+  FlValue* value = fl_value_lookup_string(args, "spectrum");
+  if (value == nullptr || fl_value_get_type(value) != FL_VALUE_TYPE_BOOL ||
+      !fl_value_get_bool(value)) {
+    return;
+  }
+  config->spectrum = true;
+  SpectrumOptions& options = config->spectrum_options;
+  value = fl_value_lookup_string(args, "spectrumFftSize");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_INT) {
+    options.fft_size = static_cast<int>(std::max<int64_t>(
+        64, std::min<int64_t>(fl_value_get_int(value), kMaxSpectrumFftSize)));
+  }
+  value = fl_value_lookup_string(args, "spectrumOverlap");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_FLOAT) {
+    options.overlap = fl_value_get_float(value);  // The analyzer clamps it.
+  }
+  value = fl_value_lookup_string(args, "spectrumBands");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_INT) {
+    options.bands = static_cast<int>(std::max<int64_t>(
+        1, std::min<int64_t>(fl_value_get_int(value), kMaxSpectrumBands)));
+  }
+  value = fl_value_lookup_string(args, "spectrumLowHz");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_FLOAT) {
+    options.low_hz = std::max(0.0, fl_value_get_float(value));
+  }
+  value = fl_value_lookup_string(args, "spectrumHighHz");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_FLOAT) {
+    options.high_hz = std::max(0.0, fl_value_get_float(value));
+  }
+  value = fl_value_lookup_string(args, "spectrumSmoothing");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_FLOAT) {
+    options.smoothing = fl_value_get_float(value);  // The analyzer clamps it.
+  }
+  value = fl_value_lookup_string(args, "spectrumRateHz");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_INT) {
+    config->spectrum_rate_hz = static_cast<int>(std::max<int64_t>(
+        1, std::min<int64_t>(fl_value_get_int(value), kMaxSpectrumRateHz)));
+  }
+}
+
+void ParseWaveformArgs(FlValue* args, CaptureSessionConfig* config) {
+  config->waveform = false;
+  config->waveform_options = WaveformOptions();
+  if (args == nullptr || fl_value_get_type(args) != FL_VALUE_TYPE_MAP) {
+    return;
+  }
+
+  FlValue* value = fl_value_lookup_string(args, "waveform");
+  if (value == nullptr || fl_value_get_type(value) != FL_VALUE_TYPE_BOOL ||
+      !fl_value_get_bool(value)) {
+    return;
+  }
+  config->waveform = true;
+  WaveformOptions& options = config->waveform_options;
+  value = fl_value_lookup_string(args, "waveformBucketRateHz");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_INT) {
+    options.bucket_rate_hz = static_cast<int>(std::max<int64_t>(
+        1,
+        std::min<int64_t>(fl_value_get_int(value), kMaxWaveformBucketRateHz)));
+  }
+  value = fl_value_lookup_string(args, "waveformLevels");
+  if (value != nullptr && fl_value_get_type(value) == FL_VALUE_TYPE_INT) {
+    options.levels = static_cast<int>(std::max<int64_t>(
+        1, std::min<int64_t>(fl_value_get_int(value), kMaxWaveformLevels)));
+  }
+}
+
+CaptureFormat ResolveCaptureFormat(const CaptureSessionConfig& config,
+                                   const std::string& source_name) {
+  CaptureFormat format = {config.sample_rate, SampleFormat::kS16};
+  if (!config.native_rate) {
+    return format;
+  }
+  pa_sample_spec spec;
+  std::string error_message;
+  if (!QuerySourceSampleSpec(source_name, &spec, &error_message)) {
+    g_warning("Using %d Hz, native rate unknown: %s", config.sample_rate,
+              error_message.c_str());
+    return format;
+  }
+  format.rate = static_cast<int>(spec.rate);
+  if (!GetPulseSampleFormat(spec.format, &format.sample_format)) {
+    format.sample_format = SampleFormat::kS16;
+  }
+  return format;
+}
+
+size_t CaptureChunkSize(const CaptureSessionConfig& config,
+                        const CaptureFormat& format) {
+  const size_t channels = static_cast<size_t>(config.channels);
+  const size_t frames = config.read_size / (sizeof(int16_t) * channels);
+  const size_t frame_size = SampleFormatBytes(format.sample_format) * channels;
+  if (format.rate <= 0 || format.rate == config.sample_rate) {
+    return frames * frame_size;
+  }
+  const size_t capture_frames = std::max<size_t>(
+      1, static_cast<size_t>(static_cast<guint64>(frames) * format.rate /
+                             config.sample_rate));
+  return capture_frames * frame_size;
+}
+
+void CaptureHostInit(CaptureHost* host, GObject* owner,
+                     const gchar* thread_name) {
+  host->owner = owner;
+  host->messenger = nullptr;
+  host->main_context = g_main_context_ref_thread_default();
+  host->stream_channel_name = nullptr;
+  host->thread_name = thread_name;
+  host->event_channel = nullptr;
+  host->status_event_channel = nullptr;
+  host->decibel_event_channel = nullptr;
+  host->events_event_channel = nullptr;
+  g_mutex_init(&host->lock);
+  host->has_listener = FALSE;
+  host->has_status_listener = FALSE;
+  host->has_decibel_listener = FALSE;
+  host->has_events_listener = FALSE;
+  host->consumers = 0;
+}
+
+void CaptureHostRegisterChannels(CaptureHost* host,
+                                 FlBinaryMessenger* messenger,
+                                 const gchar* stream_channel_name,
+                                 const gchar* status_channel_name,
+                                 const gchar* decibel_channel_name,
+                                 const gchar* events_channel_name) {
+  g_autoptr(FlStandardMethodCodec) codec = fl_standard_method_codec_new();
+
+  host->messenger = messenger;
+  host->stream_channel_name = stream_channel_name;
+
+  // The channels are cleared in CaptureHostDispose, before |host| goes away,
+  // so the handlers do not need to hold a reference.
+  host->event_channel = fl_event_channel_new(messenger, stream_channel_name,
+                                             FL_METHOD_CODEC(codec));
+  fl_event_channel_set_stream_handlers(host->event_channel, OnListenHandler,
+                                       OnCancelHandler, host, nullptr);
+
+  // Register status event channel
+  host->status_event_channel = fl_event_channel_new(
+      messenger, status_channel_name, FL_METHOD_CODEC(codec));
+  fl_event_channel_set_stream_handlers(host->status_event_channel,
+                                       OnStatusListenHandler,
+                                       OnStatusCancelHandler, host, nullptr);
+
+  // Register decibel event channel
+  host->decibel_event_channel = fl_event_channel_new(
+      messenger, decibel_channel_name, FL_METHOD_CODEC(codec));
+  fl_event_channel_set_stream_handlers(host->decibel_event_channel,
+                                       OnDecibelListenHandler,
+                                       OnDecibelCancelHandler, host, nullptr);
+
+  // Register session events channel
+  host->events_event_channel = fl_event_channel_new(
+      messenger, events_channel_name, FL_METHOD_CODEC(codec));
+  fl_event_channel_set_stream_handlers(host->events_event_channel,
+                                       OnEventsListenHandler,
+                                       OnEventsCancelHandler, host, nullptr);
+}
+
+void CaptureHostDispose(CaptureHost* host) {
+  CaptureHostStopAllSessions(host);
+
+  if (host->event_channel != nullptr) {
+    g_clear_object(&host->event_channel);
+  }
+
+  if (host->status_event_channel != nullptr) {
+    g_clear_object(&host->status_event_channel);
+  }
+
+  if (host->decibel_event_channel != nullptr) {
+    g_clear_object(&host->decibel_event_channel);
+  }
+
+  if (host->events_event_channel != nullptr) {
+    g_clear_object(&host->events_event_channel);
+  }
+
+  if (host->main_context != nullptr) {
+    g_main_context_unref(host->main_context);
+    host->main_context = nullptr;
+  }
+
+  g_mutex_clear(&host->lock);
+}
+
+bool CaptureHostIsCapturing(CaptureHost* host) {
+  bool is_capturing = false;
+  g_mutex_lock(&g_sessions_lock);
+  if (g_sessions != nullptr) {
+    GHashTableIter iter;
+    gpointer value = nullptr;
+    g_hash_table_iter_init(&iter, g_sessions);
+    while (g_hash_table_iter_next(&iter, nullptr, &value)) {
+      if (static_cast<CaptureSession*>(value)->host == host) {
+        is_capturing = true;
+        break;
+      }
+    }
+  }
+  g_mutex_unlock(&g_sessions_lock);
+  return is_capturing;
+}
+
+void CaptureHostSendStatus(CaptureHost* host, gboolean is_active,
+                           guint session_id, const std::string& device_name) {
+  g_mutex_lock(&host->lock);
+  const gboolean has_status_listener = host->has_status_listener;
+  g_mutex_unlock(&host->lock);
+
+  if (!has_status_listener || host->status_event_channel == nullptr) {
+    return;
+  }
+
+  g_autoptr(FlValue) status_map = fl_value_new_map();
+  fl_value_set_string_take(status_map, "isActive", fl_value_new_bool(is_active));
+  fl_value_set_string_take(status_map, "timestamp", fl_value_new_float(g_get_real_time() / 1000000.0));
+  if (session_id != 0) {
+    fl_value_set_string_take(status_map, "sessionId", fl_value_new_int(session_id));
+  }
+  if (!device_name.empty()) {
+    fl_value_set_string_take(status_map, "deviceName", fl_value_new_string(device_name.c_str()));
+  }
+
+  g_autoptr(GError) error = nullptr;
+  fl_event_channel_send(host->status_event_channel, status_map, nullptr, &error);
+}
+
+guint CaptureSessionStart(CaptureHost* host, pa_simple* stream,
+                          const CaptureSessionConfig& config,
+                          const std::string& device_name) {
+  pa_simple* streams[] = {stream};
+  const CaptureFormat capture_formats[] = {config.capture_format};
+  return StartSession(host, streams, capture_formats, 1, config, nullptr,
+                      device_name);
+}
+
+guint CaptureSessionStartSynced(CaptureHost* host, pa_simple* mic_stream,
+                                pa_simple* system_stream,
+                                const CaptureSessionConfig& config,
+                                const SyncedCaptureConfig& synced_config) {
+  pa_simple* streams[kMaxSources];
+  streams[kMicSource] = mic_stream;
+  streams[kSystemSource] = system_stream;
+  CaptureFormat capture_formats[kMaxSources];
+  capture_formats[kMicSource] = config.capture_format;
+  capture_formats[kSystemSource] = synced_config.system_capture_format;
+  return StartSession(host, streams, capture_formats, kMaxSources, config,
+                      &synced_config, std::string());
+}
+
+FlValue* CaptureSessionGetStats(CaptureHost* host, guint session_id) {
+  CaptureSession* session = LookupSession(host, session_id);
+  if (session == nullptr) {
+    return nullptr;
+  }
+
+  g_mutex_lock(&session->stats_lock);
+  const SessionStats stats = session->stats;
+  g_mutex_unlock(&session->stats_lock);
+
+  FlValue* stats_map = fl_value_new_map();
+  fl_value_set_string_take(stats_map, "sessionId", fl_value_new_int(session->id));
+  fl_value_set_string_take(stats_map, "chunksCaptured", fl_value_new_int(stats.chunks_captured));
+  fl_value_set_string_take(stats_map, "droppedChunks", fl_value_new_int(stats.dropped_chunks));
+  fl_value_set_string_take(stats_map, "overruns", fl_value_new_int(stats.overruns));
+  fl_value_set_string_take(stats_map, "lostFrames", fl_value_new_int(stats.lost_frames));
+  fl_value_set_string_take(stats_map, "filledFrames", fl_value_new_int(stats.filled_frames));
+  fl_value_set_string_take(stats_map, "scheduling", fl_value_new_string(ThreadSchedulingName(stats.scheduling)));
+  fl_value_set_string_take(stats_map, "realtimeThreads", fl_value_new_int(stats.realtime_readers));
+  fl_value_set_string_take(stats_map, "jitterSamples", fl_value_new_int(stats.jitter_samples));
+  fl_value_set_string_take(stats_map, "jitterMeanUs", fl_value_new_int(stats.jitter_samples > 0 ? stats.jitter_total_us / static_cast<gint64>(stats.jitter_samples) : 0));
+  fl_value_set_string_take(stats_map, "jitterMaxUs", fl_value_new_int(stats.jitter_max_us));
+  g_autoptr(FlValue) histogram = fl_value_new_list();
+  for (int i = 0; i < kJitterBuckets; ++i) {
+    fl_value_append_take(histogram, fl_value_new_int(stats.jitter_histogram[i]));
+  }
+  fl_value_set_string(stats_map, "jitterHistogram", histogram);
+
+  size_t ready_depth = 0;
+  size_t ready_capacity = 0;
+  for (int i = 0; i < session->source_count; ++i) {
+    ready_depth += session->sources[i].ready_chunks->Size();
+    ready_capacity += session->sources[i].ready_chunks->Capacity();
+  }
+  fl_value_set_string_take(stats_map, "readyQueueDepth", fl_value_new_int(ready_depth));
+  fl_value_set_string_take(stats_map, "readyQueueCapacity", fl_value_new_int(ready_capacity));
+  fl_value_set_string_take(stats_map, "readyQueueHighWater", fl_value_new_int(stats.ready_high_water));
+  fl_value_set_string_take(stats_map, "readyWaitMaxUs", fl_value_new_int(stats.ready_wait_max_us));
+  fl_value_set_string_take(stats_map, "processedChunks", fl_value_new_int(stats.processed_chunks));
+  fl_value_set_string_take(stats_map, "processingMeanUs", fl_value_new_int(stats.processed_chunks > 0 ? stats.processing_total_us / static_cast<gint64>(stats.processed_chunks) : 0));
+  fl_value_set_string_take(stats_map, "processingMaxUs", fl_value_new_int(stats.processing_max_us));
+  fl_value_set_string_take(stats_map, "emitQueueDepth", fl_value_new_int(g_atomic_int_get(&session->pending_emissions)));
+  fl_value_set_string_take(stats_map, "emitQueueCapacity", fl_value_new_int(session->emit_pool->buffer_count()));
+  fl_value_set_string_take(stats_map, "emitQueueHighWater", fl_value_new_int(stats.emit_high_water));
+  fl_value_set_string_take(stats_map, "emitDroppedChunks", fl_value_new_int(stats.emit_dropped_chunks));
+  fl_value_set_string_take(stats_map, "emittedChunks", fl_value_new_int(stats.emitted_chunks));
+  fl_value_set_string_take(stats_map, "emitWaitMeanUs", fl_value_new_int(stats.emitted_chunks > 0 ? stats.emit_wait_total_us / static_cast<gint64>(stats.emitted_chunks) : 0));
+  fl_value_set_string_take(stats_map, "emitWaitMaxUs", fl_value_new_int(stats.emit_wait_max_us));
+
+  g_autoptr(FlValue) capture_rates = fl_value_new_list();
+  for (int i = 0; i < session->source_count; ++i) {
+    fl_value_append_take(capture_rates, fl_value_new_int(session->sources[i].capture_rate));
+  }
+  fl_value_set_string(stats_map, "captureRates", capture_rates);
+  g_autoptr(FlValue) capture_formats = fl_value_new_list();
+  for (int i = 0; i < session->source_count; ++i) {
+    fl_value_append_take(capture_formats, fl_value_new_string(SampleFormatName(session->sources[i].sample_format)));
+  }
+  fl_value_set_string(stats_map, "captureFormats", capture_formats);
+  fl_value_set_string_take(stats_map, "convertedChunks", fl_value_new_int(stats.converted_chunks));
+  fl_value_set_string_take(stats_map, "conversionMeanUs", fl_value_new_int(stats.converted_chunks > 0 ? stats.conversion_total_us / static_cast<gint64>(stats.converted_chunks) : 0));
+  fl_value_set_string_take(stats_map, "conversionMaxUs", fl_value_new_int(stats.conversion_max_us));
+  if (stats.has_loudness) {
+    fl_value_set_string_take(stats_map, "loudness", LoudnessToMap(stats.loudness));
+  }
+  if (stats.has_delay) {
+    fl_value_set_string_take(stats_map, "delayMs", fl_value_new_float(stats.delay.delay_ms));
+    fl_value_set_string_take(stats_map, "delayConfidence", fl_value_new_float(stats.delay.confidence));
+  }
+  if (stats.has_echo) {
+    fl_value_set_string_take(stats_map, "echoDelayMs", fl_value_new_int(static_cast<gint64>(stats.echo_delay_frames * 1000 / session->config.sample_rate)));
+    fl_value_set_string_take(stats_map, "echoErleDb", fl_value_new_float(stats.echo_erle_db));
+  }
+
+  CaptureSessionUnref(session);
+  return stats_map;
+}
+
+bool CaptureSessionStop(CaptureHost* host, guint session_id) {
+  CaptureSession* session = LookupSession(host, session_id);
+  if (session == nullptr) {
+    return false;
+  }
+
+  FinishSession(session);
+  CaptureSessionUnref(session);
+  return true;
+}
+
+bool CaptureHostStopAllSessions(CaptureHost* host) {
+  std::vector<guint> session_ids;
+  g_mutex_lock(&g_sessions_lock);
+  if (g_sessions != nullptr) {
+    GHashTableIter iter;
+    gpointer key = nullptr;
+    gpointer value = nullptr;
+    g_hash_table_iter_init(&iter, g_sessions);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+      if (static_cast<CaptureSession*>(value)->host == host) {
+        session_ids.push_back(GPOINTER_TO_UINT(key));
+      }
+    }
+  }
+  g_mutex_unlock(&g_sessions_lock);
+
+  bool stopped = false;
+  for (guint session_id : session_ids) {
+    stopped = CaptureSessionStop(host, session_id) || stopped;
+  }
+  return stopped;
+}
+
+}  // namespace audio_capture
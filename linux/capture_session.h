@@ -0,0 +1,317 @@
+#ifndef FLUTTER_PLUGIN_CAPTURE_SESSION_H_
+#define FLUTTER_PLUGIN_CAPTURE_SESSION_H_
+
+#include <flutter_linux/flutter_linux.h>
+#include <glib-object.h>
+#include <glib.h>
+#include <pulse/simple.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "biquad.h"
+#include "compressor.h"
+#include "delay_estimator.h"
+#include "gain_control.h"
+#include "level_meter.h"
+#include "loudness_meter.h"
+#include "mel_spectrogram.h"
+#include "noise_suppressor.h"
+#include "resampler.h"
+#include "sample_format.h"
+#include "spectrum_analyzer.h"
+#include "voice_detector.h"
+#include "waveform_decimator.h"
+
+namespace audio_capture {
+
+// Plugin-side state shared by every capture session of one plugin instance:
+// the plugin-level event channels and the listener state reported by their
+// stream handlers. Embedded in the plugin struct.
+struct CaptureHost {
+  GObject* owner;  // The plugin embedding this host (not referenced).
+  FlBinaryMessenger* messenger;
+  GMainContext* main_context;
+  const gchar* stream_channel_name;  // Sessions append "/<sessionId>".
+  const gchar* thread_name;
+
+  FlEventChannel* event_channel;
+  FlEventChannel* status_event_channel;
+  FlEventChannel* decibel_event_channel;
+  FlEventChannel* events_event_channel;  // Overruns and other session events.
+
+  GMutex lock;
+  gboolean has_listener;
+  gboolean has_status_listener;
+  gboolean has_decibel_listener;
+  gboolean has_events_listener;
+  // What the PCM and decibel listeners above consume, kept in step with
+  // them for the processing workers to read without |lock|. Work nobody
+  // consumes is skipped.
+  gint consumers;
+};
+
+// Rate and sample format a stream is opened at.
+struct CaptureFormat {
+  int rate;  // 0 for the session's sample rate.
+  SampleFormat sample_format;
+};
+
+// Negotiated stream parameters for one session.
+struct CaptureSessionConfig {
+  int sample_rate;
+  int channels;
+  int bits_per_sample;
+  size_t chunk_size;  // Bytes per emitted chunk.
+  // Bytes per pa_simple_read. |chunk_size| unless the meter reads shorter
+  // pieces, which single-source sessions reassemble into chunks.
+  size_t read_size;
+  float gain_boost;
+  float input_volume;
+  // Filter stages run in order on the audio as read, before anything
+  // measures or processes it: DC removal, rumble and hum, or tone shaping.
+  // Empty for none. Single-source sessions.
+  std::vector<FilterSpec> filters;
+  // Suppress steady background noise with a NoiseSuppressor, which delays
+  // the output by one frame (16 ms at 16 kHz) behind the chunk timing. Runs
+  // on the mono audio after the input volume, before the gain boost, the
+  // compressor and the gain control. Single-source sessions emitting PCM
+  // only.
+  bool noise_suppression;
+  NoiseOptions noise_options;
+  // Automatic gain control in place of |gain_boost|: the processed output
+  // is steered towards a target level and peak limited by an
+  // AutomaticGainControl, lagging the chunk timing by its look-ahead. The
+  // gain is sent with every level. Single-source sessions emitting PCM
+  // only.
+  bool agc;
+  AgcOptions agc_options;
+  // Compress the gained output with a soft-knee Compressor and brickwall
+  // limiter instead of clamping it, and send the gain reduction with every
+  // level. Synced sessions compress each gained track. Sessions emitting
+  // PCM only; levels and loudness are still measured on the audio as read.
+  bool compressor;
+  CompressorOptions compressor_options;
+  // Replace audio lost to overruns with as many silent frames, so sample
+  // positions stay on the capture timeline. Synced sessions always do.
+  bool fill_gaps;
+
+  // Opt-in scheduling of the reader threads. Real-time mode requests
+  // SCHED_RR at |realtime_priority| and prefaults and locks the stack and
+  // chunk buffers of each reader.
+  bool realtime;
+  int realtime_priority;
+  guint64 cpu_mask;  // Bit n pins the readers to CPU n; 0 for any CPU.
+
+  // Open streams at their source's own rate and sample format and convert
+  // to S16 at |sample_rate| in-process instead of in the audio server.
+  bool native_rate;
+  ResamplerQuality resample_quality;
+  // Format the stream was opened at. Chunks are read in this format and
+  // converted by the session.
+  CaptureFormat capture_format;
+
+  // Levels on the decibel stream. With |meter_rate_hz| 0 every chunk
+  // carries the RMS level of its samples. Otherwise a LevelMeter measures
+  // blocks of 1/|meter_rate_hz| seconds with |meter_options| as audio is
+  // read, and reads are at most one block long.
+  int meter_rate_hz;
+  MeterOptions meter_options;
+  // Level meter only: no PCM is emitted, reads cover a large fragment, and
+  // the levels are sent at the meter rate by a paced main loop source.
+  bool meter_only;
+  // Measure EBU R128 loudness on all captured audio, and send it with
+  // every level and in the stats. Single-source sessions only.
+  bool loudness;
+
+  // Detect voice activity in the processed output, reporting speech
+  // starting and ending and the speech probability of every chunk. With
+  // |speech_only| the samples of chunks without speech are held back,
+  // except for up to |voice_pre_roll_ms| leading into the next chunk with
+  // speech. Single-source sessions emitting PCM only.
+  bool voice_activity;
+  VoiceOptions voice_options;
+  int voice_pre_roll_ms;
+  bool speech_only;
+
+  // Deliver PCM as whole utterances instead of chunks: the detected speech,
+  // led in by up to |voice_pre_roll_ms| before it, ending once the voice
+  // hangover passes or after |max_utterance_ms| of speech. Requires
+  // |voice_activity|.
+  bool segment_utterances;
+  int max_utterance_ms;
+
+  // Extract log-mel features from the processed output and send them on
+  // the session's features channel. Single-source sessions emitting PCM
+  // only.
+  bool mel_features;
+  MelOptions mel_options;
+
+  // Analyze the spectrum of the processed output and send the band levels
+  // on the session's spectrum channel about |spectrum_rate_hz| times a
+  // second, at most once per FFT frame. Single-source sessions emitting PCM
+  // only.
+  bool spectrum;
+  SpectrumOptions spectrum_options;
+  int spectrum_rate_hz;
+
+  // Reduce the processed output to min/max/RMS buckets at one or more
+  // resolutions and send them on the session's waveform channel as they
+  // complete. Single-source sessions emitting PCM only.
+  bool waveform;
+  WaveformOptions waveform_options;
+};
+
+// Reads the scheduling options of a start call ("realtime",
+// "realtimePriority" and "cpuAffinity") into |config|, defaulting to normal
+// scheduling on any CPU.
+void ParseSchedulingArgs(FlValue* args, CaptureSessionConfig* config);
+
+// Reads the conversion options of a start call ("nativeRate" and
+// "resampleQuality") into |config|, defaulting to server-side conversion.
+void ParseResampleArgs(FlValue* args, CaptureSessionConfig* config);
+
+// Reads the meter options of a start call ("meterOnly", "meterRateHz",
+// "meterWindowMs", "meterAttackMs", "meterReleaseMs", "meterHoldMs" and
+// "loudness") into |config| and sets |read_size| from them. A meter-only
+// session reads fragments of at least 100 ms and at least one meter period,
+// replacing |chunk_size|, and lets the server convert, clearing
+// |native_rate|. Call after the other options.
+void ParseMeterArgs(FlValue* args, CaptureSessionConfig* config);
+
+// Reads the gain control options of a start call ("agc", "agcDetector",
+// "agcTargetDb", "agcWindowMs", "agcAttackMs", "agcReleaseMs",
+// "agcMaxGainDb", "agcGateDb", "agcLookaheadMs" and "agcCeilingDb") into
+// |config|, defaulting to none. Gain control replaces the gain boost, so
+// call after setting |gain_boost|.
+void ParseGainArgs(FlValue* args, CaptureSessionConfig* config);
+
+// Reads the filter chain of a start call ("filters": a list of maps with
+// "type" one of "dcBlock", "highPass", "lowPass", "lowShelf", "highShelf"
+// or "notch", and "frequencyHz", "q" and "gainDb") into |config|,
+// defaulting to none. Unknown types are skipped.
+void ParseFilterArgs(FlValue* args, CaptureSessionConfig* config);
+
+// Reads the compressor options of a start call ("compressor",
+// "compressorThresholdDb", "compressorRatio", "compressorKneeDb",
+// "compressorAttackMs", "compressorReleaseMs" and "compressorCeilingDb")
+// into |config|, defaulting to none.
+void ParseCompressorArgs(FlValue* args, CaptureSessionConfig* config);
+
+// Reads the noise suppression option of a start call ("noiseSuppression":
+// "low", "moderate", "high" or "veryHigh") into |config|, defaulting to
+// none.
+void ParseNoiseArgs(FlValue* args, CaptureSessionConfig* config);
+
+// Reads the voice activity options of a start call ("voiceActivity",
+// "voiceThreshold", "voiceHangoverMs", "voicePreRollMs" and "speechOnly")
+// and the segmentation options ("utterances", "utteranceThreshold",
+// "utteranceSilenceMs", "utterancePreRollMs" and "utteranceMaxMs") into
+// |config|, defaulting to neither. Segmentation enables voice activity
+// detection and overrides its options.
+void ParseVoiceArgs(FlValue* args, CaptureSessionConfig* config);
+
+// Reads the feature extraction options of a start call ("melFeatures",
+// "melBins", "melWindowMs", "melHopMs", "melLowHz" and "melHighHz") into
+// |config|, defaulting to none.
+void ParseFeatureArgs(FlValue* args, CaptureSessionConfig* config);
+
+// Reads the spectrum analyzer options of a start call ("spectrum",
+// "spectrumFftSize", "spectrumOverlap", "spectrumBands", "spectrumLowHz",
+// "spectrumHighHz", "spectrumSmoothing" and "spectrumRateHz") into
+// |config|, defaulting to none.
+void ParseSpectrumArgs(FlValue* args, CaptureSessionConfig* config);
+
+// Reads the waveform options of a start call ("waveform",
+// "waveformBucketRateHz" and "waveformLevels") into |config|, defaulting to
+// none.
+void ParseWaveformArgs(FlValue* args, CaptureSessionConfig* config);
+
+// Returns the format to open |source_name| at: its own rate and sample
+// format if |config.native_rate| is set and the server reports them, else
+// S16 at |config.sample_rate|. A source format the session cannot convert
+// is left to the server. Blocks for a server round trip in native mode.
+CaptureFormat ResolveCaptureFormat(const CaptureSessionConfig& config,
+                                   const std::string& source_name);
+
+// Bytes per read in |format| covering as much time as |config.read_size|
+// at |config.sample_rate|.
+size_t CaptureChunkSize(const CaptureSessionConfig& config,
+                        const CaptureFormat& format);
+
+void CaptureHostInit(CaptureHost* host, GObject* owner,
+                     const gchar* thread_name);
+
+// Creates the plugin-level event channels. |stream_channel_name| is also the
+// prefix of the per-session PCM channels.
+void CaptureHostRegisterChannels(CaptureHost* host,
+                                 FlBinaryMessenger* messenger,
+                                 const gchar* stream_channel_name,
+                                 const gchar* status_channel_name,
+                                 const gchar* decibel_channel_name,
+                                 const gchar* events_channel_name);
+
+// Stops every session of |host| and releases its channels.
+void CaptureHostDispose(CaptureHost* host);
+
+bool CaptureHostIsCapturing(CaptureHost* host);
+
+// Sends a status event on the plugin status channel. Main thread only.
+// |session_id| 0 and an empty |device_name| are omitted from the event.
+void CaptureHostSendStatus(CaptureHost* host, gboolean is_active,
+                           guint session_id, const std::string& device_name);
+
+// How a synced session delivers its two tracks.
+enum class SyncedOutputMode {
+  kInterleaved,  // Two-channel frames: microphone, then system audio.
+  kMixed,        // One channel: the weighted sum of both tracks.
+  // One channel: the microphone track with the echo of the system audio
+  // playing on the speakers removed, the system track as the reference.
+  kEchoCancelled,
+};
+
+// Track settings of a synced microphone + system audio session. The track
+// gains replace CaptureSessionConfig::gain_boost.
+struct SyncedCaptureConfig {
+  SyncedOutputMode mode;
+  float mic_gain;
+  float system_gain;
+  // Whether the delay of the microphone behind the system audio is
+  // measured, reported in the stats and as "delay" events.
+  bool estimate_delay;
+  DelayOptions delay_options;
+  // Format |system_stream| was opened at.
+  // CaptureSessionConfig::capture_format applies to the microphone stream.
+  CaptureFormat system_capture_format;
+};
+
+// Starts a session reading from |stream|, which the session takes ownership
+// of (it is freed even if starting fails). Returns the session id, or 0.
+guint CaptureSessionStart(CaptureHost* host, pa_simple* stream,
+                          const CaptureSessionConfig& config,
+                          const std::string& device_name);
+
+// Starts a session reading |mic_stream| and |system_stream| together. Both
+// streams must use |config|, each in its own capture format; they are placed
+// on one monotonic timeline from their first chunk's capture time and then
+// aligned by sample position.
+// Takes ownership of both streams. Returns the session id, or 0.
+guint CaptureSessionStartSynced(CaptureHost* host, pa_simple* mic_stream,
+                                pa_simple* system_stream,
+                                const CaptureSessionConfig& config,
+                                const SyncedCaptureConfig& synced_config);
+
+// Returns a new map with the counters of session |session_id| of |host|, or
+// nullptr if it is not running.
+FlValue* CaptureSessionGetStats(CaptureHost* host, guint session_id);
+
+// Stops one session of |host|. Returns false if it is not running.
+bool CaptureSessionStop(CaptureHost* host, guint session_id);
+
+// Stops every session of |host|. Returns false if none was running.
+bool CaptureHostStopAllSessions(CaptureHost* host);
+
+}  // namespace audio_capture
+
+#endif  // FLUTTER_PLUGIN_CAPTURE_SESSION_H_
@@ -0,0 +1,159 @@
+#include "realtime_thread.h"
+
+#include <gio/gio.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace audio_capture {
+
+namespace {
+
+#ifndef SCHED_RESET_ON_FORK
+#define SCHED_RESET_ON_FORK 0x40000000
+#endif
+
+constexpr char kRtkitService[] = "org.freedesktop.RealtimeKit1";
+constexpr char kRtkitPath[] = "/org/freedesktop/RealtimeKit1";
+constexpr char kRtkitInterface[] = "org.freedesktop.RealtimeKit1";
+constexpr char kPropertiesInterface[] = "org.freedesktop.DBus.Properties";
+constexpr gint kRtkitTimeoutMs = 1000;
+
+constexpr size_t kPrefaultStackBytes = 64 * 1024;
+
+bool SetRoundRobin(int priority) {
+  struct sched_param param = {};
+  param.sched_priority = priority;
+  // Threads forked from a real-time thread start out normal again.
+  return sched_setscheduler(0, SCHED_RR | SCHED_RESET_ON_FORK, &param) == 0;
+}
+
+// Returns a new reference to the value of a RealtimeKit property, or nullptr.
+GVariant* GetRtkitProperty(GDBusConnection* connection, const char* name) {
+  g_autoptr(GError) error = nullptr;
+  GVariant* reply = g_dbus_connection_call_sync(
+      connection, kRtkitService, kRtkitPath, kPropertiesInterface, "Get",
+      g_variant_new("(ss)", kRtkitInterface, name), G_VARIANT_TYPE("(v)"),
+      G_DBUS_CALL_FLAGS_NONE, kRtkitTimeoutMs, nullptr, &error);
+  if (reply == nullptr) {
+    return nullptr;
+  }
+  GVariant* value = nullptr;
+  g_variant_get(reply, "(v)", &value);
+  g_variant_unref(reply);
+  return value;
+}
+
+bool RequestRtkitRealtime(int priority) {
+  g_autoptr(GError) error = nullptr;
+  g_autoptr(GDBusConnection) connection =
+      g_bus_get_sync(G_BUS_TYPE_SYSTEM, nullptr, &error);
+  if (connection == nullptr) {
+    g_warning("Failed to connect to the system bus: %s",
+              error != nullptr ? error->message : "unknown error");
+    return false;
+  }
+
+  GVariant* max_priority = GetRtkitProperty(connection, "MaxRealtimePriority");
+  if (max_priority != nullptr) {
+    priority = std::min(priority,
+                        static_cast<int>(g_variant_get_int32(max_priority)));
+    g_variant_unref(max_priority);
+  }
+
+  // RealtimeKit only serves processes whose real-time CPU time is bounded,
+  // so a runaway thread gets SIGXCPU instead of freezing the desktop.
+  GVariant* max_rttime = GetRtkitProperty(connection, "RTTimeUSecMax");
+  if (max_rttime != nullptr) {
+    const rlim_t rttime = static_cast<rlim_t>(g_variant_get_int64(max_rttime));
+    g_variant_unref(max_rttime);
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_RTTIME, &limit) == 0 && limit.rlim_max > rttime) {
+      limit.rlim_cur = rttime;
+      limit.rlim_max = rttime;
+      setrlimit(RLIMIT_RTTIME, &limit);
+    }
+  }
+
+  const guint64 thread_id = static_cast<guint64>(syscall(SYS_gettid));
+  GVariant* reply = g_dbus_connection_call_sync(
+      connection, kRtkitService, kRtkitPath, kRtkitInterface,
+      "MakeThreadRealtime",
+      g_variant_new("(tu)", thread_id, static_cast<guint32>(priority)),
+      nullptr, G_DBUS_CALL_FLAGS_NONE, kRtkitTimeoutMs, nullptr, &error);
+  if (reply == nullptr) {
+    g_warning("RealtimeKit refused real-time scheduling: %s",
+              error != nullptr ? error->message : "unknown error");
+    return false;
+  }
+  g_variant_unref(reply);
+  return true;
+}
+
+}  // namespace
+
+const char* ThreadSchedulingName(ThreadScheduling scheduling) {
+  switch (scheduling) {
+    case ThreadScheduling::kDirect:
+      return "direct";
+    case ThreadScheduling::kRtkit:
+      return "rtkit";
+    case ThreadScheduling::kNormal:
+      break;
+  }
+  return "normal";
+}
+
+ThreadScheduling MakeCurrentThreadRealtime(int priority) {
+  priority = std::max(1, std::min(priority, 99));
+  if (SetRoundRobin(priority)) {
+    return ThreadScheduling::kDirect;
+  }
+  if (RequestRtkitRealtime(priority)) {
+    return ThreadScheduling::kRtkit;
+  }
+  return ThreadScheduling::kNormal;
+}
+
+bool PinCurrentThread(guint64 cpu_mask) {
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  for (int cpu = 0; cpu < 64 && cpu < CPU_SETSIZE; ++cpu) {
+    if ((cpu_mask >> cpu) & 1) {
+      CPU_SET(cpu, &cpus);
+    }
+  }
+  return CPU_COUNT(&cpus) > 0 &&
+         pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+}
+
+bool PrefaultAndLock(void* data, size_t size) {
+  if (data == nullptr || size == 0) {
+    return true;
+  }
+  const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  volatile guint8* bytes = static_cast<volatile guint8*>(data);
+  for (size_t offset = 0; offset < size; offset += page_size) {
+    bytes[offset] = bytes[offset];
+  }
+  bytes[size - 1] = bytes[size - 1];
+  return mlock(data, size) == 0;
+}
+
+// Not inlined, so the buffer lies below the caller's frame: the part of the
+// stack the caller grows into.
+__attribute__((noinline)) bool PrefaultAndLockStack() {
+  volatile guint8 stack[kPrefaultStackBytes];
+  for (size_t offset = 0; offset < kPrefaultStackBytes; offset += 1024) {
+    stack[offset] = 0;
+  }
+  return mlock(const_cast<guint8*>(stack), kPrefaultStackBytes) == 0;
+}
+
+}  // namespace audio_capture
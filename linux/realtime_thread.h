@@ -0,0 +1,41 @@
+#ifndef FLUTTER_PLUGIN_REALTIME_THREAD_H_
+#define FLUTTER_PLUGIN_REALTIME_THREAD_H_
+
+#include <glib.h>
+
+#include <cstddef>
+
+namespace audio_capture {
+
+// How a thread ended up being scheduled.
+enum class ThreadScheduling {
+  kNormal,  // Real-time scheduling was not requested or not granted.
+  kDirect,  // SCHED_RR set by the process itself (RLIMIT_RTPRIO/CAP_SYS_NICE).
+  kRtkit,   // SCHED_RR granted by RealtimeKit.
+};
+
+// Name reported to Dart: "normal", "direct" or "rtkit".
+const char* ThreadSchedulingName(ThreadScheduling scheduling);
+
+// Switches the calling thread to SCHED_RR at |priority| (1-99). Tries the
+// scheduler directly first and falls back to RealtimeKit on the system bus,
+// which may lower the priority to its configured maximum and bounds
+// RLIMIT_RTTIME of the process as RealtimeKit requires. Blocks for at most a
+// few D-Bus round trips. Returns kNormal if neither way is permitted.
+ThreadScheduling MakeCurrentThreadRealtime(int priority);
+
+// Restricts the calling thread to the CPUs set in |cpu_mask| (bit n is CPU
+// n). Returns false if the mask names no usable CPU.
+bool PinCurrentThread(guint64 cpu_mask);
+
+// Touches every page of |size| bytes at |data| without changing them and
+// locks them into memory, so accessing them never page-faults. Returns false
+// if locking failed (RLIMIT_MEMLOCK); the pages are still prefaulted.
+bool PrefaultAndLock(void* data, size_t size);
+
+// Prefaults and locks the next 64 KiB of the calling thread's stack.
+bool PrefaultAndLockStack();
+
+}  // namespace audio_capture
+
+#endif  // FLUTTER_PLUGIN_REALTIME_THREAD_H_
@@ -0,0 +1,130 @@
+#include "source_info.h"
+
+#include <glib.h>
+#include <pulse/pulseaudio.h>
+
+namespace audio_capture {
+
+namespace {
+
+constexpr gint64 kQueryTimeoutUs = G_USEC_PER_SEC;
+
+struct SourceQuery {
+  bool done;
+  bool found;
+  pa_sample_spec spec;
+};
+
+void OnSourceInfo(pa_context* context, const pa_source_info* info, int eol,
+                  void* user_data) {
+  (void)context;
+  SourceQuery* query = static_cast<SourceQuery*>(user_data);
+  if (eol != 0 || info == nullptr) {
+    query->done = true;
+    return;
+  }
+  query->found = true;
+  query->spec = info->sample_spec;
+}
+
+// Runs |mainloop| until |done| returns true or the deadline passes.
+template <typename Predicate>
+bool IterateUntil(pa_mainloop* mainloop, gint64 deadline, Predicate done) {
+  while (!done()) {
+    if (g_get_monotonic_time() > deadline ||
+        pa_mainloop_iterate(mainloop, 0, nullptr) < 0) {
+      return false;
+    }
+    g_usleep(1000);
+  }
+  return true;
+}
+
+}  // namespace
+
+pa_sample_format_t PulseSampleFormat(SampleFormat format) {
+  switch (format) {
+    case SampleFormat::kS16:
+      return PA_SAMPLE_S16LE;
+    case SampleFormat::kS24:
+      return PA_SAMPLE_S24LE;
+    case SampleFormat::kS24In32:
+      return PA_SAMPLE_S24_32LE;
+    case SampleFormat::kS32:
+      return PA_SAMPLE_S32LE;
+    case SampleFormat::kF32:
+      return PA_SAMPLE_FLOAT32LE;
+    case SampleFormat::kF64:
+      break;  // Not a PulseAudio format.
+  }
+  return PA_SAMPLE_INVALID;
+}
+
+bool GetPulseSampleFormat(pa_sample_format_t format,
+                          SampleFormat* sample_format) {
+  switch (format) {
+    case PA_SAMPLE_S16LE:
+      *sample_format = SampleFormat::kS16;
+      return true;
+    case PA_SAMPLE_S24LE:
+      *sample_format = SampleFormat::kS24;
+      return true;
+    case PA_SAMPLE_S24_32LE:
+      *sample_format = SampleFormat::kS24In32;
+      return true;
+    case PA_SAMPLE_S32LE:
+      *sample_format = SampleFormat::kS32;
+      return true;
+    case PA_SAMPLE_FLOAT32LE:
+      *sample_format = SampleFormat::kF32;
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool QuerySourceSampleSpec(const std::string& source_name,
+                           pa_sample_spec* spec, std::string* error_message) {
+  const gint64 deadline = g_get_monotonic_time() + kQueryTimeoutUs;
+  pa_mainloop* mainloop = pa_mainloop_new();
+  pa_context* context =
+      pa_context_new(pa_mainloop_get_api(mainloop), "Voxa");
+
+  bool ok = false;
+  if (pa_context_connect(context, nullptr, PA_CONTEXT_NOAUTOSPAWN, nullptr) >=
+      0) {
+    const bool ready = IterateUntil(mainloop, deadline, [context]() {
+      const pa_context_state_t state = pa_context_get_state(context);
+      return state == PA_CONTEXT_READY || state == PA_CONTEXT_FAILED ||
+             state == PA_CONTEXT_TERMINATED;
+    });
+    if (ready && pa_context_get_state(context) == PA_CONTEXT_READY) {
+      SourceQuery query = {};
+      const char* name = source_name.empty() ? "@DEFAULT_SOURCE@"
+                                             : source_name.c_str();
+      pa_operation* operation = pa_context_get_source_info_by_name(
+          context, name, OnSourceInfo, &query);
+      if (operation != nullptr) {
+        IterateUntil(mainloop, deadline, [&query]() { return query.done; });
+        pa_operation_unref(operation);
+      }
+      if (query.found) {
+        *spec = query.spec;
+        ok = true;
+      } else if (error_message != nullptr) {
+        *error_message = "No such source: " + std::string(name);
+      }
+    } else if (error_message != nullptr) {
+      *error_message = "Could not connect to the audio server";
+    }
+    pa_context_disconnect(context);
+  } else if (error_message != nullptr) {
+    *error_message = "Could not connect to the audio server";
+  }
+
+  pa_context_unref(context);
+  pa_mainloop_free(mainloop);
+  return ok;
+}
+
+}  // namespace audio_capture
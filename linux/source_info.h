@@ -0,0 +1,30 @@
+#ifndef FLUTTER_PLUGIN_SOURCE_INFO_H_
+#define FLUTTER_PLUGIN_SOURCE_INFO_H_
+
+#include <pulse/sample.h>
+
+#include <string>
+
+#include "sample_format.h"
+
+namespace audio_capture {
+
+// The PulseAudio format of |format|.
+pa_sample_format_t PulseSampleFormat(SampleFormat format);
+
+// Reads the plugin's equivalent of PulseAudio format |format| into
+// |sample_format|. Returns false for formats it has none for, such as
+// big-endian and companded ones.
+bool GetPulseSampleFormat(pa_sample_format_t format,
+                          SampleFormat* sample_format);
+
+// Looks up the sample spec the server runs source |source_name| at. Accepts
+// the special names "@DEFAULT_SOURCE@" and "@DEFAULT_MONITOR@"; an empty name
+// means the default source. Connects to the server for the query, so it
+// blocks for a round trip or two; at most about a second.
+bool QuerySourceSampleSpec(const std::string& source_name,
+                           pa_sample_spec* spec, std::string* error_message);
+
+}  // namespace audio_capture
+
+#endif  // FLUTTER_PLUGIN_SOURCE_INFO_H_
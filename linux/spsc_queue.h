@@ -0,0 +1,72 @@
+#ifndef FLUTTER_PLUGIN_SPSC_QUEUE_H_
+#define FLUTTER_PLUGIN_SPSC_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace audio_capture {
+
+// Bounded lock-free queue for exactly one producer and one consumer thread.
+// Neither side ever blocks or allocates, so a real-time producer cannot be
+// held up by the consumer. The consumer may move between threads as long as
+// each handover synchronizes (e.g. through an atomic flag or a thread pool
+// push), and the same holds for the producer.
+template <typename T>
+class SpscQueue {
+ public:
+  // |capacity| is rounded up to a power of two.
+  explicit SpscQueue(size_t capacity) : head_(0), tail_(0) {
+    size_t size = 1;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    slots_.resize(size);
+    mask_ = size - 1;
+  }
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  // Producer only. Returns false, leaving |value| with the caller, if full.
+  bool Push(const T& value) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) > mask_) {
+      return false;
+    }
+    slots_[tail & mask_] = value;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only. Returns false if empty.
+  bool Pop(T* value) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    *value = slots_[head & mask_];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Number of queued values. Exact on either side, a snapshot elsewhere.
+  size_t Size() const {
+    // Head first: it never passes the tail, so the difference cannot wrap.
+    const size_t head = head_.load(std::memory_order_acquire);
+    return tail_.load(std::memory_order_acquire) - head;
+  }
+
+  size_t Capacity() const { return mask_ + 1; }
+
+ private:
+  std::vector<T> slots_;
+  size_t mask_;
+  // On separate cache lines so the two sides do not invalidate each other.
+  alignas(64) std::atomic<size_t> head_;  // Next slot to pop.
+  alignas(64) std::atomic<size_t> tail_;  // Next slot to push.
+};
+
+}  // namespace audio_capture
+
+#endif  // FLUTTER_PLUGIN_SPSC_QUEUE_H_
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "spsc_queue.h"
+
+namespace audio_capture {
+namespace test {
+
+TEST(SpscQueue, RoundsCapacityUpToPowerOfTwo) {
+  EXPECT_EQ(SpscQueue<int>(1).Capacity(), 1u);
+  EXPECT_EQ(SpscQueue<int>(5).Capacity(), 8u);
+  EXPECT_EQ(SpscQueue<int>(16).Capacity(), 16u);
+}
+
+TEST(SpscQueue, PopsInPushOrder) {
+  SpscQueue<int> queue(4);
+  int value = 0;
+  EXPECT_FALSE(queue.Pop(&value));
+
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(queue.Push(i));
+  }
+  EXPECT_FALSE(queue.Push(4));
+  EXPECT_EQ(queue.Size(), 4u);
+
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(queue.Pop(&value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_FALSE(queue.Pop(&value));
+  EXPECT_EQ(queue.Size(), 0u);
+}
+
+TEST(SpscQueue, WrapsAround) {
+  SpscQueue<int> queue(2);
+  int value = 0;
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(queue.Push(i));
+    ASSERT_TRUE(queue.Pop(&value));
+    EXPECT_EQ(value, i);
+  }
+}
+
+TEST(SpscQueue, HandsOverValuesBetweenThreads) {
+  constexpr int kCount = 100000;
+  SpscQueue<int> queue(8);
+
+  std::thread producer([&queue]() {
+    for (int i = 0; i < kCount; ++i) {
+      while (!queue.Push(i)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  int expected = 0;
+  while (expected < kCount) {
+    int value = 0;
+    if (queue.Pop(&value)) {
+      ASSERT_EQ(value, expected);
+      ++expected;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  EXPECT_EQ(queue.Size(), 0u);
+}
+
+}  // namespace test
+}  // namespace audio_capture
@@ -0,0 +1,83 @@
+// Cost of a capture filter chain, per second of audio, fed one capture
+// chunk at a time.
+//
+// Build and run from a checkout:
+// $ cmake -S src -B build/dsp -DCMAKE_BUILD_TYPE=Release
+// $ cmake --build build/dsp --target audio_capture_dsp_filter_benchmark
+// $ build/dsp/audio_capture_dsp_filter_benchmark
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "biquad.h"
+
+namespace {
+
+using audio_capture::BiquadChain;
+using audio_capture::FilterSpec;
+using audio_capture::FilterType;
+
+constexpr int kSeconds = 600;
+constexpr size_t kChunkFrames = 4096;  // The microphone chunk size.
+
+template <typename Function>
+double Time(Function function) {
+  const auto start = std::chrono::steady_clock::now();
+  function();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+// DC blocker, high-pass, mains notch and a presence shelf.
+std::vector<FilterSpec> Chain(size_t stages) {
+  std::vector<FilterSpec> specs(4);
+  specs[0].type = FilterType::kDcBlock;
+  specs[0].frequency_hz = 10.0;
+  specs[1].type = FilterType::kHighPass;
+  specs[1].frequency_hz = 80.0;
+  specs[2].type = FilterType::kNotch;
+  specs[2].frequency_hz = 50.0;
+  specs[2].q = 30.0;
+  specs[3].type = FilterType::kHighShelf;
+  specs[3].frequency_hz = 4000.0;
+  specs[3].gain_db = 3.0;
+  specs.resize(stages);
+  return specs;
+}
+
+void Run(int rate, int channels, size_t stages) {
+  std::mt19937 generator(1);
+  std::uniform_int_distribution<int> distribution(-8000, 8000);
+  std::vector<int16_t> input(static_cast<size_t>(rate) * kSeconds *
+                             static_cast<size_t>(channels));
+  for (int16_t& sample : input) {
+    sample = static_cast<int16_t>(distribution(generator));
+  }
+
+  BiquadChain chain(rate, channels, Chain(stages));
+  const size_t chunk = kChunkFrames * static_cast<size_t>(channels);
+  const double seconds = Time([&]() {
+    for (size_t offset = 0; offset + chunk <= input.size(); offset += chunk) {
+      chain.Process(input.data() + offset, kChunkFrames);
+    }
+  });
+  std::printf("%5d Hz  %d ch  %zu stages  %8.2f us/s  %6.3f%% CPU\n", rate,
+              channels, stages, seconds * 1e6 / kSeconds,
+              seconds * 100.0 / kSeconds);
+}
+
+}  // namespace
+
+int main() {
+  std::printf("%d s of audio per run\n", kSeconds);
+  Run(16000, 1, 1);
+  Run(16000, 1, 4);
+  Run(48000, 1, 4);
+  Run(48000, 2, 1);
+  Run(48000, 2, 4);
+  return 0;
+}
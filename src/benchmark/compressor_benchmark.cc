@@ -0,0 +1,70 @@
+// Cost of the output compressor and limiter, per second of audio, fed one
+// capture chunk at a time.
+//
+// Build and run from a checkout:
+// $ cmake -S src -B build/dsp -DCMAKE_BUILD_TYPE=Release
+// $ cmake --build build/dsp --target audio_capture_dsp_compressor_benchmark
+// $ build/dsp/audio_capture_dsp_compressor_benchmark
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "compressor.h"
+
+namespace {
+
+using audio_capture::Compressor;
+using audio_capture::CompressorOptions;
+
+constexpr int kSeconds = 600;
+constexpr size_t kChunkFrames = 4096;  // The microphone chunk size.
+
+template <typename Function>
+double Time(Function function) {
+  const auto start = std::chrono::steady_clock::now();
+  function();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+void Run(int rate, double ratio, float gain) {
+  // Speech-like input: noise under a slowly swelling envelope, boosted.
+  std::mt19937 generator(1);
+  std::normal_distribution<float> distribution(0.0f, 3000.0f);
+  std::vector<float> input(static_cast<size_t>(rate) * kSeconds);
+  for (size_t i = 0; i < input.size(); ++i) {
+    const float swell = static_cast<float>(i % static_cast<size_t>(rate)) /
+                        static_cast<float>(rate);
+    input[i] = distribution(generator) * swell * 2.0f * gain;
+  }
+  std::vector<int16_t> output(input.size());
+
+  CompressorOptions options;
+  options.ratio = ratio;
+  Compressor compressor(rate, options);
+  const double seconds = Time([&]() {
+    for (size_t offset = 0; offset + kChunkFrames <= input.size();
+         offset += kChunkFrames) {
+      compressor.Process(input.data() + offset, output.data() + offset,
+                         kChunkFrames);
+    }
+  });
+  std::printf("%5d Hz  ratio %4.1f  gain %4.1f  %8.2f us/s  %6.3f%% CPU\n",
+              rate, ratio, gain, seconds * 1e6 / kSeconds,
+              seconds * 100.0 / kSeconds);
+}
+
+}  // namespace
+
+int main() {
+  std::printf("%d s of audio per run\n", kSeconds);
+  Run(16000, 1.0, 2.5);
+  Run(16000, 4.0, 2.5);
+  Run(16000, 4.0, 10.0);
+  Run(48000, 4.0, 2.5);
+  return 0;
+}
@@ -0,0 +1,74 @@
+// Cost of delay estimation next to capture, per second of audio, fed one
+// synced block at a time.
+//
+// Build and run from a checkout:
+// $ cmake -S src -B build/dsp -DCMAKE_BUILD_TYPE=Release
+// $ cmake --build build/dsp --target audio_capture_dsp_delay_benchmark
+// $ build/dsp/audio_capture_dsp_delay_benchmark
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "delay_estimator.h"
+
+namespace {
+
+using audio_capture::DelayEstimator;
+using audio_capture::DelayOptions;
+
+constexpr int kSeconds = 600;
+constexpr int kBlockMs = 100;
+constexpr size_t kDelayFrames = 1600;
+
+template <typename Function>
+double Time(Function function) {
+  const auto start = std::chrono::steady_clock::now();
+  function();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+void Run(int rate, int interval_ms) {
+  std::mt19937 generator(1);
+  std::uniform_int_distribution<int> distribution(-8000, 8000);
+  const size_t count = static_cast<size_t>(rate) * kSeconds;
+  std::vector<int16_t> reference(count);
+  std::vector<int16_t> microphone(count);
+  for (size_t i = 0; i < count; ++i) {
+    reference[i] = static_cast<int16_t>(distribution(generator));
+    microphone[i] = static_cast<int16_t>(
+        (i >= kDelayFrames ? reference[i - kDelayFrames] / 4 : 0) +
+        distribution(generator) / 16);
+  }
+
+  DelayOptions options;
+  options.interval_ms = interval_ms;
+  DelayEstimator estimator(rate, options);
+  const size_t block = static_cast<size_t>(rate) * kBlockMs / 1000;
+  const double seconds = Time([&]() {
+    for (size_t offset = 0; offset + block <= count; offset += block) {
+      estimator.Process(microphone.data() + offset, reference.data() + offset,
+                        block);
+    }
+  });
+  std::printf(
+      "%5d Hz  every %4d ms  %8.2f us/s  %6.3f%% CPU  delay %6.2f ms  "
+      "confidence %.2f\n",
+      rate, interval_ms, seconds * 1e6 / kSeconds, seconds * 100.0 / kSeconds,
+      estimator.estimate().delay_ms, estimator.estimate().confidence);
+}
+
+}  // namespace
+
+int main() {
+  std::printf("%d s of audio per run\n", kSeconds);
+  Run(16000, 1000);
+  Run(16000, 250);
+  Run(48000, 1000);
+  Run(48000, 250);
+  return 0;
+}
@@ -0,0 +1,74 @@
+// Cost of echo cancellation next to capture, per second of audio, fed one
+// synced block at a time.
+//
+// Build and run from a checkout:
+// $ cmake -S src -B build/dsp -DCMAKE_BUILD_TYPE=Release
+// $ cmake --build build/dsp --target audio_capture_dsp_echo_benchmark
+// $ build/dsp/audio_capture_dsp_echo_benchmark
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "echo_canceller.h"
+
+namespace {
+
+using audio_capture::EchoCanceller;
+using audio_capture::EchoOptions;
+
+constexpr int kSeconds = 600;
+constexpr int kBlockMs = 20;  // The default synced block.
+
+template <typename Function>
+double Time(Function function) {
+  const auto start = std::chrono::steady_clock::now();
+  function();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+void Run(int rate, int filter_ms) {
+  std::mt19937 generator(1);
+  std::uniform_int_distribution<int> distribution(-8000, 8000);
+  const size_t count = static_cast<size_t>(rate) * kSeconds;
+  std::vector<int16_t> reference(count);
+  std::vector<int16_t> microphone(count);
+  for (size_t i = 0; i < count; ++i) {
+    reference[i] = static_cast<int16_t>(distribution(generator));
+    // A plain delayed echo under near-end noise.
+    microphone[i] = static_cast<int16_t>(
+        (i >= 1600 ? reference[i - 1600] / 4 : 0) +
+        distribution(generator) / 16);
+  }
+
+  EchoOptions options;
+  options.filter_ms = filter_ms;
+  EchoCanceller canceller(rate, options);
+  const size_t block = static_cast<size_t>(rate) * kBlockMs / 1000;
+  const double seconds = Time([&]() {
+    for (size_t offset = 0; offset + block <= count; offset += block) {
+      canceller.Process(microphone.data() + offset, reference.data() + offset,
+                        block);
+    }
+  });
+  std::printf(
+      "%5d Hz  %4d ms filter  block %4zu  %8.2f us/s  %6.3f%% CPU  "
+      "ERLE %5.1f dB\n",
+      rate, filter_ms, canceller.latency(), seconds * 1e6 / kSeconds,
+      seconds * 100.0 / kSeconds, canceller.erle_db());
+}
+
+}  // namespace
+
+int main() {
+  std::printf("%d s of audio per run\n", kSeconds);
+  Run(16000, 64);
+  Run(16000, 128);
+  Run(48000, 64);
+  Run(48000, 128);
+  return 0;
+}
@@ -0,0 +1,153 @@
+// Cost of showing an input level at a UI rate: a full capture delivering
+// PCM in chunks of one meter period, against the meter-only mode reading
+// large fragments and metering them incrementally, and the same with
+// EBU R128 loudness measured as well.
+//
+// CPU is measured for the per-chunk work of the processing worker. Wakeups
+// are those the Linux session schedules per second of audio: reader reads,
+// processing tasks and main loop dispatches.
+//
+// Build and run from a checkout:
+// $ cmake -S src -B build/dsp -DCMAKE_BUILD_TYPE=Release
+// $ cmake --build build/dsp --target audio_capture_dsp_meter_benchmark
+// $ build/dsp/audio_capture_dsp_meter_benchmark
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "level_meter.h"
+#include "loudness_meter.h"
+
+namespace {
+
+using audio_capture::LevelMeter;
+using audio_capture::LoudnessMeter;
+using audio_capture::MeasureLevel;
+using audio_capture::MeterOptions;
+using audio_capture::MeterReading;
+
+constexpr int kSeconds = 600;
+constexpr int kChannels = 2;
+constexpr float kGain = 2.5f;
+// Fragment the meter-only mode reads, as in capture_session.cc.
+constexpr int kMeterFragmentMs = 100;
+
+std::vector<int16_t> Noise(size_t samples) {
+  std::mt19937 generator(1);
+  std::uniform_int_distribution<int> distribution(-8000, 8000);
+  std::vector<int16_t> noise(samples);
+  for (int16_t& sample : noise) {
+    sample = static_cast<int16_t>(distribution(generator));
+  }
+  return noise;
+}
+
+template <typename Function>
+double Time(Function function) {
+  const auto start = std::chrono::steady_clock::now();
+  function();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+void Report(const char* path, double seconds, double reads, double tasks,
+            double dispatches) {
+  std::printf("%-12s %8.2f us/s  %6.3f%% CPU  %5.1f reads/s  %5.1f tasks/s"
+              "  %5.1f dispatches/s  %5.1f wakeups/s\n",
+              path, seconds * 1e6 / kSeconds, seconds * 100.0 / kSeconds,
+              reads, tasks, dispatches, reads + tasks + dispatches);
+}
+
+void Run(int rate, int meter_hz) {
+  const size_t period_frames = static_cast<size_t>(rate / meter_hz);
+  const size_t fragment_frames =
+      std::max(period_frames, static_cast<size_t>(rate) * kMeterFragmentMs /
+                                  1000);
+  const std::vector<int16_t> input =
+      Noise(static_cast<size_t>(rate) * kSeconds * kChannels);
+  const size_t total_frames = input.size() / kChannels;
+  volatile double sink = 0.0;
+
+  std::printf("%d Hz stereo, levels at %d Hz\n", rate, meter_hz);
+
+  // Full capture: every period is a chunk, downmixed, measured and copied
+  // into an emit buffer for the main loop.
+  {
+    std::vector<int16_t> mono(period_frames);
+    std::vector<int16_t> emit(period_frames);
+    const size_t chunks = total_frames / period_frames;
+    const double seconds = Time([&]() {
+      for (size_t c = 0; c < chunks; ++c) {
+        const int16_t* chunk = input.data() + c * period_frames * kChannels;
+        for (size_t i = 0; i < period_frames; ++i) {
+          const float mixed = (static_cast<float>(chunk[i * 2]) +
+                               chunk[i * 2 + 1]) / 2.0f * kGain;
+          mono[i] = static_cast<int16_t>(
+              std::max(-32768.0f, std::min(32767.0f, mixed)));
+        }
+        sink = MeasureLevel(mono.data(), period_frames);
+        std::memcpy(emit.data(), mono.data(), period_frames * sizeof(int16_t));
+      }
+    });
+    const double per_second = static_cast<double>(rate) / period_frames;
+    Report("full", seconds, per_second, per_second, per_second);
+  }
+
+  // Meter only: large fragments, levels folded in as they arrive.
+  {
+    // Window, peak ballistics and hold as a VU/PPM display would set them.
+    MeterOptions options;
+    options.window_ms = 300;
+    options.attack_ms = 5;
+    options.release_ms = 1500;
+    options.hold_ms = 1000;
+    LevelMeter meter(rate, period_frames, kChannels, kGain, options);
+    std::vector<MeterReading> levels(meter.MaxLevels(fragment_frames) + 1);
+    const size_t fragments = total_frames / fragment_frames;
+    const double seconds = Time([&]() {
+      for (size_t f = 0; f < fragments; ++f) {
+        const size_t count = meter.Process(
+            input.data() + f * fragment_frames * kChannels, fragment_frames,
+            levels.data(), levels.size());
+        if (count > 0) {
+          sink = levels[count - 1].rms;
+        }
+      }
+    });
+    const double per_second = static_cast<double>(rate) / fragment_frames;
+    Report("meter-only", seconds, per_second, per_second, meter_hz);
+  }
+
+  // Loudness: K-weighting and 4x oversampled true peak for every frame,
+  // read once per fragment.
+  {
+    LoudnessMeter meter(rate, kChannels, kGain);
+    const size_t fragments = total_frames / fragment_frames;
+    const double seconds = Time([&]() {
+      for (size_t f = 0; f < fragments; ++f) {
+        meter.Process(input.data() + f * fragment_frames * kChannels,
+                      fragment_frames);
+        sink = meter.Reading().integrated;
+      }
+    });
+    const double per_second = static_cast<double>(rate) / fragment_frames;
+    Report("loudness", seconds, per_second, per_second, meter_hz);
+  }
+  (void)sink;
+}
+
+}  // namespace
+
+int main() {
+  std::printf("%d s of audio per run\n", kSeconds);
+  Run(16000, 30);
+  Run(48000, 30);
+  Run(48000, 60);
+  return 0;
+}
@@ -0,0 +1,74 @@
+// Cost of extracting log-mel features next to capture: 80 bins from 25 ms
+// windows every 10 ms, fed one capture chunk at a time.
+//
+// Build and run from a checkout:
+// $ cmake -S src -B build/dsp -DCMAKE_BUILD_TYPE=Release
+// $ cmake --build build/dsp --target audio_capture_dsp_feature_benchmark
+// $ build/dsp/audio_capture_dsp_feature_benchmark
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "fft.h"
+#include "mel_spectrogram.h"
+
+namespace {
+
+using audio_capture::Fft;
+using audio_capture::MelOptions;
+using audio_capture::MelSpectrogram;
+
+constexpr int kSeconds = 600;
+constexpr size_t kChunkFrames = 4096;  // The microphone chunk size.
+
+template <typename Function>
+double Time(Function function) {
+  const auto start = std::chrono::steady_clock::now();
+  function();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+void Run(int rate, int bins) {
+  std::mt19937 generator(1);
+  std::uniform_int_distribution<int> distribution(-8000, 8000);
+  std::vector<int16_t> input(static_cast<size_t>(rate) * kSeconds);
+  for (int16_t& sample : input) {
+    sample = static_cast<int16_t>(distribution(generator));
+  }
+
+  MelOptions options;
+  options.bins = bins;
+  MelSpectrogram mel(rate, options);
+  std::vector<float> frames(mel.MaxFrames(kChunkFrames) * mel.bins());
+  volatile float sink = 0.0f;
+  const double seconds = Time([&]() {
+    for (size_t offset = 0; offset + kChunkFrames <= input.size();
+         offset += kChunkFrames) {
+      const size_t written =
+          mel.Process(input.data() + offset, kChunkFrames, frames.data(),
+                      frames.size() / mel.bins());
+      if (written > 0) {
+        sink = frames[0];
+      }
+    }
+  });
+  (void)sink;
+  std::printf("%5d Hz  %3d bins  FFT %4zu  %8.2f us/s  %6.3f%% CPU\n", rate,
+              bins, audio_capture::NextPowerOfTwo(mel.window_samples()),
+              seconds * 1e6 / kSeconds, seconds * 100.0 / kSeconds);
+}
+
+}  // namespace
+
+int main() {
+  std::printf("%d s of audio per run\n", kSeconds);
+  Run(16000, 80);
+  Run(16000, 128);
+  Run(48000, 80);
+  return 0;
+}
@@ -0,0 +1,64 @@
+// Cost of noise suppression next to capture, per second of audio, fed one
+// capture chunk at a time.
+//
+// Build and run from a checkout:
+// $ cmake -S src -B build/dsp -DCMAKE_BUILD_TYPE=Release
+// $ cmake --build build/dsp --target audio_capture_dsp_noise_benchmark
+// $ build/dsp/audio_capture_dsp_noise_benchmark
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "noise_suppressor.h"
+
+namespace {
+
+using audio_capture::NoiseOptions;
+using audio_capture::NoiseSuppressor;
+
+constexpr int kSeconds = 600;
+constexpr size_t kChunkFrames = 4096;  // The microphone chunk size.
+
+template <typename Function>
+double Time(Function function) {
+  const auto start = std::chrono::steady_clock::now();
+  function();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+void Run(int rate, double suppression_db) {
+  std::mt19937 generator(1);
+  std::uniform_int_distribution<int> distribution(-8000, 8000);
+  std::vector<int16_t> input(static_cast<size_t>(rate) * kSeconds);
+  for (int16_t& sample : input) {
+    sample = static_cast<int16_t>(distribution(generator));
+  }
+
+  NoiseOptions options;
+  options.suppression_db = suppression_db;
+  NoiseSuppressor suppressor(rate, options);
+  const double seconds = Time([&]() {
+    for (size_t offset = 0; offset + kChunkFrames <= input.size();
+         offset += kChunkFrames) {
+      suppressor.Process(input.data() + offset, kChunkFrames);
+    }
+  });
+  std::printf("%5d Hz  %4.0f dB  frame %4zu  %8.2f us/s  %6.3f%% CPU\n",
+              rate, suppression_db, suppressor.latency(),
+              seconds * 1e6 / kSeconds, seconds * 100.0 / kSeconds);
+}
+
+}  // namespace
+
+int main() {
+  std::printf("%d s of audio per run\n", kSeconds);
+  Run(16000, 12.0);
+  Run(16000, 24.0);
+  Run(48000, 12.0);
+  return 0;
+}
@@ -0,0 +1,122 @@
+// Throughput of the streaming resampler against the per-chunk linear
+// interpolation the Windows plugin used before.
+//
+// Build and run from a checkout:
+// $ cmake -S src -B build/dsp -DCMAKE_BUILD_TYPE=Release
+// $ cmake --build build/dsp --target audio_capture_dsp_benchmark
+// $ build/dsp/audio_capture_dsp_benchmark
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "resampler.h"
+
+namespace {
+
+using audio_capture::Resampler;
+using audio_capture::ResamplerQuality;
+
+constexpr int kSeconds = 60;
+constexpr int kChunkMs = 10;
+
+// The former MicCapturePlugin::ResampleAudio: restarts at frame 0 of every
+// chunk and has no anti-alias filter.
+void LinearResample(const int16_t* input, size_t input_frames, int16_t* output,
+                    size_t output_frames, int input_rate, int output_rate) {
+  const double ratio = static_cast<double>(input_rate) / output_rate;
+  for (size_t i = 0; i < output_frames; ++i) {
+    const double position = i * ratio;
+    const size_t index = static_cast<size_t>(position);
+    const double fraction = position - index;
+    if (index + 1 < input_frames) {
+      const double value =
+          input[index] + (input[index + 1] - input[index]) * fraction;
+      output[i] = static_cast<int16_t>(
+          std::max(-32768.0, std::min(32767.0, value)));
+    } else {
+      output[i] = input[std::min(index, input_frames - 1)];
+    }
+  }
+}
+
+std::vector<int16_t> Noise(size_t samples) {
+  std::mt19937 generator(1);
+  std::uniform_int_distribution<int> distribution(-8000, 8000);
+  std::vector<int16_t> noise(samples);
+  for (int16_t& sample : noise) {
+    sample = static_cast<int16_t>(distribution(generator));
+  }
+  return noise;
+}
+
+void Report(const char* name, int input_rate, int output_rate,
+            double seconds) {
+  const double frames = static_cast<double>(input_rate) * kSeconds;
+  std::printf("%-8s %6d -> %6d  %8.1f Mframes/s  %8.0fx realtime\n", name,
+              input_rate, output_rate, frames / seconds / 1e6,
+              kSeconds / seconds);
+}
+
+template <typename Function>
+double Time(Function function) {
+  const auto start = std::chrono::steady_clock::now();
+  function();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+void Run(int input_rate, int output_rate) {
+  const size_t chunk_frames = static_cast<size_t>(input_rate) * kChunkMs / 1000;
+  const size_t chunks = kSeconds * 1000 / kChunkMs;
+  const std::vector<int16_t> input = Noise(chunk_frames * chunks);
+  std::vector<int16_t> output(chunk_frames * 4 + 16);
+  volatile int16_t sink = 0;
+
+  const double linear = Time([&]() {
+    const size_t output_frames =
+        chunk_frames * static_cast<size_t>(output_rate) / input_rate;
+    for (size_t i = 0; i < chunks; ++i) {
+      LinearResample(input.data() + i * chunk_frames, chunk_frames,
+                     output.data(), output_frames, input_rate, output_rate);
+      sink = output[0];
+    }
+  });
+  Report("linear", input_rate, output_rate, linear);
+
+  const struct {
+    const char* name;
+    ResamplerQuality quality;
+  } presets[] = {
+      {"low", ResamplerQuality::kLow},
+      {"medium", ResamplerQuality::kMedium},
+      {"high", ResamplerQuality::kHigh},
+  };
+  for (const auto& preset : presets) {
+    Resampler resampler(input_rate, output_rate, 1, preset.quality);
+    const double seconds = Time([&]() {
+      for (size_t i = 0; i < chunks; ++i) {
+        resampler.Process(input.data() + i * chunk_frames, chunk_frames,
+                          output.data(), output.size());
+        sink = output[0];
+      }
+    });
+    Report(preset.name, input_rate, output_rate, seconds);
+  }
+  (void)sink;
+}
+
+}  // namespace
+
+int main() {
+  std::printf("%d s of mono audio in %d ms chunks\n", kSeconds, kChunkMs);
+  Run(48000, 16000);
+  Run(44100, 16000);
+  Run(44100, 48000);
+  Run(16000, 48000);
+  return 0;
+}
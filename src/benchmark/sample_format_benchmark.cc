@@ -0,0 +1,141 @@
+// Throughput of the sample-format converters against the per-chunk scalar
+// loops the Windows microphone plugin used before, which also allocated a
+// fresh output vector for every chunk.
+//
+// Build and run from a checkout:
+// $ cmake -S src -B build/dsp -DCMAKE_BUILD_TYPE=Release
+// $ cmake --build build/dsp --target audio_capture_dsp_format_benchmark
+// $ build/dsp/audio_capture_dsp_format_benchmark
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "sample_format.h"
+
+namespace {
+
+using audio_capture::Dither;
+using audio_capture::SampleConverter;
+using audio_capture::SampleFormat;
+using audio_capture::SampleFormatBytes;
+
+constexpr int kSeconds = 60;
+constexpr int kChunkMs = 10;
+constexpr int kRate = 48000;
+constexpr int kChannels = 2;
+
+// The former MicCapturePlugin::CaptureThread conversion.
+std::vector<int16_t> LegacyConvert(const uint8_t* data, size_t samples,
+                                   SampleFormat format) {
+  std::vector<int16_t> converted(samples);
+  if (format == SampleFormat::kF32) {
+    const float* in = reinterpret_cast<const float*>(data);
+    for (size_t i = 0; i < samples; ++i) {
+      const float sample = std::min(1.0f, std::max(-1.0f, in[i]));
+      converted[i] = static_cast<int16_t>(sample * 32767.0f);
+    }
+  } else if (format == SampleFormat::kS24) {
+    for (size_t i = 0; i < samples; ++i) {
+      const size_t offset = i * 3;
+      int32_t sample24 = static_cast<int32_t>(data[offset]) |
+                         (static_cast<int32_t>(data[offset + 1]) << 8) |
+                         (static_cast<int32_t>(data[offset + 2]) << 16);
+      if (sample24 & 0x800000) sample24 |= static_cast<int32_t>(0xFF000000);
+      converted[i] = static_cast<int16_t>(sample24 >> 8);
+    }
+  } else if (format == SampleFormat::kS32) {
+    const int32_t* in = reinterpret_cast<const int32_t*>(data);
+    for (size_t i = 0; i < samples; ++i) {
+      converted[i] = static_cast<int16_t>(in[i] >> 16);
+    }
+  }
+  return converted;
+}
+
+std::vector<uint8_t> Noise(size_t samples, SampleFormat format) {
+  std::mt19937 generator(1);
+  std::uniform_real_distribution<float> distribution(-0.5f, 0.5f);
+  std::vector<float> noise(samples);
+  for (float& sample : noise) {
+    sample = distribution(generator);
+  }
+  std::vector<uint8_t> encoded(samples * SampleFormatBytes(format));
+  SampleConverter(SampleFormat::kF32, format)
+      .Convert(noise.data(), encoded.data(), samples);
+  return encoded;
+}
+
+template <typename Function>
+double Time(Function function) {
+  const auto start = std::chrono::steady_clock::now();
+  function();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+void Report(const char* name, const char* path, double seconds) {
+  const double samples = static_cast<double>(kRate) * kChannels * kSeconds;
+  std::printf("%-8s %-14s %8.1f Msamples/s  %8.0fx realtime\n", name, path,
+              samples / seconds / 1e6, kSeconds / seconds);
+}
+
+void Run(const char* name, SampleFormat from, SampleFormat to,
+         bool has_legacy) {
+  const size_t chunk_samples =
+      static_cast<size_t>(kRate) * kChunkMs / 1000 * kChannels;
+  const size_t chunks = kSeconds * 1000 / kChunkMs;
+  const size_t input_bytes = chunk_samples * SampleFormatBytes(from);
+  const std::vector<uint8_t> input = Noise(chunk_samples * chunks, from);
+  std::vector<uint8_t> output(chunk_samples * SampleFormatBytes(to));
+  volatile uint8_t sink = 0;
+
+  if (has_legacy) {
+    const double seconds = Time([&]() {
+      for (size_t i = 0; i < chunks; ++i) {
+        const std::vector<int16_t> converted =
+            LegacyConvert(input.data() + i * input_bytes, chunk_samples, from);
+        sink = static_cast<uint8_t>(converted[0]);
+      }
+    });
+    Report(name, "legacy", seconds);
+  }
+
+  const struct {
+    const char* path;
+    Dither dither;
+  } paths[] = {{"table", Dither::kNone}, {"table+dither", Dither::kTriangular}};
+  for (const auto& path : paths) {
+    if (path.dither == Dither::kTriangular && to != SampleFormat::kS16) {
+      continue;
+    }
+    SampleConverter converter(from, to, path.dither);
+    const double seconds = Time([&]() {
+      for (size_t i = 0; i < chunks; ++i) {
+        converter.Convert(input.data() + i * input_bytes, output.data(),
+                          chunk_samples);
+        sink = output[0];
+      }
+    });
+    Report(name, path.path, seconds);
+  }
+  (void)sink;
+}
+
+}  // namespace
+
+int main() {
+  std::printf("%d s of %d Hz stereo audio in %d ms chunks\n", kSeconds, kRate,
+              kChunkMs);
+  Run("f32>s16", SampleFormat::kF32, SampleFormat::kS16, true);
+  Run("s24>s16", SampleFormat::kS24, SampleFormat::kS16, true);
+  Run("s32>s16", SampleFormat::kS32, SampleFormat::kS16, true);
+  Run("f64>s16", SampleFormat::kF64, SampleFormat::kS16, false);
+  Run("s16>f32", SampleFormat::kS16, SampleFormat::kF32, false);
+  Run("s24>f32", SampleFormat::kS24, SampleFormat::kF32, false);
+  return 0;
+}
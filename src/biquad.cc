@@ -0,0 +1,171 @@
+#include "biquad.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace audio_capture {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Highest frequency a filter is designed at, as a share of the rate.
+constexpr double kMaxFrequencyRatio = 0.49;
+// States smaller than this are flushed to zero between calls, before a
+// decay into silence turns them subnormal. Far below one 16-bit step.
+constexpr double kMinState = 1e-15;
+
+// Filters |frames| interleaved frames through |stages|. |kChannels| fixes
+// the channel count at compile time where nonzero.
+template <int kChannels>
+void FilterFrames(const std::vector<Biquad>& stages, double* state,
+                  int16_t* samples, size_t frames, int channels) {
+  const int count = kChannels > 0 ? kChannels : channels;
+  double x[BiquadChain::kMaxChannels];
+  for (size_t i = 0; i < frames; ++i) {
+    int16_t* frame = samples + i * static_cast<size_t>(count);
+    for (int c = 0; c < count; ++c) {
+      x[c] = frame[c];
+    }
+    double* z1 = state;
+    for (const Biquad& stage : stages) {
+      double* z2 = z1 + count;
+      for (int c = 0; c < count; ++c) {
+        const double y = stage.b0 * x[c] + z1[c];
+        z1[c] = stage.b1 * x[c] - stage.a1 * y + z2[c];
+        z2[c] = stage.b2 * x[c] - stage.a2 * y;
+        x[c] = y;
+      }
+      z1 = z2 + count;
+    }
+    for (int c = 0; c < count; ++c) {
+      frame[c] = static_cast<int16_t>(
+          std::max(-32768.0, std::min(32767.0, std::round(x[c]))));
+    }
+  }
+}
+
+}  // namespace
+
+void DesignKWeighting(int sample_rate, Biquad* shelf, Biquad* highpass) {
+  {
+    const double f0 = 1681.974450955533;
+    const double gain_db = 3.999843853973347;
+    const double q = 0.7071752369554196;
+    const double k = std::tan(kPi * f0 / sample_rate);
+    const double vh = std::pow(10.0, gain_db / 20.0);
+    const double vb = std::pow(vh, 0.4996667741545416);
+    const double a0 = 1.0 + k / q + k * k;
+    *shelf = {(vh + vb * k / q + k * k) / a0, 2.0 * (k * k - vh) / a0,
+              (vh - vb * k / q + k * k) / a0, 2.0 * (k * k - 1.0) / a0,
+              (1.0 - k / q + k * k) / a0};
+  }
+  {
+    const double f0 = 38.13547087602444;
+    const double q = 0.5003270373238773;
+    const double k = std::tan(kPi * f0 / sample_rate);
+    const double a0 = 1.0 + k / q + k * k;
+    *highpass = {1.0, -2.0, 1.0, 2.0 * (k * k - 1.0) / a0,
+                 (1.0 - k / q + k * k) / a0};
+  }
+}
+
+Biquad DesignFilter(const FilterSpec& spec, int sample_rate) {
+  const double rate = std::max(1, sample_rate);
+  const double frequency = std::max(
+      1e-3, std::min(spec.frequency_hz, kMaxFrequencyRatio * rate));
+  const double w0 = 2.0 * kPi * frequency / rate;
+  if (spec.type == FilterType::kDcBlock) {
+    // y[n] = x[n] - x[n-1] + r * y[n-1], scaled to unity at Nyquist.
+    const double r = std::exp(-w0);
+    const double g = 0.5 * (1.0 + r);
+    return {g, -g, 0.0, -r, 0.0};
+  }
+
+  const double cosine = std::cos(w0);
+  const double alpha = std::sin(w0) / (2.0 * std::max(1e-3, spec.q));
+  double b0 = 1.0, b1 = 0.0, b2 = 0.0, a0 = 1.0, a1 = 0.0, a2 = 0.0;
+  switch (spec.type) {
+    case FilterType::kHighPass:
+      b0 = (1.0 + cosine) / 2.0;
+      b1 = -(1.0 + cosine);
+      b2 = b0;
+      a0 = 1.0 + alpha;
+      a1 = -2.0 * cosine;
+      a2 = 1.0 - alpha;
+      break;
+    case FilterType::kLowPass:
+      b0 = (1.0 - cosine) / 2.0;
+      b1 = 1.0 - cosine;
+      b2 = b0;
+      a0 = 1.0 + alpha;
+      a1 = -2.0 * cosine;
+      a2 = 1.0 - alpha;
+      break;
+    case FilterType::kNotch:
+      b0 = 1.0;
+      b1 = -2.0 * cosine;
+      b2 = 1.0;
+      a0 = 1.0 + alpha;
+      a1 = -2.0 * cosine;
+      a2 = 1.0 - alpha;
+      break;
+    case FilterType::kLowShelf:
+    case FilterType::kHighShelf: {
+      const double a = std::pow(10.0, spec.gain_db / 40.0);
+      const double k = 2.0 * std::sqrt(a) * alpha;
+      // The high shelf is the low shelf with the cosine negated, then b1
+      // and a1 negated back.
+      const double c =
+          spec.type == FilterType::kLowShelf ? cosine : -cosine;
+      const double sign = spec.type == FilterType::kLowShelf ? 1.0 : -1.0;
+      b0 = a * ((a + 1.0) - (a - 1.0) * c + k);
+      b1 = sign * 2.0 * a * ((a - 1.0) - (a + 1.0) * c);
+      b2 = a * ((a + 1.0) - (a - 1.0) * c - k);
+      a0 = (a + 1.0) + (a - 1.0) * c + k;
+      a1 = sign * -2.0 * ((a - 1.0) + (a + 1.0) * c);
+      a2 = (a + 1.0) + (a - 1.0) * c - k;
+      break;
+    }
+    case FilterType::kDcBlock:
+      break;
+  }
+  return {b0 / a0, b1 / a0, b2 / a0, a1 / a0, a2 / a0};
+}
+
+BiquadChain::BiquadChain(int sample_rate, int channels,
+                         const std::vector<FilterSpec>& specs)
+    : channels_(std::max(1, std::min(channels, kMaxChannels))) {
+  stages_.reserve(specs.size());
+  for (const FilterSpec& spec : specs) {
+    stages_.push_back(DesignFilter(spec, sample_rate));
+  }
+  state_.resize(stages_.size() * 2 * static_cast<size_t>(channels_));
+}
+
+void BiquadChain::Process(int16_t* samples, size_t frame_count) {
+  if (stages_.empty()) {
+    return;
+  }
+  switch (channels_) {
+    case 1:
+      FilterFrames<1>(stages_, state_.data(), samples, frame_count, 1);
+      break;
+    case 2:
+      FilterFrames<2>(stages_, state_.data(), samples, frame_count, 2);
+      break;
+    default:
+      FilterFrames<0>(stages_, state_.data(), samples, frame_count,
+                      channels_);
+      break;
+  }
+  for (double& value : state_) {
+    if (std::fabs(value) < kMinState) {
+      value = 0.0;
+    }
+  }
+}
+
+void BiquadChain::Reset() { std::fill(state_.begin(), state_.end(), 0.0); }
+
+}  // namespace audio_capture
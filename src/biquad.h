@@ -0,0 +1,81 @@
+#ifndef FLUTTER_PLUGIN_BIQUAD_H_
+#define FLUTTER_PLUGIN_BIQUAD_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace audio_capture {
+
+// Direct form II transposed biquad coefficients, a0 normalized to 1.
+struct Biquad {
+  double b0, b1, b2, a1, a2;
+};
+
+// Runs |x| through |biquad| with the two state values at |state|.
+inline double FilterBiquad(double x, const Biquad& biquad, double* state) {
+  const double y = biquad.b0 * x + state[0];
+  state[0] = biquad.b1 * x - biquad.a1 * y + state[1];
+  state[1] = biquad.b2 * x - biquad.a2 * y;
+  return y;
+}
+
+// The two stages of the BS.1770 K-weighting pre-filter, a high shelf
+// modelling the head and the RLB high-pass, designed for |sample_rate| so
+// that they match the 48 kHz coefficients the standard lists. Run the
+// shelf first.
+void DesignKWeighting(int sample_rate, Biquad* shelf, Biquad* highpass);
+
+enum class FilterType {
+  kDcBlock,    // One-pole DC blocker with its corner at |frequency_hz|.
+  kHighPass,   // Second-order, resonance |q|.
+  kLowPass,    // Second-order, resonance |q|.
+  kLowShelf,   // |gain_db| below |frequency_hz|, slope from |q|.
+  kHighShelf,  // |gain_db| above |frequency_hz|, slope from |q|.
+  kNotch,      // Removes |frequency_hz|, as narrowly as |q| is high.
+};
+
+struct FilterSpec {
+  FilterType type = FilterType::kHighPass;
+  double frequency_hz = 80.0;
+  double q = 0.7071067811865476;  // Butterworth.
+  double gain_db = 0.0;           // Shelves only.
+};
+
+// The biquad for |spec| at |sample_rate|, from the Audio EQ Cookbook. The
+// frequency is kept below Nyquist.
+Biquad DesignFilter(const FilterSpec& spec, int sample_rate);
+
+// A cascade of biquads for interleaved 16-bit audio, filtered in place.
+// Each channel has its own state; the channels of a frame run side by side
+// through a stage, so stereo vectorizes.
+//
+// Not thread-safe; use one instance per stream.
+class BiquadChain {
+ public:
+  // |channels| from 1 to kMaxChannels.
+  BiquadChain(int sample_rate, int channels,
+              const std::vector<FilterSpec>& specs);
+
+  static constexpr int kMaxChannels = 8;
+
+  bool empty() const { return stages_.empty(); }
+
+  // Filters |frame_count| interleaved frames in place, rounding and
+  // clamping to 16 bits.
+  void Process(int16_t* samples, size_t frame_count);
+
+  // Forgets the audio in flight, for streams that do not continue the
+  // previous ones.
+  void Reset();
+
+ private:
+  int channels_;
+  std::vector<Biquad> stages_;
+  // Per stage, the first and then the second state value of every channel.
+  std::vector<double> state_;
+};
+
+}  // namespace audio_capture
+
+#endif  // FLUTTER_PLUGIN_BIQUAD_H_
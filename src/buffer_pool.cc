@@ -0,0 +1,84 @@
+#include "buffer_pool.h"
+
+#include <new>
+
+namespace audio_capture {
+
+namespace {
+
+constexpr size_t kAlignment = 64;
+
+// Index of the empty stack.
+constexpr uint32_t kNone = UINT32_MAX;
+
+uint64_t PackHead(uint64_t head, uint32_t index) {
+  return (((head >> 32) + 1) << 32) | index;
+}
+
+}  // namespace
+
+BufferPool::BufferPool(size_t buffer_size, size_t buffer_count)
+    : buffer_size_(buffer_size),
+      buffer_count_(buffer_count),
+      stride_((buffer_size + kAlignment - 1) / kAlignment * kAlignment),
+      storage_(nullptr),
+      next_(new std::atomic<uint32_t>[buffer_count > 0 ? buffer_count : 1]),
+      head_(kNone),
+      available_(buffer_count) {
+  if (stride_ == 0) {
+    stride_ = kAlignment;
+  }
+  storage_ = static_cast<uint8_t*>(::operator new(
+      stride_ * buffer_count_, std::align_val_t(kAlignment)));
+  for (size_t i = 0; i < buffer_count_; ++i) {
+    next_[i].store(i + 1 < buffer_count_ ? static_cast<uint32_t>(i + 1) : kNone,
+                   std::memory_order_relaxed);
+  }
+  if (buffer_count_ > 0) {
+    head_.store(0, std::memory_order_relaxed);
+  }
+}
+
+BufferPool::~BufferPool() {
+  ::operator delete(storage_, std::align_val_t(kAlignment));
+}
+
+void* BufferPool::Acquire() {
+  uint64_t head = head_.load(std::memory_order_acquire);
+  while (true) {
+    const uint32_t index = static_cast<uint32_t>(head);
+    if (index == kNone) {
+      return nullptr;
+    }
+    // May be stale if another thread takes the buffer first; the swap then
+    // fails on the changed counter.
+    const uint32_t next = next_[index].load(std::memory_order_relaxed);
+    if (head_.compare_exchange_weak(head, PackHead(head, next),
+                                    std::memory_order_acquire,
+                                    std::memory_order_acquire)) {
+      available_.fetch_sub(1, std::memory_order_relaxed);
+      return storage_ + index * stride_;
+    }
+  }
+}
+
+void BufferPool::Release(void* buffer) {
+  const size_t offset = static_cast<size_t>(static_cast<uint8_t*>(buffer) -
+                                            storage_);
+  const uint32_t index = static_cast<uint32_t>(offset / stride_);
+  uint64_t head = head_.load(std::memory_order_relaxed);
+  do {
+    next_[index].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+  } while (!head_.compare_exchange_weak(head, PackHead(head, index),
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed));
+  available_.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool BufferPool::Owns(const void* buffer) const {
+  const uint8_t* bytes = static_cast<const uint8_t*>(buffer);
+  return bytes >= storage_ && bytes < storage_ + storage_size() &&
+         static_cast<size_t>(bytes - storage_) % stride_ == 0;
+}
+
+}  // namespace audio_capture
@@ -0,0 +1,64 @@
+#ifndef FLUTTER_PLUGIN_BUFFER_POOL_H_
+#define FLUTTER_PLUGIN_BUFFER_POOL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace audio_capture {
+
+// A fixed set of equally sized buffers, allocated together when the pool is
+// created and handed out and taken back without locks or allocation. Any
+// thread may acquire or release, so a chunk can be filled on the capture
+// side and released by whichever thread consumes it.
+class BufferPool {
+ public:
+  // Creates |buffer_count| buffers of |buffer_size| bytes each, aligned to a
+  // cache line.
+  BufferPool(size_t buffer_size, size_t buffer_count);
+  ~BufferPool();
+
+  BufferPool(const BufferPool&) = delete;
+  BufferPool& operator=(const BufferPool&) = delete;
+
+  // Returns a free buffer, or nullptr if every buffer is in use.
+  void* Acquire();
+
+  // Returns |buffer|, acquired from this pool, for reuse.
+  void Release(void* buffer);
+
+  // Whether |buffer| is one of this pool's buffers.
+  bool Owns(const void* buffer) const;
+
+  size_t buffer_size() const { return buffer_size_; }
+  size_t buffer_count() const { return buffer_count_; }
+
+  // Free buffers. Exact when no other thread uses the pool, a snapshot
+  // otherwise.
+  size_t available() const {
+    return available_.load(std::memory_order_relaxed);
+  }
+
+  // The memory holding every buffer, to prefault or lock it.
+  void* storage() const { return storage_; }
+  size_t storage_size() const { return stride_ * buffer_count_; }
+
+ private:
+  size_t buffer_size_;
+  size_t buffer_count_;
+  size_t stride_;  // Bytes from one buffer to the next.
+  uint8_t* storage_;
+
+  // Free buffers form a stack linked through |next_|. The head packs the
+  // index of the top buffer with a counter bumped on every change, so a
+  // buffer taken and returned between a load and its swap cannot be
+  // mistaken for an unchanged stack.
+  std::unique_ptr<std::atomic<uint32_t>[]> next_;
+  alignas(64) std::atomic<uint64_t> head_;
+  std::atomic<size_t> available_;
+};
+
+}  // namespace audio_capture
+
+#endif  // FLUTTER_PLUGIN_BUFFER_POOL_H_
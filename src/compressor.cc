@@ -0,0 +1,110 @@
+#include "compressor.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace audio_capture {
+
+namespace {
+
+// Samples the gain computer handles at a time.
+constexpr size_t kBlockSize = 256;
+constexpr float kFullScale = 32768.0f;
+// Decibels per unit of the log2 level domain.
+constexpr double kDbPerLevel = 6.020599913279624;
+// Amplitude the level reads as silence from, far below one LSB.
+constexpr float kMinAmplitude = 1e-3f;
+// Narrowest knee, so the knee's curve never divides by zero.
+constexpr float kMinKnee = 1e-3f;
+
+// Per-sample coefficient of a one-pole smoother with time constant |ms|;
+// 1 follows at once.
+float SmoothingCoefficient(int sample_rate, int ms) {
+  if (ms <= 0) {
+    return 1.0f;
+  }
+  return static_cast<float>(
+      1.0 - std::exp(-1000.0 / (static_cast<double>(ms) * sample_rate)));
+}
+
+float DbToGain(double db) {
+  return static_cast<float>(std::pow(10.0, db / 20.0));
+}
+
+}  // namespace
+
+Compressor::Compressor(int sample_rate, const CompressorOptions& options)
+    : threshold_(static_cast<float>(options.threshold_db / kDbPerLevel)),
+      knee_(std::max(kMinKnee,
+                     static_cast<float>(options.knee_db / kDbPerLevel))),
+      slope_(static_cast<float>(1.0 / std::max(1.0, options.ratio) - 1.0)),
+      attack_coefficient_(
+          SmoothingCoefficient(sample_rate, options.attack_ms)),
+      release_coefficient_(
+          SmoothingCoefficient(sample_rate, options.release_ms)),
+      level_(0.0f),
+      ceiling_(std::min(32767.0f,
+                        kFullScale * DbToGain(std::min(0.0,
+                                                       options.ceiling_db)))),
+      limiter_release_coefficient_(
+          1.0f - SmoothingCoefficient(sample_rate,
+                                      options.limiter_release_ms)),
+      envelope_(0.0f),
+      min_gain_(1.0f),
+      gains_(kBlockSize) {}
+
+void Compressor::Process(const float* input, int16_t* output, size_t count,
+                         size_t stride) {
+  const float half_knee = knee_ * 0.5f;
+  const float knee_scale = 0.5f / knee_;
+  float min_gain = 1.0f;
+  for (size_t start = 0; start < count; start += kBlockSize) {
+    const float* in = input + start;
+    int16_t* out = output + start * stride;
+    const size_t size = std::min(kBlockSize, count - start);
+
+    // Level detector: the peak envelope, rising with the attack and
+    // falling with the release.
+    float* gains = gains_.data();
+    for (size_t i = 0; i < size; ++i) {
+      const float amplitude = std::fabs(in[i]);
+      const float coefficient =
+          amplitude > level_ ? attack_coefficient_ : release_coefficient_;
+      level_ += coefficient * (amplitude - level_);
+      gains[i] = level_;
+    }
+
+    // Gain computer: the gain each level calls for, reduced in the level
+    // domain. Below the knee it is 0, through it a quadratic, above it the
+    // ratio's line; |within| and |beyond| split the excess so each is a
+    // clamp, and the loop has no branches.
+    for (size_t i = 0; i < size; ++i) {
+      const float level =
+          std::log2(std::max(gains[i], kMinAmplitude) / kFullScale);
+      const float over = level - threshold_;
+      const float within = std::min(std::max(over + half_knee, 0.0f), knee_);
+      const float beyond = std::max(over - half_knee, 0.0f);
+      gains[i] = std::exp2(slope_ * (within * within * knee_scale + beyond));
+    }
+
+    // The limiter, on the compressed samples.
+    for (size_t i = 0; i < size; ++i) {
+      const float gain = gains[i];
+      const float sample = in[i] * gain;
+      envelope_ =
+          std::max(std::fabs(sample), envelope_ * limiter_release_coefficient_);
+      const float limit = std::min(1.0f, ceiling_ / envelope_);
+      min_gain = std::min(min_gain, gain * limit);
+      const float limited = std::nearbyint(sample * limit);
+      out[i * stride] = static_cast<int16_t>(
+          std::max(-ceiling_, std::min(ceiling_, limited)));
+    }
+  }
+  min_gain_ = min_gain;
+}
+
+double Compressor::gain_db() const {
+  return 20.0 * std::log10(std::max(min_gain_, 1e-6f));
+}
+
+}  // namespace audio_capture
@@ -0,0 +1,70 @@
+#ifndef FLUTTER_PLUGIN_COMPRESSOR_H_
+#define FLUTTER_PLUGIN_COMPRESSOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace audio_capture {
+
+struct CompressorOptions {
+  // Level above which the gain is reduced, in dBFS, and by how much: the
+  // level over the threshold is divided by |ratio|. A ratio of 1 leaves
+  // only the limiter.
+  double threshold_db = -12.0;
+  double ratio = 4.0;
+  double knee_db = 6.0;  // Width of the soft knee around the threshold.
+  // Time constants of the level detector while it rises and falls.
+  int attack_ms = 5;
+  int release_ms = 150;
+  double ceiling_db = -1.0;  // Highest peak the limiter lets through.
+  int limiter_release_ms = 50;
+};
+
+// Dynamics for the gained mono output: a soft-knee compressor followed by a
+// brickwall limiter, converting to 16 bits without ever clipping.
+//
+// The compressor follows the peak level with the attack and release time
+// constants, and its gain computer maps the level to a gain reduction with
+// a quadratic knee, branch free over a block at a time. The limiter's
+// envelope rises to every peak at once and decays with its own release,
+// and its gain keeps that envelope under the ceiling, so no sample can
+// exceed it however far the input goes past full scale. There is no
+// look-ahead: the output is not delayed. Work is O(1) per sample.
+//
+// Not thread-safe; use one instance per stream.
+class Compressor {
+ public:
+  Compressor(int sample_rate,
+             const CompressorOptions& options = CompressorOptions());
+
+  // Compresses and limits |count| samples of |input|, full scale at 32768
+  // and free to exceed it, into every |stride|-th sample of |output|, so one
+  // track of interleaved output can be written in place.
+  void Process(const float* input, int16_t* output, size_t count,
+               size_t stride = 1);
+
+  // Lowest gain the last Process() applied, compressor and limiter
+  // together, in dB (0 or below).
+  double gain_db() const;
+
+ private:
+  // Level domain: log2 of the amplitude relative to full scale.
+  float threshold_;
+  float knee_;
+  float slope_;  // 1 / ratio - 1: reduction per unit over the threshold.
+  float attack_coefficient_;
+  float release_coefficient_;
+  float level_;  // Peak envelope, in samples.
+
+  float ceiling_;  // Linear, in samples.
+  float limiter_release_coefficient_;
+  float envelope_;
+  float min_gain_;
+
+  std::vector<float> gains_;  // Scratch, a block of levels, then gains.
+};
+
+}  // namespace audio_capture
+
+#endif  // FLUTTER_PLUGIN_COMPRESSOR_H_
@@ -0,0 +1,165 @@
+#include "delay_estimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace audio_capture {
+
+namespace {
+
+// Rate the streams are decimated to, at least.
+constexpr int kAnalysisRate = 4000;
+// A window quieter than this, in RMS, is taken as silent: about -60 dBFS.
+constexpr float kMinLevel = 1e-3f;
+// Cross spectrum magnitudes below this share of their mean are whitened as
+// if they had it, so empty bands do not turn noise into peaks.
+constexpr float kWhiteningFloor = 1e-3f;
+
+// Analysis samples in |ms|, at least one.
+size_t Samples(int ms, double rate) {
+  return std::max<size_t>(
+      1, static_cast<size_t>(std::max(0, ms) * rate / 1000.0));
+}
+
+}  // namespace
+
+DelayEstimator::DelayEstimator(int sample_rate, const DelayOptions& options)
+    : factor_(static_cast<size_t>(
+          std::max(1, std::max(1, sample_rate) / kAnalysisRate))),
+      analysis_rate_(static_cast<double>(std::max(1, sample_rate)) /
+                     static_cast<double>(factor_)),
+      window_(Samples(options.window_ms, analysis_rate_)),
+      interval_(Samples(options.interval_ms, analysis_rate_)),
+      max_lag_(std::min(window_ - 1,
+                        Samples(options.max_delay_ms, analysis_rate_))),
+      // Zero padding past the largest lag keeps the circular correlation
+      // from wrapping onto the lags searched.
+      fft_(std::max<size_t>(4, NextPowerOfTwo(window_ + max_lag_ + 1))) {
+  microphone_.resize(window_);
+  reference_.resize(window_);
+  frame_.resize(fft_.size());
+  microphone_real_.resize(fft_.bins());
+  microphone_imag_.resize(fft_.bins());
+  reference_real_.resize(fft_.bins());
+  reference_imag_.resize(fft_.bins());
+  Reset();
+}
+
+bool DelayEstimator::Process(const int16_t* microphone,
+                             const int16_t* reference, size_t count) {
+  const float scale = 1.0f / (32768.0f * static_cast<float>(factor_));
+  bool estimated = false;
+  for (size_t i = 0; i < count; ++i) {
+    microphone_sum_ += static_cast<float>(microphone[i]);
+    reference_sum_ += static_cast<float>(reference[i]);
+    if (++phase_ < factor_) {
+      continue;
+    }
+    microphone_[next_] = microphone_sum_ * scale;
+    reference_[next_] = reference_sum_ * scale;
+    microphone_sum_ = 0.0f;
+    reference_sum_ = 0.0f;
+    phase_ = 0;
+    next_ = next_ + 1 == window_ ? 0 : next_ + 1;
+    filled_ = std::min(filled_ + 1, window_);
+    if (++since_estimate_ >= interval_ && filled_ == window_) {
+      since_estimate_ = 0;
+      estimated = Estimate() || estimated;
+    }
+  }
+  return estimated;
+}
+
+bool DelayEstimator::Estimate() {
+  // Oldest first, zero padded; the DC of each window is removed.
+  const size_t size = fft_.size();
+  float* const streams[] = {microphone_.data(), reference_.data()};
+  float* const reals[] = {microphone_real_.data(), reference_real_.data()};
+  float* const imags[] = {microphone_imag_.data(), reference_imag_.data()};
+  for (int s = 0; s < 2; ++s) {
+    const float* ring = streams[s];
+    float mean = 0.0f;
+    for (size_t i = 0; i < window_; ++i) {
+      mean += ring[i];
+    }
+    mean /= static_cast<float>(window_);
+    float energy = 0.0f;
+    for (size_t i = 0; i < window_; ++i) {
+      const float sample = ring[(next_ + i) % window_] - mean;
+      frame_[i] = sample;
+      energy += sample * sample;
+    }
+    if (energy < kMinLevel * kMinLevel * static_cast<float>(window_)) {
+      return false;
+    }
+    std::fill(frame_.begin() + window_, frame_.end(), 0.0f);
+    fft_.Forward(frame_.data(), reals[s], imags[s]);
+  }
+
+  // Cross spectrum, microphone times the conjugate reference, whitened.
+  const size_t bins = fft_.bins();
+  float mean_magnitude = 0.0f;
+  for (size_t k = 0; k < bins; ++k) {
+    const float mr = microphone_real_[k];
+    const float mi = microphone_imag_[k];
+    const float rr = reference_real_[k];
+    const float ri = reference_imag_[k];
+    microphone_real_[k] = mr * rr + mi * ri;
+    microphone_imag_[k] = mi * rr - mr * ri;
+    const float magnitude =
+        std::sqrt(microphone_real_[k] * microphone_real_[k] +
+                  microphone_imag_[k] * microphone_imag_[k]);
+    reference_real_[k] = magnitude;
+    mean_magnitude += magnitude;
+  }
+  const float floor =
+      kWhiteningFloor * mean_magnitude / static_cast<float>(bins);
+  for (size_t k = 0; k < bins; ++k) {
+    const float weight = 1.0f / std::max(reference_real_[k], floor);
+    microphone_real_[k] *= weight;
+    microphone_imag_[k] *= weight;
+  }
+  fft_.Inverse(microphone_real_.data(), microphone_imag_.data(),
+               frame_.data());
+
+  // Lag n >= 0 sits at n, lag -n at size - n.
+  auto at = [&](long lag) {
+    return frame_[static_cast<size_t>(lag < 0 ? static_cast<long>(size) + lag
+                                              : lag)];
+  };
+  const long max_lag = static_cast<long>(max_lag_);
+  long best = 0;
+  for (long lag = -max_lag; lag <= max_lag; ++lag) {
+    if (at(lag) > at(best)) {
+      best = lag;
+    }
+  }
+  double offset = 0.0;
+  if (best > -max_lag && best < max_lag) {
+    const double before = at(best - 1);
+    const double peak = at(best);
+    const double after = at(best + 1);
+    const double curvature = before - 2.0 * peak + after;
+    if (curvature < 0.0) {
+      offset = 0.5 * (before - after) / curvature;
+    }
+  }
+  estimate_.delay_ms =
+      (static_cast<double>(best) + offset) * 1000.0 / analysis_rate_;
+  estimate_.confidence =
+      std::max(0.0, std::min(1.0, static_cast<double>(at(best))));
+  return true;
+}
+
+void DelayEstimator::Reset() {
+  microphone_sum_ = 0.0f;
+  reference_sum_ = 0.0f;
+  phase_ = 0;
+  std::fill(microphone_.begin(), microphone_.end(), 0.0f);
+  std::fill(reference_.begin(), reference_.end(), 0.0f);
+  next_ = 0;
+  filled_ = 0;
+  since_estimate_ = 0;
+}
+
+}  // namespace audio_capture
@@ -0,0 +1,95 @@
+#ifndef FLUTTER_PLUGIN_DELAY_ESTIMATOR_H_
+#define FLUTTER_PLUGIN_DELAY_ESTIMATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "fft.h"
+
+namespace audio_capture {
+
+struct DelayOptions {
+  // Audio each estimate correlates, and how often one is made.
+  int window_ms = 1000;
+  int interval_ms = 1000;
+  // Largest delay either way that is searched.
+  int max_delay_ms = 500;
+};
+
+struct DelayEstimate {
+  // Delay of the microphone behind the reference in milliseconds, negative
+  // when the microphone leads.
+  double delay_ms = 0.0;
+  // Height of the whitened correlation peak: about 1 when one stream is a
+  // delayed copy of the other, near 0 when they are unrelated.
+  double confidence = 0.0;
+};
+
+// Measures the delay between two mono 16-bit streams on the same timeline,
+// such as a microphone and the system audio it hears, by generalized
+// cross-correlation with the phase transform (GCC-PHAT).
+//
+// Both streams are decimated by averaging to about 4 kHz as they arrive.
+// Every |interval_ms| the last |window_ms| of each are transformed, their
+// cross spectrum is whitened so every band counts alike, and the peak of
+// its inverse within |max_delay_ms| gives the delay, refined between lags
+// by a parabola. Windows where either stream is silent make no estimate.
+// An estimate costs three FFTs of the window plus the search; the
+// decimation costs O(1) per sample.
+//
+// Not thread-safe; use one instance per stream pair.
+class DelayEstimator {
+ public:
+  DelayEstimator(int sample_rate,
+                 const DelayOptions& options = DelayOptions());
+
+  // Adds |count| samples of each stream, both covering the same stretch of
+  // the timeline. Returns true if an estimate was made; with several, the
+  // last is kept.
+  bool Process(const int16_t* microphone, const int16_t* reference,
+               size_t count);
+
+  // The last estimate made.
+  const DelayEstimate& estimate() const { return estimate_; }
+
+  // Forgets the audio gathered, for streams that do not continue the
+  // previous ones; the last estimate stays.
+  void Reset();
+
+ private:
+  // Correlates the windows in the rings. Returns false if either is silent.
+  bool Estimate();
+
+  size_t factor_;         // Samples averaged into one analysis sample.
+  double analysis_rate_;  // Rate of the analysis samples, in Hz.
+  size_t window_;         // Analysis samples correlated.
+  size_t interval_;       // Analysis samples between estimates.
+  size_t max_lag_;
+  Fft fft_;
+
+  // Decimation in progress.
+  float microphone_sum_;
+  float reference_sum_;
+  size_t phase_;
+
+  // The last |window_| analysis samples of each stream, oldest at |next_|.
+  std::vector<float> microphone_;
+  std::vector<float> reference_;
+  size_t next_;
+  size_t filled_;
+  size_t since_estimate_;
+
+  // Scratch.
+  std::vector<float> frame_;
+  std::vector<float> microphone_real_;
+  std::vector<float> microphone_imag_;
+  std::vector<float> reference_real_;
+  std::vector<float> reference_imag_;
+
+  DelayEstimate estimate_;
+};
+
+}  // namespace audio_capture
+
+#endif  // FLUTTER_PLUGIN_DELAY_ESTIMATOR_H_
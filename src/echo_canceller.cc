@@ -0,0 +1,328 @@
+#include "echo_canceller.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace audio_capture {
+
+namespace {
+
+// Blocks span at least this long.
+constexpr int kBlockMs = 4;
+constexpr size_t kMinBlockSize = 32;
+// Normalized step size of the filter update.
+constexpr float kStepSize = 0.5f;
+// Weight of the previous block in the reference power of each bin.
+constexpr float kPowerSmoothing = 0.9f;
+// Reference power below which a bin is not adapted on, per sample of the
+// frame: about -60 dBFS.
+constexpr float kMinPowerPerSample = 1e-6f;
+// The far end is active while a block of the reference peaks above this.
+constexpr float kActiveLevel = 1e-3f;  // -60 dBFS.
+// Double talk while the microphone peaks above this share of the reference
+// peak over the filter span, and for the hangover after.
+constexpr float kGeigelThreshold = 0.5f;
+constexpr int kDoubleTalkHoldMs = 60;
+// The filter restarts when its output is this much stronger than both its
+// input and the reference.
+constexpr double kDivergenceRatio = 8.0;
+// Delays within this many blocks of the estimate are left to the filter,
+// which starts this far before it.
+constexpr size_t kDelayMarginBlocks = 2;
+// Time constant of the envelope statistics, and how long a new delay must
+// lead before the filter moves to it.
+constexpr double kDelayWindowSeconds = 2.0;
+constexpr int kDelayConfirmMs = 250;
+// Least normalized correlation a delay is taken at.
+constexpr float kMinCorrelation = 0.3f;
+// Time constant of the ERLE energies.
+constexpr double kErleWindowSeconds = 0.5;
+
+double Coefficient(size_t block, int sample_rate, double seconds) {
+  return 1.0 - std::exp(-static_cast<double>(block) /
+                        (seconds * std::max(1, sample_rate)));
+}
+
+}  // namespace
+
+EchoCanceller::EchoCanceller(int sample_rate, const EchoOptions& options)
+    : block_(std::max(kMinBlockSize,
+                      NextPowerOfTwo(static_cast<size_t>(
+                          std::max(1, sample_rate) * kBlockMs / 1000)))),
+      fft_(2 * block_),
+      bins_(fft_.bins()) {
+  const size_t rate = static_cast<size_t>(std::max(1, sample_rate));
+  const size_t filter_samples =
+      rate * static_cast<size_t>(std::max(1, options.filter_ms)) / 1000;
+  partitions_ = std::max<size_t>(
+      kDelayMarginBlocks + 1, (filter_samples + block_ - 1) / block_);
+  max_delay_blocks_ =
+      rate * static_cast<size_t>(std::max(0, options.max_delay_ms)) / 1000 /
+      block_;
+  confirm_blocks_ = std::max<size_t>(
+      1, rate * static_cast<size_t>(kDelayConfirmMs) / 1000 / block_);
+  hold_limit_ = std::max<size_t>(
+      1, rate * static_cast<size_t>(kDoubleTalkHoldMs) / 1000 / block_);
+  delay_smoothing_ = static_cast<float>(
+      Coefficient(block_, sample_rate, kDelayWindowSeconds));
+  erle_smoothing_ = Coefficient(block_, sample_rate, kErleWindowSeconds);
+
+  microphone_.resize(block_);
+  output_.resize(block_);
+  history_.resize((max_delay_blocks_ + 1) * block_);
+  x_real_.resize(partitions_ * bins_);
+  x_imag_.resize(partitions_ * bins_);
+  w_real_.resize(partitions_ * bins_);
+  w_imag_.resize(partitions_ * bins_);
+  reference_power_.resize(bins_);
+  previous_block_.resize(block_);
+  block_peaks_.resize(partitions_);
+  frame_.resize(2 * block_);
+  real_.resize(bins_);
+  imag_.resize(bins_);
+  envelopes_.resize(max_delay_blocks_ + 1);
+  covariance_.resize(max_delay_blocks_ + 1);
+
+  microphone_mean_ = 0.0f;
+  microphone_variance_ = 0.0f;
+  reference_mean_ = 0.0f;
+  reference_variance_ = 0.0f;
+  delay_blocks_ = 0;
+  candidate_blocks_ = 0;
+  candidate_count_ = 0;
+  ResetFilter();
+  Reset();
+}
+
+void EchoCanceller::Process(int16_t* microphone, const int16_t* reference,
+                            size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    microphone_[fill_] =
+        static_cast<float>(microphone[i]) * (1.0f / 32768.0f);
+    history_[history_next_] =
+        static_cast<float>(reference[i]) * (1.0f / 32768.0f);
+    history_next_ = history_next_ + 1 == history_.size() ? 0
+                                                         : history_next_ + 1;
+    const float out = output_[fill_] * 32768.0f;
+    microphone[i] =
+        static_cast<int16_t>(std::max(-32768.0f, std::min(32767.0f, out)));
+    if (++fill_ == block_) {
+      ProcessBlock();
+      fill_ = 0;
+    }
+  }
+}
+
+void EchoCanceller::ProcessBlock() {
+  const size_t size = history_.size();
+  // The block just received ends at |history_next_|.
+  const size_t newest = (history_next_ + size - block_) % size;
+  float reference_envelope = 0.0f;
+  float microphone_envelope = 0.0f;
+  float microphone_peak = 0.0f;
+  for (size_t i = 0; i < block_; ++i) {
+    reference_envelope += std::fabs(history_[(newest + i) % size]);
+    const float magnitude = std::fabs(microphone_[i]);
+    microphone_envelope += magnitude;
+    microphone_peak = std::max(microphone_peak, magnitude);
+  }
+  const float scale = 1.0f / static_cast<float>(block_);
+  envelopes_[envelope_next_] = reference_envelope * scale;
+  if (UpdateDelay(microphone_envelope * scale)) {
+    ResetFilter();
+  }
+  envelope_next_ =
+      envelope_next_ + 1 == envelopes_.size() ? 0 : envelope_next_ + 1;
+
+  // The reference block the filter starts at, the margin before the echo.
+  const size_t offset =
+      delay_blocks_ > kDelayMarginBlocks ? delay_blocks_ - kDelayMarginBlocks
+                                         : 0;
+  const size_t start = (newest + size - offset * block_) % size;
+  float reference_peak = 0.0f;
+  for (size_t i = 0; i < block_; ++i) {
+    const float sample = history_[(start + i) % size];
+    frame_[i] = previous_block_[i];
+    frame_[block_ + i] = sample;
+    previous_block_[i] = sample;
+    reference_peak = std::max(reference_peak, std::fabs(sample));
+  }
+
+  // The newest reference spectrum goes before the others.
+  head_ = head_ == 0 ? partitions_ - 1 : head_ - 1;
+  float* x_real = x_real_.data() + head_ * bins_;
+  float* x_imag = x_imag_.data() + head_ * bins_;
+  fft_.Forward(frame_.data(), x_real, x_imag);
+  block_peaks_[head_] = reference_peak;
+  const bool active = reference_peak > kActiveLevel;
+  const float span_peak =
+      *std::max_element(block_peaks_.begin(), block_peaks_.end());
+
+  // Echo estimate: the weights applied to the reference spectra.
+  std::fill(real_.begin(), real_.end(), 0.0f);
+  std::fill(imag_.begin(), imag_.end(), 0.0f);
+  for (size_t p = 0; p < partitions_; ++p) {
+    const size_t slot = ((head_ + p) % partitions_) * bins_;
+    const float* xr = x_real_.data() + slot;
+    const float* xi = x_imag_.data() + slot;
+    const float* wr = w_real_.data() + p * bins_;
+    const float* wi = w_imag_.data() + p * bins_;
+    for (size_t k = 0; k < bins_; ++k) {
+      real_[k] += wr[k] * xr[k] - wi[k] * xi[k];
+      imag_[k] += wr[k] * xi[k] + wi[k] * xr[k];
+    }
+  }
+  fft_.Inverse(real_.data(), imag_.data(), frame_.data());
+
+  double microphone_energy = 0.0;
+  double error_energy = 0.0;
+  for (size_t i = 0; i < block_; ++i) {
+    const float error = microphone_[i] - frame_[block_ + i];
+    output_[i] = error;
+    microphone_energy += static_cast<double>(microphone_[i]) * microphone_[i];
+    error_energy += static_cast<double>(error) * error;
+  }
+
+  if (!active) {
+    return;
+  }
+  // An honest estimate stays below the reference peak over the filter span,
+  // so a quiet microphone as the far end starts is no sign of divergence.
+  const double span_energy =
+      static_cast<double>(span_peak) * span_peak * static_cast<double>(block_);
+  if (error_energy > kDivergenceRatio * (microphone_energy + span_energy)) {
+    // The filter adds echo instead of removing it: pass the microphone.
+    std::copy(microphone_.begin(), microphone_.end(), output_.begin());
+    ResetFilter();
+    return;
+  }
+  // Geigel double-talk detection over the filter span.
+  if (microphone_peak > kGeigelThreshold * span_peak) {
+    hold_blocks_ = hold_limit_;
+  } else if (hold_blocks_ > 0) {
+    --hold_blocks_;
+  }
+  microphone_energy_ +=
+      erle_smoothing_ * (microphone_energy - microphone_energy_);
+  error_energy_ += erle_smoothing_ * (error_energy - error_energy_);
+  if (hold_blocks_ > 0) {
+    return;
+  }
+
+  // Normalized gradient: the error spectrum, from a frame zero-padded in
+  // front, times each reference spectrum over the reference power.
+  std::fill(frame_.begin(), frame_.begin() + block_, 0.0f);
+  std::copy(output_.begin(), output_.end(), frame_.begin() + block_);
+  fft_.Forward(frame_.data(), real_.data(), imag_.data());
+  const float floor = kMinPowerPerSample * static_cast<float>(2 * block_);
+  // Every partition adapts on the same error, so they share the step.
+  const float step = kStepSize / static_cast<float>(partitions_);
+  for (size_t k = 0; k < bins_; ++k) {
+    const float power = x_real[k] * x_real[k] + x_imag[k] * x_imag[k];
+    reference_power_[k] +=
+        (1.0f - kPowerSmoothing) * (power - reference_power_[k]);
+    const float gain = step / (reference_power_[k] + floor);
+    real_[k] *= gain;
+    imag_[k] *= gain;
+  }
+  for (size_t p = 0; p < partitions_; ++p) {
+    const size_t slot = ((head_ + p) % partitions_) * bins_;
+    const float* xr = x_real_.data() + slot;
+    const float* xi = x_imag_.data() + slot;
+    float* wr = w_real_.data() + p * bins_;
+    float* wi = w_imag_.data() + p * bins_;
+    for (size_t k = 0; k < bins_; ++k) {
+      // conj(X) * E.
+      wr[k] += xr[k] * real_[k] + xi[k] * imag_[k];
+      wi[k] += xr[k] * imag_[k] - xi[k] * real_[k];
+    }
+  }
+
+  // Keep one partition's impulse response to its block, so the circular
+  // convolution stays linear.
+  float* wr = w_real_.data() + constrain_next_ * bins_;
+  float* wi = w_imag_.data() + constrain_next_ * bins_;
+  fft_.Inverse(wr, wi, frame_.data());
+  std::fill(frame_.begin() + block_, frame_.end(), 0.0f);
+  fft_.Forward(frame_.data(), wr, wi);
+  constrain_next_ = constrain_next_ + 1 == partitions_ ? 0
+                                                       : constrain_next_ + 1;
+}
+
+bool EchoCanceller::UpdateDelay(float microphone_envelope) {
+  const float reference_envelope = envelopes_[envelope_next_];
+  if (reference_envelope * 2.0f < kActiveLevel) {
+    return false;  // The far end is silent: nothing to correlate.
+  }
+  const float a = delay_smoothing_;
+  microphone_mean_ += a * (microphone_envelope - microphone_mean_);
+  reference_mean_ += a * (reference_envelope - reference_mean_);
+  const float microphone_deviation = microphone_envelope - microphone_mean_;
+  const float reference_deviation = reference_envelope - reference_mean_;
+  microphone_variance_ +=
+      a * (microphone_deviation * microphone_deviation - microphone_variance_);
+  reference_variance_ +=
+      a * (reference_deviation * reference_deviation - reference_variance_);
+
+  const size_t count = envelopes_.size();
+  size_t best = 0;
+  for (size_t d = 0; d < count; ++d) {
+    const float past =
+        envelopes_[(envelope_next_ + count - d) % count] - reference_mean_;
+    covariance_[d] += a * (microphone_deviation * past - covariance_[d]);
+    if (covariance_[d] > covariance_[best]) {
+      best = d;
+    }
+  }
+  const float norm =
+      std::sqrt(microphone_variance_ * reference_variance_) + 1e-12f;
+  if (covariance_[best] < kMinCorrelation * norm) {
+    candidate_count_ = 0;
+    return false;
+  }
+  if (best != candidate_blocks_) {
+    candidate_blocks_ = best;
+    candidate_count_ = 0;
+  }
+  if (++candidate_count_ < confirm_blocks_) {
+    return false;
+  }
+  const size_t distance = best > delay_blocks_ ? best - delay_blocks_
+                                               : delay_blocks_ - best;
+  if (distance <= kDelayMarginBlocks) {
+    return false;  // Within the filter's reach.
+  }
+  delay_blocks_ = best;
+  return true;
+}
+
+double EchoCanceller::erle_db() const {
+  return 10.0 * std::log10((microphone_energy_ + 1e-12) /
+                           (error_energy_ + 1e-12));
+}
+
+void EchoCanceller::ResetFilter() {
+  std::fill(w_real_.begin(), w_real_.end(), 0.0f);
+  std::fill(w_imag_.begin(), w_imag_.end(), 0.0f);
+  constrain_next_ = 0;
+  hold_blocks_ = 0;
+  microphone_energy_ = 0.0;
+  error_energy_ = 0.0;
+}
+
+void EchoCanceller::Reset() {
+  std::fill(microphone_.begin(), microphone_.end(), 0.0f);
+  std::fill(output_.begin(), output_.end(), 0.0f);
+  fill_ = 0;
+  std::fill(history_.begin(), history_.end(), 0.0f);
+  history_next_ = 0;
+  std::fill(x_real_.begin(), x_real_.end(), 0.0f);
+  std::fill(x_imag_.begin(), x_imag_.end(), 0.0f);
+  head_ = 0;
+  std::fill(previous_block_.begin(), previous_block_.end(), 0.0f);
+  std::fill(block_peaks_.begin(), block_peaks_.end(), 0.0f);
+  std::fill(envelopes_.begin(), envelopes_.end(), 0.0f);
+  envelope_next_ = 0;
+}
+
+}  // namespace audio_capture
@@ -0,0 +1,127 @@
+#ifndef FLUTTER_PLUGIN_ECHO_CANCELLER_H_
+#define FLUTTER_PLUGIN_ECHO_CANCELLER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "fft.h"
+
+namespace audio_capture {
+
+struct EchoOptions {
+  // Length of the echo path the filter models past the estimated delay:
+  // the room's reverberation the canceller removes.
+  int filter_ms = 64;
+  // Longest delay of the echo behind the reference the estimator searches.
+  int max_delay_ms = 500;
+};
+
+// Acoustic echo cancellation for a mono 16-bit microphone stream, given the
+// far-end audio playing on the speakers as a reference on the same
+// timeline.
+//
+// The delay of the echo behind the reference is estimated from the
+// correlation of the two signals' block envelopes, and the reference is
+// delayed to match. A partitioned-block frequency-domain adaptive filter
+// (multidelay NLMS, one partition per block, the gradient constraint
+// applied to one partition per block in turn) then models the echo path
+// over |filter_ms| and subtracts its estimate. Adaptation stops during
+// double talk, detected Geigel-style when the microphone peaks above half
+// the recent reference peak, and the filter restarts if it diverges. Each
+// block costs four FFTs and O(partitions * bins).
+//
+// Not thread-safe; use one instance per stream pair.
+class EchoCanceller {
+ public:
+  EchoCanceller(int sample_rate, const EchoOptions& options = EchoOptions());
+
+  // Samples the output lags the input by: one block.
+  size_t latency() const { return block_; }
+
+  // Removes the echo of |reference| from |count| samples of |microphone| in
+  // place. Both cover the same stretch of the timeline. The output is
+  // delayed by latency() samples, the first of them silent.
+  void Process(int16_t* microphone, const int16_t* reference, size_t count);
+
+  // Estimated delay of the echo behind the reference, in samples.
+  size_t delay() const { return delay_blocks_ * block_; }
+
+  // Echo return loss enhancement: how much weaker the output is than the
+  // microphone, smoothed over half a second while the far end is active.
+  double erle_db() const;
+
+  // Whether double talk held adaptation for the last block.
+  bool double_talk() const { return hold_blocks_ > 0; }
+
+  // Forgets the audio in flight, for streams that do not continue the
+  // previous ones; the echo path and delay stay.
+  void Reset();
+
+ private:
+  void ProcessBlock();
+  // Follows the delay, returning true when it moved past the filter's
+  // margin.
+  bool UpdateDelay(float microphone_envelope);
+  void ResetFilter();
+
+  size_t block_;       // Samples per block, B; the FFT spans 2B.
+  size_t partitions_;  // Filter length in blocks.
+  size_t max_delay_blocks_;
+  Fft fft_;
+  size_t bins_;
+
+  // Input being gathered and output being handed out, a block of each.
+  std::vector<float> microphone_;
+  std::vector<float> output_;
+  size_t fill_;
+
+  // The reference as received, in a ring long enough for the largest delay.
+  std::vector<float> history_;
+  size_t history_next_;
+
+  // The filter: spectra of the last |partitions_| reference frames, newest
+  // at |head_|, and the matching weights, each partition |bins_| complex
+  // values.
+  std::vector<float> x_real_;
+  std::vector<float> x_imag_;
+  std::vector<float> w_real_;
+  std::vector<float> w_imag_;
+  size_t head_;
+  size_t constrain_next_;  // Partition whose weights are constrained next.
+  std::vector<float> reference_power_;  // Smoothed per bin.
+  std::vector<float> previous_block_;   // Delayed reference, last block.
+  std::vector<float> block_peaks_;      // Of the last |partitions_| blocks.
+
+  // Scratch.
+  std::vector<float> frame_;
+  std::vector<float> real_;
+  std::vector<float> imag_;
+
+  // Delay estimation on block envelopes: the reference envelopes of the
+  // last |max_delay_blocks_| + 1 blocks, and the smoothed covariance of the
+  // microphone envelope with each of them.
+  std::vector<float> envelopes_;
+  size_t envelope_next_;
+  std::vector<float> covariance_;
+  float microphone_mean_;
+  float microphone_variance_;
+  float reference_mean_;
+  float reference_variance_;
+  float delay_smoothing_;
+  size_t delay_blocks_;
+  size_t candidate_blocks_;
+  size_t candidate_count_;  // Blocks |candidate_blocks_| has led.
+  size_t confirm_blocks_;   // Blocks a new delay must lead.
+
+  size_t hold_blocks_;  // Double talk hangover left.
+  size_t hold_limit_;
+  // Smoothed block energies, for erle_db().
+  double erle_smoothing_;
+  double microphone_energy_;
+  double error_energy_;
+};
+
+}  // namespace audio_capture
+
+#endif  // FLUTTER_PLUGIN_ECHO_CANCELLER_H_
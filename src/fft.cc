@@ -0,0 +1,203 @@
+#include "fft.h"
+
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define AUDIO_CAPTURE_FFT_SSE 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define AUDIO_CAPTURE_FFT_NEON 1
+#endif
+
+namespace audio_capture {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Butterflies of one block of a stage: |half| pairs |a| and |b| = |a| +
+// |half|, the latter rotated by the twiddles |w|.
+void Butterflies(float* a_real, float* a_imag, const float* w_real,
+                 const float* w_imag, size_t half) {
+  float* b_real = a_real + half;
+  float* b_imag = a_imag + half;
+  size_t j = 0;
+#if defined(AUDIO_CAPTURE_FFT_SSE)
+  for (; j + 4 <= half; j += 4) {
+    const __m128 wr = _mm_loadu_ps(w_real + j);
+    const __m128 wi = _mm_loadu_ps(w_imag + j);
+    const __m128 br = _mm_loadu_ps(b_real + j);
+    const __m128 bi = _mm_loadu_ps(b_imag + j);
+    const __m128 tr = _mm_sub_ps(_mm_mul_ps(br, wr), _mm_mul_ps(bi, wi));
+    const __m128 ti = _mm_add_ps(_mm_mul_ps(br, wi), _mm_mul_ps(bi, wr));
+    const __m128 ar = _mm_loadu_ps(a_real + j);
+    const __m128 ai = _mm_loadu_ps(a_imag + j);
+    _mm_storeu_ps(b_real + j, _mm_sub_ps(ar, tr));
+    _mm_storeu_ps(b_imag + j, _mm_sub_ps(ai, ti));
+    _mm_storeu_ps(a_real + j, _mm_add_ps(ar, tr));
+    _mm_storeu_ps(a_imag + j, _mm_add_ps(ai, ti));
+  }
+#elif defined(AUDIO_CAPTURE_FFT_NEON)
+  for (; j + 4 <= half; j += 4) {
+    const float32x4_t wr = vld1q_f32(w_real + j);
+    const float32x4_t wi = vld1q_f32(w_imag + j);
+    const float32x4_t br = vld1q_f32(b_real + j);
+    const float32x4_t bi = vld1q_f32(b_imag + j);
+    const float32x4_t tr = vmlsq_f32(vmulq_f32(br, wr), bi, wi);
+    const float32x4_t ti = vmlaq_f32(vmulq_f32(br, wi), bi, wr);
+    const float32x4_t ar = vld1q_f32(a_real + j);
+    const float32x4_t ai = vld1q_f32(a_imag + j);
+    vst1q_f32(b_real + j, vsubq_f32(ar, tr));
+    vst1q_f32(b_imag + j, vsubq_f32(ai, ti));
+    vst1q_f32(a_real + j, vaddq_f32(ar, tr));
+    vst1q_f32(a_imag + j, vaddq_f32(ai, ti));
+  }
+#endif
+  // The first stages, and what vectors leave over.
+  for (; j < half; ++j) {
+    const float tr = b_real[j] * w_real[j] - b_imag[j] * w_imag[j];
+    const float ti = b_real[j] * w_imag[j] + b_imag[j] * w_real[j];
+    b_real[j] = a_real[j] - tr;
+    b_imag[j] = a_imag[j] - ti;
+    a_real[j] += tr;
+    a_imag[j] += ti;
+  }
+}
+
+}  // namespace
+
+size_t NextPowerOfTwo(size_t value) {
+  size_t power = 1;
+  while (power < value) {
+    power <<= 1;
+  }
+  return power;
+}
+
+Fft::Fft(size_t size)
+    : size_(size),
+      half_(size / 2),
+      bit_reverse_(half_),
+      twiddle_real_(half_ > 1 ? half_ - 1 : 0),
+      twiddle_imag_(twiddle_real_.size()),
+      split_real_(half_ + 1),
+      split_imag_(half_ + 1),
+      work_real_(half_),
+      work_imag_(half_),
+      out_real_(half_ + 1),
+      out_imag_(half_ + 1) {
+  size_t bits = 0;
+  while ((static_cast<size_t>(1) << bits) < half_) {
+    ++bits;
+  }
+  for (size_t i = 0; i < half_; ++i) {
+    size_t reversed = 0;
+    for (size_t b = 0; b < bits; ++b) {
+      reversed |= ((i >> b) & 1) << (bits - 1 - b);
+    }
+    bit_reverse_[i] = reversed;
+  }
+
+  // The stage with blocks of |length| starts at |length| / 2 - 1.
+  for (size_t half = 1; half < half_; half <<= 1) {
+    for (size_t j = 0; j < half; ++j) {
+      const double angle =
+          -kPi * static_cast<double>(j) / static_cast<double>(half);
+      twiddle_real_[half - 1 + j] = static_cast<float>(std::cos(angle));
+      twiddle_imag_[half - 1 + j] = static_cast<float>(std::sin(angle));
+    }
+  }
+  for (size_t k = 0; k <= half_; ++k) {
+    const double angle = -2.0 * kPi * static_cast<double>(k) /
+                         static_cast<double>(size_);
+    split_real_[k] = static_cast<float>(std::cos(angle));
+    split_imag_[k] = static_cast<float>(std::sin(angle));
+  }
+}
+
+void Fft::Transform() {
+  for (size_t half = 1; half < half_; half <<= 1) {
+    const float* w_real = twiddle_real_.data() + half - 1;
+    const float* w_imag = twiddle_imag_.data() + half - 1;
+    for (size_t block = 0; block < half_; block += 2 * half) {
+      Butterflies(work_real_.data() + block, work_imag_.data() + block,
+                  w_real, w_imag, half);
+    }
+  }
+}
+
+void Fft::Forward(const float* input, float* real, float* imag) {
+  float* z_real = work_real_.data();
+  float* z_imag = work_imag_.data();
+  // Even samples are the real parts, odd ones the imaginary parts.
+  for (size_t i = 0; i < half_; ++i) {
+    const size_t n = bit_reverse_[i];
+    z_real[i] = input[2 * n];
+    z_imag[i] = input[2 * n + 1];
+  }
+  Transform();
+
+  // X[k] = E[k] + W^k O[k], with E and O the transforms of the even and
+  // odd samples recovered from Z[k] and conj(Z[N/2 - k]).
+  const size_t mask = half_ - 1;
+  for (size_t k = 0; k <= half_; ++k) {
+    const size_t a = k & mask;
+    const size_t b = (half_ - k) & mask;
+    const float even_real = 0.5f * (z_real[a] + z_real[b]);
+    const float even_imag = 0.5f * (z_imag[a] - z_imag[b]);
+    const float odd_real = 0.5f * (z_imag[a] + z_imag[b]);
+    const float odd_imag = -0.5f * (z_real[a] - z_real[b]);
+    real[k] = even_real + split_real_[k] * odd_real -
+              split_imag_[k] * odd_imag;
+    imag[k] = even_imag + split_real_[k] * odd_imag +
+              split_imag_[k] * odd_real;
+  }
+}
+
+void Fft::Inverse(const float* real, const float* imag, float* output) {
+  // Z[k] = E[k] + i O[k], with E[k] = (X[k] + conj(X[N/2 - k])) / 2 and
+  // O[k] = (X[k] - conj(X[N/2 - k])) conj(W^k) / 2; its inverse transform
+  // holds the even samples in the real parts and the odd ones in the
+  // imaginary parts.
+  float* z_real = out_real_.data();
+  float* z_imag = out_imag_.data();
+  for (size_t k = 0; k < half_; ++k) {
+    const size_t m = half_ - k;
+    // The first and last bins of a real signal are real.
+    const float a_imag = k == 0 ? 0.0f : imag[k];
+    const float b_imag = m == half_ ? 0.0f : imag[m];
+    const float even_real = 0.5f * (real[k] + real[m]);
+    const float even_imag = 0.5f * (a_imag - b_imag);
+    const float diff_real = 0.5f * (real[k] - real[m]);
+    const float diff_imag = 0.5f * (a_imag + b_imag);
+    const float odd_real =
+        diff_real * split_real_[k] + diff_imag * split_imag_[k];
+    const float odd_imag =
+        diff_imag * split_real_[k] - diff_real * split_imag_[k];
+    // Conjugated, so the forward butterflies compute the inverse.
+    z_real[k] = even_real - odd_imag;
+    z_imag[k] = -(even_imag + odd_real);
+  }
+  for (size_t i = 0; i < half_; ++i) {
+    const size_t n = bit_reverse_[i];
+    work_real_[i] = z_real[n];
+    work_imag_[i] = z_imag[n];
+  }
+  Transform();
+  const float scale = 1.0f / static_cast<float>(half_);
+  for (size_t n = 0; n < half_; ++n) {
+    output[2 * n] = work_real_[n] * scale;
+    output[2 * n + 1] = -work_imag_[n] * scale;
+  }
+}
+
+void Fft::PowerSpectrum(const float* input, float* power) {
+  Forward(input, out_real_.data(), out_imag_.data());
+  for (size_t k = 0; k <= half_; ++k) {
+    power[k] = out_real_[k] * out_real_[k] + out_imag_[k] * out_imag_[k];
+  }
+}
+
+}  // namespace audio_capture
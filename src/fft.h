@@ -0,0 +1,60 @@
+#ifndef FLUTTER_PLUGIN_FFT_H_
+#define FLUTTER_PLUGIN_FFT_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace audio_capture {
+
+// FFT of real input of a power-of-two size, and its inverse, computed as a
+// complex FFT of half the size on the even and odd samples. Butterflies
+// use SSE or NEON where available; twiddles are tabulated at construction.
+//
+// Not thread-safe; use one instance per stream.
+class Fft {
+ public:
+  // |size| is a power of two of at least 4.
+  explicit Fft(size_t size);
+
+  size_t size() const { return size_; }
+
+  // Bins a transform writes: size() / 2 + 1, from 0 Hz to Nyquist.
+  size_t bins() const { return size_ / 2 + 1; }
+
+  // Transforms size() samples into bins() complex values, unnormalized.
+  void Forward(const float* input, float* real, float* imag);
+
+  // Transforms bins() complex values back into size() samples, scaled so
+  // that it undoes Forward. The imaginary parts of the first and last bin
+  // are ignored.
+  void Inverse(const float* real, const float* imag, float* output);
+
+  // Writes the squared magnitude of each of the bins() values.
+  void PowerSpectrum(const float* input, float* power);
+
+ private:
+  // Runs the butterfly stages over the bit-reversed |work_real_| and
+  // |work_imag_| in place.
+  void Transform();
+
+  size_t size_;
+  size_t half_;  // Size of the complex FFT.
+  std::vector<size_t> bit_reverse_;
+  // Twiddles of each stage, one run of |length| / 2 per stage.
+  std::vector<float> twiddle_real_;
+  std::vector<float> twiddle_imag_;
+  // Twiddles splitting the complex FFT into the real one.
+  std::vector<float> split_real_;
+  std::vector<float> split_imag_;
+  std::vector<float> work_real_;
+  std::vector<float> work_imag_;
+  std::vector<float> out_real_;  // For PowerSpectrum and Inverse.
+  std::vector<float> out_imag_;
+};
+
+// Smallest power of two of at least |value|.
+size_t NextPowerOfTwo(size_t value);
+
+}  // namespace audio_capture
+
+#endif  // FLUTTER_PLUGIN_FFT_H_
@@ -0,0 +1,181 @@
+#include "gain_control.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace audio_capture {
+
+namespace {
+
+// BS.1770 offset of the K-weighting's gain at 1 kHz.
+constexpr double kLoudnessOffset = -0.691;
+// The level is converted to decibels this often.
+constexpr int kControlPeriodMs = 1;
+// Integration time of the level the gate compares.
+constexpr int kGateWindowMs = 20;
+// Power of kMinLevelDb, below which the detector reads silence.
+constexpr double kMinPower = 1e-12;
+
+// Per-sample coefficient of a one-pole smoother with time constant |ms|.
+double SmoothingCoefficient(int sample_rate, int ms) {
+  return 1.0 - std::exp(-1000.0 / (static_cast<double>(std::max(1, ms)) *
+                                   sample_rate));
+}
+
+float DbToGain(double db) {
+  return static_cast<float>(std::pow(10.0, db / 20.0));
+}
+
+}  // namespace
+
+AutomaticGainControl::AutomaticGainControl(int sample_rate,
+                                           const AgcOptions& options)
+    : detector_(options.detector),
+      power_coefficient_(SmoothingCoefficient(sample_rate,
+                                              options.window_ms)),
+      level_offset_db_(options.detector == AgcDetector::kLoudness
+                           ? kLoudnessOffset
+                           : 0.0),
+      fast_coefficient_(SmoothingCoefficient(sample_rate, kGateWindowMs)),
+      gate_power_(std::pow(10.0, (options.gate_db - level_offset_db_) /
+                                     10.0)),
+      control_period_(static_cast<size_t>(
+          std::max(1, sample_rate * kControlPeriodMs / 1000))),
+      target_db_(options.target_db),
+      min_gain_db_(std::min(options.min_gain_db, options.max_gain_db)),
+      max_gain_db_(options.max_gain_db),
+      attack_coefficient_(static_cast<float>(
+          SmoothingCoefficient(sample_rate, options.attack_ms))),
+      release_coefficient_(static_cast<float>(
+          SmoothingCoefficient(sample_rate, options.release_ms))),
+      window_(static_cast<size_t>(sample_rate) *
+                  static_cast<size_t>(std::max(0, options.lookahead_ms)) /
+                  1000 +
+              1),
+      ceiling_(DbToGain(std::min(0.0, options.ceiling_db))),
+      limiter_release_coefficient_(static_cast<float>(SmoothingCoefficient(
+          sample_rate, options.limiter_release_ms))),
+      delay_(window_ - 1),
+      required_(window_),
+      minima_(window_),
+      mins_(window_) {
+  DesignKWeighting(sample_rate, &shelf_, &highpass_);
+  gain_ = DbToGain(std::max(min_gain_db_, std::min(0.0, max_gain_db_)));
+  target_gain_ = gain_;
+  Reset();
+}
+
+void AutomaticGainControl::Process(int16_t* samples, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    const float x = static_cast<float>(samples[i]) * (1.0f / 32768.0f);
+
+    double detected = x;
+    if (detector_ == AgcDetector::kLoudness) {
+      detected = FilterBiquad(FilterBiquad(detected, shelf_, filter_state_),
+                              highpass_, filter_state_ + 2);
+    }
+    const double squared = detected * detected;
+    fast_power_ += fast_coefficient_ * (squared - fast_power_);
+    if (fast_power_ >= gate_power_) {
+      power_ += power_coefficient_ * (squared - power_);
+    }
+    if (--until_control_ == 0) {
+      UpdateTarget();
+      until_control_ = control_period_;
+    }
+    gain_ += (target_gain_ < gain_ ? attack_coefficient_
+                                   : release_coefficient_) *
+             (target_gain_ - gain_);
+
+    const float y = x * gain_;
+    const float magnitude = std::fabs(y);
+    const float required = magnitude > ceiling_ ? ceiling_ / magnitude : 1.0f;
+    float delayed = y;
+    if (!delay_.empty()) {
+      delayed = delay_[delay_next_];
+      delay_[delay_next_] = y;
+      delay_next_ = delay_next_ + 1 == delay_.size() ? 0 : delay_next_ + 1;
+    }
+    const float out = delayed * LimiterGain(required) * 32768.0f;
+    samples[i] =
+        static_cast<int16_t>(std::max(-32768.0f, std::min(32767.0f, out)));
+  }
+}
+
+void AutomaticGainControl::UpdateTarget() {
+  if (fast_power_ < gate_power_) {
+    target_gain_ = gain_;  // A pause: hold the gain where it is.
+    return;
+  }
+  if (power_ < kMinPower) {
+    return;
+  }
+  const double level_db = 10.0 * std::log10(power_) + level_offset_db_;
+  target_gain_ = DbToGain(
+      std::max(min_gain_db_, std::min(max_gain_db_, target_db_ - level_db)));
+}
+
+float AutomaticGainControl::LimiterGain(float required) {
+  // Drop the minimum that leaves the window, then those the new value
+  // undercuts; the front is the minimum of the window.
+  const uint64_t index = index_++;
+  if (minima_size_ > 0 && minima_[minima_head_] + window_ <= index) {
+    minima_head_ = minima_head_ + 1 == window_ ? 0 : minima_head_ + 1;
+    --minima_size_;
+  }
+  const size_t slot = static_cast<size_t>(index % window_);
+  required_[slot] = required;
+  while (minima_size_ > 0) {
+    const size_t back = (minima_head_ + minima_size_ - 1) % window_;
+    if (required_[static_cast<size_t>(minima_[back] % window_)] <
+        required) {
+      break;
+    }
+    --minima_size_;
+  }
+  minima_[(minima_head_ + minima_size_) % window_] = index;
+  ++minima_size_;
+  const float minimum =
+      required_[static_cast<size_t>(minima_[minima_head_] % window_)];
+
+  // Every minimum averaged for the sample leaving now covers it, so the
+  // average never exceeds the gain it needs.
+  mins_sum_ += minimum - mins_[slot];
+  mins_[slot] = minimum;
+  const float average = std::min(
+      1.0f, static_cast<float>(mins_sum_ / static_cast<double>(window_)));
+  if (average < limiter_gain_) {
+    limiter_gain_ = average;
+  } else {
+    limiter_gain_ +=
+        limiter_release_coefficient_ * (average - limiter_gain_);
+  }
+  return limiter_gain_;
+}
+
+double AutomaticGainControl::gain_db() const {
+  return 20.0 * std::log10(static_cast<double>(gain_));
+}
+
+double AutomaticGainControl::limiter_gain_db() const {
+  return 20.0 * std::log10(std::max(static_cast<double>(limiter_gain_),
+                                    kMinPower));
+}
+
+void AutomaticGainControl::Reset() {
+  std::fill(filter_state_, filter_state_ + 4, 0.0);
+  power_ = 0.0;
+  fast_power_ = 0.0;
+  until_control_ = control_period_;
+  std::fill(delay_.begin(), delay_.end(), 0.0f);
+  delay_next_ = 0;
+  std::fill(required_.begin(), required_.end(), 1.0f);
+  minima_head_ = 0;
+  minima_size_ = 0;
+  std::fill(mins_.begin(), mins_.end(), 1.0f);
+  mins_sum_ = static_cast<double>(window_);
+  index_ = 0;
+  limiter_gain_ = 1.0f;
+}
+
+}  // namespace audio_capture
@@ -0,0 +1,116 @@
+#ifndef FLUTTER_PLUGIN_GAIN_CONTROL_H_
+#define FLUTTER_PLUGIN_GAIN_CONTROL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "biquad.h"
+
+namespace audio_capture {
+
+// What the gain control measures the input level with.
+enum class AgcDetector {
+  kRms,       // Plain RMS, in dBFS.
+  kLoudness,  // K-weighted as BS.1770, in LUFS.
+};
+
+struct AgcOptions {
+  AgcDetector detector = AgcDetector::kRms;
+  double target_db = -20.0;  // Level the gain steers towards.
+  int window_ms = 400;       // Integration time of the detector.
+  // Time constants of the gain while it falls and rises.
+  int attack_ms = 150;
+  int release_ms = 2000;
+  double min_gain_db = -20.0;
+  double max_gain_db = 30.0;
+  // Input quieter than this over the last 20 ms is left out of the level
+  // and holds the gain, so pauses are not boosted into noise.
+  double gate_db = -60.0;
+  // The limiter sees peaks this far ahead, and delays the audio as much.
+  int lookahead_ms = 5;
+  double ceiling_db = -1.0;  // Highest peak the limiter lets through.
+  int limiter_release_ms = 60;
+};
+
+// Automatic gain control for a mono 16-bit stream: a feed-forward gain that
+// follows the input level towards a target, followed by a look-ahead peak
+// limiter, so quiet and loud talkers come out alike and nothing clips.
+//
+// The detector integrates the squared (optionally K-weighted) input over
+// a one-pole window, skipping gated pauses, and the gain moves towards
+// target minus level with the attack or release time constant. The limiter
+// finds the gain each sample needs to stay under the ceiling, takes the
+// minimum over the look-ahead window and averages that over the same
+// window, which ramps the gain down in time for every peak; it then
+// recovers with its own release. Every step costs O(1) per sample; the
+// level is converted to decibels once per control period of a millisecond.
+//
+// Not thread-safe; use one instance per stream.
+class AutomaticGainControl {
+ public:
+  AutomaticGainControl(int sample_rate,
+                       const AgcOptions& options = AgcOptions());
+
+  // Samples the output lags the input by: the look-ahead.
+  size_t latency() const { return delay_.size(); }
+
+  // Applies the gain and limiter to |count| samples in place. The output is
+  // delayed by latency() samples, the first of them silent.
+  void Process(int16_t* samples, size_t count);
+
+  // Current gain of the gain control, and of the limiter (0 or below).
+  double gain_db() const;
+  double limiter_gain_db() const;
+
+  // Forgets the audio in flight and the level; the gain stays where it is.
+  void Reset();
+
+ private:
+  void UpdateTarget();
+  // Gain the limiter needs for the sample |window_| samples back.
+  float LimiterGain(float required);
+
+  AgcDetector detector_;
+  Biquad shelf_;
+  Biquad highpass_;
+  double filter_state_[4];
+  double power_;  // Over the window, while not gated.
+  double power_coefficient_;
+  double level_offset_db_;
+  double fast_power_;  // Over the gate's 20 ms.
+  double fast_coefficient_;
+  double gate_power_;
+  size_t control_period_;
+  size_t until_control_;
+
+  double target_db_;
+  double min_gain_db_;
+  double max_gain_db_;
+  float attack_coefficient_;
+  float release_coefficient_;
+  float gain_;         // Linear, as applied.
+  float target_gain_;  // Linear, what |gain_| moves towards.
+
+  // The look-ahead: the gained samples still to leave, and the gain each
+  // needs, as a ring of |window_| = latency() + 1 entries. The minima over
+  // the window are kept as a monotonic queue of indices, and their running
+  // sum over the window gives the average.
+  size_t window_;
+  float ceiling_;
+  float limiter_release_coefficient_;
+  std::vector<float> delay_;
+  size_t delay_next_;
+  std::vector<float> required_;
+  std::vector<uint64_t> minima_;  // Indices into |required_|, by age.
+  size_t minima_head_;
+  size_t minima_size_;
+  std::vector<float> mins_;  // Window minimum at each of the last |window_|.
+  double mins_sum_;
+  uint64_t index_;
+  float limiter_gain_;
+};
+
+}  // namespace audio_capture
+
+#endif  // FLUTTER_PLUGIN_GAIN_CONTROL_H_
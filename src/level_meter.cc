@@ -0,0 +1,187 @@
+#include "level_meter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace audio_capture {
+
+namespace {
+
+constexpr double kFullScale = 32767.0;
+
+double ToDb(double amplitude) {
+  if (amplitude <= 0.0) {
+    return kMinLevelDb;
+  }
+  return std::max(kMinLevelDb,
+                  std::min(0.0, 20.0 * std::log10(amplitude / kFullScale)));
+}
+
+double LevelOf(double sum_of_squares, size_t sample_count) {
+  if (sample_count == 0 || sum_of_squares <= 0.0) {
+    return kMinLevelDb;
+  }
+  return ToDb(std::sqrt(sum_of_squares / sample_count));
+}
+
+// The mono sample a capture path would emit for |frame|, clamped to the
+// S16 range. It is not rounded to an integer, which moves a level by far
+// less than a meter can show.
+inline float MonoSample(const int16_t* frame, int channels, float gain) {
+  const float mono =
+      channels == 1 ? frame[0] * gain
+                    : (static_cast<float>(frame[0]) + frame[1]) / 2.0f * gain;
+  return std::max(-32768.0f, std::min(32767.0f, mono));
+}
+
+// Adds the squared mono samples of |count| frames to |sum| and raises
+// |peak| to their largest magnitude. Kept in independent float lanes, which
+// the compiler can vectorize, and added up in double; a block is short
+// enough for float to hold its sum.
+template <int kChannels>
+void Accumulate(const int16_t* frames, size_t count, float gain, double* sum,
+                float* peak) {
+  constexpr size_t kLanes = 8;
+  float lanes[kLanes] = {};
+  float peaks[kLanes] = {};
+  size_t i = 0;
+  for (; i + kLanes <= count; i += kLanes) {
+    for (size_t lane = 0; lane < kLanes; ++lane) {
+      const float sample =
+          MonoSample(frames + (i + lane) * kChannels, kChannels, gain);
+      lanes[lane] += sample * sample;
+      peaks[lane] = std::max(peaks[lane], std::fabs(sample));
+    }
+  }
+  for (; i < count; ++i) {
+    const float sample = MonoSample(frames + i * kChannels, kChannels, gain);
+    *sum += static_cast<double>(sample) * sample;
+    *peak = std::max(*peak, std::fabs(sample));
+  }
+  for (size_t lane = 0; lane < kLanes; ++lane) {
+    *sum += lanes[lane];
+    *peak = std::max(*peak, peaks[lane]);
+  }
+}
+
+// Per-block coefficient of a one-pole follower with time constant
+// |time_ms|; 0 follows at once.
+double FollowerCoefficient(int time_ms, double block_ms) {
+  return time_ms > 0 ? std::exp(-block_ms / time_ms) : 0.0;
+}
+
+}  // namespace
+
+LevelMeter::LevelMeter(int sample_rate, size_t block_frames, int channels,
+                       float gain, const MeterOptions& options)
+    : block_frames_(std::max<size_t>(block_frames, 1)),
+      channels_(channels),
+      gain_(gain),
+      window_next_(0),
+      window_filled_(0),
+      window_sum_(0.0),
+      sum_of_squares_(0.0),
+      peak_(0.0f),
+      frames_(0),
+      peak_envelope_(0.0),
+      peak_hold_(0.0),
+      hold_remaining_(0) {
+  const double block_ms = block_frames_ * 1000.0 / sample_rate;
+  attack_ = FollowerCoefficient(options.attack_ms, block_ms);
+  release_ = FollowerCoefficient(options.release_ms, block_ms);
+  hold_blocks_ = static_cast<size_t>(std::lround(options.hold_ms / block_ms));
+  window_.resize(std::max<size_t>(
+      1, static_cast<size_t>(std::lround(options.window_ms / block_ms))));
+}
+
+size_t LevelMeter::Process(const int16_t* frames, size_t frame_count,
+                           MeterReading* readings, size_t max_readings) {
+  size_t written = 0;
+  size_t offset = 0;
+  while (offset < frame_count) {
+    const size_t take =
+        std::min(frame_count - offset, block_frames_ - frames_);
+    const int16_t* block = frames + offset * channels_;
+    if (channels_ == 1) {
+      Accumulate<1>(block, take, gain_, &sum_of_squares_, &peak_);
+    } else {
+      Accumulate<2>(block, take, gain_, &sum_of_squares_, &peak_);
+    }
+    frames_ += take;
+    offset += take;
+
+    if (frames_ == block_frames_) {
+      const MeterReading reading = FinishBlock();
+      if (written < max_readings) {
+        readings[written++] = reading;
+      }
+    }
+  }
+  return written;
+}
+
+MeterReading LevelMeter::FinishBlock() {
+  window_sum_ += sum_of_squares_ - window_[window_next_];
+  window_[window_next_] = sum_of_squares_;
+  window_next_ = (window_next_ + 1) % window_.size();
+  window_filled_ = std::min(window_filled_ + 1, window_.size());
+  if (window_next_ == 0) {
+    // Rebuilt once per pass, so rounding from adding and removing blocks
+    // cannot pile up.
+    window_sum_ = 0.0;
+    for (double block_sum : window_) {
+      window_sum_ += block_sum;
+    }
+  }
+
+  const double peak = peak_;
+  const double coefficient = peak > peak_envelope_ ? attack_ : release_;
+  peak_envelope_ = peak + coefficient * (peak_envelope_ - peak);
+
+  if (peak_envelope_ >= peak_hold_) {
+    peak_hold_ = peak_envelope_;
+    hold_remaining_ = hold_blocks_;
+  } else if (hold_remaining_ > 0) {
+    --hold_remaining_;
+  } else {
+    peak_hold_ = peak_envelope_;
+  }
+
+  MeterReading reading;
+  reading.rms = LevelOf(window_sum_, window_filled_ * block_frames_);
+  reading.peak = ToDb(peak_envelope_);
+  reading.peak_hold = ToDb(peak_hold_);
+
+  sum_of_squares_ = 0.0;
+  peak_ = 0.0f;
+  frames_ = 0;
+  return reading;
+}
+
+size_t LevelMeter::MaxLevels(size_t frame_count) const {
+  return (frames_ + frame_count) / block_frames_;
+}
+
+void LevelMeter::Reset() {
+  std::fill(window_.begin(), window_.end(), 0.0);
+  window_next_ = 0;
+  window_filled_ = 0;
+  window_sum_ = 0.0;
+  sum_of_squares_ = 0.0;
+  peak_ = 0.0f;
+  frames_ = 0;
+  peak_envelope_ = 0.0;
+  peak_hold_ = 0.0;
+  hold_remaining_ = 0;
+}
+
+double MeasureLevel(const int16_t* samples, size_t sample_count) {
+  double sum_of_squares = 0.0;
+  for (size_t i = 0; i < sample_count; ++i) {
+    const double value = samples[i];
+    sum_of_squares += value * value;
+  }
+  return LevelOf(sum_of_squares, sample_count);
+}
+
+}  // namespace audio_capture
@@ -0,0 +1,103 @@
+#ifndef FLUTTER_PLUGIN_LEVEL_METER_H_
+#define FLUTTER_PLUGIN_LEVEL_METER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace audio_capture {
+
+// Lowest level a meter reports, for silence.
+constexpr double kMinLevelDb = -120.0;
+
+// Integration and ballistics of a LevelMeter. Times are rounded to whole
+// blocks; 0 disables the feature.
+struct MeterOptions {
+  // RMS integration time. 0 measures each block on its own; 300 gives
+  // VU-like averaging.
+  int window_ms = 0;
+  // Time constants of the peak follower while the peak rises and falls. A
+  // PPM rises in a few milliseconds and falls over about 1.5 s.
+  int attack_ms = 0;
+  int release_ms = 0;
+  // How long the highest peak is held before it follows the peak down.
+  int hold_ms = 0;
+};
+
+// One reading of a LevelMeter, in dBFS from kMinLevelDb to 0.
+struct MeterReading {
+  double rms;        // Over the integration window ending with the block.
+  double peak;       // Highest sample, through the attack and release.
+  double peak_hold;  // Highest recent |peak|, held for the hold time.
+};
+
+// Level meter over fixed blocks of a stream. Samples are folded into running
+// sums as they arrive, so a block may span any number of Process calls and
+// no samples are buffered. Interleaved frames are downmixed and scaled the
+// way the capture paths prepare mono output, so the levels agree with those
+// measured on processed chunks.
+//
+// Not thread-safe; use one instance per stream.
+class LevelMeter {
+ public:
+  // Reports one reading per |block_frames| frames of |channels| channels at
+  // |sample_rate|, after scaling by |gain| and clamping to the S16 range.
+  LevelMeter(int sample_rate, size_t block_frames, int channels,
+             float gain = 1.0f, const MeterOptions& options = MeterOptions());
+
+  // Adds |frame_count| frames and writes the reading of every block they
+  // complete to |readings|, up to |max_readings|; blocks past that are
+  // measured but not reported. Returns the number of readings written. The
+  // first one ends |frames_to_next_level()| frames into |frames|, as read
+  // before the call, and each following one |block_frames| later.
+  size_t Process(const int16_t* frames, size_t frame_count,
+                 MeterReading* readings, size_t max_readings);
+
+  // Upper bound of the readings one Process call of |frame_count| frames
+  // writes.
+  size_t MaxLevels(size_t frame_count) const;
+
+  // Frames still missing from the current block.
+  size_t frames_to_next_level() const { return block_frames_ - frames_; }
+
+  size_t block_frames() const { return block_frames_; }
+
+  // Drops the partial block, the integration window and the ballistics, as
+  // if the stream started anew.
+  void Reset();
+
+ private:
+  MeterReading FinishBlock();
+
+  size_t block_frames_;
+  int channels_;
+  float gain_;
+
+  // Per-block coefficients of the peak follower and the hold time, in
+  // blocks.
+  double attack_;
+  double release_;
+  size_t hold_blocks_;
+
+  // Sums of squares of the last blocks, oldest first from |window_next_|,
+  // and their total.
+  std::vector<double> window_;
+  size_t window_next_;
+  size_t window_filled_;
+  double window_sum_;
+
+  double sum_of_squares_;  // Of the current block so far.
+  float peak_;             // Of the current block so far.
+  size_t frames_;          // In the current block so far.
+
+  double peak_envelope_;   // Linear, after the ballistics.
+  double peak_hold_;       // Linear.
+  size_t hold_remaining_;  // Blocks until |peak_hold_| falls.
+};
+
+// RMS level of |sample_count| mono samples in dBFS, from kMinLevelDb to 0.
+double MeasureLevel(const int16_t* samples, size_t sample_count);
+
+}  // namespace audio_capture
+
+#endif  // FLUTTER_PLUGIN_LEVEL_METER_H_
@@ -0,0 +1,265 @@
+#include "loudness_meter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace audio_capture {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// BS.1770 loudness of a K-weighted mean square: -0.691 dB offsets the
+// K-weighting's gain at 1 kHz.
+constexpr double kLoudnessOffset = -0.691;
+constexpr double kAbsoluteGate = -70.0;
+constexpr double kIntegratedRelativeGate = -10.0;
+constexpr double kRangeRelativeGate = -20.0;
+
+constexpr int kStepsPerSecond = 10;  // 100 ms steps.
+constexpr size_t kMomentarySteps = 4;
+constexpr size_t kShortTermSteps = 30;
+
+constexpr double kBinsPerLu = 10.0;
+constexpr size_t kHistogramBins = 800;  // -70 to +10 LUFS.
+
+constexpr size_t kTruePeakTaps = 12;
+
+double LoudnessOf(double power) {
+  if (power <= 0.0) {
+    return kMinLevelDb;
+  }
+  return std::max(kMinLevelDb, kLoudnessOffset + 10.0 * std::log10(power));
+}
+
+size_t BinOf(double loudness) {
+  const double bin = std::floor((loudness - kAbsoluteGate) * kBinsPerLu);
+  return static_cast<size_t>(
+      std::max(0.0, std::min(bin, static_cast<double>(kHistogramBins - 1))));
+}
+
+double LoudnessOfBin(size_t bin) {
+  return kAbsoluteGate + (static_cast<double>(bin) + 0.5) / kBinsPerLu;
+}
+
+}  // namespace
+
+void LoudnessMeter::Histogram::Add(double power) {
+  const double loudness = LoudnessOf(power);
+  if (loudness <= kAbsoluteGate) {
+    return;
+  }
+  const size_t bin = BinOf(loudness);
+  counts[bin]++;
+  powers[bin] += power;
+}
+
+LoudnessMeter::LoudnessMeter(int sample_rate, int channels, float gain)
+    : channels_(channels),
+      gain_(gain),
+      filter_state_(static_cast<size_t>(channels) * 4, 0.0),
+      step_frames_(std::max(1, sample_rate / kStepsPerSecond)),
+      steps_(kShortTermSteps, 0.0),
+      step_next_(0),
+      steps_filled_(0),
+      step_sum_(0.0),
+      frames_(0),
+      momentary_(0.0),
+      short_term_(0.0),
+      history_next_(0),
+      true_peak_(0.0f) {
+  DesignKWeighting(sample_rate, &shelf_, &highpass_);
+
+  momentary_blocks_.counts.assign(kHistogramBins, 0);
+  momentary_blocks_.powers.assign(kHistogramBins, 0.0);
+  short_term_blocks_.counts.assign(kHistogramBins, 0);
+  short_term_blocks_.powers.assign(kHistogramBins, 0.0);
+
+  // Blackman-windowed sinc interpolator cutting off at the input's Nyquist
+  // frequency. Each phase is normalized to unity gain at DC.
+  oversampling_ = sample_rate < 96000 ? 4 : sample_rate < 192000 ? 2 : 1;
+  if (oversampling_ > 1) {
+    const size_t length = kTruePeakTaps * oversampling_;
+    const double last = static_cast<double>(length - 1);
+    const double center = last / 2.0;
+    std::vector<double> prototype(length);
+    for (size_t i = 0; i < length; ++i) {
+      const double x = (static_cast<double>(i) - center) / oversampling_;
+      const double sinc = x == 0.0 ? 1.0 : std::sin(kPi * x) / (kPi * x);
+      const double phase = 2.0 * kPi * static_cast<double>(i) / last;
+      const double window =
+          0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase);
+      prototype[i] = sinc * window;
+    }
+    phases_.resize(length);
+    for (int p = 0; p < oversampling_; ++p) {
+      double sum = 0.0;
+      for (size_t k = 0; k < kTruePeakTaps; ++k) {
+        sum += prototype[k * oversampling_ + p];
+      }
+      for (size_t k = 0; k < kTruePeakTaps; ++k) {
+        // Output phase p at input n is sum_k h[k * L + p] * x[n - k]; the
+        // window runs oldest first, so the taps are stored reversed.
+        phases_[p * kTruePeakTaps + (kTruePeakTaps - 1 - k)] =
+            static_cast<float>(prototype[k * oversampling_ + p] / sum);
+      }
+    }
+    history_.assign(static_cast<size_t>(channels) * kTruePeakTaps * 2, 0.0f);
+  }
+}
+
+float LoudnessMeter::TruePeakOf(int channel, float sample) {
+  float peak = std::fabs(sample);
+  if (oversampling_ == 1) {
+    return peak;
+  }
+  float* history = history_.data() + channel * kTruePeakTaps * 2;
+  history[history_next_] = sample;
+  history[history_next_ + kTruePeakTaps] = sample;
+  const float* window = history + history_next_ + 1;
+  for (int p = 0; p < oversampling_; ++p) {
+    const float* taps = phases_.data() + p * kTruePeakTaps;
+    float value = 0.0f;
+    for (size_t k = 0; k < kTruePeakTaps; ++k) {
+      value += taps[k] * window[k];
+    }
+    peak = std::max(peak, std::fabs(value));
+  }
+  return peak;
+}
+
+void LoudnessMeter::Process(const int16_t* frames, size_t frame_count) {
+  for (size_t i = 0; i < frame_count; ++i) {
+    const int16_t* frame = frames + i * channels_;
+    for (int c = 0; c < channels_; ++c) {
+      const float sample =
+          std::max(-32768.0f, std::min(32767.0f, frame[c] * gain_)) /
+          32768.0f;
+      double* state = filter_state_.data() + c * 4;
+      const double weighted =
+          FilterBiquad(FilterBiquad(sample, shelf_, state), highpass_,
+                       state + 2);
+      step_sum_ += weighted * weighted;
+      true_peak_ = std::max(true_peak_, TruePeakOf(c, sample));
+    }
+    if (oversampling_ > 1) {
+      history_next_ = (history_next_ + 1) % kTruePeakTaps;
+    }
+    if (++frames_ == step_frames_) {
+      FinishStep();
+    }
+  }
+}
+
+void LoudnessMeter::FinishStep() {
+  steps_[step_next_] = step_sum_;
+  step_next_ = (step_next_ + 1) % steps_.size();
+  steps_filled_ = std::min(steps_filled_ + 1, steps_.size());
+  step_sum_ = 0.0;
+  frames_ = 0;
+
+  // Sums over the last steps; a fixed 34 additions per 100 ms, and no
+  // rounding carried from one step to the next.
+  double momentary = 0.0;
+  double short_term = 0.0;
+  for (size_t i = 0; i < steps_filled_; ++i) {
+    const double step = steps_[(step_next_ + steps_.size() - 1 - i) %
+                               steps_.size()];
+    short_term += step;
+    if (i < kMomentarySteps) {
+      momentary += step;
+    }
+  }
+  momentary_ = momentary / static_cast<double>(
+                               std::min(steps_filled_, kMomentarySteps) *
+                               step_frames_);
+  short_term_ =
+      short_term / static_cast<double>(steps_filled_ * step_frames_);
+
+  // Gating blocks overlap by 75% (400 ms) and by 2.9 s (3 s), and start once
+  // a whole block has been measured.
+  if (steps_filled_ >= kMomentarySteps) {
+    momentary_blocks_.Add(momentary_);
+  }
+  if (steps_filled_ >= kShortTermSteps) {
+    short_term_blocks_.Add(short_term_);
+  }
+}
+
+LoudnessReading LoudnessMeter::Reading() const {
+  LoudnessReading reading;
+  reading.momentary = LoudnessOf(momentary_);
+  reading.short_term = LoudnessOf(short_term_);
+  reading.true_peak =
+      true_peak_ > 0.0f ? std::max(kMinLevelDb, 20.0 * std::log10(true_peak_))
+                        : kMinLevelDb;
+
+  // Integrated: the mean power of the blocks above the absolute gate sets
+  // a relative gate 10 LU below it; the blocks above both are averaged.
+  {
+    const Histogram& blocks = momentary_blocks_;
+    uint64_t count = 0;
+    double power = 0.0;
+    for (size_t i = 0; i < kHistogramBins; ++i) {
+      count += blocks.counts[i];
+      power += blocks.powers[i];
+    }
+    reading.integrated = kMinLevelDb;
+    if (count > 0) {
+      const size_t gate =
+          BinOf(LoudnessOf(power / static_cast<double>(count)) +
+                kIntegratedRelativeGate);
+      count = 0;
+      power = 0.0;
+      for (size_t i = gate; i < kHistogramBins; ++i) {
+        count += blocks.counts[i];
+        power += blocks.powers[i];
+      }
+      if (count > 0) {
+        reading.integrated = LoudnessOf(power / static_cast<double>(count));
+      }
+    }
+  }
+
+  // Range: the spread from the 10th to the 95th percentile of the 3 s
+  // blocks above a relative gate 20 LU below their mean power.
+  {
+    const Histogram& blocks = short_term_blocks_;
+    uint64_t count = 0;
+    double power = 0.0;
+    for (size_t i = 0; i < kHistogramBins; ++i) {
+      count += blocks.counts[i];
+      power += blocks.powers[i];
+    }
+    reading.range = 0.0;
+    if (count > 0) {
+      const size_t gate =
+          BinOf(LoudnessOf(power / static_cast<double>(count)) +
+                kRangeRelativeGate);
+      uint64_t gated = 0;
+      for (size_t i = gate; i < kHistogramBins; ++i) {
+        gated += blocks.counts[i];
+      }
+      const uint64_t low_rank = gated / 10;
+      const uint64_t high_rank = (gated * 95 + 99) / 100 - 1;
+      double low = 0.0;
+      double high = 0.0;
+      uint64_t seen = 0;
+      for (size_t i = gate; i < kHistogramBins; ++i) {
+        const uint64_t next = seen + blocks.counts[i];
+        if (seen <= low_rank && low_rank < next) {
+          low = LoudnessOfBin(i);
+        }
+        if (seen <= high_rank && high_rank < next) {
+          high = LoudnessOfBin(i);
+          break;
+        }
+        seen = next;
+      }
+      reading.range = high - low;
+    }
+  }
+  return reading;
+}
+
+}  // namespace audio_capture
@@ -0,0 +1,156 @@
+#include "mel_spectrogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace audio_capture {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Filter energies are clamped to this before the log.
+constexpr float kMinEnergy = 1e-10f;
+
+double HzToMel(double hz) { return 2595.0 * std::log10(1.0 + hz / 700.0); }
+
+double MelToHz(double mel) {
+  return 700.0 * (std::pow(10.0, mel / 2595.0) - 1.0);
+}
+
+}  // namespace
+
+MelSpectrogram::MelSpectrogram(int sample_rate, const MelOptions& options)
+    : bins_(static_cast<size_t>(std::max(1, options.bins))),
+      window_(std::max<size_t>(
+          2, static_cast<size_t>(sample_rate) *
+                 static_cast<size_t>(std::max(1, options.window_ms)) / 1000)),
+      fft_(std::max<size_t>(4, NextPowerOfTwo(window_.size()))) {
+  hop_ = std::min(window_.size(),
+                  std::max<size_t>(1, static_cast<size_t>(sample_rate) *
+                                          static_cast<size_t>(std::max(
+                                              1, options.hop_ms)) /
+                                          1000));
+
+  // Periodic Hann window.
+  for (size_t i = 0; i < window_.size(); ++i) {
+    window_[i] = static_cast<float>(
+        0.5 - 0.5 * std::cos(2.0 * kPi * static_cast<double>(i) /
+                             static_cast<double>(window_.size())));
+  }
+
+  // Triangles between mel points evenly spaced from |low_hz| to |high_hz|,
+  // each peaking at 1 where the next one starts.
+  const double nyquist = sample_rate / 2.0;
+  const double high_hz =
+      options.high_hz > 0.0 ? std::min(options.high_hz, nyquist) : nyquist;
+  const double low_hz = std::max(0.0, std::min(options.low_hz, high_hz));
+  const double low_mel = HzToMel(low_hz);
+  const double mel_step =
+      (HzToMel(high_hz) - low_mel) / static_cast<double>(bins_ + 1);
+  const double bin_hz =
+      static_cast<double>(sample_rate) / static_cast<double>(fft_.size());
+  filter_start_.resize(bins_);
+  filter_length_.resize(bins_);
+  filter_offset_.resize(bins_);
+  for (size_t m = 0; m < bins_; ++m) {
+    const double left = low_mel + static_cast<double>(m) * mel_step;
+    const double center = left + mel_step;
+    const double right = center + mel_step;
+    filter_start_[m] = fft_.bins();
+    filter_length_[m] = 0;
+    filter_offset_[m] = weights_.size();
+    for (size_t k = 0; k < fft_.bins(); ++k) {
+      const double mel = HzToMel(static_cast<double>(k) * bin_hz);
+      const double weight = mel <= center ? (mel - left) / mel_step
+                                          : (right - mel) / mel_step;
+      if (weight <= 0.0) {
+        if (filter_length_[m] > 0) {
+          break;
+        }
+        continue;
+      }
+      if (filter_length_[m] == 0) {
+        filter_start_[m] = k;
+      }
+      weights_.push_back(static_cast<float>(weight));
+      ++filter_length_[m];
+    }
+    if (filter_length_[m] == 0) {
+      // Narrower than a bin: take the bin nearest its center.
+      filter_start_[m] = std::min(
+          fft_.bins() - 1,
+          static_cast<size_t>(std::lround(MelToHz(center) / bin_hz)));
+      filter_length_[m] = 1;
+      weights_.push_back(1.0f);
+    }
+  }
+
+  buffer_.resize(window_.size());
+  frame_.assign(fft_.size(), 0.0f);
+  power_.resize(fft_.bins());
+  Reset();
+}
+
+size_t MelSpectrogram::Process(const int16_t* samples, size_t count,
+                               float* frames, size_t max_frames) {
+  const size_t window = window_.size();
+  size_t written = 0;
+  while (count > 0) {
+    const size_t take = std::min(count, window - fill_);
+    float* buffer = buffer_.data() + fill_;
+    for (size_t i = 0; i < take; ++i) {
+      buffer[i] = static_cast<float>(samples[i]) * (1.0f / 32768.0f);
+    }
+    fill_ += take;
+    samples += take;
+    count -= take;
+    if (fill_ < window) {
+      break;
+    }
+
+    if (written < max_frames) {
+      ComputeFrame(frames + written * bins_);
+      ++written;
+    }
+    ++frame_count_;
+    // The next window starts a hop later.
+    std::memmove(buffer_.data(), buffer_.data() + hop_,
+                 (window - hop_) * sizeof(float));
+    fill_ = window - hop_;
+  }
+  return written;
+}
+
+void MelSpectrogram::ComputeFrame(float* out) {
+  // Past the window the frame stays zero.
+  for (size_t i = 0; i < window_.size(); ++i) {
+    frame_[i] = buffer_[i] * window_[i];
+  }
+  fft_.PowerSpectrum(frame_.data(), power_.data());
+  for (size_t m = 0; m < bins_; ++m) {
+    const float* power = power_.data() + filter_start_[m];
+    const float* weights = weights_.data() + filter_offset_[m];
+    float energy = 0.0f;
+    for (size_t k = 0; k < filter_length_[m]; ++k) {
+      energy += weights[k] * power[k];
+    }
+    out[m] = std::log(std::max(energy, kMinEnergy));
+  }
+}
+
+size_t MelSpectrogram::MaxFrames(size_t count) const {
+  const size_t total = fill_ + count;
+  if (total < window_.size()) {
+    return 0;
+  }
+  return (total - window_.size()) / hop_ + 1;
+}
+
+void MelSpectrogram::Reset() {
+  fill_ = 0;
+  frame_count_ = 0;
+}
+
+}  // namespace audio_capture
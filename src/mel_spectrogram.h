@@ -0,0 +1,78 @@
+#ifndef FLUTTER_PLUGIN_MEL_SPECTROGRAM_H_
+#define FLUTTER_PLUGIN_MEL_SPECTROGRAM_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "fft.h"
+
+namespace audio_capture {
+
+struct MelOptions {
+  int bins = 80;
+  int window_ms = 25;
+  int hop_ms = 10;  // At most |window_ms|.
+  double low_hz = 20.0;
+  double high_hz = 0.0;  // 0 for half the sample rate.
+};
+
+// Log-mel spectrogram of a mono 16-bit stream, as speech recognition front
+// ends take it: Hann-windowed frames every hop, zero-padded to a power of
+// two, their power spectrum weighted by triangular filters evenly spaced on
+// the HTK mel scale, and the natural log of each filter's energy. Samples
+// are scaled to [-1, 1) first.
+//
+// The filterbank and window are tabulated at construction. Frame n covers
+// the samples from n * hop_samples() since construction or Reset().
+//
+// Not thread-safe; use one instance per stream.
+class MelSpectrogram {
+ public:
+  MelSpectrogram(int sample_rate, const MelOptions& options = MelOptions());
+
+  size_t bins() const { return bins_; }
+  size_t window_samples() const { return window_.size(); }
+  size_t hop_samples() const { return hop_; }
+
+  // Adds |count| samples and writes each frame they complete, bins() values
+  // per frame, to |frames|, up to |max_frames|; MaxFrames() is always
+  // enough. Returns the number written.
+  size_t Process(const int16_t* samples, size_t count, float* frames,
+                 size_t max_frames);
+
+  // Upper bound of the frames one Process call of |count| samples writes.
+  size_t MaxFrames(size_t count) const;
+
+  // Frames completed since construction or Reset(), including any not
+  // written for lack of room.
+  uint64_t frame_count() const { return frame_count_; }
+
+  // Forgets buffered samples, for a stream that does not continue the
+  // previous one.
+  void Reset();
+
+ private:
+  void ComputeFrame(float* out);
+
+  size_t bins_;
+  size_t hop_;
+  std::vector<float> window_;
+  Fft fft_;
+  // Filter m weights the power bins from |filter_start_[m]| with the
+  // |filter_length_[m]| weights at |filter_offset_[m]| in |weights_|.
+  std::vector<size_t> filter_start_;
+  std::vector<size_t> filter_length_;
+  std::vector<size_t> filter_offset_;
+  std::vector<float> weights_;
+
+  std::vector<float> buffer_;  // The current window so far.
+  size_t fill_;
+  uint64_t frame_count_;
+  std::vector<float> frame_;  // Windowed and zero-padded.
+  std::vector<float> power_;
+};
+
+}  // namespace audio_capture
+
+#endif  // FLUTTER_PLUGIN_MEL_SPECTROGRAM_H_
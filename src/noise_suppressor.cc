@@ -0,0 +1,131 @@
+#include "noise_suppressor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace audio_capture {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// Frames span at least this long.
+constexpr int kFrameMs = 10;
+constexpr size_t kMinFrameSize = 64;
+// Weight of the previous frame in the smoothed power.
+constexpr float kPowerSmoothing = 0.8f;
+// Fastest the noise estimate may rise; it falls at once.
+constexpr double kNoiseRiseDbPerSecond = 5.0;
+// The minimum of a smoothed periodogram sits below its mean by about this
+// factor.
+constexpr float kNoiseBias = 2.0f;
+// Weight of the previous frame in the decision-directed a priori SNR.
+constexpr float kPriorSmoothing = 0.98f;
+constexpr double kMaxSuppressionDb = 40.0;
+// Power of a bin below which it is taken as silent.
+constexpr float kMinPower = 1e-12f;
+
+}  // namespace
+
+NoiseSuppressor::NoiseSuppressor(int sample_rate,
+                                 const NoiseOptions& options)
+    : window_(std::max(kMinFrameSize,
+                       NextPowerOfTwo(static_cast<size_t>(
+                           std::max(1, sample_rate) * kFrameMs / 1000)))),
+      fft_(window_.size()) {
+  const size_t size = window_.size();
+  hop_ = size / 2;
+  gain_floor_ = static_cast<float>(std::pow(
+      10.0,
+      -std::max(0.0, std::min(options.suppression_db, kMaxSuppressionDb)) /
+          20.0));
+  noise_rise_ = static_cast<float>(
+      std::pow(10.0, kNoiseRiseDbPerSecond / 10.0 *
+                         static_cast<double>(hop_) /
+                         std::max(1, sample_rate)));
+
+  // Square root of the periodic Hann window: applied before and after,
+  // frames a hop apart sum to one.
+  for (size_t i = 0; i < size; ++i) {
+    window_[i] = static_cast<float>(
+        std::sin(kPi * static_cast<double>(i) / static_cast<double>(size)));
+  }
+
+  input_.resize(size);
+  overlap_.resize(size);
+  ready_.resize(hop_);
+  frame_.resize(size);
+  real_.resize(fft_.bins());
+  imag_.resize(fft_.bins());
+  smoothed_.resize(fft_.bins());
+  noise_.resize(fft_.bins());
+  previous_.resize(fft_.bins());
+  learned_ = false;
+  Reset();
+}
+
+void NoiseSuppressor::Process(int16_t* samples, size_t count) {
+  float* input = input_.data() + (input_.size() - hop_);
+  for (size_t i = 0; i < count; ++i) {
+    input[fill_] = static_cast<float>(samples[i]) * (1.0f / 32768.0f);
+    const float out = ready_[fill_] * 32768.0f;
+    samples[i] =
+        static_cast<int16_t>(std::max(-32768.0f, std::min(32767.0f, out)));
+    if (++fill_ == hop_) {
+      ProcessFrame();
+      fill_ = 0;
+    }
+  }
+}
+
+void NoiseSuppressor::ProcessFrame() {
+  const size_t size = window_.size();
+  for (size_t i = 0; i < size; ++i) {
+    frame_[i] = input_[i] * window_[i];
+  }
+  fft_.Forward(frame_.data(), real_.data(), imag_.data());
+
+  for (size_t k = 0; k < real_.size(); ++k) {
+    const float power = real_[k] * real_[k] + imag_[k] * imag_[k];
+    if (!learned_) {
+      smoothed_[k] = power;
+      noise_[k] = power;
+    } else {
+      smoothed_[k] =
+          kPowerSmoothing * smoothed_[k] + (1.0f - kPowerSmoothing) * power;
+      noise_[k] = std::min(smoothed_[k], noise_[k] * noise_rise_);
+    }
+    const float noise = std::max(kMinPower, kNoiseBias * noise_[k]);
+    const float posterior = power / noise;
+    const float prior =
+        kPriorSmoothing * previous_[k] +
+        (1.0f - kPriorSmoothing) * std::max(0.0f, posterior - 1.0f);
+    const float gain = std::max(gain_floor_, prior / (1.0f + prior));
+    previous_[k] = gain * gain * posterior;
+    real_[k] *= gain;
+    imag_[k] *= gain;
+  }
+  learned_ = true;
+
+  fft_.Inverse(real_.data(), imag_.data(), frame_.data());
+  for (size_t i = 0; i < size; ++i) {
+    overlap_[i] += frame_[i] * window_[i];
+  }
+  std::copy(overlap_.begin(), overlap_.begin() + hop_, ready_.begin());
+  std::memmove(overlap_.data(), overlap_.data() + hop_,
+               (size - hop_) * sizeof(float));
+  std::fill(overlap_.begin() + (size - hop_), overlap_.end(), 0.0f);
+  std::memmove(input_.data(), input_.data() + hop_,
+               (size - hop_) * sizeof(float));
+}
+
+void NoiseSuppressor::Reset() {
+  std::fill(input_.begin(), input_.end(), 0.0f);
+  std::fill(overlap_.begin(), overlap_.end(), 0.0f);
+  std::fill(ready_.begin(), ready_.end(), 0.0f);
+  fill_ = 0;
+  std::fill(previous_.begin(), previous_.end(), 0.0f);
+}
+
+}  // namespace audio_capture
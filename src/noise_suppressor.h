@@ -0,0 +1,74 @@
+#ifndef FLUTTER_PLUGIN_NOISE_SUPPRESSOR_H_
+#define FLUTTER_PLUGIN_NOISE_SUPPRESSOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "fft.h"
+
+namespace audio_capture {
+
+struct NoiseOptions {
+  // Most the noise is attenuated by, in dB. Higher removes more noise at
+  // the cost of more artifacts on speech.
+  double suppression_db = 12.0;
+};
+
+// Single-channel noise suppression for a mono 16-bit stream: a Wiener
+// filter on a short-time spectrum, with the noise spectrum tracked from the
+// audio itself.
+//
+// Frames of about 10 ms, rounded up to a power of two, overlap by half
+// under a square-root Hann window, so unit gains reconstruct the input.
+// Each bin's noise power follows the minimum of its smoothed power, rising
+// by at most a few dB a second, so steady noise such as fans and hum is
+// learned within a pause while speech is not. The gain of each bin comes
+// from its a priori SNR, estimated decision-directed as Ephraim and Malah
+// describe to keep musical noise down, and never falls below the
+// suppression floor. Each frame costs two FFTs and O(bins).
+//
+// Not thread-safe; use one instance per stream.
+class NoiseSuppressor {
+ public:
+  NoiseSuppressor(int sample_rate,
+                  const NoiseOptions& options = NoiseOptions());
+
+  // Samples the output lags the input by: one frame.
+  size_t latency() const { return window_.size(); }
+
+  // Suppresses noise in |count| samples in place. The output is delayed by
+  // latency() samples, the first of them silent.
+  void Process(int16_t* samples, size_t count);
+
+  // Forgets the audio in flight; the noise estimate stays, as the noise
+  // rarely changes with a gap in the stream.
+  void Reset();
+
+ private:
+  // Filters the frame in |input_| and overlap-adds it into |overlap_|.
+  void ProcessFrame();
+
+  size_t hop_;
+  float gain_floor_;
+  float noise_rise_;  // Most the noise estimate grows by per frame.
+  std::vector<float> window_;
+  Fft fft_;
+  std::vector<float> input_;    // The frame being filled, oldest first.
+  std::vector<float> overlap_;  // Output still being overlap-added.
+  std::vector<float> ready_;    // Finished output, one hop of it.
+  size_t fill_;                 // New samples in |input_|.
+  std::vector<float> frame_;
+  std::vector<float> real_;
+  std::vector<float> imag_;
+
+  // Per bin.
+  bool learned_;  // Whether the noise estimate has been set.
+  std::vector<float> smoothed_;
+  std::vector<float> noise_;
+  std::vector<float> previous_;  // Last gain squared times a posteriori SNR.
+};
+
+}  // namespace audio_capture
+
+#endif  // FLUTTER_PLUGIN_NOISE_SUPPRESSOR_H_
@@ -0,0 +1,280 @@
+#include "resampler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define AUDIO_CAPTURE_RESAMPLER_SSE 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define AUDIO_CAPTURE_RESAMPLER_NEON 1
+#endif
+
+namespace audio_capture {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+struct QualityPreset {
+  int zero_crossings;  // Per side of the filter, at the cutoff frequency.
+  double kaiser_beta;
+  double passband;     // Cutoff as a fraction of the lower Nyquist frequency.
+  size_t max_phases;   // Beyond this many phases rows are interpolated.
+};
+
+QualityPreset GetPreset(ResamplerQuality quality) {
+  switch (quality) {
+    case ResamplerQuality::kLow:
+      return {8, 5.0, 0.80, 256};
+    case ResamplerQuality::kHigh:
+      return {32, 9.0, 0.95, 1024};
+    case ResamplerQuality::kMedium:
+      break;
+  }
+  return {16, 7.0, 0.90, 512};
+}
+
+uint64_t GreatestCommonDivisor(uint64_t a, uint64_t b) {
+  while (b != 0) {
+    const uint64_t rest = a % b;
+    a = b;
+    b = rest;
+  }
+  return a;
+}
+
+// Zeroth-order modified Bessel function of the first kind.
+double BesselI0(double x) {
+  double sum = 1.0;
+  double term = 1.0;
+  const double half_x = x / 2.0;
+  for (int k = 1; k < 50; ++k) {
+    term *= (half_x / k) * (half_x / k);
+    sum += term;
+    if (term < sum * 1e-12) {
+      break;
+    }
+  }
+  return sum;
+}
+
+// |count| is a multiple of 4.
+float DotProduct(const float* a, const float* b, size_t count) {
+#if defined(AUDIO_CAPTURE_RESAMPLER_SSE)
+  __m128 sum = _mm_setzero_ps();
+  for (size_t i = 0; i < count; i += 4) {
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+  }
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+  return _mm_cvtss_f32(sum);
+#elif defined(AUDIO_CAPTURE_RESAMPLER_NEON)
+  float32x4_t sum = vdupq_n_f32(0.0f);
+  for (size_t i = 0; i < count; i += 4) {
+    sum = vmlaq_f32(sum, vld1q_f32(a + i), vld1q_f32(b + i));
+  }
+  float32x2_t pair = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+  return vget_lane_f32(vpadd_f32(pair, pair), 0);
+#else
+  float sums[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  for (size_t i = 0; i < count; i += 4) {
+    sums[0] += a[i] * b[i];
+    sums[1] += a[i + 1] * b[i + 1];
+    sums[2] += a[i + 2] * b[i + 2];
+    sums[3] += a[i + 3] * b[i + 3];
+  }
+  return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+#endif
+}
+
+inline float ToFloat(int16_t sample) {
+  return static_cast<float>(sample) * (1.0f / 32768.0f);
+}
+
+inline float ToFloat(float sample) { return sample; }
+
+inline void FromFloat(float value, int16_t* sample) {
+  const float scaled = std::round(value * 32768.0f);
+  *sample = static_cast<int16_t>(std::max(-32768.0f, std::min(32767.0f, scaled)));
+}
+
+inline void FromFloat(float value, float* sample) { *sample = value; }
+
+}  // namespace
+
+Resampler::Resampler(int input_rate, int output_rate, int channels,
+                     ResamplerQuality quality)
+    : input_rate_(std::max(1, input_rate)),
+      output_rate_(std::max(1, output_rate)),
+      channels_(std::max(1, channels)),
+      passthrough_(input_rate_ == output_rate_),
+      step_(1),
+      phase_count_(1),
+      taps_(0),
+      filter_phases_(1),
+      interpolate_(false),
+      history_(static_cast<size_t>(channels_)),
+      phase_(0) {
+  const uint64_t divisor = GreatestCommonDivisor(
+      static_cast<uint64_t>(input_rate_), static_cast<uint64_t>(output_rate_));
+  step_ = static_cast<uint64_t>(input_rate_) / divisor;
+  phase_count_ = static_cast<uint64_t>(output_rate_) / divisor;
+  if (!passthrough_) {
+    BuildFilter(quality);
+  }
+  Reset();
+}
+
+void Resampler::BuildFilter(ResamplerQuality quality) {
+  const QualityPreset preset = GetPreset(quality);
+
+  // Cutoff in cycles per input frame, below the lower of the two Nyquist
+  // frequencies.
+  const double scale =
+      std::min(1.0, static_cast<double>(output_rate_) / input_rate_);
+  const double cutoff = 0.5 * scale * preset.passband;
+
+  // The window spans |zero_crossings| periods of the cutoff on each side.
+  const size_t half_width = static_cast<size_t>(
+      std::ceil(preset.zero_crossings / (2.0 * cutoff)));
+  taps_ = (2 * half_width + 3) / 4 * 4;
+  const double half = static_cast<double>(taps_ / 2);
+
+  interpolate_ = phase_count_ > preset.max_phases;
+  filter_phases_ = interpolate_ ? preset.max_phases
+                                : static_cast<size_t>(phase_count_);
+  filter_.assign((filter_phases_ + 1) * taps_, 0.0f);
+
+  const double window_norm = BesselI0(preset.kaiser_beta);
+  std::vector<double> row(taps_);
+  for (size_t p = 0; p <= filter_phases_; ++p) {
+    const double fraction = static_cast<double>(p) / static_cast<double>(filter_phases_);
+    double sum = 0.0;
+    for (size_t j = 0; j < taps_; ++j) {
+      // Distance from the output position to input frame j of the window,
+      // which starts half - 1 frames before the position's integer part.
+      const double distance = fraction + (half - 1.0) - static_cast<double>(j);
+      double value = 0.0;
+      const double ratio = distance / half;
+      if (std::fabs(ratio) <= 1.0) {
+        const double x = 2.0 * cutoff * distance;
+        const double sinc =
+            std::fabs(x) < 1e-9 ? 1.0 : std::sin(kPi * x) / (kPi * x);
+        const double window =
+            BesselI0(preset.kaiser_beta * std::sqrt(1.0 - ratio * ratio)) /
+            window_norm;
+        value = sinc * window;
+      }
+      row[j] = value;
+      sum += value;
+    }
+    // Unity gain at DC for every phase, so no phase-dependent ripple.
+    for (size_t j = 0; j < taps_; ++j) {
+      filter_[p * taps_ + j] = static_cast<float>(row[j] / sum);
+    }
+  }
+}
+
+void Resampler::Reset() {
+  phase_ = 0;
+  for (std::vector<float>& channel : history_) {
+    channel.clear();
+    if (!passthrough_) {
+      // Silence before the stream, so the first output lands on input
+      // frame 0.
+      channel.assign(taps_ / 2 - 1, 0.0f);
+    }
+  }
+}
+
+size_t Resampler::MaxOutputFrames(size_t input_frames) const {
+  if (passthrough_) {
+    return input_frames;
+  }
+  // At most taps_ - 1 frames are pending from earlier calls, which yield no
+  // more than one output beyond what the new frames add.
+  return static_cast<size_t>(
+             (static_cast<uint64_t>(input_frames) * phase_count_ + step_ - 1) /
+             step_) +
+         1;
+}
+
+size_t Resampler::Process(const int16_t* input, size_t input_frames,
+                          int16_t* output, size_t output_capacity) {
+  return ProcessInterleaved(input, input_frames, output, output_capacity);
+}
+
+size_t Resampler::Process(const float* input, size_t input_frames,
+                          float* output, size_t output_capacity) {
+  return ProcessInterleaved(input, input_frames, output, output_capacity);
+}
+
+template <typename Sample>
+size_t Resampler::ProcessInterleaved(const Sample* input, size_t input_frames,
+                                     Sample* output, size_t output_capacity) {
+  const size_t channels = static_cast<size_t>(channels_);
+  if (passthrough_) {
+    const size_t frames = std::min(input_frames, output_capacity);
+    if (output != input) {
+      std::copy(input, input + frames * channels, output);
+    }
+    return frames;
+  }
+
+  // All input is taken in before any output is written, which makes
+  // converting in place safe.
+  for (size_t c = 0; c < channels; ++c) {
+    std::vector<float>& channel = history_[c];
+    const size_t offset = channel.size();
+    channel.resize(offset + input_frames);
+    for (size_t i = 0; i < input_frames; ++i) {
+      channel[offset + i] = ToFloat(input[i * channels + c]);
+    }
+  }
+
+  const size_t available = history_[0].size();
+  size_t start = 0;
+  size_t produced = 0;
+  while (produced < output_capacity && start + taps_ <= available) {
+    Sample* frame = output + produced * channels;
+    if (interpolate_) {
+      const uint64_t position = phase_ * filter_phases_;
+      const size_t row = static_cast<size_t>(position / phase_count_);
+      const float weight =
+          static_cast<float>(position % phase_count_) /
+          static_cast<float>(phase_count_);
+      const float* lower = &filter_[row * taps_];
+      const float* upper = lower + taps_;
+      for (size_t c = 0; c < channels; ++c) {
+        const float* window = history_[c].data() + start;
+        const float a = DotProduct(window, lower, taps_);
+        const float b = DotProduct(window, upper, taps_);
+        FromFloat(a + (b - a) * weight, &frame[c]);
+      }
+    } else {
+      const float* coefficients = &filter_[static_cast<size_t>(phase_) * taps_];
+      for (size_t c = 0; c < channels; ++c) {
+        FromFloat(DotProduct(history_[c].data() + start, coefficients, taps_),
+                  &frame[c]);
+      }
+    }
+    ++produced;
+
+    phase_ += step_;
+    start += static_cast<size_t>(phase_ / phase_count_);
+    phase_ %= phase_count_;
+  }
+
+  // Keep the frames later outputs still need. The window is longer than a
+  // step, so |start| never passes the end. Erasing from the front moves
+  // less than one window and never reallocates.
+  for (std::vector<float>& channel : history_) {
+    channel.erase(channel.begin(), channel.begin() + start);
+  }
+  return produced;
+}
+
+}  // namespace audio_capture
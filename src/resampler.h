@@ -0,0 +1,92 @@
+#ifndef FLUTTER_PLUGIN_RESAMPLER_H_
+#define FLUTTER_PLUGIN_RESAMPLER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace audio_capture {
+
+// Trade-off between filter length (CPU, latency) and stop-band rejection.
+enum class ResamplerQuality {
+  kLow,     // 8 zero crossings, about 50 dB rejection.
+  kMedium,  // 16 zero crossings, about 70 dB rejection.
+  kHigh,    // 32 zero crossings, about 90 dB rejection.
+};
+
+// Streaming polyphase windowed-sinc sample rate converter for interleaved
+// audio. The filter history and the fractional position carry over from one
+// Process call to the next, so converting a stream chunk by chunk yields the
+// same samples as converting it in one go, with no discontinuity at chunk
+// boundaries. Any pair of integer rates is converted exactly: the output
+// advances by input_rate / output_rate input frames, reduced to a rational
+// step. When downsampling, the filter cuts off below the output Nyquist
+// frequency, so content above it is removed rather than aliased.
+//
+// Not thread-safe; use one instance per stream.
+class Resampler {
+ public:
+  Resampler(int input_rate, int output_rate, int channels,
+            ResamplerQuality quality = ResamplerQuality::kMedium);
+
+  Resampler(const Resampler&) = delete;
+  Resampler& operator=(const Resampler&) = delete;
+
+  // Converts |input_frames| frames and writes up to |output_capacity| frames
+  // to |output|. Returns the number of frames written, which varies by one
+  // from call to call with the fractional position. Input that does not yet
+  // produce output, or would exceed |output_capacity|, is kept for the next
+  // call. MaxOutputFrames gives a capacity that always suffices. |output|
+  // may be |input|, converting in place, if it holds enough frames.
+  size_t Process(const int16_t* input, size_t input_frames, int16_t* output,
+                 size_t output_capacity);
+  size_t Process(const float* input, size_t input_frames, float* output,
+                 size_t output_capacity);
+
+  // Upper bound of the frames one Process call of |input_frames| frames
+  // writes, given every earlier call had enough capacity.
+  size_t MaxOutputFrames(size_t input_frames) const;
+
+  // Delay of the output behind the input, in input frames.
+  size_t latency_frames() const { return passthrough_ ? 0 : taps_ / 2; }
+
+  int input_rate() const { return input_rate_; }
+  int output_rate() const { return output_rate_; }
+  int channels() const { return channels_; }
+
+  // Forgets the history, as if the stream started anew.
+  void Reset();
+
+ private:
+  template <typename Sample>
+  size_t ProcessInterleaved(const Sample* input, size_t input_frames,
+                            Sample* output, size_t output_capacity);
+  void BuildFilter(ResamplerQuality quality);
+
+  int input_rate_;
+  int output_rate_;
+  int channels_;
+  bool passthrough_;
+
+  // The output position advances by step_ / phase_count_ input frames.
+  uint64_t step_;
+  uint64_t phase_count_;
+
+  size_t taps_;           // Filter length, a multiple of 4.
+  size_t filter_phases_;  // Rows of |filter_| minus the closing row.
+  // Whether |filter_| has fewer rows than there are phases and coefficients
+  // are interpolated between neighbouring rows.
+  bool interpolate_;
+  // Row p holds the taps for a fractional position of p / filter_phases_.
+  // The extra last row (position 1) lets interpolation read one row ahead.
+  std::vector<float> filter_;
+
+  // Unconsumed input per channel. |history_[c][0]| is the first frame of the
+  // next output's filter window.
+  std::vector<std::vector<float>> history_;
+  uint64_t phase_;  // Fractional position, in 1 / phase_count_ frames.
+};
+
+}  // namespace audio_capture
+
+#endif  // FLUTTER_PLUGIN_RESAMPLER_H_
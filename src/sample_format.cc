@@ -0,0 +1,524 @@
+#include "sample_format.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AUDIO_CAPTURE_SAMPLE_FORMAT_SSE2 1
+#if defined(__SSSE3__) || defined(__AVX__)
+#include <tmmintrin.h>
+#define AUDIO_CAPTURE_SAMPLE_FORMAT_SSSE3 1
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define AUDIO_CAPTURE_SAMPLE_FORMAT_NEON 1
+#endif
+
+namespace audio_capture {
+
+namespace {
+
+using DitherState = SampleConverter::DitherState;
+using ConvertFunction = SampleConverter::ConvertFunction;
+
+constexpr float kS16Scale = 32768.0f;
+constexpr float kS24Scale = 8388608.0f;
+constexpr float kS32Scale = 2147483648.0f;
+// Largest float below 2^31; full scale itself does not fit an int32.
+constexpr float kS32Max = 2147483520.0f;
+
+// Samples converted per pass when going through floats, on the stack.
+constexpr size_t kBlockSamples = 256;
+
+constexpr size_t kFormatCount = 6;
+
+// Rounds to the nearest integer, ties to even like the vector conversions.
+inline int32_t RoundToInt(float value) {
+  return static_cast<int32_t>(std::lrint(value));
+}
+
+inline float Clamp(float value, float low, float high) {
+  return std::min(high, std::max(low, value));
+}
+
+// xorshift32: cheap, and each vector lane runs its own generator.
+inline uint32_t NextRandom(uint32_t x) {
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return x;
+}
+
+// Uniform in [-0.5, 0.5) from the low 23 bits of |mantissa|.
+inline float UniformNoise(uint32_t mantissa) {
+  const uint32_t bits = (mantissa & 0x007fffffu) | 0x3f800000u;
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value - 1.5f;
+}
+
+// Sum of two uniform draws, one from each half of a random word: triangular
+// in [-1, 1) LSB. 16 bits per draw are plenty for noise. Sample i of a call
+// uses lane i % 4, as the vector code does.
+inline float TriangularNoise(DitherState* dither, size_t lane) {
+  uint32_t& x = dither->lanes[lane];
+  x = NextRandom(x);
+  return UniformNoise((x >> 16) << 7) + UniformNoise(x << 7);
+}
+
+#if defined(AUDIO_CAPTURE_SAMPLE_FORMAT_SSE2)
+inline __m128i NextRandom(__m128i x) {
+  x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+  x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+  return _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+}
+
+inline __m128 UniformNoise(__m128i mantissa) {
+  const __m128i bits =
+      _mm_or_si128(_mm_and_si128(mantissa, _mm_set1_epi32(0x007fffff)),
+                   _mm_set1_epi32(0x3f800000));
+  return _mm_sub_ps(_mm_castsi128_ps(bits), _mm_set1_ps(1.5f));
+}
+
+inline __m128 TriangularNoise(__m128i* state) {
+  *state = NextRandom(*state);
+  const __m128i high = _mm_slli_epi32(_mm_srli_epi32(*state, 16), 7);
+  return _mm_add_ps(UniformNoise(high),
+                    UniformNoise(_mm_slli_epi32(*state, 7)));
+}
+#elif defined(AUDIO_CAPTURE_SAMPLE_FORMAT_NEON)
+inline uint32x4_t NextRandom(uint32x4_t x) {
+  x = veorq_u32(x, vshlq_n_u32(x, 13));
+  x = veorq_u32(x, vshrq_n_u32(x, 17));
+  return veorq_u32(x, vshlq_n_u32(x, 5));
+}
+
+inline float32x4_t UniformNoise(uint32x4_t mantissa) {
+  const uint32x4_t bits =
+      vorrq_u32(vandq_u32(mantissa, vdupq_n_u32(0x007fffffu)),
+                vdupq_n_u32(0x3f800000u));
+  return vsubq_f32(vreinterpretq_f32_u32(bits), vdupq_n_f32(1.5f));
+}
+
+inline float32x4_t TriangularNoise(uint32x4_t* state) {
+  *state = NextRandom(*state);
+  const uint32x4_t high = vshlq_n_u32(vshrq_n_u32(*state, 16), 7);
+  return vaddq_f32(UniformNoise(high), UniformNoise(vshlq_n_u32(*state, 7)));
+}
+#endif
+
+// Input kernels: |count| samples to floats at +/-1.0.
+
+void S16ToF32(const void* input, float* output, size_t count) {
+  const int16_t* in = static_cast<const int16_t*>(input);
+  const float scale = 1.0f / kS16Scale;
+  size_t i = 0;
+#if defined(AUDIO_CAPTURE_SAMPLE_FORMAT_SSE2)
+  const __m128 scale4 = _mm_set1_ps(scale);
+  for (; i + 8 <= count; i += 8) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    // Each sample into the top half of a 32-bit lane, then sign-extended.
+    const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+    const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+    _mm_storeu_ps(output + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scale4));
+    _mm_storeu_ps(output + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale4));
+  }
+#elif defined(AUDIO_CAPTURE_SAMPLE_FORMAT_NEON)
+  for (; i + 8 <= count; i += 8) {
+    const int16x8_t v = vld1q_s16(in + i);
+    vst1q_f32(output + i,
+              vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+    vst1q_f32(output + i + 4,
+              vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+  }
+#endif
+  for (; i < count; ++i) {
+    output[i] = static_cast<float>(in[i]) * scale;
+  }
+}
+
+void S24ToF32(const void* input, float* output, size_t count) {
+  const uint8_t* in = static_cast<const uint8_t*>(input);
+  const float scale = 1.0f / kS32Scale;
+  size_t i = 0;
+#if defined(AUDIO_CAPTURE_SAMPLE_FORMAT_SSSE3)
+  // Moves the 3 bytes of each of 4 samples into the top of a 32-bit lane.
+  const __m128i spread = _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8,
+                                       -1, 9, 10, 11);
+  const __m128 scale4 = _mm_set1_ps(scale);
+  // Each load reads 16 bytes for 12, so stop two samples short.
+  for (; i + 6 <= count; i += 4) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 3));
+    _mm_storeu_ps(output + i, _mm_mul_ps(_mm_cvtepi32_ps(
+                                             _mm_shuffle_epi8(v, spread)),
+                                         scale4));
+  }
+#endif
+  for (; i < count; ++i) {
+    const uint8_t* bytes = in + i * 3;
+    const uint32_t value = (static_cast<uint32_t>(bytes[0]) << 8) |
+                           (static_cast<uint32_t>(bytes[1]) << 16) |
+                           (static_cast<uint32_t>(bytes[2]) << 24);
+    output[i] = static_cast<float>(static_cast<int32_t>(value)) * scale;
+  }
+}
+
+void S24In32ToF32(const void* input, float* output, size_t count) {
+  const int32_t* in = static_cast<const int32_t*>(input);
+  const float scale = 1.0f / kS32Scale;
+  size_t i = 0;
+#if defined(AUDIO_CAPTURE_SAMPLE_FORMAT_SSE2)
+  const __m128 scale4 = _mm_set1_ps(scale);
+  for (; i + 4 <= count; i += 4) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    _mm_storeu_ps(output + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_slli_epi32(v, 8)),
+                                         scale4));
+  }
+#elif defined(AUDIO_CAPTURE_SAMPLE_FORMAT_NEON)
+  for (; i + 4 <= count; i += 4) {
+    vst1q_f32(output + i, vmulq_n_f32(vcvtq_f32_s32(vshlq_n_s32(
+                                          vld1q_s32(in + i), 8)),
+                                      scale));
+  }
+#endif
+  for (; i < count; ++i) {
+    const uint32_t value = static_cast<uint32_t>(in[i]) << 8;
+    output[i] = static_cast<float>(static_cast<int32_t>(value)) * scale;
+  }
+}
+
+void S32ToF32(const void* input, float* output, size_t count) {
+  const int32_t* in = static_cast<const int32_t*>(input);
+  const float scale = 1.0f / kS32Scale;
+  size_t i = 0;
+#if defined(AUDIO_CAPTURE_SAMPLE_FORMAT_SSE2)
+  const __m128 scale4 = _mm_set1_ps(scale);
+  for (; i + 4 <= count; i += 4) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    _mm_storeu_ps(output + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale4));
+  }
+#elif defined(AUDIO_CAPTURE_SAMPLE_FORMAT_NEON)
+  for (; i + 4 <= count; i += 4) {
+    vst1q_f32(output + i, vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(in + i)), scale));
+  }
+#endif
+  for (; i < count; ++i) {
+    output[i] = static_cast<float>(in[i]) * scale;
+  }
+}
+
+void F64ToF32(const void* input, float* output, size_t count) {
+  const double* in = static_cast<const double*>(input);
+  size_t i = 0;
+#if defined(AUDIO_CAPTURE_SAMPLE_FORMAT_SSE2)
+  for (; i + 4 <= count; i += 4) {
+    const __m128 low = _mm_cvtpd_ps(_mm_loadu_pd(in + i));
+    const __m128 high = _mm_cvtpd_ps(_mm_loadu_pd(in + i + 2));
+    _mm_storeu_ps(output + i, _mm_movelh_ps(low, high));
+  }
+#elif defined(AUDIO_CAPTURE_SAMPLE_FORMAT_NEON)
+  for (; i + 4 <= count; i += 4) {
+    vst1q_f32(output + i, vcombine_f32(vcvt_f32_f64(vld1q_f64(in + i)),
+                                       vcvt_f32_f64(vld1q_f64(in + i + 2))));
+  }
+#endif
+  for (; i < count; ++i) {
+    output[i] = static_cast<float>(in[i]);
+  }
+}
+
+// Output kernels: |count| floats at +/-1.0 to samples. Only the S16 kernel
+// with dither uses |dither|.
+
+template <bool kDither>
+void F32ToS16(const float* input, void* output, size_t count,
+              DitherState* dither) {
+  int16_t* out = static_cast<int16_t*>(output);
+  size_t i = 0;
+#if defined(AUDIO_CAPTURE_SAMPLE_FORMAT_SSE2)
+  const __m128 scale = _mm_set1_ps(kS16Scale);
+  const __m128 low = _mm_set1_ps(-kS16Scale);
+  const __m128 high = _mm_set1_ps(kS16Scale - 1.0f);
+  __m128i state = _mm_setzero_si128();
+  if (kDither) {
+    state = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dither->lanes));
+  }
+  for (; i + 8 <= count; i += 8) {
+    __m128 a = _mm_mul_ps(_mm_loadu_ps(input + i), scale);
+    __m128 b = _mm_mul_ps(_mm_loadu_ps(input + i + 4), scale);
+    if (kDither) {
+      a = _mm_add_ps(a, TriangularNoise(&state));
+      b = _mm_add_ps(b, TriangularNoise(&state));
+    }
+    // Clamped first: out-of-range floats convert to INT32_MIN.
+    a = _mm_max_ps(_mm_min_ps(a, high), low);
+    b = _mm_max_ps(_mm_min_ps(b, high), low);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                     _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+  }
+  if (kDither) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dither->lanes), state);
+  }
+#elif defined(AUDIO_CAPTURE_SAMPLE_FORMAT_NEON)
+  uint32x4_t state = vdupq_n_u32(0);
+  if (kDither) {
+    state = vld1q_u32(dither->lanes);
+  }
+  for (; i + 8 <= count; i += 8) {
+    float32x4_t a = vmulq_n_f32(vld1q_f32(input + i), kS16Scale);
+    float32x4_t b = vmulq_n_f32(vld1q_f32(input + i + 4), kS16Scale);
+    if (kDither) {
+      a = vaddq_f32(a, TriangularNoise(&state));
+      b = vaddq_f32(b, TriangularNoise(&state));
+    }
+    // Both conversions saturate.
+    vst1q_s16(out + i, vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(a)),
+                                    vqmovn_s32(vcvtnq_s32_f32(b))));
+  }
+  if (kDither) {
+    vst1q_u32(dither->lanes, state);
+  }
+#endif
+  for (; i < count; ++i) {
+    float value = input[i] * kS16Scale;
+    if (kDither) {
+      value += TriangularNoise(dither, i & 3);
+    }
+    out[i] = static_cast<int16_t>(
+        RoundToInt(Clamp(value, -kS16Scale, kS16Scale - 1.0f)));
+  }
+}
+
+void F32ToS24(const float* input, void* output, size_t count,
+              DitherState* /* dither */) {
+  uint8_t* out = static_cast<uint8_t*>(output);
+  for (size_t i = 0; i < count; ++i) {
+    const uint32_t value = static_cast<uint32_t>(RoundToInt(
+        Clamp(input[i] * kS24Scale, -kS24Scale, kS24Scale - 1.0f)));
+    uint8_t* bytes = out + i * 3;
+    bytes[0] = static_cast<uint8_t>(value);
+    bytes[1] = static_cast<uint8_t>(value >> 8);
+    bytes[2] = static_cast<uint8_t>(value >> 16);
+  }
+}
+
+// Shared by the 24-in-32 and 32-bit formats, which differ in scale only.
+template <int kBits>
+void F32ToS32(const float* input, void* output, size_t count,
+              DitherState* /* dither */) {
+  int32_t* out = static_cast<int32_t*>(output);
+  const float scale = kBits == 24 ? kS24Scale : kS32Scale;
+  const float max = kBits == 24 ? kS24Scale - 1.0f : kS32Max;
+  size_t i = 0;
+#if defined(AUDIO_CAPTURE_SAMPLE_FORMAT_SSE2)
+  const __m128 scale4 = _mm_set1_ps(scale);
+  const __m128 low = _mm_set1_ps(-scale);
+  const __m128 high = _mm_set1_ps(max);
+  for (; i + 4 <= count; i += 4) {
+    const __m128 v = _mm_mul_ps(_mm_loadu_ps(input + i), scale4);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                     _mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(v, high), low)));
+  }
+#elif defined(AUDIO_CAPTURE_SAMPLE_FORMAT_NEON)
+  const float32x4_t low = vdupq_n_f32(-scale);
+  const float32x4_t high = vdupq_n_f32(max);
+  for (; i + 4 <= count; i += 4) {
+    const float32x4_t v = vmulq_n_f32(vld1q_f32(input + i), scale);
+    vst1q_s32(out + i, vcvtnq_s32_f32(vmaxq_f32(vminq_f32(v, high), low)));
+  }
+#endif
+  for (; i < count; ++i) {
+    out[i] = RoundToInt(Clamp(input[i] * scale, -scale, max));
+  }
+}
+
+void F32ToF64(const float* input, void* output, size_t count,
+              DitherState* /* dither */) {
+  double* out = static_cast<double*>(output);
+  size_t i = 0;
+#if defined(AUDIO_CAPTURE_SAMPLE_FORMAT_SSE2)
+  for (; i + 4 <= count; i += 4) {
+    const __m128 v = _mm_loadu_ps(input + i);
+    _mm_storeu_pd(out + i, _mm_cvtps_pd(v));
+    _mm_storeu_pd(out + i + 2, _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+  }
+#elif defined(AUDIO_CAPTURE_SAMPLE_FORMAT_NEON)
+  for (; i + 4 <= count; i += 4) {
+    const float32x4_t v = vld1q_f32(input + i);
+    vst1q_f64(out + i, vcvt_f64_f32(vget_low_f32(v)));
+    vst1q_f64(out + i + 2, vcvt_high_f64_f32(v));
+  }
+#endif
+  for (; i < count; ++i) {
+    out[i] = static_cast<double>(input[i]);
+  }
+}
+
+// Table entries.
+
+using ToFloatKernel = void (*)(const void* input, float* output,
+                               size_t count);
+using FromFloatKernel = void (*)(const float* input, void* output,
+                                 size_t count, DitherState* dither);
+
+template <size_t kBytes>
+void Copy(const void* input, void* output, size_t samples,
+          DitherState* /* dither */) {
+  if (input != output) {
+    std::memmove(output, input, samples * kBytes);
+  }
+}
+
+template <ToFloatKernel kLoad>
+void ToFloat(const void* input, void* output, size_t samples,
+             DitherState* /* dither */) {
+  kLoad(input, static_cast<float*>(output), samples);
+}
+
+template <FromFloatKernel kStore>
+void FromFloat(const void* input, void* output, size_t samples,
+               DitherState* dither) {
+  kStore(static_cast<const float*>(input), output, samples, dither);
+}
+
+// Everything not to or from F32 goes through floats a block at a time.
+// Each block is read before any of its output is written, so narrowing
+// conversions work in place.
+template <ToFloatKernel kLoad, size_t kInputBytes, FromFloatKernel kStore,
+          size_t kOutputBytes>
+void ThroughFloat(const void* input, void* output, size_t samples,
+                  DitherState* dither) {
+  float block[kBlockSamples];
+  const uint8_t* in = static_cast<const uint8_t*>(input);
+  uint8_t* out = static_cast<uint8_t*>(output);
+  for (size_t done = 0; done < samples; done += kBlockSamples) {
+    const size_t count = std::min(kBlockSamples, samples - done);
+    kLoad(in + done * kInputBytes, block, count);
+    kStore(block, out + done * kOutputBytes, count, dither);
+  }
+}
+
+template <ToFloatKernel kLoad, size_t kInputBytes>
+constexpr ConvertFunction ToS16() {
+  return ThroughFloat<kLoad, kInputBytes, F32ToS16<false>, 2>;
+}
+
+template <ToFloatKernel kLoad, size_t kInputBytes>
+constexpr ConvertFunction ToS16Dithered() {
+  return ThroughFloat<kLoad, kInputBytes, F32ToS16<true>, 2>;
+}
+
+template <FromFloatKernel kStore, size_t kOutputBytes>
+constexpr ConvertFunction FromS16() {
+  return ThroughFloat<S16ToF32, 2, kStore, kOutputBytes>;
+}
+
+// kConverters[input][output], in SampleFormat order; null where neither
+// side is S16 or F32.
+const ConvertFunction kConverters[kFormatCount][kFormatCount] = {
+    // From S16.
+    {Copy<2>, FromS16<F32ToS24, 3>(), FromS16<F32ToS32<24>, 4>(),
+     FromS16<F32ToS32<32>, 4>(), ToFloat<S16ToF32>, FromS16<F32ToF64, 8>()},
+    // From S24.
+    {ToS16<S24ToF32, 3>(), nullptr, nullptr, nullptr, ToFloat<S24ToF32>,
+     nullptr},
+    // From S24 in 32.
+    {ToS16<S24In32ToF32, 4>(), nullptr, nullptr, nullptr,
+     ToFloat<S24In32ToF32>, nullptr},
+    // From S32.
+    {ToS16<S32ToF32, 4>(), nullptr, nullptr, nullptr, ToFloat<S32ToF32>,
+     nullptr},
+    // From F32.
+    {FromFloat<F32ToS16<false>>, FromFloat<F32ToS24>,
+     FromFloat<F32ToS32<24>>, FromFloat<F32ToS32<32>>, Copy<4>,
+     FromFloat<F32ToF64>},
+    // From F64.
+    {ToS16<F64ToF32, 8>(), nullptr, nullptr, nullptr, ToFloat<F64ToF32>,
+     nullptr},
+};
+
+// Replaces the S16 column of kConverters when dithering. S16 input has
+// nothing to dither.
+const ConvertFunction kDitheredToS16[kFormatCount] = {
+    Copy<2>,
+    ToS16Dithered<S24ToF32, 3>(),
+    ToS16Dithered<S24In32ToF32, 4>(),
+    ToS16Dithered<S32ToF32, 4>(),
+    FromFloat<F32ToS16<true>>,
+    ToS16Dithered<F64ToF32, 8>(),
+};
+
+}  // namespace
+
+size_t SampleFormatBytes(SampleFormat format) {
+  switch (format) {
+    case SampleFormat::kS16:
+      return 2;
+    case SampleFormat::kS24:
+      return 3;
+    case SampleFormat::kS24In32:
+    case SampleFormat::kS32:
+    case SampleFormat::kF32:
+      return 4;
+    case SampleFormat::kF64:
+      return 8;
+  }
+  return 0;
+}
+
+const char* SampleFormatName(SampleFormat format) {
+  switch (format) {
+    case SampleFormat::kS16:
+      return "s16";
+    case SampleFormat::kS24:
+      return "s24";
+    case SampleFormat::kS24In32:
+      return "s24_32";
+    case SampleFormat::kS32:
+      return "s32";
+    case SampleFormat::kF32:
+      return "f32";
+    case SampleFormat::kF64:
+      return "f64";
+  }
+  return "unknown";
+}
+
+SampleConverter::SampleConverter(SampleFormat input, SampleFormat output,
+                                 Dither dither)
+    : input_(input),
+      output_(output),
+      convert_(nullptr),
+      dither_state_{{0x6a09e667u, 0xbb67ae85u, 0x3c6ef372u, 0xa54ff53au}} {
+  const size_t from = static_cast<size_t>(input);
+  const size_t to = static_cast<size_t>(output);
+  if (from >= kFormatCount || to >= kFormatCount) {
+    return;
+  }
+  convert_ = output == SampleFormat::kS16 && dither == Dither::kTriangular
+                 ? kDitheredToS16[from]
+                 : kConverters[from][to];
+}
+
+bool SampleConverter::IsSupported(SampleFormat input, SampleFormat output) {
+  const size_t from = static_cast<size_t>(input);
+  const size_t to = static_cast<size_t>(output);
+  return from < kFormatCount && to < kFormatCount &&
+         kConverters[from][to] != nullptr;
+}
+
+void SampleConverter::Convert(const void* input, void* output,
+                              size_t samples) {
+  if (convert_ != nullptr) {
+    convert_(input, output, samples, &dither_state_);
+  }
+}
+
+}  // namespace audio_capture
@@ -0,0 +1,81 @@
+#ifndef FLUTTER_PLUGIN_SAMPLE_FORMAT_H_
+#define FLUTTER_PLUGIN_SAMPLE_FORMAT_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace audio_capture {
+
+// Sample encodings audio servers deliver, all little-endian. Integer samples
+// are full scale at their type's range, float samples at +/-1.0.
+enum class SampleFormat {
+  kS16,       // 16-bit signed.
+  kS24,       // 24-bit signed, packed in 3 bytes.
+  kS24In32,   // 24-bit signed in the low 3 bytes of 4. The top byte is
+              // ignored on input and holds the sign on output.
+  kS32,       // 32-bit signed; also 24 valid bits left-aligned in 32.
+  kF32,       // 32-bit float.
+  kF64,       // 64-bit float.
+};
+
+// Bytes per sample of |format|.
+size_t SampleFormatBytes(SampleFormat format);
+
+// Short lowercase name of |format|, such as "s16" or "f32".
+const char* SampleFormatName(SampleFormat format);
+
+// Noise added when reducing to 16 bits, so the rounding error of quiet
+// signals becomes steady noise instead of distortion that follows the
+// signal.
+enum class Dither {
+  kNone,
+  kTriangular,  // TPDF noise of +/-1 LSB.
+};
+
+// Converts interleaved samples between any supported format and S16 or F32,
+// in either direction. The conversion is looked up once when the converter
+// is created, from a table of vectorized routines (SSE2 or NEON, with a
+// scalar fallback), so the per-chunk call is a single indirect call with no
+// format checks. Floats are clamped to full scale when converted to
+// integers, and integers rounded to the nearest value.
+//
+// Not thread-safe; use one instance per stream.
+class SampleConverter {
+ public:
+  // |dither| applies when the output is S16 and the input has more
+  // resolution; it is ignored otherwise.
+  SampleConverter(SampleFormat input, SampleFormat output,
+                  Dither dither = Dither::kNone);
+
+  // Whether |input| can be converted to |output|: one of them is S16 or F32.
+  static bool IsSupported(SampleFormat input, SampleFormat output);
+
+  // False if the formats are not supported; Convert then does nothing.
+  bool valid() const { return convert_ != nullptr; }
+
+  // Converts |samples| samples (frames times channels) from |input| to
+  // |output|. |output| may be |input|, converting in place, if output
+  // samples are no wider than input samples.
+  void Convert(const void* input, void* output, size_t samples);
+
+  SampleFormat input_format() const { return input_; }
+  SampleFormat output_format() const { return output_; }
+
+  // State of the dither noise generator, one per vector lane.
+  struct DitherState {
+    uint32_t lanes[4];
+  };
+
+  using ConvertFunction = void (*)(const void* input, void* output,
+                                   size_t samples, DitherState* dither);
+
+ private:
+  SampleFormat input_;
+  SampleFormat output_;
+  ConvertFunction convert_;
+  DitherState dither_state_;
+};
+
+}  // namespace audio_capture
+
+#endif  // FLUTTER_PLUGIN_SAMPLE_FORMAT_H_
@@ -0,0 +1,156 @@
+#include "spectrum_analyzer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "level_meter.h"
+
+namespace audio_capture {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+constexpr size_t kMinFftSize = 64;
+constexpr size_t kMaxFftSize = 32768;
+constexpr double kMaxOverlap = 0.95;
+constexpr double kMaxSmoothing = 0.99;
+
+// Relative band power of kMinLevelDb.
+constexpr float kMinPower = 1e-12f;
+
+}  // namespace
+
+SpectrumAnalyzer::SpectrumAnalyzer(int sample_rate,
+                                   const SpectrumOptions& options)
+    : smoothing_(static_cast<float>(
+          std::max(0.0, std::min(options.smoothing, kMaxSmoothing)))),
+      window_(std::min(
+          kMaxFftSize,
+          NextPowerOfTwo(std::max(
+              kMinFftSize,
+              static_cast<size_t>(std::max(0, options.fft_size)))))),
+      fft_(window_.size()) {
+  const size_t size = window_.size();
+  const double overlap =
+      std::max(0.0, std::min(options.overlap, kMaxOverlap));
+  hop_ = std::max<size_t>(
+      1, static_cast<size_t>(
+             std::lround(static_cast<double>(size) * (1.0 - overlap))));
+
+  // Periodic Hann window.
+  for (size_t i = 0; i < size; ++i) {
+    window_[i] = static_cast<float>(
+        0.5 - 0.5 * std::cos(2.0 * kPi * static_cast<double>(i) /
+                             static_cast<double>(size)));
+  }
+  // A sine of amplitude 1 puts N * sum(w^2) / 4 = 3N^2 / 32 into the
+  // positive-frequency bins around it.
+  reference_power_ =
+      static_cast<float>(3.0 * static_cast<double>(size) *
+                         static_cast<double>(size) / 32.0);
+
+  // Edges evenly spaced on a log axis from |low_hz| to |high_hz|.
+  const size_t bands = static_cast<size_t>(std::max(1, options.bands));
+  const double nyquist = sample_rate / 2.0;
+  const double high_hz = options.high_hz > 0.0
+                             ? std::min(options.high_hz, nyquist)
+                             : nyquist;
+  const double low_hz =
+      std::max(1.0, std::min(options.low_hz, high_hz / 2.0));
+  const double ratio = std::pow(high_hz / low_hz,
+                                1.0 / static_cast<double>(bands));
+  const double bin_hz =
+      static_cast<double>(sample_rate) / static_cast<double>(size);
+  const size_t last_bin = fft_.bins() - 1;
+  band_start_.resize(bands);
+  band_end_.resize(bands);
+  frequencies_.resize(bands);
+  for (size_t b = 0; b < bands; ++b) {
+    const double lower = low_hz * std::pow(ratio, static_cast<double>(b));
+    const double upper = lower * ratio;
+    const double center = std::sqrt(lower * upper);
+    frequencies_[b] = static_cast<float>(center);
+    size_t start = std::min(
+        last_bin, static_cast<size_t>(std::ceil(lower / bin_hz)));
+    size_t end = std::min(
+        last_bin + 1, static_cast<size_t>(std::ceil(upper / bin_hz)));
+    if (end <= start) {
+      // Narrower than a bin: take the bin nearest its center.
+      start = std::min(last_bin,
+                       static_cast<size_t>(std::lround(center / bin_hz)));
+      end = start + 1;
+    }
+    band_start_[b] = start;
+    band_end_[b] = end;
+  }
+
+  buffer_.resize(size);
+  frame_.resize(size);
+  power_.resize(fft_.bins());
+  smoothed_.resize(bands);
+  levels_.resize(bands);
+  Reset();
+}
+
+size_t SpectrumAnalyzer::Process(const int16_t* samples, size_t count) {
+  const size_t size = window_.size();
+  size_t completed = 0;
+  while (count > 0) {
+    const size_t take = std::min(count, size - fill_);
+    float* buffer = buffer_.data() + fill_;
+    for (size_t i = 0; i < take; ++i) {
+      buffer[i] = static_cast<float>(samples[i]) * (1.0f / 32768.0f);
+    }
+    fill_ += take;
+    consumed_ += take;
+    samples += take;
+    count -= take;
+    if (fill_ < size) {
+      break;
+    }
+
+    AnalyzeFrame();
+    ++completed;
+    ++frame_count_;
+    frame_end_ = consumed_;
+    // The next frame starts a hop later.
+    std::memmove(buffer_.data(), buffer_.data() + hop_,
+                 (size - hop_) * sizeof(float));
+    fill_ = size - hop_;
+  }
+  return completed;
+}
+
+void SpectrumAnalyzer::AnalyzeFrame() {
+  for (size_t i = 0; i < window_.size(); ++i) {
+    frame_[i] = buffer_[i] * window_[i];
+  }
+  fft_.PowerSpectrum(frame_.data(), power_.data());
+  const float scale = 1.0f / reference_power_;
+  for (size_t b = 0; b < levels_.size(); ++b) {
+    float power = 0.0f;
+    for (size_t k = band_start_[b]; k < band_end_[b]; ++k) {
+      power += power_[k];
+    }
+    power *= scale;
+    smoothed_[b] = smoothing_ * smoothed_[b] + (1.0f - smoothing_) * power;
+    levels_[b] = smoothed_[b] > kMinPower
+                     ? std::max(static_cast<float>(kMinLevelDb),
+                                10.0f * std::log10(smoothed_[b]))
+                     : static_cast<float>(kMinLevelDb);
+  }
+}
+
+void SpectrumAnalyzer::Reset() {
+  fill_ = 0;
+  consumed_ = 0;
+  frame_count_ = 0;
+  frame_end_ = 0;
+  std::fill(smoothed_.begin(), smoothed_.end(), 0.0f);
+  std::fill(levels_.begin(), levels_.end(),
+            static_cast<float>(kMinLevelDb));
+}
+
+}  // namespace audio_capture
@@ -0,0 +1,90 @@
+#ifndef FLUTTER_PLUGIN_SPECTRUM_ANALYZER_H_
+#define FLUTTER_PLUGIN_SPECTRUM_ANALYZER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "fft.h"
+
+namespace audio_capture {
+
+struct SpectrumOptions {
+  int fft_size = 2048;    // Rounded up to a power of two of at least 64.
+  double overlap = 0.5;   // Of consecutive frames, from 0 to 0.95.
+  int bands = 32;
+  double low_hz = 40.0;
+  double high_hz = 16000.0;  // 0 or above half the sample rate for Nyquist.
+  // Weight of the previous level in each new one, from 0 (none) to 0.99,
+  // like the smoothing time constant of a Web Audio analyser.
+  double smoothing = 0.5;
+};
+
+// Spectrum of a mono 16-bit stream for visualizers: Hann-windowed FFT frames
+// every hop, their power summed into bands spaced evenly on a log frequency
+// axis, smoothed across frames and reported in dBFS. A full-scale sine
+// reads about 0 dB in its band; silence reads kMinLevelDb.
+//
+// Band edges and the window are tabulated at construction. Frame n covers
+// the samples from n * hop_samples() since construction or Reset().
+//
+// Not thread-safe; use one instance per stream.
+class SpectrumAnalyzer {
+ public:
+  SpectrumAnalyzer(int sample_rate,
+                   const SpectrumOptions& options = SpectrumOptions());
+
+  size_t bands() const { return levels_.size(); }
+  size_t fft_size() const { return fft_.size(); }
+  size_t hop_samples() const { return hop_; }
+
+  // Geometric center of each band, in Hz.
+  const std::vector<float>& frequencies() const { return frequencies_; }
+
+  // Adds |count| samples and analyzes each frame they complete. Returns the
+  // number of frames completed.
+  size_t Process(const int16_t* samples, size_t count);
+
+  // Smoothed level of each band as of the last completed frame, in dBFS
+  // from kMinLevelDb to about 0.
+  const std::vector<float>& levels() const { return levels_; }
+
+  // Frames completed since construction or Reset().
+  uint64_t frame_count() const { return frame_count_; }
+
+  // Samples from construction or Reset() to the end of the last completed
+  // frame.
+  uint64_t frame_end() const { return frame_end_; }
+
+  // Forgets buffered samples and smoothing, for a stream that does not
+  // continue the previous one.
+  void Reset();
+
+ private:
+  void AnalyzeFrame();
+
+  size_t hop_;
+  float smoothing_;
+  std::vector<float> window_;
+  Fft fft_;
+  // Band b sums the power bins from |band_start_[b]| to |band_end_[b]|,
+  // exclusive.
+  std::vector<size_t> band_start_;
+  std::vector<size_t> band_end_;
+  std::vector<float> frequencies_;
+  float reference_power_;  // Band power of a full-scale sine.
+
+  std::vector<float> buffer_;  // The current frame so far.
+  size_t fill_;
+  uint64_t consumed_;
+  uint64_t frame_count_;
+  uint64_t frame_end_;
+  std::vector<float> frame_;  // Windowed.
+  std::vector<float> power_;
+  std::vector<float> smoothed_;  // Band powers, relative to the reference.
+  std::vector<float> levels_;
+};
+
+}  // namespace audio_capture
+
+#endif  // FLUTTER_PLUGIN_SPECTRUM_ANALYZER_H_
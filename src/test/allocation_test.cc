@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "buffer_pool.h"
+#include "resampler.h"
+#include "sample_format.h"
+
+// Counts heap allocations while a test enables it. Replacing the global
+// operators catches every C++ allocation, and wrapping malloc catches C code
+// and the C++ runtime. That changes every test linked with it, so this file
+// builds into a binary of its own, and only against glibc, whose __libc_*
+// entry points the wrappers forward to.
+namespace {
+
+std::atomic<bool> g_count_allocations(false);
+std::atomic<size_t> g_allocations(0);
+
+void CountAllocation() {
+  if (g_count_allocations.load(std::memory_order_relaxed)) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void __libc_free(void* pointer);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+
+void* malloc(size_t size) {
+  CountAllocation();
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+  CountAllocation();
+  return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) {
+  CountAllocation();
+  return __libc_realloc(pointer, size);
+}
+}  // extern "C"
+
+void* operator new(size_t size) {
+  CountAllocation();
+  void* pointer = __libc_malloc(size > 0 ? size : 1);
+  if (pointer == nullptr) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+
+// Freed through glibc directly, like the allocations above: a plain free()
+// of operator new's result reads to the compiler as a mismatched pair.
+void operator delete(void* pointer) noexcept { __libc_free(pointer); }
+
+void operator delete[](void* pointer) noexcept { __libc_free(pointer); }
+
+void operator delete(void* pointer, size_t) noexcept { __libc_free(pointer); }
+
+void operator delete[](void* pointer, size_t) noexcept {
+  __libc_free(pointer);
+}
+
+namespace audio_capture {
+namespace test {
+
+namespace {
+
+// Hands buffers from one thread to another, the way the plugins pass chunks
+// to the thread that sends them. Fixed capacity, no allocation.
+class Handoff {
+ public:
+  bool Push(void* buffer) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == kCapacity) {
+      return false;
+    }
+    slots_[tail % kCapacity] = buffer;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  void* Pop() {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+    void* buffer = slots_[head % kCapacity];
+    head_.store(head + 1, std::memory_order_release);
+    return buffer;
+  }
+
+ private:
+  static constexpr size_t kCapacity = 8;
+  void* slots_[kCapacity] = {};
+  std::atomic<size_t> head_{0};
+  std::atomic<size_t> tail_{0};
+};
+
+}  // namespace
+
+// The per-chunk path of a capture: convert the device format, resample,
+// fill a pooled buffer and hand it to another thread, which releases it once
+// sent. After the first chunks nothing on either side may allocate.
+TEST(BufferPool, SteadyStateCaptureLoopDoesNotAllocate) {
+  constexpr int kCaptureRate = 44100;
+  constexpr int kOutputRate = 16000;
+  constexpr size_t kChunkFrames = kCaptureRate / 50;
+  constexpr int kWarmUpChunks = 20;
+  constexpr int kChunks = 2000;
+
+  Resampler resampler(kCaptureRate, kOutputRate, 2);
+  SampleConverter to_float(SampleFormat::kS24, SampleFormat::kF32);
+  SampleConverter to_s16(SampleFormat::kF32, SampleFormat::kS16,
+                         Dither::kTriangular);
+  std::vector<uint8_t> device(kChunkFrames * 2 * 3, 0x11);
+  std::vector<float> frames(kChunkFrames * 2);
+  const size_t max_output_frames = resampler.MaxOutputFrames(kChunkFrames);
+  BufferPool pool(max_output_frames * 2 * sizeof(int16_t), 4);
+  Handoff handoff;
+
+  std::atomic<bool> done(false);
+  std::atomic<size_t> released(0);
+  std::thread consumer([&]() {
+    while (true) {
+      void* buffer = handoff.Pop();
+      if (buffer == nullptr) {
+        if (done.load(std::memory_order_acquire)) {
+          break;
+        }
+        std::this_thread::yield();
+        continue;
+      }
+      pool.Release(buffer);
+      released.fetch_add(1, std::memory_order_relaxed);
+    }
+  });
+
+  size_t produced = 0;
+  auto capture_chunk = [&]() {
+    void* buffer = nullptr;
+    while ((buffer = pool.Acquire()) == nullptr) {
+      std::this_thread::yield();
+    }
+    to_float.Convert(device.data(), frames.data(), kChunkFrames * 2);
+    const size_t output_frames =
+        resampler.Process(frames.data(), kChunkFrames, frames.data(),
+                          max_output_frames);
+    to_s16.Convert(frames.data(), buffer, output_frames * 2);
+    while (!handoff.Push(buffer)) {
+      std::this_thread::yield();
+    }
+    ++produced;
+  };
+
+  for (int i = 0; i < kWarmUpChunks; ++i) {
+    capture_chunk();
+  }
+  g_allocations = 0;
+  g_count_allocations = true;
+  for (int i = 0; i < kChunks; ++i) {
+    capture_chunk();
+  }
+  while (released.load(std::memory_order_relaxed) < produced) {
+    std::this_thread::yield();
+  }
+  g_count_allocations = false;
+  done.store(true, std::memory_order_release);
+  consumer.join();
+
+  EXPECT_EQ(g_allocations.load(), 0u)
+      << "allocations per chunk: "
+      << static_cast<double>(g_allocations.load()) / kChunks;
+  EXPECT_EQ(pool.available(), pool.buffer_count());
+}
+
+// The processing side of a capture with gap filling: lost audio becomes
+// silence ahead of the next chunk, in a buffer sized at start for the longest
+// fill, and the result goes out in pooled pieces. The first gap after the
+// warm-up must not allocate either.
+TEST(BufferPool, GapFillDoesNotAllocate) {
+  constexpr int kRate = 16000;
+  constexpr size_t kChunkFrames = kRate / 50;
+  constexpr size_t kMaxFillFrames = kRate * 10;
+  constexpr int kWarmUpChunks = 20;
+  constexpr int kChunks = 2000;
+
+  const std::vector<int16_t> chunk(kChunkFrames * 2, 1000);
+  std::vector<int16_t> output(kMaxFillFrames + kChunkFrames);
+  BufferPool pool(kChunkFrames * sizeof(int16_t), 4);
+
+  auto process_chunk = [&](size_t lead_in) {
+    std::fill_n(output.begin(), lead_in, 0);
+    int16_t* mono = output.data() + lead_in;
+    for (size_t i = 0; i < kChunkFrames; ++i) {
+      mono[i] = static_cast<int16_t>((chunk[i * 2] + chunk[i * 2 + 1]) / 2);
+    }
+    const size_t count = lead_in + kChunkFrames;
+    for (size_t offset = 0; offset < count; offset += kChunkFrames) {
+      void* buffer = pool.Acquire();
+      ASSERT_NE(buffer, nullptr);
+      const size_t piece = std::min(kChunkFrames, count - offset);
+      memcpy(buffer, output.data() + offset, piece * sizeof(int16_t));
+      pool.Release(buffer);
+    }
+  };
+
+  for (int i = 0; i < kWarmUpChunks; ++i) {
+    process_chunk(0);
+  }
+  g_allocations = 0;
+  g_count_allocations = true;
+  for (int i = 0; i < kChunks; ++i) {
+    // Every tenth chunk follows a gap, up to the longest one filled.
+    process_chunk(i % 10 == 0 ? kMaxFillFrames * (i % 7 + 1) / 7 : 0);
+  }
+  g_count_allocations = false;
+
+  EXPECT_EQ(g_allocations.load(), 0u);
+  EXPECT_EQ(pool.available(), pool.buffer_count());
+}
+
+}  // namespace test
+}  // namespace audio_capture
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "biquad.h"
+
+namespace audio_capture {
+namespace test {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr int kRate = 48000;
+
+// |seconds| of a sine at |frequency| Hz and |amplitude|, plus |offset|,
+// on each of |channels| interleaved channels.
+std::vector<int16_t> Sine(double frequency, double amplitude, double offset,
+                          double seconds, int channels = 1) {
+  const size_t frames = static_cast<size_t>(seconds * kRate);
+  std::vector<int16_t> samples(frames * static_cast<size_t>(channels));
+  for (size_t i = 0; i < frames; ++i) {
+    const double value =
+        offset + amplitude * std::sin(2.0 * kPi * frequency * i / kRate);
+    for (int c = 0; c < channels; ++c) {
+      samples[i * static_cast<size_t>(channels) + static_cast<size_t>(c)] =
+          static_cast<int16_t>(std::lround(value));
+    }
+  }
+  return samples;
+}
+
+// Mean and RMS about it of channel |channel| over the last half.
+void Stats(const std::vector<int16_t>& samples, int channels, int channel,
+           double* mean, double* rms) {
+  const size_t frames = samples.size() / static_cast<size_t>(channels);
+  double sum = 0.0;
+  double square_sum = 0.0;
+  size_t count = 0;
+  for (size_t i = frames / 2; i < frames; ++i) {
+    const double value = samples[i * static_cast<size_t>(channels) +
+                                 static_cast<size_t>(channel)];
+    sum += value;
+    square_sum += value * value;
+    ++count;
+  }
+  *mean = sum / count;
+  *rms = std::sqrt(std::max(0.0, square_sum / count - *mean * *mean));
+}
+
+// Gain of |spec| at |frequency| Hz, in dB, measured on a sine.
+double GainDb(const FilterSpec& spec, double frequency) {
+  std::vector<int16_t> samples = Sine(frequency, 10000.0, 0.0, 1.0);
+  BiquadChain chain(kRate, 1, {spec});
+  chain.Process(samples.data(), samples.size());
+  double mean = 0.0;
+  double rms = 0.0;
+  Stats(samples, 1, 0, &mean, &rms);
+  return 20.0 * std::log10(rms / (10000.0 / std::sqrt(2.0)));
+}
+
+}  // namespace
+
+TEST(BiquadChain, BlocksDcOffset) {
+  std::vector<int16_t> samples = Sine(1000.0, 8000.0, 3000.0, 2.0);
+  FilterSpec spec;
+  spec.type = FilterType::kDcBlock;
+  spec.frequency_hz = 10.0;
+  BiquadChain chain(kRate, 1, {spec});
+  chain.Process(samples.data(), samples.size());
+
+  double mean = 0.0;
+  double rms = 0.0;
+  Stats(samples, 1, 0, &mean, &rms);
+  EXPECT_NEAR(mean, 0.0, 1.0);
+  EXPECT_NEAR(rms, 8000.0 / std::sqrt(2.0), 10.0);
+}
+
+TEST(BiquadChain, ShapesTheResponse) {
+  FilterSpec high_pass;
+  high_pass.type = FilterType::kHighPass;
+  high_pass.frequency_hz = 100.0;
+  EXPECT_NEAR(GainDb(high_pass, 100.0), -3.0, 0.2);
+  EXPECT_LT(GainDb(high_pass, 25.0), -23.0);
+  EXPECT_NEAR(GainDb(high_pass, 1000.0), 0.0, 0.1);
+
+  FilterSpec low_pass;
+  low_pass.type = FilterType::kLowPass;
+  low_pass.frequency_hz = 4000.0;
+  EXPECT_NEAR(GainDb(low_pass, 4000.0), -3.0, 0.2);
+  EXPECT_NEAR(GainDb(low_pass, 200.0), 0.0, 0.1);
+
+  FilterSpec notch;
+  notch.type = FilterType::kNotch;
+  notch.frequency_hz = 50.0;
+  notch.q = 10.0;
+  EXPECT_LT(GainDb(notch, 50.0), -40.0);
+  EXPECT_NEAR(GainDb(notch, 200.0), 0.0, 0.2);
+
+  FilterSpec low_shelf;
+  low_shelf.type = FilterType::kLowShelf;
+  low_shelf.frequency_hz = 200.0;
+  low_shelf.gain_db = -6.0;
+  EXPECT_NEAR(GainDb(low_shelf, 20.0), -6.0, 0.2);
+  EXPECT_NEAR(GainDb(low_shelf, 5000.0), 0.0, 0.1);
+
+  FilterSpec high_shelf;
+  high_shelf.type = FilterType::kHighShelf;
+  high_shelf.frequency_hz = 2000.0;
+  high_shelf.gain_db = 6.0;
+  EXPECT_NEAR(GainDb(high_shelf, 15000.0), 6.0, 0.2);
+  EXPECT_NEAR(GainDb(high_shelf, 100.0), 0.0, 0.1);
+}
+
+TEST(BiquadChain, FiltersChannelsAlike) {
+  FilterSpec dc_block;
+  dc_block.type = FilterType::kDcBlock;
+  dc_block.frequency_hz = 20.0;
+  FilterSpec notch;
+  notch.type = FilterType::kNotch;
+  notch.frequency_hz = 60.0;
+  const std::vector<FilterSpec> specs = {dc_block, notch};
+
+  // Stereo in uneven pieces against each channel filtered on its own.
+  std::vector<int16_t> stereo = Sine(60.0, 5000.0, 1000.0, 0.5, 2);
+  for (size_t i = 0; i < stereo.size(); i += 2) {
+    stereo[i + 1] = static_cast<int16_t>(-stereo[i + 1] / 2);
+  }
+  std::vector<int16_t> left(stereo.size() / 2);
+  std::vector<int16_t> right(stereo.size() / 2);
+  for (size_t i = 0; i < left.size(); ++i) {
+    left[i] = stereo[i * 2];
+    right[i] = stereo[i * 2 + 1];
+  }
+  BiquadChain chain(kRate, 2, specs);
+  const size_t frames = stereo.size() / 2;
+  chain.Process(stereo.data(), 1001);
+  chain.Process(stereo.data() + 2002, frames - 1001);
+  BiquadChain left_chain(kRate, 1, specs);
+  left_chain.Process(left.data(), left.size());
+  BiquadChain right_chain(kRate, 1, specs);
+  right_chain.Process(right.data(), right.size());
+
+  for (size_t i = 0; i < frames; ++i) {
+    ASSERT_EQ(stereo[i * 2], left[i]) << i;
+    ASSERT_EQ(stereo[i * 2 + 1], right[i]) << i;
+  }
+}
+
+}  // namespace test
+}  // namespace audio_capture
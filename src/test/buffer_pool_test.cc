@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "buffer_pool.h"
+
+namespace audio_capture {
+namespace test {
+
+TEST(BufferPool, HandsOutEveryBufferOnce) {
+  BufferPool pool(100, 5);
+  EXPECT_EQ(pool.buffer_size(), 100u);
+  EXPECT_EQ(pool.buffer_count(), 5u);
+  EXPECT_EQ(pool.available(), 5u);
+
+  std::set<void*> buffers;
+  for (int i = 0; i < 5; ++i) {
+    void* buffer = pool.Acquire();
+    ASSERT_NE(buffer, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer) % 64, 0u);
+    EXPECT_TRUE(pool.Owns(buffer));
+    // The whole buffer is usable.
+    std::memset(buffer, i, pool.buffer_size());
+    buffers.insert(buffer);
+  }
+  EXPECT_EQ(buffers.size(), 5u);
+  EXPECT_EQ(pool.Acquire(), nullptr);
+  EXPECT_EQ(pool.available(), 0u);
+
+  void* returned = *buffers.begin();
+  pool.Release(returned);
+  EXPECT_EQ(pool.available(), 1u);
+  EXPECT_EQ(pool.Acquire(), returned);
+
+  int outside = 0;
+  EXPECT_FALSE(pool.Owns(&outside));
+  EXPECT_FALSE(pool.Owns(static_cast<uint8_t*>(returned) + 1));
+}
+
+TEST(BufferPool, EmptyPoolHasNoBuffers) {
+  BufferPool pool(64, 0);
+  EXPECT_EQ(pool.Acquire(), nullptr);
+  EXPECT_EQ(pool.available(), 0u);
+}
+
+TEST(BufferPool, NeverHandsOneBufferToTwoThreads) {
+  constexpr int kThreads = 4;
+  constexpr int kRounds = 20000;
+  BufferPool pool(sizeof(int), 3);
+  std::atomic<bool> corrupted(false);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&pool, &corrupted, t]() {
+      for (int i = 0; i < kRounds; ++i) {
+        int* buffer = static_cast<int*>(pool.Acquire());
+        if (buffer == nullptr) {
+          continue;
+        }
+        *buffer = t;
+        std::this_thread::yield();
+        if (*buffer != t) {
+          corrupted = true;
+        }
+        pool.Release(buffer);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  EXPECT_FALSE(corrupted);
+  EXPECT_EQ(pool.available(), 3u);
+}
+
+}  // namespace test
+}  // namespace audio_capture
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "compressor.h"
+
+namespace audio_capture {
+namespace test {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr int kRate = 16000;
+
+// |seconds| of a 440 Hz sine peaking at |peak_db| relative to full scale.
+std::vector<float> Sine(double peak_db, double seconds) {
+  const double amplitude = 32768.0 * std::pow(10.0, peak_db / 20.0);
+  std::vector<float> samples(static_cast<size_t>(seconds * kRate));
+  for (size_t i = 0; i < samples.size(); ++i) {
+    samples[i] =
+        static_cast<float>(amplitude * std::sin(2.0 * kPi * 440.0 * i / kRate));
+  }
+  return samples;
+}
+
+// Peak of the last half of |samples| in dBFS.
+double PeakDb(const std::vector<int16_t>& samples) {
+  int peak = 0;
+  for (size_t i = samples.size() / 2; i < samples.size(); ++i) {
+    peak = std::max(peak, std::abs(static_cast<int>(samples[i])));
+  }
+  return 20.0 * std::log10(peak / 32768.0);
+}
+
+}  // namespace
+
+TEST(Compressor, LeavesQuietAudioAlone) {
+  const std::vector<float> input = Sine(-30.0, 1.0);
+  std::vector<int16_t> output(input.size());
+  Compressor compressor(kRate);
+  compressor.Process(input.data(), output.data(), input.size());
+
+  for (size_t i = 0; i < input.size(); ++i) {
+    ASSERT_EQ(output[i], static_cast<int16_t>(std::nearbyint(input[i]))) << i;
+  }
+  EXPECT_DOUBLE_EQ(compressor.gain_db(), 0.0);
+}
+
+TEST(Compressor, WritesOneTrackOfInterleavedOutput) {
+  const std::vector<float> input = Sine(-6.0, 0.1);
+  std::vector<int16_t> mono(input.size());
+  Compressor mono_compressor(kRate);
+  mono_compressor.Process(input.data(), mono.data(), input.size());
+
+  std::vector<int16_t> stereo(input.size() * 2, 7);
+  Compressor stereo_compressor(kRate);
+  stereo_compressor.Process(input.data(), stereo.data() + 1, 300, 2);
+  stereo_compressor.Process(input.data() + 300, stereo.data() + 601,
+                            input.size() - 300, 2);
+  for (size_t i = 0; i < input.size(); ++i) {
+    ASSERT_EQ(stereo[i * 2], 7) << i;
+    ASSERT_EQ(stereo[i * 2 + 1], mono[i]) << i;
+  }
+}
+
+TEST(Compressor, CompressesAboveTheThreshold) {
+  // Peaks 12 dB over the threshold come out 3 dB over it at 4:1.
+  const std::vector<float> input = Sine(0.0, 2.0);
+  std::vector<int16_t> output(input.size());
+  CompressorOptions options;
+  options.threshold_db = -12.0;
+  options.ratio = 4.0;
+  options.ceiling_db = 0.0;
+  Compressor compressor(kRate, options);
+  compressor.Process(input.data(), output.data(), input.size());
+
+  EXPECT_NEAR(PeakDb(output), -9.0, 0.5);
+}
+
+TEST(Compressor, NeverClips) {
+  // Ten times full scale, in steady tone and sudden bursts.
+  std::vector<float> input = Sine(20.0, 2.0);
+  for (size_t i = kRate / 2; i < input.size(); i += kRate / 4) {
+    std::fill_n(input.begin() + static_cast<long>(i), 100, 327680.0f);
+  }
+  std::vector<int16_t> output(input.size());
+  CompressorOptions options;
+  options.ratio = 1.0;  // The limiter alone.
+  options.ceiling_db = -1.0;
+  Compressor compressor(kRate, options);
+  for (size_t i = 0; i < input.size(); i += 1000) {
+    const size_t count = std::min<size_t>(1000, input.size() - i);
+    compressor.Process(input.data() + i, output.data() + i, count);
+  }
+
+  const int ceiling = static_cast<int>(32768.0 * std::pow(10.0, -1.0 / 20.0));
+  for (size_t i = 0; i < output.size(); ++i) {
+    ASSERT_LE(std::abs(static_cast<int>(output[i])), ceiling) << i;
+  }
+  EXPECT_NEAR(PeakDb(output), -1.0, 0.1);
+  EXPECT_LT(compressor.gain_db(), -20.0);
+}
+
+}  // namespace test
+}  // namespace audio_capture
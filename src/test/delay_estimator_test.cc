@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "delay_estimator.h"
+
+namespace audio_capture {
+namespace test {
+
+namespace {
+
+constexpr int kRate = 16000;
+
+// |seconds| of white noise at |rms_db| dBFS RMS.
+std::vector<double> Noise(double rms_db, double seconds, unsigned seed) {
+  std::mt19937 generator(seed);
+  std::normal_distribution<double> distribution(
+      0.0, 32768.0 * std::pow(10.0, rms_db / 20.0));
+  std::vector<double> samples(static_cast<size_t>(seconds * kRate));
+  for (double& sample : samples) {
+    sample = distribution(generator);
+  }
+  return samples;
+}
+
+// |signal| |delay| samples later (earlier if negative) through a short
+// decaying room response.
+std::vector<double> Echo(const std::vector<double>& signal, long delay) {
+  const double response[] = {0.5, -0.3, 0.2, 0.1, -0.05};
+  std::vector<double> echo(signal.size());
+  for (size_t i = 0; i < echo.size(); ++i) {
+    for (size_t j = 0; j < 5; ++j) {
+      const long source = static_cast<long>(i) - delay - static_cast<long>(j);
+      if (source >= 0 && source < static_cast<long>(signal.size())) {
+        echo[i] += response[j] * signal[static_cast<size_t>(source)];
+      }
+    }
+  }
+  return echo;
+}
+
+std::vector<int16_t> ToSamples(const std::vector<double>& signal) {
+  std::vector<int16_t> samples(signal.size());
+  for (size_t i = 0; i < signal.size(); ++i) {
+    samples[i] = static_cast<int16_t>(
+        std::max(-32768.0, std::min(32767.0, std::round(signal[i]))));
+  }
+  return samples;
+}
+
+// Mixes |near_end| into |echo|.
+std::vector<double> Mix(std::vector<double> echo,
+                        const std::vector<double>& near_end) {
+  for (size_t i = 0; i < echo.size(); ++i) {
+    echo[i] += near_end[i];
+  }
+  return echo;
+}
+
+}  // namespace
+
+TEST(DelayEstimator, FindsMicrophoneDelay) {
+  const std::vector<double> far_end = Noise(-20.0, 3.0, 1);
+  const std::vector<int16_t> reference = ToSamples(far_end);
+  // 37.5 ms behind, under near-end noise 10 dB below the echo.
+  const std::vector<int16_t> microphone =
+      ToSamples(Mix(Echo(far_end, 600), Noise(-36.0, 3.0, 2)));
+
+  DelayEstimator estimator(kRate);
+  // In uneven pieces, so decimation spans calls.
+  bool estimated = false;
+  for (size_t offset = 0; offset < reference.size(); offset += 777) {
+    const size_t piece = std::min<size_t>(777, reference.size() - offset);
+    estimated = estimator.Process(microphone.data() + offset,
+                                  reference.data() + offset, piece) ||
+                estimated;
+  }
+  ASSERT_TRUE(estimated);
+  EXPECT_NEAR(estimator.estimate().delay_ms, 37.5, 0.5);
+  EXPECT_GT(estimator.estimate().confidence, 0.3);
+}
+
+TEST(DelayEstimator, FindsMicrophoneLead) {
+  const std::vector<double> far_end = Noise(-20.0, 2.0, 3);
+  const std::vector<int16_t> reference = ToSamples(far_end);
+  const std::vector<int16_t> microphone = ToSamples(Echo(far_end, -320));
+
+  DelayEstimator estimator(kRate);
+  ASSERT_TRUE(estimator.Process(microphone.data(), reference.data(),
+                                reference.size()));
+  EXPECT_NEAR(estimator.estimate().delay_ms, -20.0, 0.5);
+}
+
+TEST(DelayEstimator, HasNoConfidenceInUnrelatedStreams) {
+  const std::vector<int16_t> reference = ToSamples(Noise(-20.0, 2.0, 4));
+  const std::vector<int16_t> microphone = ToSamples(Noise(-20.0, 2.0, 5));
+
+  DelayEstimator estimator(kRate);
+  ASSERT_TRUE(estimator.Process(microphone.data(), reference.data(),
+                                reference.size()));
+  EXPECT_LT(estimator.estimate().confidence, 0.1);
+}
+
+TEST(DelayEstimator, SkipsSilence) {
+  const std::vector<int16_t> reference(3 * kRate, 0);
+  const std::vector<int16_t> microphone = ToSamples(Noise(-20.0, 3.0, 6));
+
+  DelayEstimator estimator(kRate);
+  EXPECT_FALSE(estimator.Process(microphone.data(), reference.data(),
+                                 reference.size()));
+  EXPECT_EQ(estimator.estimate().confidence, 0.0);
+}
+
+}  // namespace test
+}  // namespace audio_capture
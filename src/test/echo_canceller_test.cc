@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "echo_canceller.h"
+
+namespace audio_capture {
+namespace test {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr int kRate = 16000;
+
+// |seconds| of white noise at |rms_db| dBFS RMS.
+std::vector<double> Noise(double rms_db, double seconds, unsigned seed) {
+  std::mt19937 generator(seed);
+  std::normal_distribution<double> distribution(
+      0.0, 32768.0 * std::pow(10.0, rms_db / 20.0));
+  std::vector<double> samples(static_cast<size_t>(seconds * kRate));
+  for (double& sample : samples) {
+    sample = distribution(generator);
+  }
+  return samples;
+}
+
+// Speech-like noise: |signal| switched on and off every |period| samples.
+void Gate(std::vector<double>& signal, size_t period) {
+  for (size_t i = 0; i < signal.size(); ++i) {
+    if ((i / period) % 2 == 1) {
+      signal[i] = 0.0;
+    }
+  }
+}
+
+// The echo of |reference| |delay| samples later through a decaying room
+// response, |loss_db| weaker.
+std::vector<double> Echo(const std::vector<double>& reference, size_t delay,
+                         double loss_db) {
+  std::mt19937 generator(7);
+  std::normal_distribution<double> distribution(0.0, 1.0);
+  std::vector<double> response(kRate / 50);  // 20 ms.
+  double energy = 0.0;
+  for (size_t i = 0; i < response.size(); ++i) {
+    response[i] =
+        distribution(generator) * std::exp(-8.0 * i / response.size());
+    energy += response[i] * response[i];
+  }
+  const double scale = std::pow(10.0, -loss_db / 20.0) / std::sqrt(energy);
+  std::vector<double> echo(reference.size());
+  for (size_t i = delay; i < echo.size(); ++i) {
+    double sum = 0.0;
+    for (size_t j = 0; j < response.size() && j <= i - delay; ++j) {
+      sum += response[j] * reference[i - delay - j];
+    }
+    echo[i] = sum * scale;
+  }
+  return echo;
+}
+
+std::vector<int16_t> ToSamples(const std::vector<double>& signal) {
+  std::vector<int16_t> samples(signal.size());
+  for (size_t i = 0; i < signal.size(); ++i) {
+    samples[i] = static_cast<int16_t>(
+        std::max(-32768.0, std::min(32767.0, std::round(signal[i]))));
+  }
+  return samples;
+}
+
+// RMS of |count| samples from |start|, in dBFS.
+double RmsDb(const std::vector<int16_t>& samples, size_t start,
+             size_t count) {
+  double sum = 0.0;
+  for (size_t i = start; i < start + count; ++i) {
+    sum += static_cast<double>(samples[i]) * samples[i];
+  }
+  return 10.0 * std::log10(sum / count / (32768.0 * 32768.0) + 1e-20);
+}
+
+}  // namespace
+
+TEST(EchoCanceller, CancelsDelayedEcho) {
+  std::vector<double> far_end = Noise(-20.0, 8.0, 1);
+  Gate(far_end, kRate / 4);
+  const size_t delay = kRate / 10;  // 100 ms.
+  const std::vector<int16_t> reference = ToSamples(far_end);
+  std::vector<int16_t> microphone = ToSamples(Echo(far_end, delay, 10.0));
+  const std::vector<int16_t> input = microphone;
+
+  EchoCanceller canceller(kRate);
+  // In uneven pieces, so blocks span calls.
+  size_t offset = 0;
+  while (offset < microphone.size()) {
+    const size_t piece = std::min<size_t>(1237, microphone.size() - offset);
+    canceller.Process(microphone.data() + offset, reference.data() + offset,
+                      piece);
+    offset += piece;
+  }
+
+  const size_t block = canceller.latency();
+  EXPECT_NEAR(static_cast<double>(canceller.delay()),
+              static_cast<double>(delay), 2.0 * block);
+  // The echo of the last burst of far end.
+  const size_t start = 7 * kRate + delay;
+  const size_t count = kRate / 4;
+  EXPECT_LT(RmsDb(microphone, start + block, count),
+            RmsDb(input, start, count) - 20.0);
+  EXPECT_GT(canceller.erle_db(), 15.0);
+}
+
+TEST(EchoCanceller, KeepsNearEndDuringDoubleTalk) {
+  std::vector<double> far_end = Noise(-20.0, 6.0, 2);
+  const std::vector<int16_t> reference = ToSamples(far_end);
+  std::vector<double> microphone_signal = Echo(far_end, kRate / 20, 10.0);
+  // A near-end tone well above the echo over the last two seconds.
+  const double amplitude = 32768.0 * std::sqrt(2.0) * std::pow(10.0, -0.5);
+  for (size_t i = 4 * kRate; i < microphone_signal.size(); ++i) {
+    microphone_signal[i] += amplitude * std::sin(2.0 * kPi * 440.0 * i / kRate);
+  }
+  std::vector<int16_t> microphone = ToSamples(microphone_signal);
+  const std::vector<int16_t> input = microphone;
+
+  EchoCanceller canceller(kRate);
+  canceller.Process(microphone.data(), reference.data(), microphone.size());
+
+  EXPECT_TRUE(canceller.double_talk());
+  const size_t block = canceller.latency();
+  const size_t start = 5 * kRate;
+  const size_t count = kRate / 2;
+  EXPECT_NEAR(RmsDb(microphone, start + block, count),
+              RmsDb(input, start, count), 1.0);
+}
+
+TEST(EchoCanceller, PassesMicrophoneWithoutFarEnd) {
+  EchoCanceller canceller(kRate);
+  EXPECT_EQ(canceller.latency(), 64u);
+
+  const std::vector<int16_t> input = ToSamples(Noise(-30.0, 0.5, 3));
+  std::vector<int16_t> microphone = input;
+  const std::vector<int16_t> reference(input.size(), 0);
+  canceller.Process(microphone.data(), reference.data(), microphone.size());
+
+  const size_t latency = canceller.latency();
+  for (size_t i = 0; i < latency; ++i) {
+    ASSERT_EQ(microphone[i], 0) << i;
+  }
+  for (size_t i = latency; i < microphone.size(); ++i) {
+    ASSERT_LE(std::abs(microphone[i] - input[i - latency]), 1) << i;
+  }
+}
+
+}  // namespace test
+}  // namespace audio_capture
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "fft.h"
+
+namespace audio_capture {
+namespace test {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+}  // namespace
+
+TEST(Fft, MatchesDirectTransform) {
+  std::mt19937 generator(1);
+  std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+  for (size_t size : {4u, 8u, 64u, 512u}) {
+    std::vector<float> input(size);
+    for (float& sample : input) {
+      sample = distribution(generator);
+    }
+    Fft fft(size);
+    std::vector<float> real(fft.bins());
+    std::vector<float> imag(fft.bins());
+    fft.Forward(input.data(), real.data(), imag.data());
+    for (size_t k = 0; k < fft.bins(); ++k) {
+      double expected_real = 0.0;
+      double expected_imag = 0.0;
+      for (size_t n = 0; n < size; ++n) {
+        const double angle = -2.0 * kPi * static_cast<double>(k * n) /
+                             static_cast<double>(size);
+        expected_real += input[n] * std::cos(angle);
+        expected_imag += input[n] * std::sin(angle);
+      }
+      EXPECT_NEAR(real[k], expected_real, 1e-3) << size << " bin " << k;
+      EXPECT_NEAR(imag[k], expected_imag, 1e-3) << size << " bin " << k;
+    }
+  }
+}
+
+TEST(Fft, FindsSinePower) {
+  // A sine on bin 16 of 256 has all its power there: (256 / 2)^2.
+  std::vector<float> input(256);
+  for (size_t n = 0; n < input.size(); ++n) {
+    input[n] = static_cast<float>(std::sin(2.0 * kPi * 16.0 * n / 256.0));
+  }
+  Fft fft(256);
+  std::vector<float> power(fft.bins());
+  fft.PowerSpectrum(input.data(), power.data());
+  EXPECT_NEAR(power[16], 128.0 * 128.0, 1.0);
+  for (size_t k = 0; k < power.size(); ++k) {
+    if (k != 16) {
+      EXPECT_LT(power[k], 1e-3) << k;
+    }
+  }
+}
+
+TEST(Fft, InverseUndoesForward) {
+  std::mt19937 generator(2);
+  std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+  for (size_t size : {4u, 8u, 64u, 512u}) {
+    std::vector<float> input(size);
+    for (float& sample : input) {
+      sample = distribution(generator);
+    }
+    Fft fft(size);
+    std::vector<float> real(fft.bins());
+    std::vector<float> imag(fft.bins());
+    fft.Forward(input.data(), real.data(), imag.data());
+    std::vector<float> output(size);
+    fft.Inverse(real.data(), imag.data(), output.data());
+    for (size_t n = 0; n < size; ++n) {
+      EXPECT_NEAR(output[n], input[n], 1e-5) << size << " sample " << n;
+    }
+  }
+}
+
+TEST(Fft, RoundsSizesUpToPowersOfTwo) {
+  EXPECT_EQ(NextPowerOfTwo(1), 1u);
+  EXPECT_EQ(NextPowerOfTwo(400), 512u);
+  EXPECT_EQ(NextPowerOfTwo(512), 512u);
+}
+
+}  // namespace test
+}  // namespace audio_capture
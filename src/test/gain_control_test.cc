@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "gain_control.h"
+
+namespace audio_capture {
+namespace test {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr int kRate = 16000;
+
+// |seconds| of a 1 kHz sine at |rms_db| dBFS RMS.
+std::vector<int16_t> Sine(double rms_db, double seconds) {
+  const double amplitude = 32768.0 * std::sqrt(2.0) *
+                           std::pow(10.0, rms_db / 20.0);
+  std::vector<int16_t> samples(static_cast<size_t>(seconds * kRate));
+  for (size_t i = 0; i < samples.size(); ++i) {
+    samples[i] = static_cast<int16_t>(std::max(
+        -32768.0,
+        std::min(32767.0, amplitude * std::sin(2.0 * kPi * 1000.0 * i /
+                                               kRate))));
+  }
+  return samples;
+}
+
+// RMS of the last |seconds| of |samples|, in dBFS.
+double TailRmsDb(const std::vector<int16_t>& samples, double seconds) {
+  const size_t count = static_cast<size_t>(seconds * kRate);
+  double sum = 0.0;
+  for (size_t i = samples.size() - count; i < samples.size(); ++i) {
+    sum += static_cast<double>(samples[i]) * samples[i];
+  }
+  return 10.0 * std::log10(sum / count / (32768.0 * 32768.0));
+}
+
+int PeakOf(const std::vector<int16_t>& samples) {
+  int peak = 0;
+  for (int16_t sample : samples) {
+    peak = std::max(peak, std::abs(static_cast<int>(sample)));
+  }
+  return peak;
+}
+
+}  // namespace
+
+TEST(AutomaticGainControl, ConvergesToTheTarget) {
+  for (AgcDetector detector : {AgcDetector::kRms, AgcDetector::kLoudness}) {
+    for (double input_db : {-45.0, -30.0, -8.0}) {
+      AgcOptions options;
+      options.detector = detector;
+      options.target_db = -20.0;
+      AutomaticGainControl agc(kRate, options);
+      std::vector<int16_t> samples = Sine(input_db, 10.0);
+      agc.Process(samples.data(), samples.size());
+      EXPECT_NEAR(TailRmsDb(samples, 1.0), -20.0, 1.0)
+          << static_cast<int>(detector) << " " << input_db;
+      EXPECT_NEAR(agc.gain_db(), -20.0 - input_db, 1.0);
+    }
+  }
+
+  // The gain stops at its bounds.
+  AgcOptions options;
+  options.max_gain_db = 12.0;
+  AutomaticGainControl agc(kRate, options);
+  std::vector<int16_t> samples = Sine(-50.0, 10.0);
+  agc.Process(samples.data(), samples.size());
+  EXPECT_NEAR(agc.gain_db(), 12.0, 0.1);
+}
+
+TEST(AutomaticGainControl, LimiterKeepsPeaksUnderTheCeiling) {
+  AgcOptions options;
+  options.ceiling_db = -1.0;
+  AutomaticGainControl agc(kRate, options);
+  // Settle at a high gain on quiet speech, then a shout arrives at once.
+  std::vector<int16_t> samples = Sine(-45.0, 5.0);
+  const std::vector<int16_t> loud = Sine(-3.0, 1.0);
+  samples.insert(samples.end(), loud.begin(), loud.end());
+  agc.Process(samples.data(), samples.size());
+
+  const int ceiling = static_cast<int>(32768.0 * std::pow(10.0, -1.0 / 20.0));
+  EXPECT_LE(PeakOf(samples), ceiling + 1);
+  EXPECT_LT(agc.limiter_gain_db(), 0.0);
+
+  // Without the look-ahead the same shout would have clipped.
+  EXPECT_GT(agc.gain_db() + 0.0, -30.0);
+}
+
+TEST(AutomaticGainControl, HoldsTheGainThroughSilence) {
+  AgcOptions options;
+  AutomaticGainControl agc(kRate, options);
+  std::vector<int16_t> speech = Sine(-35.0, 5.0);
+  agc.Process(speech.data(), speech.size());
+  const double gain = agc.gain_db();
+  EXPECT_NEAR(gain, 15.0, 1.0);
+
+  // Far below the gate: the gain neither climbs nor falls.
+  std::vector<int16_t> silence = Sine(-80.0, 5.0);
+  agc.Process(silence.data(), silence.size());
+  EXPECT_NEAR(agc.gain_db(), gain, 0.1);
+}
+
+TEST(AutomaticGainControl, DelaysByTheLookAhead) {
+  AgcOptions options;
+  options.lookahead_ms = 5;
+  options.max_gain_db = 0.0;
+  options.min_gain_db = 0.0;
+  AutomaticGainControl agc(kRate, options);
+  EXPECT_EQ(agc.latency(), 80u);
+
+  std::vector<int16_t> samples(400, 0);
+  samples[10] = 8000;
+  // In pieces, so the delay spans calls.
+  agc.Process(samples.data(), 50);
+  agc.Process(samples.data() + 50, samples.size() - 50);
+  for (size_t i = 0; i < samples.size(); ++i) {
+    EXPECT_EQ(samples[i], i == 90 ? 8000 : 0) << i;
+  }
+}
+
+}  // namespace test
+}  // namespace audio_capture
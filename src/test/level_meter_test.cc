@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "level_meter.h"
+
+namespace audio_capture {
+namespace test {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+std::vector<int16_t> Sine(double frequency, int rate, size_t frames,
+                          int channels, double amplitude) {
+  std::vector<int16_t> samples(frames * channels);
+  for (size_t i = 0; i < frames; ++i) {
+    const int16_t value = static_cast<int16_t>(
+        amplitude * 32767.0 * std::sin(2.0 * kPi * frequency * i / rate));
+    for (int c = 0; c < channels; ++c) {
+      samples[i * channels + c] = value;
+    }
+  }
+  return samples;
+}
+
+}  // namespace
+
+TEST(LevelMeter, MeasuresFullScaleSineAtMinus3Db) {
+  const std::vector<int16_t> sine = Sine(1000.0, 48000, 4800, 1, 1.0);
+  EXPECT_NEAR(MeasureLevel(sine.data(), sine.size()), -3.01, 0.05);
+
+  LevelMeter meter(48000, 4800, 1);
+  MeterReading reading;
+  ASSERT_EQ(meter.Process(sine.data(), 4800, &reading, 1), 1u);
+  EXPECT_NEAR(reading.rms, -3.01, 0.05);
+  EXPECT_NEAR(reading.peak, 0.0, 0.01);
+}
+
+TEST(LevelMeter, ReportsSilenceAsFloor) {
+  const std::vector<int16_t> silence(160, 0);
+  EXPECT_EQ(MeasureLevel(silence.data(), silence.size()), kMinLevelDb);
+  EXPECT_EQ(MeasureLevel(nullptr, 0), kMinLevelDb);
+
+  LevelMeter meter(16000, 160, 1);
+  MeterReading reading;
+  ASSERT_EQ(meter.Process(silence.data(), 160, &reading, 1), 1u);
+  EXPECT_EQ(reading.rms, kMinLevelDb);
+  EXPECT_EQ(reading.peak, kMinLevelDb);
+  EXPECT_EQ(reading.peak_hold, kMinLevelDb);
+}
+
+TEST(LevelMeter, BlocksSpanChunksLikeOneMeasurement) {
+  const size_t kBlock = 533;  // 30 Hz at 16 kHz.
+  const std::vector<int16_t> sine = Sine(440.0, 16000, kBlock * 6, 1, 0.3);
+
+  LevelMeter meter(16000, kBlock, 1);
+  std::vector<double> levels;
+  size_t offset = 0;
+  const size_t chunks[] = {100, 1, 900, 533, 1066, 98};
+  for (size_t chunk : chunks) {
+    const size_t frames_to_next = meter.frames_to_next_level();
+    std::vector<MeterReading> chunk_levels(meter.MaxLevels(chunk));
+    const size_t written = meter.Process(sine.data() + offset, chunk,
+                                         chunk_levels.data(),
+                                         chunk_levels.size());
+    EXPECT_EQ(written, chunk_levels.size());
+    for (size_t i = 0; i < written; ++i) {
+      // Each level ends where the meter said it would.
+      const size_t end = offset + frames_to_next + i * kBlock;
+      EXPECT_EQ(end % kBlock, 0u);
+      levels.push_back(chunk_levels[i].rms);
+    }
+    offset += chunk;
+  }
+
+  ASSERT_EQ(levels.size(), 5u);
+  for (size_t i = 0; i < levels.size(); ++i) {
+    EXPECT_NEAR(levels[i], MeasureLevel(sine.data() + i * kBlock, kBlock),
+                1e-4);
+  }
+  EXPECT_EQ(meter.frames_to_next_level(), 500u);
+}
+
+TEST(LevelMeter, DownmixesAndScalesLikeTheCapturePath) {
+  std::vector<int16_t> stereo(200 * 2);
+  std::vector<int16_t> mono(200);
+  for (size_t i = 0; i < 200; ++i) {
+    stereo[i * 2] = static_cast<int16_t>(i * 50);
+    stereo[i * 2 + 1] = static_cast<int16_t>(-static_cast<int>(i) * 10);
+    const float mixed =
+        (static_cast<float>(stereo[i * 2]) + stereo[i * 2 + 1]) / 2.0f * 2.5f;
+    mono[i] = static_cast<int16_t>(std::max(-32768.0f,
+                                            std::min(32767.0f, mixed)));
+  }
+
+  LevelMeter meter(16000, 200, 2, 2.5f);
+  MeterReading reading;
+  ASSERT_EQ(meter.Process(stereo.data(), 200, &reading, 1), 1u);
+  EXPECT_NEAR(reading.rms, MeasureLevel(mono.data(), mono.size()), 1e-3);
+}
+
+TEST(LevelMeter, ResetDropsThePartialBlock) {
+  const std::vector<int16_t> loud(100, 20000);
+  const std::vector<int16_t> quiet(100, 100);
+  LevelMeter meter(16000, 100, 1);
+  MeterReading reading;
+  EXPECT_EQ(meter.Process(loud.data(), 60, &reading, 1), 0u);
+  meter.Reset();
+  EXPECT_EQ(meter.frames_to_next_level(), 100u);
+  ASSERT_EQ(meter.Process(quiet.data(), 100, &reading, 1), 1u);
+  EXPECT_NEAR(reading.rms, MeasureLevel(quiet.data(), quiet.size()), 1e-3);
+}
+
+TEST(LevelMeter, MeasuresBlocksBeyondTheOutputCapacity) {
+  const std::vector<int16_t> samples(1000, 1000);
+  LevelMeter meter(16000, 100, 1);
+  MeterReading reading;
+  EXPECT_EQ(meter.MaxLevels(1000), 10u);
+  EXPECT_EQ(meter.Process(samples.data(), 1000, &reading, 1), 1u);
+  EXPECT_EQ(meter.frames_to_next_level(), 100u);
+}
+
+TEST(LevelMeter, AveragesRmsOverTheWindow) {
+  // 10 ms blocks, a 40 ms window: a burst of one loud block is averaged
+  // with the blocks before it, and leaves the window after four blocks.
+  MeterOptions options;
+  options.window_ms = 40;
+  LevelMeter meter(16000, 160, 1, 1.0f, options);
+  const std::vector<int16_t> loud(160, 16000);
+  const std::vector<int16_t> silence(160, 0);
+  MeterReading reading;
+
+  for (int i = 0; i < 4; ++i) {
+    meter.Process(silence.data(), 160, &reading, 1);
+  }
+  meter.Process(loud.data(), 160, &reading, 1);
+  const double block_level = MeasureLevel(loud.data(), loud.size());
+  // A quarter of the power: 6 dB down.
+  EXPECT_NEAR(reading.rms, block_level - 6.02, 0.01);
+  for (int i = 0; i < 3; ++i) {
+    meter.Process(silence.data(), 160, &reading, 1);
+    EXPECT_NEAR(reading.rms, block_level - 6.02, 0.01);
+  }
+  meter.Process(silence.data(), 160, &reading, 1);
+  EXPECT_EQ(reading.rms, kMinLevelDb);
+}
+
+TEST(LevelMeter, PeakFollowsAttackAndRelease) {
+  MeterOptions options;
+  options.attack_ms = 10;
+  options.release_ms = 100;
+  LevelMeter meter(16000, 160, 1, 1.0f, options);  // 10 ms blocks.
+  std::vector<int16_t> loud(160, 0);
+  loud[80] = 32767;
+  const std::vector<int16_t> silence(160, 0);
+  MeterReading reading;
+
+  // One time constant of attack reaches 1 - 1/e of the peak.
+  meter.Process(loud.data(), 160, &reading, 1);
+  EXPECT_NEAR(reading.peak, 20.0 * std::log10(1.0 - std::exp(-1.0)), 0.01);
+  for (int i = 0; i < 20; ++i) {
+    meter.Process(loud.data(), 160, &reading, 1);
+  }
+  EXPECT_NEAR(reading.peak, 0.0, 0.01);
+
+  // Release falls by a factor of e per 100 ms: 8.7 dB.
+  for (int i = 0; i < 10; ++i) {
+    meter.Process(silence.data(), 160, &reading, 1);
+  }
+  EXPECT_NEAR(reading.peak, -8.69, 0.05);
+}
+
+TEST(LevelMeter, HoldsThePeak) {
+  MeterOptions options;
+  options.hold_ms = 50;
+  LevelMeter meter(16000, 160, 1, 1.0f, options);  // 10 ms blocks.
+  const std::vector<int16_t> loud(160, 16384);
+  const std::vector<int16_t> quiet(160, 1024);
+  MeterReading reading;
+
+  meter.Process(loud.data(), 160, &reading, 1);
+  const double loud_db = reading.peak;
+  EXPECT_EQ(reading.peak_hold, loud_db);
+  for (int i = 0; i < 5; ++i) {
+    meter.Process(quiet.data(), 160, &reading, 1);
+    EXPECT_LT(reading.peak, loud_db - 20.0);
+    EXPECT_EQ(reading.peak_hold, loud_db);
+  }
+  meter.Process(quiet.data(), 160, &reading, 1);
+  EXPECT_EQ(reading.peak_hold, reading.peak);
+}
+
+}  // namespace test
+}  // namespace audio_capture
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "loudness_meter.h"
+
+namespace audio_capture {
+namespace test {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// |seconds| of a sine with peak level |peak_db| dBFS on every channel.
+std::vector<int16_t> Sine(double frequency, int rate, double seconds,
+                          int channels, double peak_db, double phase = 0.0) {
+  const size_t frames = static_cast<size_t>(seconds * rate);
+  const double amplitude = 32768.0 * std::pow(10.0, peak_db / 20.0);
+  std::vector<int16_t> samples(frames * channels);
+  for (size_t i = 0; i < frames; ++i) {
+    const int16_t value = static_cast<int16_t>(std::lround(
+        amplitude * std::sin(2.0 * kPi * frequency * i / rate + phase)));
+    for (int c = 0; c < channels; ++c) {
+      samples[i * channels + c] = value;
+    }
+  }
+  return samples;
+}
+
+void Feed(LoudnessMeter* meter, const std::vector<int16_t>& samples,
+          int channels) {
+  // In uneven pieces, as reads deliver them.
+  const size_t frames = samples.size() / channels;
+  size_t offset = 0;
+  for (size_t piece = 1; offset < frames; piece = piece * 3 % 4801) {
+    const size_t count = std::min(piece, frames - offset);
+    meter->Process(samples.data() + offset * channels, count);
+    offset += count;
+  }
+}
+
+}  // namespace
+
+TEST(LoudnessMeter, ReadsReferenceToneAtMinus23Lufs) {
+  // EBU Tech 3341: a stereo 1 kHz sine at -23 dBFS reads -23 LUFS.
+  for (int rate : {44100, 48000}) {
+    LoudnessMeter meter(rate, 2);
+    Feed(&meter, Sine(1000.0, rate, 20.0, 2, -23.0), 2);
+    const LoudnessReading reading = meter.Reading();
+    EXPECT_NEAR(reading.momentary, -23.0, 0.1) << rate;
+    EXPECT_NEAR(reading.short_term, -23.0, 0.1) << rate;
+    EXPECT_NEAR(reading.integrated, -23.0, 0.1) << rate;
+    EXPECT_NEAR(reading.range, 0.0, 0.2) << rate;
+  }
+}
+
+TEST(LoudnessMeter, ReportsSilenceAsFloor) {
+  LoudnessMeter meter(16000, 1);
+  Feed(&meter, std::vector<int16_t>(16000 * 5, 0), 1);
+  const LoudnessReading reading = meter.Reading();
+  EXPECT_EQ(reading.momentary, kMinLevelDb);
+  EXPECT_EQ(reading.short_term, kMinLevelDb);
+  EXPECT_EQ(reading.integrated, kMinLevelDb);
+  EXPECT_EQ(reading.range, 0.0);
+  EXPECT_EQ(reading.true_peak, kMinLevelDb);
+}
+
+TEST(LoudnessMeter, GatesSilenceAndQuietPassages) {
+  LoudnessMeter meter(48000, 2);
+  Feed(&meter, Sine(1000.0, 48000, 10.0, 2, -20.0), 2);
+  const double loud = meter.Reading().integrated;
+  EXPECT_NEAR(loud, -20.0, 0.1);
+
+  // Below the absolute gate.
+  Feed(&meter, std::vector<int16_t>(48000 * 2 * 10, 0), 2);
+  EXPECT_NEAR(meter.Reading().integrated, loud, 0.1);
+  // Above it, but more than 10 LU below the loud passage.
+  Feed(&meter, Sine(1000.0, 48000, 10.0, 2, -40.0), 2);
+  EXPECT_NEAR(meter.Reading().integrated, loud, 0.1);
+  EXPECT_NEAR(meter.Reading().momentary, -40.0, 0.1);
+}
+
+TEST(LoudnessMeter, MeasuresLoudnessRange) {
+  // EBU Tech 3342: 20 s at -20 LUFS, then 20 s at -30 LUFS, is 10 LU.
+  LoudnessMeter meter(48000, 2);
+  Feed(&meter, Sine(1000.0, 48000, 20.0, 2, -20.0), 2);
+  Feed(&meter, Sine(1000.0, 48000, 20.0, 2, -30.0), 2);
+  EXPECT_NEAR(meter.Reading().range, 10.0, 0.2);
+}
+
+TEST(LoudnessMeter, FindsPeaksBetweenSamples) {
+  // A quarter of the sample rate, 45 degrees off: every sample is 3 dB
+  // below the peak of the wave.
+  LoudnessMeter meter(48000, 1);
+  Feed(&meter, Sine(12000.0, 48000, 1.0, 1, -6.0, kPi / 4.0), 1);
+  EXPECT_NEAR(meter.Reading().true_peak, -6.0, 0.3);
+}
+
+TEST(LoudnessMeter, AppliesTheGain) {
+  LoudnessMeter meter(48000, 2, 0.5f);
+  Feed(&meter, Sine(1000.0, 48000, 5.0, 2, -17.0), 2);
+  EXPECT_NEAR(meter.Reading().momentary, -23.0, 0.1);
+  EXPECT_NEAR(meter.Reading().true_peak, -23.0, 0.1);
+}
+
+}  // namespace test
+}  // namespace audio_capture
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "mel_spectrogram.h"
+
+namespace audio_capture {
+namespace test {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr int kRate = 16000;
+
+std::vector<int16_t> Sine(double frequency, double seconds) {
+  std::vector<int16_t> samples(static_cast<size_t>(seconds * kRate));
+  for (size_t i = 0; i < samples.size(); ++i) {
+    samples[i] = static_cast<int16_t>(
+        8000.0 * std::sin(2.0 * kPi * frequency * i / kRate));
+  }
+  return samples;
+}
+
+// Feeds |samples| in pieces of |piece| and returns every frame.
+std::vector<float> Extract(MelSpectrogram* mel,
+                           const std::vector<int16_t>& samples,
+                           size_t piece) {
+  std::vector<float> frames;
+  for (size_t offset = 0; offset < samples.size(); offset += piece) {
+    const size_t count = std::min(piece, samples.size() - offset);
+    std::vector<float> out(mel->MaxFrames(count) * mel->bins());
+    const size_t written = mel->Process(samples.data() + offset, count,
+                                        out.data(), out.size() / mel->bins());
+    frames.insert(frames.end(), out.begin(),
+                  out.begin() + written * mel->bins());
+  }
+  return frames;
+}
+
+}  // namespace
+
+TEST(MelSpectrogram, FramesEveryHop) {
+  MelSpectrogram mel(kRate);
+  EXPECT_EQ(mel.bins(), 80u);
+  EXPECT_EQ(mel.window_samples(), 400u);
+  EXPECT_EQ(mel.hop_samples(), 160u);
+
+  // (16000 - 400) / 160 + 1 frames in a second, however it arrives.
+  const std::vector<int16_t> samples = Sine(440.0, 1.0);
+  const std::vector<float> whole = Extract(&mel, samples, samples.size());
+  EXPECT_EQ(whole.size(), 98u * 80u);
+  EXPECT_EQ(mel.frame_count(), 98u);
+
+  for (size_t piece : {1u, 97u, 160u, 1024u}) {
+    MelSpectrogram streamed(kRate);
+    const std::vector<float> frames = Extract(&streamed, samples, piece);
+    ASSERT_EQ(frames.size(), whole.size()) << piece;
+    for (size_t i = 0; i < frames.size(); ++i) {
+      ASSERT_FLOAT_EQ(frames[i], whole[i]) << piece << " at " << i;
+    }
+  }
+}
+
+TEST(MelSpectrogram, PeaksAtTheToneFrequency) {
+  MelOptions options;
+  options.bins = 40;
+  options.low_hz = 0.0;
+  MelSpectrogram mel(kRate, options);
+  // The filters are centred on mel points spaced evenly up to 8 kHz; a tone
+  // at the centre of filter 20 peaks there.
+  const double step = 2595.0 * std::log10(1.0 + 8000.0 / 700.0) / 41.0;
+  const double center_hz =
+      700.0 * (std::pow(10.0, 21.0 * step / 2595.0) - 1.0);
+  const std::vector<float> frames = Extract(&mel, Sine(center_hz, 0.5), 800);
+  ASSERT_GE(frames.size(), 40u);
+  const float* last = frames.data() + frames.size() - 40;
+  EXPECT_EQ(std::max_element(last, last + 40) - last, 20);
+}
+
+TEST(MelSpectrogram, ClampsSilenceToTheLogFloor) {
+  MelSpectrogram mel(kRate);
+  const std::vector<float> frames =
+      Extract(&mel, std::vector<int16_t>(kRate / 10, 0), 320);
+  ASSERT_FALSE(frames.empty());
+  for (float value : frames) {
+    EXPECT_FLOAT_EQ(value, std::log(1e-10f));
+  }
+}
+
+TEST(MelSpectrogram, ResetStartsANewStream) {
+  MelSpectrogram mel(kRate);
+  const std::vector<int16_t> samples = Sine(1000.0, 0.1);
+  Extract(&mel, std::vector<int16_t>(250, 1000), 250);
+  mel.Reset();
+  const std::vector<float> after_reset = Extract(&mel, samples, 512);
+  MelSpectrogram fresh(kRate);
+  EXPECT_EQ(after_reset, Extract(&fresh, samples, 512));
+  EXPECT_EQ(mel.frame_count(), fresh.frame_count());
+}
+
+}  // namespace test
+}  // namespace audio_capture
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "noise_suppressor.h"
+
+namespace audio_capture {
+namespace test {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr int kRate = 16000;
+
+// |seconds| of white noise at |rms_db| dBFS RMS.
+std::vector<double> Noise(double rms_db, double seconds, unsigned seed) {
+  std::mt19937 generator(seed);
+  std::normal_distribution<double> distribution(
+      0.0, 32768.0 * std::pow(10.0, rms_db / 20.0));
+  std::vector<double> samples(static_cast<size_t>(seconds * kRate));
+  for (double& sample : samples) {
+    sample = distribution(generator);
+  }
+  return samples;
+}
+
+std::vector<int16_t> ToSamples(const std::vector<double>& signal) {
+  std::vector<int16_t> samples(signal.size());
+  for (size_t i = 0; i < signal.size(); ++i) {
+    samples[i] = static_cast<int16_t>(
+        std::max(-32768.0, std::min(32767.0, std::round(signal[i]))));
+  }
+  return samples;
+}
+
+// RMS of |count| samples from |start|, in dBFS.
+double RmsDb(const std::vector<int16_t>& samples, size_t start,
+             size_t count) {
+  double sum = 0.0;
+  for (size_t i = start; i < start + count; ++i) {
+    sum += static_cast<double>(samples[i]) * samples[i];
+  }
+  return 10.0 * std::log10(sum / count / (32768.0 * 32768.0));
+}
+
+}  // namespace
+
+TEST(NoiseSuppressor, AttenuatesSteadyNoise) {
+  NoiseOptions options;
+  options.suppression_db = 12.0;
+  NoiseSuppressor suppressor(kRate, options);
+  std::vector<int16_t> samples = ToSamples(Noise(-40.0, 4.0, 1));
+  suppressor.Process(samples.data(), samples.size());
+
+  // Learned within the first second, then held near the floor.
+  const double output_db = RmsDb(samples, 2 * kRate, 2 * kRate);
+  EXPECT_LT(output_db, -40.0 - 9.0);
+  EXPECT_GT(output_db, -40.0 - 14.0);
+}
+
+TEST(NoiseSuppressor, KeepsSpeechOverNoise) {
+  NoiseSuppressor suppressor(kRate);
+  // Two seconds of noise, then a 1 kHz tone 30 dB above it for 300 ms.
+  std::vector<double> signal = Noise(-50.0, 2.3, 2);
+  const double amplitude = 32768.0 * std::sqrt(2.0) * std::pow(10.0, -1.0);
+  for (size_t i = 2 * kRate; i < signal.size(); ++i) {
+    signal[i] += amplitude * std::sin(2.0 * kPi * 1000.0 * i / kRate);
+  }
+  std::vector<int16_t> samples = ToSamples(signal);
+  const std::vector<int16_t> input = samples;
+  suppressor.Process(samples.data(), samples.size());
+
+  const size_t latency = suppressor.latency();
+  const size_t start = 2 * kRate + kRate / 20;
+  const size_t count = kRate / 5;
+  EXPECT_NEAR(RmsDb(samples, start + latency, count),
+              RmsDb(input, start, count), 0.5);
+}
+
+TEST(NoiseSuppressor, ReconstructsWithoutSuppression) {
+  NoiseOptions options;
+  options.suppression_db = 0.0;
+  NoiseSuppressor suppressor(kRate, options);
+  EXPECT_EQ(suppressor.latency(), 256u);
+
+  const std::vector<int16_t> input = ToSamples(Noise(-20.0, 0.5, 3));
+  std::vector<int16_t> samples = input;
+  // In uneven pieces, so frames span calls.
+  size_t offset = 0;
+  for (size_t piece : {100u, 1000u, 37u}) {
+    suppressor.Process(samples.data() + offset, piece);
+    offset += piece;
+  }
+  suppressor.Process(samples.data() + offset, samples.size() - offset);
+
+  const size_t latency = suppressor.latency();
+  for (size_t i = 0; i < latency; ++i) {
+    ASSERT_EQ(samples[i], 0) << i;
+  }
+  for (size_t i = latency; i < samples.size(); ++i) {
+    ASSERT_LE(std::abs(samples[i] - input[i - latency]), 1) << i;
+  }
+}
+
+}  // namespace test
+}  // namespace audio_capture
@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "resampler.h"
+
+namespace audio_capture {
+namespace test {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+std::vector<float> Sine(double frequency, int rate, size_t frames,
+                        float amplitude = 0.5f) {
+  std::vector<float> samples(frames);
+  for (size_t i = 0; i < frames; ++i) {
+    samples[i] = amplitude * static_cast<float>(std::sin(
+                                 2.0 * kPi * frequency * i / rate));
+  }
+  return samples;
+}
+
+double Rms(const std::vector<float>& samples, size_t skip) {
+  double sum = 0.0;
+  for (size_t i = skip; i < samples.size(); ++i) {
+    sum += samples[i] * samples[i];
+  }
+  return std::sqrt(sum / (samples.size() - skip));
+}
+
+// Converts |input| in chunks of |chunk_frames| frames.
+std::vector<float> ResampleInChunks(Resampler* resampler,
+                                    const std::vector<float>& input,
+                                    size_t chunk_frames) {
+  std::vector<float> output;
+  std::vector<float> buffer;
+  for (size_t offset = 0; offset < input.size(); offset += chunk_frames) {
+    const size_t frames = std::min(chunk_frames, input.size() - offset);
+    buffer.resize(resampler->MaxOutputFrames(frames));
+    const size_t produced = resampler->Process(input.data() + offset, frames,
+                                               buffer.data(), buffer.size());
+    output.insert(output.end(), buffer.begin(), buffer.begin() + produced);
+  }
+  return output;
+}
+
+}  // namespace
+
+TEST(Resampler, PassesEqualRatesThrough) {
+  Resampler resampler(16000, 16000, 2);
+  const std::vector<int16_t> input = {1, -1, 2, -2, 3, -3};
+  std::vector<int16_t> output(resampler.MaxOutputFrames(3) * 2);
+  ASSERT_EQ(resampler.Process(input.data(), 3, output.data(), 3), 3u);
+  output.resize(6);
+  EXPECT_EQ(output, input);
+  EXPECT_EQ(resampler.latency_frames(), 0u);
+}
+
+TEST(Resampler, ProducesFramesAtOutputRate) {
+  const int rates[][2] = {
+      {48000, 16000}, {44100, 16000}, {44100, 48000}, {16000, 48000},
+      {48000, 44100}, {44101, 16000},
+  };
+  for (const auto& rate : rates) {
+    Resampler resampler(rate[0], rate[1], 1);
+    const std::vector<float> input(static_cast<size_t>(rate[0]), 0.0f);
+    const std::vector<float> output = ResampleInChunks(&resampler, input, 441);
+    // One second in, one second out minus the filter delay.
+    const double expected =
+        rate[1] - static_cast<double>(resampler.latency_frames()) * rate[1] /
+                      rate[0];
+    EXPECT_NEAR(static_cast<double>(output.size()), expected, 1.0)
+        << rate[0] << " -> " << rate[1];
+  }
+}
+
+TEST(Resampler, ChunkingDoesNotChangeOutput) {
+  const std::vector<float> input = Sine(440.0, 44100, 44100);
+
+  Resampler whole(44100, 16000, 1);
+  const std::vector<float> expected = ResampleInChunks(&whole, input, 44100);
+
+  // Chunk sizes that leave a different fractional position at every
+  // boundary.
+  for (size_t chunk_frames : {1, 37, 441, 1000}) {
+    Resampler chunked(44100, 16000, 1);
+    const std::vector<float> output =
+        ResampleInChunks(&chunked, input, chunk_frames);
+    ASSERT_EQ(output.size(), expected.size()) << chunk_frames;
+    for (size_t i = 0; i < output.size(); ++i) {
+      ASSERT_EQ(output[i], expected[i]) << chunk_frames << " at " << i;
+    }
+  }
+}
+
+TEST(Resampler, KeepsPassbandLevel) {
+  for (ResamplerQuality quality :
+       {ResamplerQuality::kLow, ResamplerQuality::kMedium,
+        ResamplerQuality::kHigh}) {
+    Resampler resampler(48000, 16000, 1, quality);
+    const std::vector<float> output =
+        ResampleInChunks(&resampler, Sine(1000.0, 48000, 48000), 480);
+    // A full-scale-0.5 sine has an RMS of 0.5 / sqrt(2).
+    EXPECT_NEAR(Rms(output, 1000), 0.5 / std::sqrt(2.0), 0.01);
+  }
+}
+
+TEST(Resampler, RejectsContentAboveOutputNyquist) {
+  // 12 kHz folds back to 4 kHz at 16 kHz unless filtered.
+  Resampler resampler(48000, 16000, 1);
+  const std::vector<float> output =
+      ResampleInChunks(&resampler, Sine(12000.0, 48000, 48000), 480);
+  const double rejection_db =
+      20.0 * std::log10(Rms(output, 1000) / (0.5 / std::sqrt(2.0)));
+  EXPECT_LT(rejection_db, -60.0);
+}
+
+TEST(Resampler, ConvertsIncommensurateRates) {
+  // 44101 and 16000 share no factor; the filter rows are interpolated.
+  Resampler resampler(44101, 16000, 1);
+  const std::vector<float> output =
+      ResampleInChunks(&resampler, Sine(1000.0, 44101, 44101), 441);
+  EXPECT_NEAR(Rms(output, 1000), 0.5 / std::sqrt(2.0), 0.01);
+
+  // The sine keeps its frequency: zero crossings of 1 kHz at 16 kHz.
+  size_t crossings = 0;
+  for (size_t i = 1001; i < output.size(); ++i) {
+    if ((output[i - 1] < 0.0f) != (output[i] < 0.0f)) {
+      ++crossings;
+    }
+  }
+  const double seconds = (output.size() - 1001) / 16000.0;
+  EXPECT_NEAR(crossings / seconds, 2000.0, 5.0);
+}
+
+TEST(Resampler, KeepsChannelsApart) {
+  Resampler resampler(48000, 16000, 2);
+  std::vector<int16_t> input(4800 * 2);
+  for (size_t i = 0; i < 4800; ++i) {
+    input[i * 2] = 8000;
+    input[i * 2 + 1] = -8000;
+  }
+  std::vector<int16_t> output(resampler.MaxOutputFrames(4800) * 2);
+  const size_t produced =
+      resampler.Process(input.data(), 4800, output.data(), output.size() / 2);
+  ASSERT_GT(produced, 100u);
+  // Past the ramp-in from the initial silence.
+  for (size_t i = 100; i < produced; ++i) {
+    EXPECT_NEAR(output[i * 2], 8000, 2);
+    EXPECT_NEAR(output[i * 2 + 1], -8000, 2);
+  }
+}
+
+TEST(Resampler, ConvertsInPlace) {
+  const std::vector<float> input = Sine(440.0, 16000, 1600);
+  Resampler separate(16000, 48000, 1);
+  const std::vector<float> expected = ResampleInChunks(&separate, input, 160);
+
+  Resampler in_place(16000, 48000, 1);
+  std::vector<float> output;
+  std::vector<float> buffer(in_place.MaxOutputFrames(160));
+  for (size_t offset = 0; offset < input.size(); offset += 160) {
+    std::copy(input.begin() + offset, input.begin() + offset + 160,
+              buffer.begin());
+    const size_t produced =
+        in_place.Process(buffer.data(), 160, buffer.data(), buffer.size());
+    output.insert(output.end(), buffer.begin(), buffer.begin() + produced);
+  }
+  EXPECT_EQ(output, expected);
+}
+
+TEST(Resampler, ResetRestartsTheStream) {
+  const std::vector<float> input = Sine(440.0, 48000, 4800);
+  Resampler resampler(48000, 16000, 1);
+  const std::vector<float> first = ResampleInChunks(&resampler, input, 480);
+  resampler.Reset();
+  const std::vector<float> second = ResampleInChunks(&resampler, input, 480);
+  EXPECT_EQ(first, second);
+}
+
+}  // namespace test
+}  // namespace audio_capture
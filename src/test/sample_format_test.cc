@@ -0,0 +1,246 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "sample_format.h"
+
+namespace audio_capture {
+namespace test {
+
+namespace {
+
+// Odd and past one block, so the vector loops, their scalar tails and the
+// block loop are all exercised.
+constexpr size_t kSampleCount = 517;
+
+std::vector<float> Ramp(size_t count, float peak) {
+  std::vector<float> samples(count);
+  for (size_t i = 0; i < count; ++i) {
+    const float position =
+        static_cast<float>(i) / static_cast<float>(count - 1);
+    samples[i] = peak * (2.0f * position - 1.0f);
+  }
+  return samples;
+}
+
+template <typename Output, typename Input>
+std::vector<Output> Convert(const std::vector<Input>& input,
+                            SampleFormat from, SampleFormat to,
+                            size_t output_count,
+                            Dither dither = Dither::kNone) {
+  SampleConverter converter(from, to, dither);
+  EXPECT_TRUE(converter.valid());
+  std::vector<Output> output(output_count);
+  converter.Convert(input.data(), output.data(),
+                    input.size() * sizeof(Input) / SampleFormatBytes(from));
+  return output;
+}
+
+std::vector<uint8_t> PackS24(const std::vector<int32_t>& samples) {
+  std::vector<uint8_t> bytes;
+  for (int32_t sample : samples) {
+    const uint32_t value = static_cast<uint32_t>(sample);
+    bytes.push_back(static_cast<uint8_t>(value));
+    bytes.push_back(static_cast<uint8_t>(value >> 8));
+    bytes.push_back(static_cast<uint8_t>(value >> 16));
+  }
+  return bytes;
+}
+
+}  // namespace
+
+TEST(SampleConverter, RoundTripsEveryS16Value) {
+  std::vector<int16_t> input;
+  for (int value = -32768; value <= 32767; ++value) {
+    input.push_back(static_cast<int16_t>(value));
+  }
+  const std::vector<float> floats = Convert<float>(
+      input, SampleFormat::kS16, SampleFormat::kF32, input.size());
+  EXPECT_EQ(floats.front(), -1.0f);
+  EXPECT_EQ(floats[32768], 0.0f);
+  const std::vector<int16_t> output = Convert<int16_t>(
+      floats, SampleFormat::kF32, SampleFormat::kS16, floats.size());
+  EXPECT_EQ(output, input);
+}
+
+TEST(SampleConverter, ClampsAndRoundsFloats) {
+  const std::vector<float> input = {1.0f,          -1.0f,   2.0f, -3.0f,
+                                    0.5f,          -0.25f,  0.0f, 1e-6f,
+                                    100.0f / 32768, -1e30f, 1e30f};
+  const std::vector<int16_t> output = Convert<int16_t>(
+      input, SampleFormat::kF32, SampleFormat::kS16, input.size());
+  const std::vector<int16_t> expected = {32767, -32768, 32767, -32768,
+                                         16384, -8192,  0,     0,
+                                         100,   -32768, 32767};
+  EXPECT_EQ(output, expected);
+
+  const std::vector<int32_t> wide = Convert<int32_t>(
+      input, SampleFormat::kF32, SampleFormat::kS32, input.size());
+  EXPECT_EQ(wide[0], 2147483520);
+  EXPECT_EQ(wide[1], INT32_MIN);
+  EXPECT_EQ(wide[4], 1 << 30);
+  EXPECT_EQ(wide[10], 2147483520);
+}
+
+TEST(SampleConverter, ReadsPacked24Bit) {
+  std::vector<int32_t> samples;
+  for (size_t i = 0; i < kSampleCount; ++i) {
+    samples.push_back(static_cast<int32_t>(i * 32771 % 16777216) - 8388608);
+  }
+  samples[0] = 8388607;
+  samples[1] = -8388608;
+  const std::vector<uint8_t> bytes = PackS24(samples);
+
+  const std::vector<float> floats = Convert<float>(
+      bytes, SampleFormat::kS24, SampleFormat::kF32, samples.size());
+  const std::vector<int16_t> shorts = Convert<int16_t>(
+      bytes, SampleFormat::kS24, SampleFormat::kS16, samples.size());
+  for (size_t i = 0; i < samples.size(); ++i) {
+    ASSERT_EQ(floats[i], static_cast<float>(samples[i]) / 8388608.0f) << i;
+    ASSERT_EQ(shorts[i],
+              std::max(-32768, std::min(32767, static_cast<int>(std::lrint(
+                                                   samples[i] / 256.0)))))
+        << i;
+  }
+}
+
+TEST(SampleConverter, Ignores24In32TopByte) {
+  const std::vector<int32_t> input = {
+      0x00400000, static_cast<int32_t>(0x7f400000), 0x00c00000,
+      static_cast<int32_t>(0xffc00000), 0x007fffff};
+  const std::vector<float> output = Convert<float>(
+      input, SampleFormat::kS24In32, SampleFormat::kF32, input.size());
+  EXPECT_EQ(output[0], 0.5f);
+  EXPECT_EQ(output[1], 0.5f);
+  EXPECT_EQ(output[2], -0.5f);
+  EXPECT_EQ(output[3], -0.5f);
+  EXPECT_NEAR(output[4], 1.0f, 1e-6f);
+
+  const std::vector<int32_t> back = Convert<int32_t>(
+      output, SampleFormat::kF32, SampleFormat::kS24In32, output.size());
+  EXPECT_EQ(back[0], 0x00400000);
+  EXPECT_EQ(back[2], -0x00400000);
+  EXPECT_EQ(back[4], 0x007fffff);
+}
+
+TEST(SampleConverter, RoundTripsThroughEveryFormat) {
+  const std::vector<float> input = Ramp(kSampleCount, 0.9f);
+  const struct {
+    SampleFormat format;
+    float tolerance;
+  } formats[] = {
+      {SampleFormat::kS16, 1.0f / 32768},
+      {SampleFormat::kS24, 1.0f / 8388608},
+      {SampleFormat::kS24In32, 1.0f / 8388608},
+      {SampleFormat::kS32, 1e-7f},
+      {SampleFormat::kF64, 0.0f},
+  };
+  for (const auto& entry : formats) {
+    const std::vector<uint8_t> encoded = Convert<uint8_t>(
+        input, SampleFormat::kF32, entry.format,
+        input.size() * SampleFormatBytes(entry.format));
+    const std::vector<float> decoded = Convert<float>(
+        encoded, entry.format, SampleFormat::kF32, input.size());
+    for (size_t i = 0; i < input.size(); ++i) {
+      ASSERT_NEAR(decoded[i], input[i], entry.tolerance)
+          << static_cast<int>(entry.format) << " sample " << i;
+    }
+  }
+}
+
+TEST(SampleConverter, ConvertsS16ToWiderFormats) {
+  const std::vector<int16_t> input = {-32768, -1, 0, 1, 32767};
+  const std::vector<int32_t> wide = Convert<int32_t>(
+      input, SampleFormat::kS16, SampleFormat::kS32, input.size());
+  const std::vector<int32_t> expected = {INT32_MIN, -65536, 0, 65536,
+                                         32767 * 65536};
+  EXPECT_EQ(wide, expected);
+
+  const std::vector<double> doubles = Convert<double>(
+      input, SampleFormat::kS16, SampleFormat::kF64, input.size());
+  EXPECT_EQ(doubles[0], -1.0);
+  EXPECT_EQ(doubles[3], 1.0 / 32768);
+}
+
+TEST(SampleConverter, NarrowsInPlace) {
+  const std::vector<float> ramp = Ramp(kSampleCount, 1.0f);
+  std::vector<int32_t> input(ramp.size());
+  for (size_t i = 0; i < ramp.size(); ++i) {
+    input[i] = static_cast<int32_t>(ramp[i] * 2147483520.0f);
+  }
+  const std::vector<int16_t> expected = Convert<int16_t>(
+      input, SampleFormat::kS32, SampleFormat::kS16, input.size());
+
+  std::vector<int32_t> buffer = input;
+  SampleConverter converter(SampleFormat::kS32, SampleFormat::kS16);
+  converter.Convert(buffer.data(), buffer.data(), buffer.size());
+  const int16_t* converted = reinterpret_cast<const int16_t*>(buffer.data());
+  EXPECT_EQ(std::vector<int16_t>(converted, converted + expected.size()),
+            expected);
+
+  std::vector<float> floats = ramp;
+  SampleConverter to_s16(SampleFormat::kF32, SampleFormat::kS16,
+                         Dither::kNone);
+  to_s16.Convert(floats.data(), floats.data(), floats.size());
+  const int16_t* shorts = reinterpret_cast<const int16_t*>(floats.data());
+  EXPECT_EQ(shorts[0], -32768);
+  EXPECT_EQ(shorts[kSampleCount - 1], 32767);
+}
+
+TEST(SampleConverter, DithersQuietSignals) {
+  // A quarter of an LSB: rounds to silence without dither.
+  const std::vector<float> input(20000, 0.25f / 32768);
+  const std::vector<int16_t> plain = Convert<int16_t>(
+      input, SampleFormat::kF32, SampleFormat::kS16, input.size());
+  for (int16_t sample : plain) {
+    ASSERT_EQ(sample, 0);
+  }
+
+  const std::vector<int16_t> dithered =
+      Convert<int16_t>(input, SampleFormat::kF32, SampleFormat::kS16,
+                       input.size(), Dither::kTriangular);
+  double sum = 0.0;
+  for (int16_t sample : dithered) {
+    ASSERT_GE(sample, -1);
+    ASSERT_LE(sample, 1);
+    sum += sample;
+  }
+  // The level survives on average.
+  EXPECT_NEAR(sum / static_cast<double>(dithered.size()), 0.25, 0.02);
+
+  // Repeatable, and the same whichever path reaches the S16 kernel.
+  EXPECT_EQ(Convert<int16_t>(input, SampleFormat::kF32, SampleFormat::kS16,
+                             input.size(), Dither::kTriangular),
+            dithered);
+  const std::vector<double> wide(input.begin(), input.end());
+  EXPECT_EQ(Convert<int16_t>(wide, SampleFormat::kF64, SampleFormat::kS16,
+                             wide.size(), Dither::kTriangular),
+            dithered);
+
+  // S16 input has no resolution to dither.
+  const std::vector<int16_t> shorts = {1, -2, 3};
+  EXPECT_EQ(Convert<int16_t>(shorts, SampleFormat::kS16, SampleFormat::kS16,
+                             shorts.size(), Dither::kTriangular),
+            shorts);
+}
+
+TEST(SampleConverter, RejectsPairsWithoutS16OrF32) {
+  EXPECT_FALSE(
+      SampleConverter::IsSupported(SampleFormat::kS24, SampleFormat::kS32));
+  EXPECT_TRUE(
+      SampleConverter::IsSupported(SampleFormat::kF64, SampleFormat::kS16));
+  EXPECT_TRUE(
+      SampleConverter::IsSupported(SampleFormat::kF32, SampleFormat::kS24));
+
+  SampleConverter converter(SampleFormat::kF64, SampleFormat::kS24);
+  EXPECT_FALSE(converter.valid());
+  double input = 0.5;
+  uint8_t output[3] = {1, 2, 3};
+  converter.Convert(&input, output, 1);
+  EXPECT_EQ(output[0], 1);
+}
+
+}  // namespace test
+}  // namespace audio_capture
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "level_meter.h"
+#include "spectrum_analyzer.h"
+
+namespace audio_capture {
+namespace test {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr int kRate = 48000;
+
+std::vector<int16_t> Sine(double frequency, double amplitude,
+                          double seconds) {
+  std::vector<int16_t> samples(static_cast<size_t>(seconds * kRate));
+  for (size_t i = 0; i < samples.size(); ++i) {
+    samples[i] = static_cast<int16_t>(
+        amplitude * 32767.0 * std::sin(2.0 * kPi * frequency * i / kRate));
+  }
+  return samples;
+}
+
+// Band whose range holds |frequency|.
+size_t BandOf(const SpectrumAnalyzer& analyzer, double frequency) {
+  const std::vector<float>& centers = analyzer.frequencies();
+  size_t nearest = 0;
+  for (size_t b = 1; b < centers.size(); ++b) {
+    if (std::abs(std::log(centers[b] / frequency)) <
+        std::abs(std::log(centers[nearest] / frequency))) {
+      nearest = b;
+    }
+  }
+  return nearest;
+}
+
+}  // namespace
+
+TEST(SpectrumAnalyzer, FramesEveryHop) {
+  SpectrumAnalyzer analyzer(kRate);
+  EXPECT_EQ(analyzer.bands(), 32u);
+  EXPECT_EQ(analyzer.fft_size(), 2048u);
+  EXPECT_EQ(analyzer.hop_samples(), 1024u);
+
+  const std::vector<int16_t> samples = Sine(1000.0, 0.5, 1.0);
+  EXPECT_EQ(analyzer.Process(samples.data(), samples.size()),
+            (48000u - 2048u) / 1024u + 1u);
+  EXPECT_EQ(analyzer.frame_end(), 2048u + 44u * 1024u);
+
+  // Sizes round up to a power of two.
+  SpectrumOptions options;
+  options.fft_size = 1000;
+  options.overlap = 0.75;
+  SpectrumAnalyzer rounded(kRate, options);
+  EXPECT_EQ(rounded.fft_size(), 1024u);
+  EXPECT_EQ(rounded.hop_samples(), 256u);
+}
+
+TEST(SpectrumAnalyzer, FullScaleSineReadsZeroInItsBand) {
+  SpectrumOptions options;
+  options.smoothing = 0.0;
+  for (double frequency : {250.0, 1000.0, 5000.0}) {
+    SpectrumAnalyzer analyzer(kRate, options);
+    const std::vector<int16_t> samples = Sine(frequency, 1.0, 0.5);
+    analyzer.Process(samples.data(), samples.size());
+    const size_t band = BandOf(analyzer, frequency);
+    EXPECT_NEAR(analyzer.levels()[band], 0.0, 1.0) << frequency;
+    // Bands an octave away hold only leakage.
+    for (size_t b = 0; b < analyzer.bands(); ++b) {
+      if (std::abs(std::log2(analyzer.frequencies()[b] / frequency)) > 1.0) {
+        EXPECT_LT(analyzer.levels()[b], -50.0) << frequency << " " << b;
+      }
+    }
+  }
+
+  // Half the amplitude is 6 dB down.
+  SpectrumAnalyzer analyzer(kRate, options);
+  const std::vector<int16_t> samples = Sine(1000.0, 0.5, 0.5);
+  analyzer.Process(samples.data(), samples.size());
+  EXPECT_NEAR(analyzer.levels()[BandOf(analyzer, 1000.0)], -6.0, 1.0);
+}
+
+TEST(SpectrumAnalyzer, SilenceReadsTheFloor) {
+  SpectrumAnalyzer analyzer(kRate);
+  const std::vector<int16_t> silence(kRate, 0);
+  analyzer.Process(silence.data(), silence.size());
+  for (float level : analyzer.levels()) {
+    EXPECT_EQ(level, static_cast<float>(kMinLevelDb));
+  }
+}
+
+TEST(SpectrumAnalyzer, SmoothingDecaysGradually) {
+  SpectrumOptions options;
+  options.smoothing = 0.8;
+  SpectrumAnalyzer analyzer(kRate, options);
+  const std::vector<int16_t> tone = Sine(1000.0, 1.0, 1.0);
+  analyzer.Process(tone.data(), tone.size());
+  const size_t band = BandOf(analyzer, 1000.0);
+  EXPECT_NEAR(analyzer.levels()[band], 0.0, 1.0);
+
+  // Each frame of silence keeps 0.8 of the power: about -1 dB per frame.
+  const std::vector<int16_t> silence(analyzer.hop_samples() * 4, 0);
+  analyzer.Process(silence.data(), silence.size());
+  EXPECT_LT(analyzer.levels()[band], -1.0);
+  EXPECT_GT(analyzer.levels()[band], -12.0);
+}
+
+TEST(SpectrumAnalyzer, StreamedMatchesWhole) {
+  const std::vector<int16_t> samples = Sine(440.0, 0.3, 0.5);
+  SpectrumAnalyzer whole(kRate);
+  whole.Process(samples.data(), samples.size());
+
+  for (size_t piece : {1u, 480u, 4096u}) {
+    SpectrumAnalyzer streamed(kRate);
+    size_t frames = 0;
+    for (size_t offset = 0; offset < samples.size(); offset += piece) {
+      frames += streamed.Process(samples.data() + offset,
+                                 std::min(piece, samples.size() - offset));
+    }
+    EXPECT_EQ(frames, whole.frame_count()) << piece;
+    EXPECT_EQ(streamed.frame_end(), whole.frame_end()) << piece;
+    EXPECT_EQ(streamed.levels(), whole.levels()) << piece;
+  }
+
+  whole.Reset();
+  EXPECT_EQ(whole.frame_count(), 0u);
+  EXPECT_EQ(whole.levels()[0], static_cast<float>(kMinLevelDb));
+}
+
+}  // namespace test
+}  // namespace audio_capture
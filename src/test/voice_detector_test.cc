@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "voice_detector.h"
+
+namespace audio_capture {
+namespace test {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr int kRate = 16000;
+
+// Appends |seconds| of white noise at |level_db| dBFS RMS.
+void AddNoise(std::vector<int16_t>* samples, double seconds, double level_db,
+              std::mt19937* generator) {
+  std::normal_distribution<double> distribution(
+      0.0, 32768.0 * std::pow(10.0, level_db / 20.0));
+  for (int i = 0; i < static_cast<int>(seconds * kRate); ++i) {
+    samples->push_back(static_cast<int16_t>(
+        std::max(-32768.0, std::min(32767.0, distribution(*generator)))));
+  }
+}
+
+// Appends |seconds| of a voiced sound: harmonics of 140 Hz rolling off
+// above 1 kHz, with syllables at 4 Hz, over the same noise.
+void AddSpeech(std::vector<int16_t>* samples, double seconds,
+               std::mt19937* generator) {
+  std::normal_distribution<double> noise(0.0, 32768.0 * 0.003);
+  for (int i = 0; i < static_cast<int>(seconds * kRate); ++i) {
+    const double t = static_cast<double>(i) / kRate;
+    double voiced = 0.0;
+    for (int h = 1; h <= 25; ++h) {
+      const double f = 140.0 * h;
+      voiced += std::sin(2.0 * kPi * f * t) / (1.0 + f / 1000.0);
+    }
+    const double syllables = 0.6 + 0.4 * std::sin(2.0 * kPi * 4.0 * t);
+    const double value = 3000.0 * voiced * syllables + noise(*generator);
+    samples->push_back(static_cast<int16_t>(
+        std::max(-32768.0, std::min(32767.0, value))));
+  }
+}
+
+std::vector<VoiceTransition> Detect(VoiceDetector* detector,
+                                    const std::vector<int16_t>& samples,
+                                    size_t chunk) {
+  std::vector<VoiceTransition> found;
+  for (size_t offset = 0; offset < samples.size(); offset += chunk) {
+    const size_t count = std::min(chunk, samples.size() - offset);
+    std::vector<VoiceTransition> transitions(detector->MaxTransitions(count));
+    const size_t written = detector->Process(samples.data() + offset, count,
+                                             transitions.data(),
+                                             transitions.size());
+    for (size_t i = 0; i < written; ++i) {
+      found.push_back({offset + transitions[i].offset,
+                       transitions[i].speech});
+    }
+  }
+  return found;
+}
+
+}  // namespace
+
+TEST(VoiceDetector, FindsSpeechBetweenNoise) {
+  std::mt19937 generator(1);
+  std::vector<int16_t> samples;
+  AddNoise(&samples, 1.0, -50.0, &generator);
+  AddSpeech(&samples, 1.0, &generator);
+  AddNoise(&samples, 2.0, -50.0, &generator);
+
+  VoiceOptions options;
+  options.hangover_ms = 300;
+  VoiceDetector detector(kRate, options);
+  const std::vector<VoiceTransition> found = Detect(&detector, samples, 1000);
+
+  ASSERT_EQ(found.size(), 2u);
+  EXPECT_TRUE(found[0].speech);
+  EXPECT_NEAR(static_cast<double>(found[0].offset), 1.0 * kRate,
+              0.05 * kRate);
+  EXPECT_FALSE(found[1].speech);
+  EXPECT_NEAR(static_cast<double>(found[1].offset), 2.3 * kRate,
+              0.05 * kRate);
+  EXPECT_FALSE(detector.speaking());
+  EXPECT_LT(detector.probability(), 0.1);
+}
+
+TEST(VoiceDetector, ReportsProbabilityPerCall) {
+  std::mt19937 generator(2);
+  std::vector<int16_t> noise;
+  AddNoise(&noise, 1.0, -50.0, &generator);
+  std::vector<int16_t> speech;
+  AddSpeech(&speech, 0.5, &generator);
+
+  VoiceDetector detector(kRate);
+  VoiceTransition transitions[64];
+  detector.Process(noise.data(), noise.size(), transitions, 64);
+  EXPECT_LT(detector.probability(), 0.1);
+  detector.Process(speech.data(), speech.size(), transitions, 64);
+  EXPECT_GT(detector.probability(), 0.7);
+  EXPECT_TRUE(detector.speaking());
+}
+
+TEST(VoiceDetector, IgnoresHumAndSteadyNoise) {
+  std::mt19937 generator(3);
+  std::vector<int16_t> samples;
+  AddNoise(&samples, 1.0, -60.0, &generator);
+  // A loud 50 Hz hum switching on: well above the floor, but not speech.
+  for (int i = 0; i < 2 * kRate; ++i) {
+    samples.push_back(static_cast<int16_t>(
+        10000.0 * std::sin(2.0 * kPi * 50.0 * i / kRate)));
+  }
+  VoiceDetector hum_detector(kRate);
+  EXPECT_TRUE(Detect(&hum_detector, samples, 320).empty());
+
+  // Loud steady noise from the start never leaves the noise floor.
+  std::vector<int16_t> noise;
+  AddNoise(&noise, 3.0, -25.0, &generator);
+  VoiceDetector noise_detector(kRate);
+  EXPECT_TRUE(Detect(&noise_detector, noise, 320).empty());
+}
+
+TEST(VoiceDetector, IgnoresClicks) {
+  std::vector<int16_t> samples(kRate, 0);
+  for (int i = 8000; i < 8000 + 320; ++i) {
+    samples[i] = static_cast<int16_t>(
+        12000.0 * std::sin(2.0 * kPi * 1000.0 * i / kRate));
+  }
+  VoiceDetector detector(kRate);
+  EXPECT_TRUE(Detect(&detector, samples, 512).empty());
+}
+
+}  // namespace test
+}  // namespace audio_capture
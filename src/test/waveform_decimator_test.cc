@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "waveform_decimator.h"
+
+namespace audio_capture {
+namespace test {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr int kRate = 16000;
+
+std::vector<int16_t> Sine(double frequency, double amplitude,
+                          size_t count) {
+  std::vector<int16_t> samples(count);
+  for (size_t i = 0; i < count; ++i) {
+    samples[i] = static_cast<int16_t>(
+        std::lround(amplitude * std::sin(2.0 * kPi * frequency * i / kRate)));
+  }
+  return samples;
+}
+
+// Feeds |samples| in pieces of |piece| and returns every bucket of
+// |level|.
+std::vector<WaveformBucket> Decimate(WaveformDecimator* decimator,
+                                     const std::vector<int16_t>& samples,
+                                     size_t piece, size_t level) {
+  std::vector<WaveformBucket> found;
+  for (size_t offset = 0; offset < samples.size(); offset += piece) {
+    decimator->Process(samples.data() + offset,
+                       std::min(piece, samples.size() - offset));
+    EXPECT_EQ(decimator->first_bucket(level), found.size());
+    found.insert(found.end(), decimator->buckets(level).begin(),
+                 decimator->buckets(level).end());
+    decimator->ClearBuckets();
+  }
+  return found;
+}
+
+}  // namespace
+
+TEST(WaveformDecimator, MeasuresEachBucket) {
+  WaveformDecimator decimator(kRate);
+  EXPECT_EQ(decimator.levels(), 1u);
+  EXPECT_EQ(decimator.bucket_samples(0), 160u);
+
+  // A full cycle of 100 Hz per bucket.
+  const std::vector<int16_t> samples = Sine(100.0, 10000.0, 1600);
+  const std::vector<WaveformBucket> buckets =
+      Decimate(&decimator, samples, samples.size(), 0);
+  ASSERT_EQ(buckets.size(), 10u);
+  for (const WaveformBucket& bucket : buckets) {
+    EXPECT_EQ(bucket.max, 10000);
+    EXPECT_EQ(bucket.min, -10000);
+    EXPECT_NEAR(bucket.rms, 10000.0 / std::sqrt(2.0), 1.0);
+  }
+
+  // Extremes and silence.
+  std::vector<int16_t> extremes(160, 0);
+  extremes[7] = -32768;
+  extremes[90] = 32767;
+  decimator.Process(extremes.data(), extremes.size());
+  const std::vector<int16_t> silence(160, 0);
+  decimator.Process(silence.data(), silence.size());
+  ASSERT_EQ(decimator.buckets(0).size(), 2u);
+  EXPECT_EQ(decimator.buckets(0)[0].min, -32768);
+  EXPECT_EQ(decimator.buckets(0)[0].max, 32767);
+  EXPECT_EQ(decimator.buckets(0)[1].min, 0);
+  EXPECT_EQ(decimator.buckets(0)[1].max, 0);
+  EXPECT_EQ(decimator.buckets(0)[1].rms, 0);
+}
+
+TEST(WaveformDecimator, CoarserLevelsMergePairs) {
+  WaveformOptions options;
+  options.bucket_rate_hz = 1000;
+  options.levels = 3;
+  WaveformDecimator decimator(kRate, options);
+  EXPECT_EQ(decimator.bucket_samples(1), 32u);
+  EXPECT_EQ(decimator.bucket_samples(2), 64u);
+
+  // A ramp, so every bucket differs.
+  std::vector<int16_t> samples(640);
+  for (size_t i = 0; i < samples.size(); ++i) {
+    samples[i] = static_cast<int16_t>(static_cast<int>(i) * 50 - 16000);
+  }
+  decimator.Process(samples.data(), samples.size());
+  ASSERT_EQ(decimator.buckets(0).size(), 40u);
+  ASSERT_EQ(decimator.buckets(1).size(), 20u);
+  ASSERT_EQ(decimator.buckets(2).size(), 10u);
+  for (size_t i = 0; i < 10; ++i) {
+    const WaveformBucket& coarse = decimator.buckets(2)[i];
+    EXPECT_EQ(coarse.min, samples[i * 64]);
+    EXPECT_EQ(coarse.max, samples[i * 64 + 63]);
+    double sum_squares = 0.0;
+    for (size_t j = i * 64; j < i * 64 + 64; ++j) {
+      sum_squares += static_cast<double>(samples[j]) * samples[j];
+    }
+    EXPECT_NEAR(coarse.rms, std::sqrt(sum_squares / 64.0), 0.5);
+  }
+}
+
+TEST(WaveformDecimator, StreamedMatchesWhole) {
+  WaveformOptions options;
+  options.bucket_rate_hz = 250;
+  options.levels = 4;
+  const std::vector<int16_t> samples = Sine(440.0, 12000.0, kRate);
+  for (size_t level = 0; level < 4; ++level) {
+    WaveformDecimator whole(kRate, options);
+    const std::vector<WaveformBucket> expected =
+        Decimate(&whole, samples, samples.size(), level);
+    for (size_t piece : {1u, 63u, 441u, 4096u}) {
+      WaveformDecimator streamed(kRate, options);
+      const std::vector<WaveformBucket> found =
+          Decimate(&streamed, samples, piece, level);
+      ASSERT_EQ(found.size(), expected.size()) << level << " " << piece;
+      for (size_t i = 0; i < found.size(); ++i) {
+        EXPECT_EQ(found[i].min, expected[i].min);
+        EXPECT_EQ(found[i].max, expected[i].max);
+        EXPECT_EQ(found[i].rms, expected[i].rms);
+      }
+    }
+  }
+}
+
+TEST(WaveformDecimator, BoundsBucketsPerCall) {
+  WaveformOptions options;
+  options.bucket_rate_hz = 100;
+  options.levels = 3;
+  WaveformDecimator decimator(kRate, options);
+  const std::vector<int16_t> samples = Sine(50.0, 8000.0, 3000);
+  for (size_t piece : {100u, 700u, 1000u, 1200u}) {
+    const size_t bound = decimator.MaxBuckets(piece);
+    decimator.Process(samples.data(), piece);
+    size_t added = 0;
+    for (size_t level = 0; level < decimator.levels(); ++level) {
+      added += decimator.buckets(level).size();
+    }
+    EXPECT_EQ(added, bound) << piece;
+    decimator.ClearBuckets();
+  }
+
+  decimator.Reset();
+  EXPECT_EQ(decimator.first_bucket(0), 0u);
+  EXPECT_EQ(decimator.MaxBuckets(159), 0u);
+}
+
+}  // namespace test
+}  // namespace audio_capture
@@ -0,0 +1,176 @@
+#include "voice_detector.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace audio_capture {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+constexpr int kFrameMs = 20;
+constexpr size_t kOnsetFrames = 3;  // 60 ms.
+
+constexpr double kSpeechLowHz = 200.0;
+constexpr double kSpeechHighHz = 4000.0;
+
+// Below this a frame is too quiet to be speech whatever the noise floor.
+constexpr double kMinSpeechDb = -60.0;
+constexpr double kSilenceDb = -120.0;
+
+// How fast the noise floor follows rising energy, in dB per second; it
+// follows falling energy at once. Slower during speech, which is loud but
+// not noise.
+constexpr double kFloorRiseDbPerSecond = 3.0;
+constexpr double kFloorRiseSpeechDbPerSecond = 0.5;
+
+double Sigmoid(double x) { return 1.0 / (1.0 + std::exp(-x)); }
+
+}  // namespace
+
+double VoiceDetector::Biquad::Filter(double x) {
+  const double y = b0 * x + s1;
+  s1 = b1 * x - a1 * y + s2;
+  s2 = b2 * x - a2 * y;
+  return y;
+}
+
+VoiceDetector::VoiceDetector(int sample_rate, const VoiceOptions& options)
+    : frame_samples_(
+          std::max<size_t>(1, static_cast<size_t>(sample_rate) * kFrameMs /
+                                  1000)),
+      threshold_(options.threshold),
+      hangover_frames_(static_cast<size_t>(std::max(0, options.hangover_ms)) /
+                       kFrameMs) {
+  floor_rise_db_ = kFloorRiseDbPerSecond * kFrameMs / 1000.0;
+  floor_rise_speech_db_ = kFloorRiseSpeechDbPerSecond * kFrameMs / 1000.0;
+
+  // Second-order Butterworth sections bounding the speech band.
+  const double q = std::sqrt(0.5);
+  {
+    const double w = 2.0 * kPi * kSpeechLowHz / sample_rate;
+    const double alpha = std::sin(w) / (2.0 * q);
+    const double cosw = std::cos(w);
+    const double a0 = 1.0 + alpha;
+    highpass_ = {(1.0 + cosw) / 2.0 / a0, -(1.0 + cosw) / a0,
+                 (1.0 + cosw) / 2.0 / a0, -2.0 * cosw / a0,
+                 (1.0 - alpha) / a0, 0.0, 0.0};
+  }
+  {
+    const double high = std::min(kSpeechHighHz, 0.45 * sample_rate);
+    const double w = 2.0 * kPi * high / sample_rate;
+    const double alpha = std::sin(w) / (2.0 * q);
+    const double cosw = std::cos(w);
+    const double a0 = 1.0 + alpha;
+    lowpass_ = {(1.0 - cosw) / 2.0 / a0, (1.0 - cosw) / a0,
+                (1.0 - cosw) / 2.0 / a0, -2.0 * cosw / a0,
+                (1.0 - alpha) / a0, 0.0, 0.0};
+  }
+  Reset();
+}
+
+size_t VoiceDetector::Process(const int16_t* samples, size_t count,
+                              VoiceTransition* transitions,
+                              size_t max_transitions) {
+  size_t written = 0;
+  double probability_sum = 0.0;
+  size_t frames = 0;
+  for (size_t i = 0; i < count; ++i) {
+    const double x = samples[i] / 32768.0;
+    const double band = lowpass_.Filter(highpass_.Filter(x));
+    frame_energy_ += x * x;
+    band_energy_ += band * band;
+    if (++frame_fill_ < frame_samples_) {
+      continue;
+    }
+
+    const bool was_speaking = speaking_;
+    const double probability = FinishFrame();
+    probability_sum += probability;
+    ++frames;
+    if (speaking_ != was_speaking && written < max_transitions) {
+      // Speech starts with the first frame of its onset and ends with the
+      // last frame of the hangover.
+      const size_t frame_end = i + 1;
+      const size_t onset = (kOnsetFrames - 1) * frame_samples_;
+      transitions[written].offset =
+          speaking_ ? (frame_end > frame_samples_ + onset
+                           ? frame_end - frame_samples_ - onset
+                           : 0)
+                    : frame_end;
+      transitions[written].speech = speaking_;
+      ++written;
+    }
+  }
+  if (frames > 0) {
+    probability_ = probability_sum / frames;
+  }
+  return written;
+}
+
+double VoiceDetector::FinishFrame() {
+  const double energy = frame_energy_ / frame_samples_;
+  const double level_db =
+      energy > 0.0 ? std::max(kSilenceDb, 10.0 * std::log10(energy))
+                   : kSilenceDb;
+  const double band_share =
+      frame_energy_ > 0.0 ? std::min(1.0, band_energy_ / frame_energy_) : 0.0;
+  frame_energy_ = 0.0;
+  band_energy_ = 0.0;
+  frame_fill_ = 0;
+
+  if (!has_floor_) {
+    noise_floor_db_ = level_db;
+    has_floor_ = true;
+  } else if (level_db < noise_floor_db_) {
+    noise_floor_db_ = level_db;
+  } else {
+    noise_floor_db_ = std::min(
+        level_db, noise_floor_db_ +
+                      (speaking_ ? floor_rise_speech_db_ : floor_rise_db_));
+  }
+
+  // Each feature maps to a likelihood; speech needs all of them.
+  const double above_floor = Sigmoid((level_db - noise_floor_db_ - 8.0) / 2.0);
+  const double in_band = Sigmoid((band_share - 0.4) / 0.08);
+  const double audible = Sigmoid((level_db - kMinSpeechDb) / 3.0);
+  const double probability = above_floor * in_band * audible;
+
+  if (probability >= threshold_) {
+    onset_frames_ = std::min(onset_frames_ + 1, kOnsetFrames);
+    if (onset_frames_ == kOnsetFrames) {
+      speaking_ = true;
+      hangover_left_ = hangover_frames_;
+    }
+  } else {
+    onset_frames_ = 0;
+    if (hangover_left_ > 0) {
+      --hangover_left_;
+    }
+    if (hangover_left_ == 0) {
+      speaking_ = false;
+    }
+  }
+  return probability;
+}
+
+size_t VoiceDetector::MaxTransitions(size_t count) const {
+  return (frame_fill_ + count) / frame_samples_;
+}
+
+void VoiceDetector::Reset() {
+  highpass_.s1 = highpass_.s2 = 0.0;
+  lowpass_.s1 = lowpass_.s2 = 0.0;
+  frame_energy_ = 0.0;
+  band_energy_ = 0.0;
+  frame_fill_ = 0;
+  has_floor_ = false;
+  noise_floor_db_ = kSilenceDb;
+  onset_frames_ = 0;
+  hangover_left_ = 0;
+  speaking_ = false;
+  probability_ = 0.0;
+}
+
+}  // namespace audio_capture
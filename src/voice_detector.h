@@ -0,0 +1,89 @@
+#ifndef FLUTTER_PLUGIN_VOICE_DETECTOR_H_
+#define FLUTTER_PLUGIN_VOICE_DETECTOR_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace audio_capture {
+
+struct VoiceOptions {
+  // Speech probability at which speech starts.
+  double threshold = 0.5;
+  // How long speech lasts after the probability last reached the
+  // threshold, so pauses between words do not end it.
+  int hangover_ms = 500;
+};
+
+// A change between speech and non-speech found by a VoiceDetector.
+struct VoiceTransition {
+  size_t offset;  // Sample of the Process call's input where it happens.
+  bool speech;    // Whether speech starts or ends there.
+};
+
+// Voice activity detector for mono 16-bit audio, from two features of each
+// 20 ms frame: its energy above a tracked noise floor, and the share of the
+// energy in the speech band (200 Hz to 4 kHz). Loud but stationary sound
+// raises the noise floor; hum and rumble fall outside the band. Speech
+// starts after 60 ms above the threshold and ends once the hangover passes
+// without it.
+//
+// Not thread-safe; use one instance per stream.
+class VoiceDetector {
+ public:
+  VoiceDetector(int sample_rate, const VoiceOptions& options = VoiceOptions());
+
+  // Analyzes |count| samples, which may end mid-frame, and writes the
+  // transitions they contain to |transitions|, up to |max_transitions|;
+  // MaxTransitions() is always enough. Returns the number written.
+  size_t Process(const int16_t* samples, size_t count,
+                 VoiceTransition* transitions, size_t max_transitions);
+
+  // Upper bound of the transitions one Process call of |count| samples
+  // writes.
+  size_t MaxTransitions(size_t count) const;
+
+  // Mean speech probability of the frames completed by the last Process
+  // call, or of the last completed frame if it completed none.
+  double probability() const { return probability_; }
+
+  // Whether speech, including its hangover, lasts at the end of the
+  // samples processed so far.
+  bool speaking() const { return speaking_; }
+
+  // Forgets the noise floor and any speech in progress.
+  void Reset();
+
+ private:
+  struct Biquad {
+    double b0, b1, b2, a1, a2;
+    double s1, s2;
+    double Filter(double x);
+  };
+
+  // Returns the speech probability of the frame just completed.
+  double FinishFrame();
+
+  size_t frame_samples_;
+  double threshold_;
+  size_t hangover_frames_;
+  double floor_rise_db_;         // Per frame, without speech.
+  double floor_rise_speech_db_;  // Per frame, during speech.
+
+  Biquad highpass_;
+  Biquad lowpass_;
+
+  double frame_energy_;  // Of the current frame so far.
+  double band_energy_;
+  size_t frame_fill_;
+
+  bool has_floor_;
+  double noise_floor_db_;
+  size_t onset_frames_;      // Consecutive frames at the threshold.
+  size_t hangover_left_;     // Frames of speech left without the threshold.
+  bool speaking_;
+  double probability_;
+};
+
+}  // namespace audio_capture
+
+#endif  // FLUTTER_PLUGIN_VOICE_DETECTOR_H_
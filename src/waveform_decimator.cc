@@ -0,0 +1,114 @@
+#include "waveform_decimator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace audio_capture {
+
+void WaveformDecimator::Partial::Clear() {
+  min = std::numeric_limits<int16_t>::max();
+  max = std::numeric_limits<int16_t>::min();
+  sum_squares = 0.0;
+  samples = 0;
+}
+
+WaveformDecimator::WaveformDecimator(int sample_rate,
+                                     const WaveformOptions& options) {
+  const int rate = std::max(1, sample_rate);
+  const size_t bucket = static_cast<size_t>(
+      rate / std::max(1, std::min(options.bucket_rate_hz, rate)));
+  levels_.resize(static_cast<size_t>(
+      std::max(1, std::min(options.levels, kMaxWaveformLevels))));
+  for (size_t level = 0; level < levels_.size(); ++level) {
+    levels_[level].bucket_samples = bucket << level;
+  }
+  Reset();
+}
+
+void WaveformDecimator::Process(const int16_t* samples, size_t count) {
+  Level& finest = levels_[0];
+  Partial& partial = finest.partial;
+  while (count > 0) {
+    const size_t take =
+        std::min(count, finest.bucket_samples - partial.samples);
+    int min = partial.min;
+    int max = partial.max;
+    // Exact for buckets of up to 2^33 samples.
+    int64_t sum_squares = 0;
+    for (size_t i = 0; i < take; ++i) {
+      const int sample = samples[i];
+      min = std::min(min, sample);
+      max = std::max(max, sample);
+      sum_squares += sample * sample;
+    }
+    partial.min = min;
+    partial.max = max;
+    partial.sum_squares += static_cast<double>(sum_squares);
+    partial.samples += take;
+    samples += take;
+    count -= take;
+    if (partial.samples == finest.bucket_samples) {
+      Complete(0);
+    }
+  }
+}
+
+void WaveformDecimator::Complete(size_t level) {
+  Level& current = levels_[level];
+  Partial& partial = current.partial;
+  const double rms = std::sqrt(partial.sum_squares /
+                               static_cast<double>(partial.samples));
+  current.buckets.push_back(
+      {static_cast<int16_t>(partial.min), static_cast<int16_t>(partial.max),
+       static_cast<int16_t>(std::min(32767.0, std::round(rms)))});
+  ++current.bucket_count;
+
+  if (level + 1 < levels_.size()) {
+    Level& next = levels_[level + 1];
+    next.partial.min = std::min(next.partial.min, partial.min);
+    next.partial.max = std::max(next.partial.max, partial.max);
+    next.partial.sum_squares += partial.sum_squares;
+    next.partial.samples += partial.samples;
+    if (next.partial.samples == next.bucket_samples) {
+      Complete(level + 1);
+    }
+  }
+  partial.Clear();
+}
+
+size_t WaveformDecimator::MaxBuckets(size_t count) const {
+  // Samples not yet in a bucket of a level are in the partial buckets of
+  // that level and the finer ones.
+  size_t pending = count;
+  size_t total = 0;
+  for (const Level& level : levels_) {
+    pending += level.partial.samples;
+    total += pending / level.bucket_samples;
+  }
+  return total;
+}
+
+void WaveformDecimator::Reserve(size_t count) {
+  for (Level& level : levels_) {
+    level.buckets.reserve(count / level.bucket_samples + 1);
+  }
+}
+
+void WaveformDecimator::ClearBuckets() {
+  for (Level& level : levels_) {
+    level.buckets.clear();
+    level.first_bucket = level.bucket_count;
+  }
+}
+
+void WaveformDecimator::Reset() {
+  for (Level& level : levels_) {
+    level.partial.Clear();
+    level.buckets.clear();
+    level.first_bucket = 0;
+    level.bucket_count = 0;
+  }
+}
+
+}  // namespace audio_capture
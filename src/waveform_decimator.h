@@ -0,0 +1,101 @@
+#ifndef FLUTTER_PLUGIN_WAVEFORM_DECIMATOR_H_
+#define FLUTTER_PLUGIN_WAVEFORM_DECIMATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace audio_capture {
+
+// Most resolutions a WaveformDecimator keeps.
+constexpr int kMaxWaveformLevels = 8;
+
+struct WaveformOptions {
+  // Buckets per second of the finest level; each coarser level has half as
+  // many. At most the sample rate.
+  int bucket_rate_hz = 100;
+  int levels = 1;  // From 1 to kMaxWaveformLevels.
+};
+
+// What a waveform display draws for one bucket of samples.
+struct WaveformBucket {
+  int16_t min;
+  int16_t max;
+  int16_t rms;  // Rounded, from 0 to 32767.
+};
+
+// Reduces a mono 16-bit stream to the minimum, maximum and RMS of fixed
+// buckets, at several resolutions: level 0 buckets span bucket_samples(0)
+// samples and each further level merges two buckets of the one before, so
+// a display can pick the level nearest its pixel width and zoom without
+// the samples. Buckets may span any number of Process calls.
+//
+// Completed buckets collect in buckets() until ClearBuckets(); bucket n of
+// a level covers the samples from n * bucket_samples(level) since
+// construction or Reset().
+//
+// Not thread-safe; use one instance per stream.
+class WaveformDecimator {
+ public:
+  WaveformDecimator(int sample_rate,
+                    const WaveformOptions& options = WaveformOptions());
+
+  size_t levels() const { return levels_.size(); }
+  size_t bucket_samples(size_t level) const {
+    return levels_[level].bucket_samples;
+  }
+
+  // Adds |count| samples.
+  void Process(const int16_t* samples, size_t count);
+
+  // Buckets of |level| completed since the last ClearBuckets(), and the
+  // index of the first of them.
+  const std::vector<WaveformBucket>& buckets(size_t level) const {
+    return levels_[level].buckets;
+  }
+  uint64_t first_bucket(size_t level) const {
+    return levels_[level].first_bucket;
+  }
+
+  // Most buckets of all levels one Process call of |count| samples adds.
+  size_t MaxBuckets(size_t count) const;
+
+  // Makes room for the buckets of |count| samples, so Process then only
+  // allocates for longer runs between ClearBuckets() calls.
+  void Reserve(size_t count);
+
+  // Forgets the completed buckets, keeping their storage.
+  void ClearBuckets();
+
+  // Forgets buffered samples and buckets, for a stream that does not
+  // continue the previous one.
+  void Reset();
+
+ private:
+  // A bucket being filled.
+  struct Partial {
+    void Clear();
+
+    int min;
+    int max;
+    double sum_squares;
+    size_t samples;
+  };
+
+  struct Level {
+    size_t bucket_samples;
+    Partial partial;
+    std::vector<WaveformBucket> buckets;
+    uint64_t first_bucket;
+    uint64_t bucket_count;  // Completed since construction or Reset().
+  };
+
+  // Completes the partial bucket of |level|, folding it into the next.
+  void Complete(size_t level);
+
+  std::vector<Level> levels_;
+};
+
+}  // namespace audio_capture
+
+#endif  // FLUTTER_PLUGIN_WAVEFORM_DECIMATOR_H_
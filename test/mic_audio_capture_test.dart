@@ -245,6 +245,37 @@ void main() {
       expect(methodCallLog, isEmpty);
     });
 
+    test('startCapture stores session id and stopCapture passes it', () async {
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(methodChannel,
+              (MethodCall methodCall) async {
+        methodCallLog.add(methodCall);
+        switch (methodCall.method) {
+          case 'requestPermissions':
+            return true;
+          case 'startCapture':
+            return 7;
+          case 'stopCapture':
+            return true;
+          default:
+            return null;
+        }
+      });
+
+      await micCapture.startCapture();
+      expect(micCapture.isRecording, true);
+      expect(micCapture.sessionId, 7);
+
+      await micCapture.stopCapture();
+      expect(micCapture.sessionId, isNull);
+      expect(methodCallLog.last.arguments, {'sessionId': 7});
+    });
+
+    test('startCapture passes deviceId when set', () async {
+      await micCapture.startCapture(config: MicAudioConfig(deviceId: 'source-1'));
+      expect(methodCallLog[1].arguments['deviceId'], 'source-1');
+    });
+
     test('stopCapture throws exception when stop fails', () async {
       await micCapture.startCapture();
       TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
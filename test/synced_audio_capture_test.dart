@@ -0,0 +1,182 @@
+import 'package:desktop_audio_capture/audio_capture.dart';
+import 'package:flutter/services.dart';
+import 'package:flutter_test/flutter_test.dart';
+
+void main() {
+  TestWidgetsFlutterBinding.ensureInitialized();
+
+  const MethodChannel methodChannel = MethodChannel(
+    'com.system_audio_transcriber/audio_capture',
+  );
+
+  late SyncedAudioCapture syncedCapture;
+  late List<MethodCall> methodCallLog;
+
+  setUp(() {
+    syncedCapture = SyncedAudioCapture();
+    methodCallLog = [];
+
+    TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+        .setMockMethodCallHandler(methodChannel, (MethodCall methodCall) async {
+      methodCallLog.add(methodCall);
+      switch (methodCall.method) {
+        case 'requestPermissions':
+          return true;
+        case 'startSyncedCapture':
+          return 3;
+        case 'stopCapture':
+          return true;
+        default:
+          return null;
+      }
+    });
+  });
+
+  tearDown(() {
+    methodCallLog.clear();
+    TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+        .setMockMethodCallHandler(methodChannel, null);
+  });
+
+  group('SyncedAudioConfig', () {
+    test('toMap sends output mode by name and omits unset devices', () {
+      final map = SyncedAudioConfig(
+        outputMode: SyncedOutputMode.mixed,
+        systemGain: 0.5,
+      ).toMap();
+      expect(map['outputMode'], 'mixed');
+      expect(map['systemGain'], 0.5);
+      expect(map.containsKey('micDeviceId'), false);
+      expect(map.containsKey('systemDeviceId'), false);
+    });
+
+    test('toMap sends echo cancellation as an output mode', () {
+      final map =
+          SyncedAudioConfig(outputMode: SyncedOutputMode.echoCancelled)
+              .toMap();
+      expect(map['outputMode'], 'echoCancelled');
+    });
+
+    test('toMap sends delay estimation', () {
+      final map = SyncedAudioConfig().toMap();
+      expect(map['estimateDelay'], false);
+
+      final estimating = SyncedAudioConfig(
+        estimateDelay: true,
+        delayIntervalMs: 250,
+      ).toMap();
+      expect(estimating['estimateDelay'], true);
+      expect(estimating['delayIntervalMs'], 250);
+    });
+
+    test('toMap sends the compressor only when set', () {
+      expect(SyncedAudioConfig().toMap().containsKey('compressor'), false);
+
+      final map = SyncedAudioConfig(
+        compressor: const CompressorConfig(ratio: 2.0),
+      ).toMap();
+      expect(map['compressor'], true);
+      expect(map['compressorRatio'], 2.0);
+    });
+  });
+
+  group('SyncedAudioCapture', () {
+    test('startCapture stores session id', () async {
+      await syncedCapture.startCapture();
+      expect(syncedCapture.isRecording, true);
+      expect(syncedCapture.sessionId, 3);
+      expect(methodCallLog[1].method, 'startSyncedCapture');
+      expect(methodCallLog[1].arguments['outputMode'], 'interleaved');
+      expect(syncedCapture.audioStream, isNotNull);
+    });
+
+    test('startCapture throws when platform returns no session', () async {
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(methodChannel,
+              (MethodCall methodCall) async {
+        if (methodCall.method == 'requestPermissions') {
+          return true;
+        }
+        return false;
+      });
+
+      await expectLater(
+        () => syncedCapture.startCapture(),
+        throwsA(isA<Exception>()),
+      );
+      expect(syncedCapture.isRecording, false);
+    });
+
+    test('stopCapture passes session id', () async {
+      await syncedCapture.startCapture();
+      await syncedCapture.stopCapture();
+      expect(syncedCapture.isRecording, false);
+      expect(methodCallLog.last.method, 'stopCapture');
+      expect(methodCallLog.last.arguments, {'sessionId': 3});
+    });
+
+    test('stopCapture does nothing if not recording', () async {
+      await syncedCapture.stopCapture();
+      expect(methodCallLog, isEmpty);
+    });
+
+    test('delayStream returns null when not recording', () {
+      expect(syncedCapture.delayStream, isNull);
+    });
+
+    test('getStats parses delay and echo cancellation', () async {
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(methodChannel,
+              (MethodCall methodCall) async {
+        methodCallLog.add(methodCall);
+        switch (methodCall.method) {
+          case 'startSyncedCapture':
+            return 3;
+          case 'getCaptureStats':
+            return {
+              'sessionId': 3,
+              'chunksCaptured': 20,
+              'droppedChunks': 0,
+              'overruns': 0,
+              'lostFrames': 0,
+              'filledFrames': 0,
+              'delayMs': 95.5,
+              'delayConfidence': 0.7,
+              'echoDelayMs': 96,
+              'echoErleDb': 24.5,
+            };
+          default:
+            return true;
+        }
+      });
+      await syncedCapture.startCapture();
+
+      final stats = await syncedCapture.getStats();
+      expect(methodCallLog.last.arguments, {'sessionId': 3});
+      expect(stats?.delayMs, 95.5);
+      expect(stats?.delayConfidence, 0.7);
+      expect(stats?.echoDelayMs, 96);
+      expect(stats?.echoErleDb, 24.5);
+      expect(stats?.loudness, isNull);
+    });
+  });
+
+  group('DelayEvent', () {
+    test('fromMap reads delay and confidence', () {
+      final event = DelayEvent.fromMap({
+        'type': 'delay',
+        'sessionId': 3,
+        'delayMs': -12.25,
+        'confidence': 0.64,
+        'samplePosition': 32000,
+        'captureTimeUs': 5000000,
+        'timestamp': 1700000002.0,
+      });
+      expect(event.sessionId, 3);
+      expect(event.delayMs, -12.25);
+      expect(event.confidence, 0.64);
+      expect(event.samplePosition, 32000);
+      expect(event.captureTimeUs, 5000000);
+    });
+  });
+}
@@ -1,3 +1,5 @@
+import 'dart:typed_data';
+
 import 'package:desktop_audio_capture/audio_capture.dart';
 import 'package:desktop_audio_capture/system/system_audio_capture.dart';
 import 'package:flutter/services.dart';
@@ -175,6 +177,315 @@ void main() {
       expect(methodCallLog, isEmpty);
     });
 
+    test('startCapture stores session id and stopCapture passes it', () async {
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(methodChannel,
+              (MethodCall methodCall) async {
+        methodCallLog.add(methodCall);
+        switch (methodCall.method) {
+          case 'requestPermissions':
+            return true;
+          case 'startCapture':
+            return 7;
+          case 'stopCapture':
+            return true;
+          default:
+            return null;
+        }
+      });
+
+      await systemCapture.startCapture();
+      expect(systemCapture.isRecording, true);
+      expect(systemCapture.sessionId, 7);
+
+      await systemCapture.stopCapture();
+      expect(systemCapture.sessionId, isNull);
+      expect(methodCallLog.last.arguments, {'sessionId': 7});
+    });
+
+    test('chunkStream is only available with a session', () async {
+      await systemCapture.startCapture();
+      expect(systemCapture.chunkStream, isNull);
+      await systemCapture.stopCapture();
+
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(methodChannel,
+              (MethodCall methodCall) async {
+        return methodCall.method == 'startCapture' ? 4 : true;
+      });
+      await systemCapture.startCapture();
+      expect(systemCapture.chunkStream, isNotNull);
+      expect(systemCapture.audioStream, isNotNull);
+    });
+
+    test('getStats passes session id and parses counters', () async {
+      expect(await systemCapture.getStats(), isNull);
+
+      TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
+          .setMockMethodCallHandler(methodChannel,
+              (MethodCall methodCall) async {
+        methodCallLog.add(methodCall);
+        switch (methodCall.method) {
+          case 'startCapture':
+            return 5;
+          case 'getCaptureStats':
+            return {
+              'sessionId': 5,
+              'chunksCaptured': 100,
+              'droppedChunks': 2,
+              'overruns': 3,
+              'lostFrames': 4800,
+              'filledFrames': 0,
+              'scheduling': 'rtkit',
+              'jitterMaxUs': 1500,
+              'jitterHistogram': [10, 2, 0, 0, 0, 0, 0],
+              'readyQueueHighWater': 3,
+              'processingMaxUs': 250,
+              'emitWaitMaxUs': 800,
+              'emitQueueCapacity': 64,
+              'emitDroppedChunks': 1,
+              'captureRates': [48000],
+              'captureFormats': ['f32'],
+              'conversionMaxUs': 90,
+              'loudness': {
+                'momentary': -20.5,
+                'shortTerm': -21.0,
+                'integrated': -23.0,
+                'range': 6.5,
+                'truePeak': -1.2,
+              },
+            };
+          default:
+            return true;
+        }
+      });
+      await systemCapture.startCapture();
+      expect(systemCapture.overrunStream, isNotNull);
+
+      final stats = await systemCapture.getStats();
+      expect(methodCallLog.last.arguments, {'sessionId': 5});
+      expect(stats?.droppedChunks, 2);
+      expect(stats?.overruns, 3);
+      expect(stats?.lostFrames, 4800);
+      expect(stats?.scheduling, 'rtkit');
+      expect(stats?.jitterHistogram.length,
+          CaptureStats.jitterHistogramBoundsUs.length + 1);
+      expect(stats?.readyQueueHighWater, 3);
+      expect(stats?.processingMaxUs, 250);
+      expect(stats?.emitWaitMaxUs, 800);
+      expect(stats?.emitQueueDepth, 0);
+      expect(stats?.emitQueueCapacity, 64);
+      expect(stats?.emitDroppedChunks, 1);
+      expect(stats?.captureRates, [48000]);
+      expect(stats?.captureFormats, ['f32']);
+      expect(stats?.conversionMaxUs, 90);
+      expect(stats?.loudness?.integrated, -23.0);
+      expect(stats?.loudness?.range, 6.5);
+      expect(stats?.loudness?.truePeak, -1.2);
+    });
+
+    test('startCapture passes fillGaps', () async {
+      await systemCapture.startCapture(config: SystemAudioConfig(fillGaps: true));
+      expect(methodCallLog[1].arguments['fillGaps'], true);
+    });
+
+    test('startCapture passes scheduling options', () async {
+      await systemCapture.startCapture(
+        config: SystemAudioConfig(realtime: true, cpuAffinity: [2, 3]),
+      );
+      expect(methodCallLog[1].arguments['realtime'], true);
+      expect(methodCallLog[1].arguments['realtimePriority'], 10);
+      expect(methodCallLog[1].arguments['cpuAffinity'], [2, 3]);
+    });
+
+    test('startCapture passes conversion options', () async {
+      await systemCapture.startCapture(
+        config: SystemAudioConfig(
+          nativeRate: true,
+          resampleQuality: ResampleQuality.high,
+        ),
+      );
+      expect(methodCallLog[1].arguments['nativeRate'], true);
+      expect(methodCallLog[1].arguments['resampleQuality'], 'high');
+    });
+
+    test('startCapture passes meter options', () async {
+      await systemCapture.startCapture(
+        config: SystemAudioConfig(
+          meterOnly: true,
+          meter: const LevelMeterConfig.ppm(rateHz: 20),
+        ),
+      );
+      expect(methodCallLog[1].arguments['meterOnly'], true);
+      expect(methodCallLog[1].arguments['meterRateHz'], 20);
+      expect(methodCallLog[1].arguments['meterAttackMs'], 5);
+      expect(methodCallLog[1].arguments['meterReleaseMs'], 1500);
+      expect(methodCallLog[1].arguments['meterHoldMs'], 1000);
+      expect(methodCallLog[1].arguments['loudness'], false);
+    });
+
+    test('startCapture passes the loudness option', () async {
+      await systemCapture.startCapture(
+        config: SystemAudioConfig(loudness: true),
+      );
+      expect(methodCallLog[1].arguments['loudness'], true);
+    });
+
+    test('startCapture passes voice activity options', () async {
+      await systemCapture.startCapture(
+        config: SystemAudioConfig(
+          voiceActivity: const VoiceActivityConfig(
+            threshold: 0.7,
+            hangoverMs: 800,
+            speechOnly: true,
+          ),
+        ),
+      );
+      expect(methodCallLog[1].arguments['voiceActivity'], true);
+      expect(methodCallLog[1].arguments['voiceThreshold'], 0.7);
+      expect(methodCallLog[1].arguments['voiceHangoverMs'], 800);
+      expect(methodCallLog[1].arguments['voicePreRollMs'], 300);
+      expect(methodCallLog[1].arguments['speechOnly'], true);
+    });
+
+    test('startCapture omits voice activity by default', () async {
+      await systemCapture.startCapture();
+      expect(methodCallLog[1].arguments.containsKey('voiceActivity'), false);
+    });
+
+    test('startCapture passes utterance options', () async {
+      await systemCapture.startCapture(
+        config: SystemAudioConfig(
+          utterances: const UtteranceConfig(maxDurationMs: 8000),
+        ),
+      );
+      expect(methodCallLog[1].arguments['utterances'], true);
+      expect(methodCallLog[1].arguments['utteranceMaxMs'], 8000);
+      expect(methodCallLog[1].arguments['utteranceSilenceMs'], 700);
+      expect(methodCallLog[1].arguments['utterancePreRollMs'], 300);
+      expect(methodCallLog[1].arguments['utteranceThreshold'], 0.5);
+    });
+
+    test('startCapture passes feature options', () async {
+      await systemCapture.startCapture(
+        config: SystemAudioConfig(
+          melFeatures: const MelFeatureConfig(bins: 64, hopMs: 20),
+        ),
+      );
+      expect(methodCallLog[1].arguments['melFeatures'], true);
+      expect(methodCallLog[1].arguments['melBins'], 64);
+      expect(methodCallLog[1].arguments['melWindowMs'], 25);
+      expect(methodCallLog[1].arguments['melHopMs'], 20);
+      expect(methodCallLog[1].arguments['melLowHz'], 20.0);
+    });
+
+    test('featureStream returns null when not recording', () {
+      expect(systemCapture.featureStream, isNull);
+    });
+
+    test('startCapture passes spectrum options', () async {
+      await systemCapture.startCapture(
+        config: SystemAudioConfig(
+          spectrum: const SpectrumConfig(bands: 64, rateHz: 60),
+        ),
+      );
+      expect(methodCallLog[1].arguments['spectrum'], true);
+      expect(methodCallLog[1].arguments['spectrumBands'], 64);
+      expect(methodCallLog[1].arguments['spectrumFftSize'], 2048);
+      expect(methodCallLog[1].arguments['spectrumOverlap'], 0.5);
+      expect(methodCallLog[1].arguments['spectrumSmoothing'], 0.5);
+      expect(methodCallLog[1].arguments['spectrumRateHz'], 60);
+    });
+
+    test('spectrumStream returns null when not recording', () {
+      expect(systemCapture.spectrumStream, isNull);
+    });
+
+    test('startCapture passes waveform options', () async {
+      await systemCapture.startCapture(
+        config: SystemAudioConfig(
+          waveform: const WaveformConfig(bucketRateHz: 200, levels: 3),
+        ),
+      );
+      expect(methodCallLog[1].arguments['waveform'], true);
+      expect(methodCallLog[1].arguments['waveformBucketRateHz'], 200);
+      expect(methodCallLog[1].arguments['waveformLevels'], 3);
+    });
+
+    test('waveformStream returns null when not recording', () {
+      expect(systemCapture.waveformStream, isNull);
+    });
+
+    test('startCapture passes the filter chain', () async {
+      await systemCapture.startCapture(
+        config: SystemAudioConfig(
+          filters: const [
+            AudioFilter.dcBlock(),
+            AudioFilter.notch(frequencyHz: 60.0),
+            AudioFilter.highShelf(frequencyHz: 4000.0, gainDb: 3.0),
+          ],
+        ),
+      );
+      expect(methodCallLog[1].arguments['filters'], [
+        {'type': 'dcBlock', 'frequencyHz': 10.0, 'q': 0.7071, 'gainDb': 0.0},
+        {'type': 'notch', 'frequencyHz': 60.0, 'q': 10.0, 'gainDb': 0.0},
+        {
+          'type': 'highShelf',
+          'frequencyHz': 4000.0,
+          'q': 0.7071,
+          'gainDb': 3.0,
+        },
+      ]);
+    });
+
+    test('startCapture passes the noise suppression level', () async {
+      await systemCapture.startCapture(
+        config: SystemAudioConfig(
+          noiseSuppression: NoiseSuppressionLevel.veryHigh,
+        ),
+      );
+      expect(methodCallLog[1].arguments['noiseSuppression'], 'veryHigh');
+    });
+
+    test('startCapture passes gain control options', () async {
+      await systemCapture.startCapture(
+        config: SystemAudioConfig(
+          agc: const AgcConfig(
+            detector: AgcDetector.loudness,
+            targetDb: -18.0,
+            lookaheadMs: 10,
+          ),
+        ),
+      );
+      expect(methodCallLog[1].arguments['agc'], true);
+      expect(methodCallLog[1].arguments['agcDetector'], 'loudness');
+      expect(methodCallLog[1].arguments['agcTargetDb'], -18.0);
+      expect(methodCallLog[1].arguments['agcLookaheadMs'], 10);
+      expect(methodCallLog[1].arguments['agcCeilingDb'], -1.0);
+    });
+
+    test('startCapture passes compressor options', () async {
+      await systemCapture.startCapture(
+        config: SystemAudioConfig(
+          compressor: const CompressorConfig(thresholdDb: -18.0, ratio: 3.0),
+        ),
+      );
+      expect(methodCallLog[1].arguments['compressor'], true);
+      expect(methodCallLog[1].arguments['compressorThresholdDb'], -18.0);
+      expect(methodCallLog[1].arguments['compressorRatio'], 3.0);
+      expect(methodCallLog[1].arguments['compressorAttackMs'], 5);
+      expect(methodCallLog[1].arguments['compressorCeilingDb'], -1.0);
+    });
+
+    test('speechStream returns null when not recording', () {
+      expect(systemCapture.speechStream, isNull);
+    });
+
+    test('startCapture passes deviceId when set', () async {
+      await systemCapture.startCapture(config: SystemAudioConfig(deviceId: 'source-1'));
+      expect(methodCallLog[1].arguments['deviceId'], 'source-1');
+    });
+
     test('stopCapture throws exception when stop fails', () async {
       await systemCapture.startCapture();
       TestDefaultBinaryMessengerBinding.instance.defaultBinaryMessenger
@@ -215,4 +526,188 @@ void main() {
       expect(systemCapture.decibelStream, isNotNull);
     });
   });
+
+  group('AudioChunk', () {
+    test('fromMap reads timing fields', () {
+      final chunk = AudioChunk.fromMap({
+        'data': Uint8List.fromList([1, 2, 3, 4]),
+        'sequence': 12,
+        'samplePosition': 192000,
+        'captureTimeUs': 5000000,
+        'timestamp': 1700000000.5,
+        'conversionUs': 42,
+        'speechProbability': 0.85,
+      });
+      expect(chunk.data.length, 4);
+      expect(chunk.conversionUs, 42);
+      expect(chunk.speechProbability, 0.85);
+      expect(chunk.sequence, 12);
+      expect(chunk.samplePosition, 192000);
+      expect(chunk.captureTimeUs, 5000000);
+      expect(chunk.captureTime.millisecondsSinceEpoch, 1700000000500);
+      expect(chunk.isUtterance, false);
+    });
+
+    test('fromMap reads utterance bounds', () {
+      final chunk = AudioChunk.fromMap({
+        'data': Uint8List(3200),
+        'sequence': 4,
+        'samplePosition': 16000,
+        'endPosition': 17600,
+        'endReason': 'maxDuration',
+        'captureTimeUs': 5000000,
+        'timestamp': 1700000000.5,
+      });
+      expect(chunk.isUtterance, true);
+      expect(chunk.endPosition, 17600);
+      expect(chunk.endReason, UtteranceEndReason.maxDuration);
+      expect(chunk.speechProbability, isNull);
+    });
+  });
+
+  group('OverrunEvent', () {
+    test('fromMap reads cause and position', () {
+      final event = OverrunEvent.fromMap({
+        'type': 'overrun',
+        'sessionId': 2,
+        'cause': 'serverOverflow',
+        'samplePosition': 32000,
+        'lostFrames': 1600,
+        'durationMs': 100.0,
+        'filled': true,
+        'captureTimeUs': 7000000,
+        'timestamp': 1700000000.0,
+      });
+      expect(event.cause, OverrunCause.serverOverflow);
+      expect(event.track, isNull);
+      expect(event.samplePosition, 32000);
+      expect(event.lostFrames, 1600);
+      expect(event.filled, true);
+    });
+  });
+
+  group('SpeechEvent', () {
+    test('fromMap reads transition and position', () {
+      final event = SpeechEvent.fromMap({
+        'type': 'speech',
+        'sessionId': 3,
+        'speaking': true,
+        'probability': 0.92,
+        'samplePosition': 48000,
+        'captureTimeUs': 9000000,
+        'timestamp': 1700000001.0,
+      });
+      expect(event.sessionId, 3);
+      expect(event.speaking, true);
+      expect(event.probability, 0.92);
+      expect(event.samplePosition, 48000);
+      expect(event.captureTimeUs, 9000000);
+    });
+  });
+
+  group('MelFeatures', () {
+    test('fromMap reads frames', () {
+      final features = MelFeatures.fromMap({
+        'sequence': 7,
+        'samplePosition': 1600,
+        'frameCount': 2,
+        'bins': 3,
+        'hopSamples': 160,
+        'windowSamples': 400,
+        'features': Float32List.fromList([1, 2, 3, 4, 5, 6]),
+        'captureTimeUs': 100000,
+        'timestamp': 1700000000.0,
+      });
+      expect(features.sequence, 7);
+      expect(features.samplePosition, 1600);
+      expect(features.frameCount, 2);
+      expect(features.hopSamples, 160);
+      expect(features.frame(1), [4, 5, 6]);
+    });
+  });
+
+  group('SpectrumData', () {
+    test('fromMap reads levels and normalizes them', () {
+      final spectrum = SpectrumData.fromMap({
+        'sequence': 4,
+        'samplePosition': 4096,
+        'fftSize': 2048,
+        'levels': Float32List.fromList([-120, -45, 0]),
+        'frequencies': [100.0, 1000.0, 10000.0],
+        'captureTimeUs': 200000,
+        'timestamp': 1700000000.0,
+      });
+      expect(spectrum.sequence, 4);
+      expect(spectrum.samplePosition, 4096);
+      expect(spectrum.fftSize, 2048);
+      expect(spectrum.bandCount, 3);
+      expect(spectrum.frequencies, [100.0, 1000.0, 10000.0]);
+      expect(spectrum.normalized(), [0.0, 0.5, 1.0]);
+    });
+  });
+
+  group('WaveformData', () {
+    test('fromMap reads packed buckets of each level', () {
+      final fine = Int16List.fromList([-100, 200, 90, -300, 50, 120]);
+      final coarse = Int16List.fromList([-300, 200, 106]);
+      final waveform = WaveformData.fromMap({
+        'sequence': 2,
+        'samplePosition': 320,
+        'captureTimeUs': 20000,
+        'timestamp': 1700000000.0,
+        'levels': [
+          {
+            'bucketSamples': 160,
+            'samplePosition': 320,
+            'data': fine.buffer.asUint8List(),
+          },
+          {
+            'bucketSamples': 320,
+            'samplePosition': 320,
+            'data': coarse.buffer.asUint8List(),
+          },
+        ],
+      });
+      expect(waveform.sequence, 2);
+      expect(waveform.samplePosition, 320);
+      expect(waveform.levels, hasLength(2));
+      final level = waveform.levels[0];
+      expect(level.bucketSamples, 160);
+      expect(level.bucketCount, 2);
+      expect(level.min(1), -300);
+      expect(level.max(0), 200);
+      expect(level.rms(1), 120);
+      expect(waveform.levels[1].bucketCount, 1);
+      expect(waveform.levels[1].rms(0), 106);
+    });
+  });
+
+  group('DecibelData', () {
+    test('fromMap reads the gain control gains', () {
+      final data = DecibelData.fromMap({
+        'decibel': -20.0,
+        'timestamp': 1.0,
+        'gainDb': 12.5,
+        'limiterGainDb': -0.5,
+      });
+      expect(data.gainDb, 12.5);
+      expect(data.limiterGainDb, -0.5);
+      expect(data.toMap()['gainDb'], 12.5);
+      expect(DecibelData.fromMap({'decibel': -20.0}).gainDb, isNull);
+    });
+
+    test('fromMap reads the compressor gain', () {
+      final data = DecibelData.fromMap({
+        'decibel': -20.0,
+        'timestamp': 1.0,
+        'compressorGainDb': -4.5,
+      });
+      expect(data.compressorGainDb, -4.5);
+      expect(data.toMap()['compressorGainDb'], -4.5);
+      expect(
+        DecibelData.fromMap({'decibel': -20.0}).compressorGainDb,
+        isNull,
+      );
+    });
+  });
 }
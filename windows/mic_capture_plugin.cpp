@@ -1,5 +1,9 @@
 #include "mic_capture_plugin.h"
 
+#include "resampler.h"
+#include "sample_format.h"
+#include "wave_format.h"
+
 #ifndef NOMINMAX
 #define NOMINMAX
 #endif
@@ -29,9 +33,6 @@
 #include <string>
 #include <thread>
 #include <vector>
-// After existing includes, add:
-#include <queue>
-#include <chrono>
 
 #pragma comment(lib, "ole32.lib")
 #pragma comment(lib, "oleaut32.lib")
@@ -88,6 +89,9 @@ constexpr int kDefaultBitsPerSample = 16;
 constexpr float kDefaultGainBoost = 2.5f;
 constexpr float kDefaultInputVolume = 1.0f;
 
+// Chunk length; short chunks keep the latency low.
+constexpr int kChunkMs = 30;
+
 }  // namespace
 
 // static
@@ -101,6 +105,11 @@ MicCapturePlugin::MicCapturePlugin(flutter::PluginRegistrarWindows *registrar)
     : registrar_(registrar),
       is_capturing_(false),
       should_stop_(false),
+      has_listener_(false),
+      has_decibel_listener_(false),
+      queue_head_(0),
+      queue_size_(0),
+      chunk_frames_(0),
       sample_rate_(kDefaultSampleRate),
       channels_(kDefaultChannels),
       bits_per_sample_(kDefaultBitsPerSample),
@@ -136,12 +145,14 @@ MicCapturePlugin::MicCapturePlugin(flutter::PluginRegistrarWindows *registrar)
               -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
             std::lock_guard<std::mutex> lock(mutex_);
             event_sink_ = std::move(events);
+            has_listener_ = true;
             return nullptr;
           },
           [this](const flutter::EncodableValue* arguments)
               -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
             std::lock_guard<std::mutex> lock(mutex_);
             event_sink_.reset();
+            has_listener_ = false;
             return nullptr;
           }));
 
@@ -179,12 +190,14 @@ MicCapturePlugin::MicCapturePlugin(flutter::PluginRegistrarWindows *registrar)
               -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
             std::lock_guard<std::mutex> lock(mutex_);
             decibel_event_sink_ = std::move(events);
+            has_decibel_listener_ = true;
             return nullptr;
           },
           [this](const flutter::EncodableValue* arguments)
               -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
             std::lock_guard<std::mutex> lock(mutex_);
             decibel_event_sink_.reset();
+            has_decibel_listener_ = false;
             return nullptr;
           }));
 }
@@ -193,21 +206,38 @@ MicCapturePlugin::~MicCapturePlugin() {
   StopCapture();
 }
 
-// NEW: Queue audio data from background thread
-void MicCapturePlugin::QueueAudioData(std::vector<uint8_t> data, double decibel) {
+// Queues a processed chunk from the capture thread: |sample_count|
+// samples, none if nobody listens for audio, and the level if
+// |has_decibel|. The samples are copied into a pool buffer, so no
+// allocation happens here.
+void MicCapturePlugin::QueueAudioData(const int16_t* samples,
+                                      size_t sample_count, bool has_decibel,
+                                      double decibel) {
+  const size_t size = sample_count * sizeof(int16_t);
+  uint8_t* data = nullptr;
+  if (size > 0) {
+    data = static_cast<uint8_t*>(chunk_pool_->Acquire());
+    if (data == nullptr) {
+      return;  // Every buffer is queued or being sent.
+    }
+    memcpy(data, samples, size);
+  }
+
   std::lock_guard<std::mutex> lock(queue_mutex_);
   
   // Prevent queue overflow
-  if (audio_queue_.size() >= kMaxQueueSize) {
-    audio_queue_.pop();  // Remove oldest
+  if (queue_size_ == audio_queue_.size()) {
+    PopQueuedPacket();  // Remove oldest
   }
   
-  AudioDataPacket packet;
-  packet.data = std::move(data);
+  AudioDataPacket& packet =
+      audio_queue_[(queue_head_ + queue_size_) % audio_queue_.size()];
+  packet.data = data;
+  packet.size = size;
+  packet.has_decibel = has_decibel;
   packet.decibel = decibel;
   packet.timestamp = std::chrono::steady_clock::now();
-  
-  audio_queue_.push(std::move(packet));
+  ++queue_size_;
   
   // Post task to platform thread to process queue
   registrar_->messenger()->Send(
@@ -225,15 +255,16 @@ void MicCapturePlugin::ProcessQueue() {
   std::lock_guard<std::mutex> lock(queue_mutex_);
   
   // Process all queued packets
-  while (!audio_queue_.empty()) {
-    AudioDataPacket& packet = audio_queue_.front();
+  while (queue_size_ > 0) {
+    AudioDataPacket& packet = audio_queue_[queue_head_];
     
     // Send audio data
     {
       std::lock_guard<std::mutex> sink_lock(mutex_);
-      if (event_sink_) {
+      if (event_sink_ && packet.size > 0) {
         try {
-          event_sink_->Success(flutter::EncodableValue(packet.data));
+          event_sink_->Success(flutter::EncodableValue(
+              std::vector<uint8_t>(packet.data, packet.data + packet.size)));
         } catch (...) {
           // Ignore errors
         }
@@ -243,7 +274,7 @@ void MicCapturePlugin::ProcessQueue() {
     // Send decibel data
     {
       std::lock_guard<std::mutex> sink_lock(mutex_);
-      if (decibel_event_sink_) {
+      if (decibel_event_sink_ && packet.has_decibel) {
         try {
           flutter::EncodableMap decibel_map;
           decibel_map[flutter::EncodableValue("decibel")] = 
@@ -264,7 +295,26 @@ void MicCapturePlugin::ProcessQueue() {
       }
     }
     
-    audio_queue_.pop();
+    PopQueuedPacket();
+  }
+}
+
+// Drops the oldest queued packet, returning its buffer to the pool. Called
+// with |queue_mutex_| held.
+void MicCapturePlugin::PopQueuedPacket() {
+  AudioDataPacket& packet = audio_queue_[queue_head_];
+  if (packet.data != nullptr) {
+    chunk_pool_->Release(packet.data);
+  }
+  queue_head_ = (queue_head_ + 1) % audio_queue_.size();
+  --queue_size_;
+}
+
+// Returns the buffers of chunks never sent to the pool. Platform thread only.
+void MicCapturePlugin::ClearQueue() {
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  while (queue_size_ > 0) {
+    PopQueuedPacket();
   }
 }
 
@@ -303,30 +353,22 @@ void MicCapturePlugin::HandleMethodCall(
 }
 
 void MicCapturePlugin::ApplyGainBoostAndConvertToMono(
-    const int16_t* input, int16_t* output, size_t frame_count,
-    int input_channels, float gain_boost) {
-  const float max_value = 32767.0f;
-  const float min_value = -32768.0f;
-
+    const int16_t* input, float* gained, int16_t* output, size_t frame_count,
+    int input_channels, float gain_boost, Compressor* limiter) {
   if (input_channels == 1) {
     // Mono: just apply gain boost
     for (size_t i = 0; i < frame_count; ++i) {
-      float sample = static_cast<float>(input[i]) * gain_boost;
-      float clamped_sample = (std::min)(max_value, sample);
-      sample = (std::max)(min_value, clamped_sample);
-      output[i] = static_cast<int16_t>(sample);
+      gained[i] = static_cast<float>(input[i]) * gain_boost;
     }
   } else {
     // Stereo: convert to mono and apply gain boost
     for (size_t i = 0; i < frame_count; ++i) {
       float left = static_cast<float>(input[i * 2]);
       float right = static_cast<float>(input[i * 2 + 1]);
-      float mono = (left + right) / 2.0f * gain_boost;
-      float clamped_mono = (std::min)(max_value, mono);
-      mono = (std::max)(min_value, clamped_mono);
-      output[i] = static_cast<int16_t>(mono);
+      gained[i] = (left + right) / 2.0f * gain_boost;
     }
   }
+  limiter->Process(gained, output, frame_count);
 }
 
 double MicCapturePlugin::CalculateDecibel(const int16_t* samples,
@@ -796,6 +838,22 @@ bool MicCapturePlugin::StartCapture(const flutter::EncodableMap* args) {
 
   // Get device name (device_ is already set by OpenWASAPIStreamWithRetry)
   current_device_name_ = GetCurrentDeviceName();
+
+  // Per-chunk storage for the negotiated format, allocated once: the ring
+  // of queued chunks and a buffer for each of them, one being filled and
+  // one being sent. Chunks of an earlier capture are gone by now.
+  chunk_frames_ = mix_format_->nSamplesPerSec * kChunkMs / 1000;
+  resampler_ = std::make_unique<Resampler>(
+      static_cast<int>(mix_format_->nSamplesPerSec), sample_rate_, 1);
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    audio_queue_.assign(kMaxQueueSize, AudioDataPacket());
+    queue_head_ = 0;
+    queue_size_ = 0;
+    chunk_pool_ = std::make_unique<BufferPool>(
+        resampler_->MaxOutputFrames(chunk_frames_) * sizeof(int16_t),
+        kMaxQueueSize + 2);
+  }
   
   {
     std::lock_guard<std::mutex> lock(mutex_);
@@ -829,6 +887,7 @@ bool MicCapturePlugin::StopCapture() {
   if (capture_thread_.joinable()) {
     capture_thread_.join();
   }
+  ClearQueue();
 
   {
     std::lock_guard<std::mutex> lock(mutex_);
@@ -886,37 +945,39 @@ void MicCapturePlugin::CaptureThread() {
     }
 
     const UINT32 frame_size = mix_format_->nBlockAlign;
-    const UINT32 actual_sample_rate = mix_format_->nSamplesPerSec;
     const WORD actual_channels = mix_format_->nChannels;
-    const WORD actual_bits_per_sample = mix_format_->wBitsPerSample;
-    const WORD format_tag = mix_format_->wFormatTag;
-    
-    // Detect format
-    bool is_float_format = false;
-    bool is_pcm_format = false;
-    
-    if (format_tag == WAVE_FORMAT_EXTENSIBLE && mix_format_->cbSize >= 22) {
-      WAVEFORMATEXTENSIBLE* wfex = reinterpret_cast<WAVEFORMATEXTENSIBLE*>(mix_format_);
-      if (IsEqualGUID(wfex->SubFormat, KSDATAFORMAT_SUBTYPE_IEEE_FLOAT)) {
-        is_float_format = true;
-      } else if (IsEqualGUID(wfex->SubFormat, KSDATAFORMAT_SUBTYPE_PCM)) {
-        is_pcm_format = true;
-      }
-    } else if (format_tag == WAVE_FORMAT_IEEE_FLOAT) {
-      is_float_format = true;
-    } else if (format_tag == WAVE_FORMAT_PCM) {
-      is_pcm_format = true;
+
+    // The mix format is fixed while the stream is open, so the conversion
+    // is picked once here rather than per chunk.
+    SampleFormat sample_format;
+    if (!GetWaveSampleFormat(mix_format_, &sample_format)) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      is_capturing_ = false;
+      return;
     }
+    SampleConverter converter(sample_format, SampleFormat::kS16,
+                              Dither::kTriangular);
     
     // FIX LATENCY: Sử dụng chunk size nhỏ hơn (20-50ms) để giảm delay
-    const int effective_chunk_ms = 30; // 30ms chunk size for lower latency
-    const size_t chunk_frames = (actual_sample_rate * effective_chunk_ms / 1000);
+    const size_t chunk_frames = chunk_frames_;
     const size_t chunk_size_bytes = chunk_frames * frame_size;
-    const size_t output_frame_count = (sample_rate_ * effective_chunk_ms / 1000);
+
+    // Keeps its filter history and position across chunks, so chunk
+    // boundaries are seamless.
+    Resampler& resampler = *resampler_;
     
     std::vector<uint8_t> raw_buffer(chunk_size_bytes * 2); // Double buffer for safety
-    std::vector<int16_t> output_buffer(output_frame_count);
+    std::vector<int16_t> converted_samples(chunk_frames * actual_channels);
+    std::vector<int16_t> mono_buffer(chunk_frames);
+    // Only what the gain boost takes past full scale is limited.
+    CompressorOptions limiter_options;
+    limiter_options.ratio = 1.0;
+    limiter_options.ceiling_db = 0.0;
+    Compressor limiter(static_cast<int>(mix_format_->nSamplesPerSec), limiter_options);
+    std::vector<float> gained_buffer(chunk_frames);
+    std::vector<int16_t> output_buffer(resampler.MaxOutputFrames(chunk_frames));
     size_t raw_buffer_pos = 0;
+    bool idle = false;  // Chunks were skipped for lack of listeners.
 
     while (!should_stop_) {
       UINT32 num_frames_available = 0;
@@ -957,90 +1018,51 @@ void MicCapturePlugin::CaptureThread() {
             if (raw_buffer_pos >= chunk_size_bytes) {
               const size_t input_frame_count = chunk_size_bytes / frame_size;
               const size_t total_samples = input_frame_count * actual_channels;
-              
-              std::vector<int16_t> converted_samples(total_samples);
-              bool conversion_success = false;
-              
-              // Format conversion
-              if (is_pcm_format && actual_bits_per_sample == 16) {
-                const int16_t* raw_samples = reinterpret_cast<const int16_t*>(raw_buffer.data());
-                converted_samples.assign(raw_samples, raw_samples + total_samples);
-                conversion_success = true;
-              } else if (is_float_format && actual_bits_per_sample == 32) {
-                const float* float_samples = reinterpret_cast<const float*>(raw_buffer.data());
-                for (size_t i = 0; i < total_samples; ++i) {
-                  float sample = (std::min)(1.0f, (std::max)(-1.0f, float_samples[i]));
-                  converted_samples[i] = static_cast<int16_t>(sample * 32767.0f);
-                }
-                conversion_success = true;
-              } else if (is_pcm_format && actual_bits_per_sample == 24) {
-                const uint8_t* raw_bytes = raw_buffer.data();
-                for (size_t i = 0; i < total_samples; ++i) {
-                  size_t byte_offset = i * 3;
-                  int32_t sample24 = (static_cast<int32_t>(raw_bytes[byte_offset]) |
-                                     (static_cast<int32_t>(raw_bytes[byte_offset + 1]) << 8) |
-                                     (static_cast<int32_t>(raw_bytes[byte_offset + 2]) << 16));
-                  if (sample24 & 0x800000) sample24 |= 0xFF000000;
-                  converted_samples[i] = static_cast<int16_t>(sample24 >> 8);
-                }
-                conversion_success = true;
-              } else if (is_pcm_format && actual_bits_per_sample == 32) {
-                const int32_t* int32_samples = reinterpret_cast<const int32_t*>(raw_buffer.data());
-                for (size_t i = 0; i < total_samples; ++i) {
-                  converted_samples[i] = static_cast<int16_t>(int32_samples[i] >> 16);
+
+              // Read once per chunk, so processing follows listeners as they
+              // come and go. Without any, the chunk is only consumed.
+              const bool wants_audio = has_listener_;
+              const bool wants_decibel = has_decibel_listener_;
+              if (!wants_audio && !wants_decibel) {
+                idle = true;
+              } else {
+                if (idle) {
+                  // The history is from before the pause.
+                  resampler.Reset();
+                  idle = false;
                 }
-                conversion_success = true;
-              }
-              
-              if (!conversion_success) {
-                raw_buffer_pos = 0;
-                continue;
-              }
-              
-              if (input_volume_ > 0.0f && input_volume_ < 1.0f) {
-                for (size_t i = 0; i < total_samples; ++i) {
-                  converted_samples[i] = static_cast<int16_t>(
-                      static_cast<float>(converted_samples[i]) * input_volume_);
+
+                converter.Convert(raw_buffer.data(), converted_samples.data(),
+                                  total_samples);
+                
+                if (input_volume_ > 0.0f && input_volume_ < 1.0f) {
+                  for (size_t i = 0; i < total_samples; ++i) {
+                    converted_samples[i] = static_cast<int16_t>(
+                        static_cast<float>(converted_samples[i]) * input_volume_);
+                  }
                 }
-              }
 
-              const size_t input_frames = converted_samples.size() / actual_channels;
-              
-              // First: Convert to mono and apply gain boost (at input sample rate)
-              std::vector<int16_t> mono_buffer(input_frames);
-              ApplyGainBoostAndConvertToMono(converted_samples.data(), mono_buffer.data(),
-                                              input_frames, actual_channels, gain_boost_);
-              
-              // Second: Resample if sample rates differ
-              // Calculate correct output frames based on resampling ratio
-              size_t output_frames;
-              if (actual_sample_rate != static_cast<UINT32>(sample_rate_)) {
-                // Calculate output frames after resampling
-                output_frames = static_cast<size_t>(
-                    static_cast<double>(input_frames) * static_cast<double>(sample_rate_) / 
-                    static_cast<double>(actual_sample_rate));
-                output_frames = (std::min)(output_frames, output_frame_count);
+                // First: Convert to mono and apply gain boost (at input sample rate)
+                ApplyGainBoostAndConvertToMono(converted_samples.data(), gained_buffer.data(),
+                                               mono_buffer.data(), input_frame_count,
+                                               actual_channels, gain_boost_, &limiter);
                 
-                // Resample from actual_sample_rate to sample_rate_
-                ResampleAudio(mono_buffer.data(), input_frames,
-                             output_buffer.data(), output_frames,
-                             actual_sample_rate, sample_rate_);
-              } else {
-                // No resampling needed, just copy
-                output_frames = (std::min)(input_frames, output_frame_count);
-                memcpy(output_buffer.data(), mono_buffer.data(), output_frames * sizeof(int16_t));
+                // Second: Resample to sample_rate_ (a copy if the rates match)
+                const size_t output_frames =
+                    resampler.Process(mono_buffer.data(), input_frame_count,
+                                      output_buffer.data(), output_buffer.size());
+
+                const double decibel =
+                    wants_decibel
+                        ? CalculateDecibel(output_buffer.data(), output_frames)
+                        : 0.0;
+
+                // CHANGED: Queue instead of direct send
+                QueueAudioData(output_buffer.data(),
+                               wants_audio ? output_frames : 0, wants_decibel,
+                               decibel);
               }
 
-              double decibel = CalculateDecibel(output_buffer.data(), output_frames);
-
-              // CHANGED: Queue instead of direct send
-              const size_t output_bytes = output_frames * sizeof(int16_t);
-              std::vector<uint8_t> audio_data(
-                  reinterpret_cast<uint8_t*>(output_buffer.data()),
-                  reinterpret_cast<uint8_t*>(output_buffer.data()) + output_bytes);
-              
-              QueueAudioData(std::move(audio_data), decibel);
-
               if (raw_buffer_pos > chunk_size_bytes) {
                 const size_t remaining = raw_buffer_pos - chunk_size_bytes;
                 memmove(raw_buffer.data(), raw_buffer.data() + chunk_size_bytes, remaining);
@@ -1068,44 +1090,6 @@ void MicCapturePlugin::CaptureThread() {
   }
 }
 
-// Resample audio using linear interpolation
-void MicCapturePlugin::ResampleAudio(const int16_t* input, size_t input_frames,
-                                     int16_t* output, size_t output_frames,
-                                     int input_sample_rate, int output_sample_rate) {
-  if (input_frames == 0 || output_frames == 0) {
-    return;
-  }
-  
-  if (input_sample_rate == output_sample_rate) {
-    const size_t copy_frames = (std::min)(input_frames, output_frames);
-    memcpy(output, input, copy_frames * sizeof(int16_t));
-    return;
-  }
-  
-  // Linear interpolation resampling
-  const double ratio = static_cast<double>(input_sample_rate) / static_cast<double>(output_sample_rate);
-  
-  for (size_t i = 0; i < output_frames; ++i) {
-    const double src_pos = static_cast<double>(i) * ratio;
-    const size_t src_index = static_cast<size_t>(src_pos);
-    const double fraction = src_pos - static_cast<double>(src_index);
-    
-    if (src_index + 1 < input_frames) {
-      // Linear interpolation between two samples
-      const double sample0 = static_cast<double>(input[src_index]);
-      const double sample1 = static_cast<double>(input[src_index + 1]);
-      const double interpolated = sample0 + (sample1 - sample0) * fraction;
-      output[i] = static_cast<int16_t>((std::max)(-32768.0, (std::min)(32767.0, interpolated)));
-    } else if (src_index < input_frames) {
-      // Last sample, no interpolation
-      output[i] = input[src_index];
-    } else {
-      // Beyond input, use last sample
-      output[i] = input[input_frames - 1];
-    }
-  }
-}
-
 // Set high priority for capture thread to reduce latency
 void MicCapturePlugin::SetThreadPriority() {
   HANDLE current_thread = GetCurrentThread();
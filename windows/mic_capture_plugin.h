@@ -12,13 +12,15 @@
 #include <atomic>
 #include <vector>
 #include <string>
-// After existing includes, add:
-#include <queue>
 #include <chrono>
 
 // Include Windows headers for WAVEFORMATEX
 #include <mmsystem.h>
 
+#include "buffer_pool.h"
+#include "compressor.h"
+#include "resampler.h"
+
 // Forward declarations for WASAPI interfaces
 struct IAudioClient;
 struct IAudioCaptureClient;
@@ -26,8 +28,13 @@ struct IMMDevice;
 
 namespace audio_capture {
 
+// A chunk waiting for the platform thread. |data| is a buffer of the
+// capture's chunk pool, returned to it once the chunk is sent, or null if
+// nobody listened for audio.
 struct AudioDataPacket {
-  std::vector<uint8_t> data;
+  uint8_t* data;
+  size_t size;
+  bool has_decibel;  // Whether |decibel| was measured.
   double decibel;
   std::chrono::steady_clock::time_point timestamp;
 };
@@ -53,15 +60,19 @@ class MicCapturePlugin : public flutter::Plugin {
   void CaptureThread();
   void ProcessQueue();
   double CalculateDecibel(const int16_t* samples, size_t sample_count);
-  void ApplyGainBoostAndConvertToMono(const int16_t* input, int16_t* output,
-                                     size_t frame_count, int input_channels,
-                                     float gain_boost);
-  void ResampleAudio(const int16_t* input, size_t input_frames,
-                     int16_t* output, size_t output_frames,
-                     int input_sample_rate, int output_sample_rate);
+  // Downmixes to mono with the gain boost. Samples the boost takes past
+  // full scale are brought back by |limiter| instead of being clipped;
+  // |gained| is |frame_count| floats of scratch.
+  void ApplyGainBoostAndConvertToMono(const int16_t* input, float* gained,
+                                      int16_t* output, size_t frame_count,
+                                      int input_channels, float gain_boost,
+                                      Compressor* limiter);
   void SendStatusUpdate(bool is_active, const std::string& device_name = "");
   void SendDecibelUpdate(double decibel);
-  void QueueAudioData(std::vector<uint8_t> data, double decibel);
+  void QueueAudioData(const int16_t* samples, size_t sample_count,
+                      bool has_decibel, double decibel);
+  void PopQueuedPacket();
+  void ClearQueue();
   bool HasInputDevice();
   std::vector<flutter::EncodableValue> GetAvailableInputDevices();
   std::string GetCurrentDeviceName();
@@ -85,13 +96,27 @@ class MicCapturePlugin : public flutter::Plugin {
   std::mutex mutex_;
   std::atomic<bool> is_capturing_;
   std::atomic<bool> should_stop_;
+  // Whether the audio and decibel streams have listeners, read by the
+  // capture thread for every chunk to skip work nobody consumes.
+  std::atomic<bool> has_listener_;
+  std::atomic<bool> has_decibel_listener_;
   std::thread capture_thread_;
   std::string current_device_name_;
 
-  // NEW: Queue cho audio data
-  std::queue<AudioDataPacket> audio_queue_;
+  // Chunks waiting for the platform thread: a ring of kMaxQueueSize
+  // packets holding buffers of |chunk_pool_|. Both are sized in
+  // StartCapture from the negotiated format, so capturing allocates
+  // nothing per chunk.
+  std::vector<AudioDataPacket> audio_queue_;
+  size_t queue_head_;
+  size_t queue_size_;
+  std::unique_ptr<BufferPool> chunk_pool_;
   std::mutex queue_mutex_;
   static constexpr size_t kMaxQueueSize = 50;  // Limit queue size
+
+  // Capture thread state, set up in StartCapture.
+  size_t chunk_frames_;  // Frames per chunk at the device rate.
+  std::unique_ptr<Resampler> resampler_;
   
   // Audio configuration
   int sample_rate_;
@@ -1,5 +1,9 @@
 #include "system_audio_capture_plugin.h"
 
+#include "resampler.h"
+#include "sample_format.h"
+#include "wave_format.h"
+
 #define NOMINMAX
 #include <windows.h>
 #undef max
@@ -95,6 +99,8 @@ SystemAudioCapturePlugin::SystemAudioCapturePlugin(
     : registrar_(registrar),
       is_capturing_(false),
       should_stop_(false),
+      has_listener_(false),
+      has_decibel_listener_(false),
       sample_rate_(kDefaultSampleRate),
       channels_(kDefaultChannels),
       bits_per_sample_(kDefaultBitsPerSample),
@@ -131,12 +137,14 @@ SystemAudioCapturePlugin::SystemAudioCapturePlugin(
               -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
             std::lock_guard<std::mutex> lock(mutex_);
             event_sink_ = std::move(events);
+            has_listener_ = true;
             return nullptr;
           },
           [this](const flutter::EncodableValue* arguments)
               -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
             std::lock_guard<std::mutex> lock(mutex_);
             event_sink_.reset();
+            has_listener_ = false;
             return nullptr;
           }));
 
@@ -174,12 +182,14 @@ SystemAudioCapturePlugin::SystemAudioCapturePlugin(
               -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
             std::lock_guard<std::mutex> lock(mutex_);
             decibel_event_sink_ = std::move(events);
+            has_decibel_listener_ = true;
             return nullptr;
           },
           [this](const flutter::EncodableValue* arguments)
               -> std::unique_ptr<flutter::StreamHandlerError<flutter::EncodableValue>> {
             std::lock_guard<std::mutex> lock(mutex_);
             decibel_event_sink_.reset();
+            has_decibel_listener_ = false;
             return nullptr;
           }));
 }
@@ -211,30 +221,22 @@ void SystemAudioCapturePlugin::HandleMethodCall(
 }
 
 void SystemAudioCapturePlugin::ApplyGainBoostAndConvertToMono(
-    const int16_t* input, int16_t* output, size_t frame_count,
-    int input_channels, float gain_boost) {
-  const float max_value = 32767.0f;
-  const float min_value = -32768.0f;
-
+    const int16_t* input, float* gained, int16_t* output, size_t frame_count,
+    int input_channels, float gain_boost, Compressor* limiter) {
   if (input_channels == 1) {
     // Mono: just apply gain boost
     for (size_t i = 0; i < frame_count; ++i) {
-      float sample = static_cast<float>(input[i]) * gain_boost;
-      float clamped_sample = (std::min)(max_value, sample);
-      sample = (std::max)(min_value, clamped_sample);
-      output[i] = static_cast<int16_t>(sample);
+      gained[i] = static_cast<float>(input[i]) * gain_boost;
     }
   } else {
     // Stereo: convert to mono and apply gain boost
     for (size_t i = 0; i < frame_count; ++i) {
       float left = static_cast<float>(input[i * 2]);
       float right = static_cast<float>(input[i * 2 + 1]);
-      float mono = (left + right) / 2.0f * gain_boost;
-      float clamped_mono = (std::min)(max_value, mono);
-      mono = (std::max)(min_value, clamped_mono);
-      output[i] = static_cast<int16_t>(mono);
+      gained[i] = (left + right) / 2.0f * gain_boost;
     }
   }
+  limiter->Process(gained, output, frame_count);
 }
 
 double SystemAudioCapturePlugin::CalculateDecibel(const int16_t* samples,
@@ -597,7 +599,17 @@ void SystemAudioCapturePlugin::CaptureThread() {
     const UINT32 frame_size = mix_format_->nBlockAlign;
     const UINT32 actual_sample_rate = mix_format_->nSamplesPerSec;
     const WORD actual_channels = mix_format_->nChannels;
-    const WORD actual_bits_per_sample = mix_format_->wBitsPerSample;
+
+    // The mix format is fixed while the stream is open, so the conversion
+    // is picked once here rather than per chunk.
+    SampleFormat sample_format;
+    if (!GetWaveSampleFormat(mix_format_, &sample_format)) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      is_capturing_ = false;
+      return;
+    }
+    SampleConverter converter(sample_format, SampleFormat::kS16,
+                              Dither::kTriangular);
     
     // FIX LATENCY 1: Giảm chunk size xuống tối đa 50ms để giảm delay
     // Sử dụng chunk nhỏ hơn để gửi data nhanh hơn
@@ -606,11 +618,23 @@ void SystemAudioCapturePlugin::CaptureThread() {
     // Calculate smaller chunk size for lower latency
     const size_t chunk_frames = (actual_sample_rate * effective_chunk_ms / 1000);
     const size_t chunk_size_bytes = chunk_frames * frame_size;
-    const size_t output_frame_count = (sample_rate_ * effective_chunk_ms / 1000);
+
+    // The shared mix format rarely matches the requested rate. The resampler
+    // keeps its filter history and position across chunks.
+    Resampler resampler(static_cast<int>(actual_sample_rate), sample_rate_, 1);
     
     std::vector<uint8_t> raw_buffer(chunk_size_bytes * 2); // Double buffer for safety
-    std::vector<int16_t> output_buffer(output_frame_count);
+    std::vector<int16_t> converted_samples(chunk_frames * actual_channels);
+    std::vector<int16_t> mono_buffer(chunk_frames);
+    // Only what the gain boost takes past full scale is limited.
+    CompressorOptions limiter_options;
+    limiter_options.ratio = 1.0;
+    limiter_options.ceiling_db = 0.0;
+    Compressor limiter(static_cast<int>(actual_sample_rate), limiter_options);
+    std::vector<float> gained_buffer(chunk_frames);
+    std::vector<int16_t> output_buffer(resampler.MaxOutputFrames(chunk_frames));
     size_t raw_buffer_pos = 0;
+    bool idle = false;  // Chunks were skipped for lack of listeners.
 
     // FIX LATENCY 2: Giảm sleep time xuống tối thiểu để giảm delay
     const int sleep_time_ms = 1; // Giảm xuống 1ms để phản hồi nhanh hơn
@@ -666,76 +690,61 @@ void SystemAudioCapturePlugin::CaptureThread() {
             if (raw_buffer_pos >= chunk_size_bytes) {
               const size_t input_frame_count = chunk_size_bytes / frame_size;
               const size_t total_samples = input_frame_count * actual_channels;
-              
-              std::vector<int16_t> converted_samples(total_samples);
-              bool conversion_success = false;
-              
-              // Convert based on format
-              if (actual_bits_per_sample == 16 && 
-                  (mix_format_->wFormatTag == WAVE_FORMAT_PCM || 
-                   mix_format_->wFormatTag == WAVE_FORMAT_EXTENSIBLE)) {
-                const int16_t* raw_samples = reinterpret_cast<const int16_t*>(raw_buffer.data());
-                converted_samples.assign(raw_samples, raw_samples + total_samples);
-                conversion_success = true;
-              } else if (actual_bits_per_sample == 32 && 
-                         (mix_format_->wFormatTag == WAVE_FORMAT_IEEE_FLOAT ||
-                          mix_format_->wFormatTag == WAVE_FORMAT_EXTENSIBLE)) {
-                const float* float_samples = reinterpret_cast<const float*>(raw_buffer.data());
-                for (size_t i = 0; i < total_samples; ++i) {
-                  float sample = (std::min)(1.0f, (std::max)(-1.0f, float_samples[i]));
-                  converted_samples[i] = static_cast<int16_t>(sample * 32767.0f);
+
+              // Read once per chunk, so processing follows listeners as they
+              // come and go. Without any, the chunk is only consumed.
+              const bool wants_audio = has_listener_;
+              const bool wants_decibel = has_decibel_listener_;
+              if (!wants_audio && !wants_decibel) {
+                idle = true;
+              } else {
+                if (idle) {
+                  // The history is from before the pause.
+                  resampler.Reset();
+                  idle = false;
                 }
-                conversion_success = true;
-              } else if (actual_bits_per_sample == 24) {
-                const uint8_t* raw_bytes = raw_buffer.data();
-                for (size_t i = 0; i < total_samples; ++i) {
-                  size_t byte_offset = i * 3;
-                  int32_t sample24 = (static_cast<int32_t>(raw_bytes[byte_offset]) |
-                                     (static_cast<int32_t>(raw_bytes[byte_offset + 1]) << 8) |
-                                     (static_cast<int32_t>(raw_bytes[byte_offset + 2]) << 16));
-                  if (sample24 & 0x800000) {
-                    sample24 |= 0xFF000000;
+
+                converter.Convert(raw_buffer.data(), converted_samples.data(),
+                                  total_samples);
+                
+                // Apply input volume if needed
+                if (input_volume_ > 0.0f && input_volume_ < 1.0f) {
+                  for (size_t i = 0; i < total_samples; ++i) {
+                    converted_samples[i] = static_cast<int16_t>(
+                        static_cast<float>(converted_samples[i]) * input_volume_);
                   }
-                  converted_samples[i] = static_cast<int16_t>(sample24 >> 8);
                 }
-                conversion_success = true;
-              }
-              
-              if (!conversion_success) {
-                raw_buffer_pos = 0;
-                continue;
-              }
-              
-              // Apply input volume if needed
-              if (input_volume_ > 0.0f && input_volume_ < 1.0f) {
-                for (size_t i = 0; i < total_samples; ++i) {
-                  converted_samples[i] = static_cast<int16_t>(
-                      static_cast<float>(converted_samples[i]) * input_volume_);
-                }
-              }
-
-              const size_t frames_to_process = converted_samples.size() / actual_channels;
-              const size_t output_frames = (std::min)(frames_to_process, output_frame_count);
 
-              ApplyGainBoostAndConvertToMono(converted_samples.data(), output_buffer.data(),
-                                              output_frames, actual_channels, gain_boost_);
-
-              double decibel = CalculateDecibel(output_buffer.data(), output_frames);
+                const size_t frames_to_process = input_frame_count;
+
+                ApplyGainBoostAndConvertToMono(converted_samples.data(), gained_buffer.data(),
+                                               mono_buffer.data(), frames_to_process,
+                                               actual_channels, gain_boost_, &limiter);
+                const size_t output_frames =
+                    resampler.Process(mono_buffer.data(), frames_to_process,
+                                      output_buffer.data(), output_buffer.size());
+
+                // FIX LATENCY 5: Tối ưu mutex - giữ lock thời gian ngắn nhất
+                if (wants_audio) {
+                  std::lock_guard<std::mutex> lock(mutex_);
+                  if (event_sink_) {
+                    // Built in place: the message's own copy is the only
+                    // allocation of the chunk.
+                    const size_t output_bytes = output_frames * sizeof(int16_t);
+                    const uint8_t* output_data =
+                        reinterpret_cast<const uint8_t*>(output_buffer.data());
+                    event_sink_->Success(flutter::EncodableValue(
+                        std::vector<uint8_t>(output_data,
+                                             output_data + output_bytes)));
+                  }
+                }
 
-              // FIX LATENCY 5: Tối ưu mutex - giữ lock thời gian ngắn nhất
-              {
-                std::lock_guard<std::mutex> lock(mutex_);
-                if (event_sink_) {
-                  const size_t output_bytes = output_frames * sizeof(int16_t);
-                  std::vector<uint8_t> audio_data(
-                      reinterpret_cast<uint8_t*>(output_buffer.data()),
-                      reinterpret_cast<uint8_t*>(output_buffer.data()) + output_bytes);
-                  event_sink_->Success(flutter::EncodableValue(audio_data));
+                if (wants_decibel) {
+                  SendDecibelUpdate(
+                      CalculateDecibel(output_buffer.data(), output_frames));
                 }
               }
 
-              SendDecibelUpdate(decibel);
-
               // Move remaining data
               if (raw_buffer_pos > chunk_size_bytes) {
                 const size_t remaining = raw_buffer_pos - chunk_size_bytes;
@@ -12,6 +12,8 @@
 #include <atomic>
 #include <vector>
 
+#include "compressor.h"
+
 // Include Windows headers for WAVEFORMATEX
 #include <mmsystem.h>
 
@@ -43,9 +45,13 @@ class SystemAudioCapturePlugin : public flutter::Plugin {
   void CaptureThread();
   void SetThreadPriority();
   double CalculateDecibel(const int16_t* samples, size_t sample_count);
-  void ApplyGainBoostAndConvertToMono(const int16_t* input, int16_t* output,
-                                      size_t frame_count, int input_channels,
-                                      float gain_boost);
+  // Downmixes to mono with the gain boost. Samples the boost takes past
+  // full scale are brought back by |limiter| instead of being clipped;
+  // |gained| is |frame_count| floats of scratch.
+  void ApplyGainBoostAndConvertToMono(const int16_t* input, float* gained,
+                                      int16_t* output, size_t frame_count,
+                                      int input_channels, float gain_boost,
+                                      Compressor* limiter);
   void SendStatusUpdate(bool is_active);
   void SendDecibelUpdate(double decibel);
 
@@ -62,6 +68,10 @@ class SystemAudioCapturePlugin : public flutter::Plugin {
   std::mutex mutex_;
   std::atomic<bool> is_capturing_;
   std::atomic<bool> should_stop_;
+  // Whether the audio and decibel streams have listeners, read by the
+  // capture thread for every chunk to skip work nobody consumes.
+  std::atomic<bool> has_listener_;
+  std::atomic<bool> has_decibel_listener_;
   std::thread capture_thread_;
   
   // Audio configuration
@@ -0,0 +1,51 @@
+#include "wave_format.h"
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <mmreg.h>
+#include <ks.h>
+#include <ksmedia.h>
+
+namespace audio_capture {
+
+bool GetWaveSampleFormat(const WAVEFORMATEX* format,
+                         SampleFormat* sample_format) {
+  if (format == nullptr) {
+    return false;
+  }
+
+  bool is_float = false;
+  bool is_pcm = false;
+  if (format->wFormatTag == WAVE_FORMAT_EXTENSIBLE && format->cbSize >= 22) {
+    const WAVEFORMATEXTENSIBLE* extensible =
+        reinterpret_cast<const WAVEFORMATEXTENSIBLE*>(format);
+    if (IsEqualGUID(extensible->SubFormat, KSDATAFORMAT_SUBTYPE_IEEE_FLOAT)) {
+      is_float = true;
+    } else if (IsEqualGUID(extensible->SubFormat, KSDATAFORMAT_SUBTYPE_PCM)) {
+      is_pcm = true;
+    }
+  } else if (format->wFormatTag == WAVE_FORMAT_IEEE_FLOAT) {
+    is_float = true;
+  } else if (format->wFormatTag == WAVE_FORMAT_PCM) {
+    is_pcm = true;
+  }
+
+  if (is_float && format->wBitsPerSample == 32) {
+    *sample_format = SampleFormat::kF32;
+  } else if (is_float && format->wBitsPerSample == 64) {
+    *sample_format = SampleFormat::kF64;
+  } else if (is_pcm && format->wBitsPerSample == 16) {
+    *sample_format = SampleFormat::kS16;
+  } else if (is_pcm && format->wBitsPerSample == 24) {
+    *sample_format = SampleFormat::kS24;
+  } else if (is_pcm && format->wBitsPerSample == 32) {
+    *sample_format = SampleFormat::kS32;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+}  // namespace audio_capture
@@ -0,0 +1,20 @@
+#ifndef FLUTTER_PLUGIN_WAVE_FORMAT_H_
+#define FLUTTER_PLUGIN_WAVE_FORMAT_H_
+
+// Include Windows headers for WAVEFORMATEX
+#include <mmsystem.h>
+
+#include "sample_format.h"
+
+namespace audio_capture {
+
+// Reads the sample format of a WASAPI mix format into |sample_format|.
+// Returns false for formats the plugin cannot convert. Samples with fewer
+// valid bits than their container are left-aligned, so 24 valid bits in 32
+// read as kS32.
+bool GetWaveSampleFormat(const WAVEFORMATEX* format,
+                         SampleFormat* sample_format);
+
+}  // namespace audio_capture
+
+#endif  // FLUTTER_PLUGIN_WAVE_FORMAT_H_